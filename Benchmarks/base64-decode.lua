@@ -13,6 +13,7 @@ local inputs = {
 	luaopenssl = {},
 	openssl = {},
 	argon2 = {},
+	simd = {},
 }
 
 for i = 1, SAMPLE_SIZE, 1 do
@@ -35,6 +36,7 @@ for i, randomBytes in ipairs(inputs) do
 	inputs.luaopenssl[i] = openssl.base64(randomBytes)
 	inputs.openssl[i] = crypto.toBase64(randomBytes)
 	inputs.argon2[i] = crypto.toCompactBase64(randomBytes)
+	inputs.simd[i] = crypto.encodeBase64(randomBytes)
 end
 
 console.stopTimer("Generate random samples")
@@ -64,6 +66,14 @@ local availableBenchmarks = {
 		end
 		console.stopTimer("[Base64] Decoding with FFI bindings to Argon2")
 	end,
+
+	function()
+		console.startTimer("[Base64] Decoding with SIMD codec")
+		for i = 1, SAMPLE_SIZE, 1 do
+			crypto.decodeBase64(inputs.simd[i])
+		end
+		console.stopTimer("[Base64] Decoding with SIMD codec")
+	end,
 }
 
 table.shuffle(availableBenchmarks)
@@ -5,6 +5,7 @@ local openssl = require("openssl")
 local tinsert = table.insert
 
 local SAMPLE_SIZE = 10000
+local URL_SAFE_OPTIONS = { alphabet = crypto.BASE64_ALPHABET_URL_SAFE, padding = false }
 
 printf("Generating %d randomized samples of varying lengths", SAMPLE_SIZE)
 console.startTimer("Generate random samples")
@@ -54,6 +55,22 @@ local availableBenchmarks = {
 		end
 		console.stopTimer("[Base64] Encoding with FFI bindings to Argon2")
 	end,
+
+	function()
+		console.startTimer("[Base64] Encoding with SIMD codec")
+		for i = 1, SAMPLE_SIZE, 1 do
+			crypto.encodeBase64(inputs[i])
+		end
+		console.stopTimer("[Base64] Encoding with SIMD codec")
+	end,
+
+	function()
+		console.startTimer("[Base64] Encoding with SIMD codec (URL-safe, unpadded)")
+		for i = 1, SAMPLE_SIZE, 1 do
+			crypto.encodeBase64(inputs[i], URL_SAFE_OPTIONS)
+		end
+		console.stopTimer("[Base64] Encoding with SIMD codec (URL-safe, unpadded)")
+	end,
 }
 
 table.shuffle(availableBenchmarks)
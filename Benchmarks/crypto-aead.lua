@@ -0,0 +1,94 @@
+local console = require("console")
+local crypto = require("crypto")
+local openssl = require("openssl")
+
+local tinsert = table.insert
+
+local BYTES_PER_BENCHMARK = 16 * 1024 * 1024
+local MESSAGE_SIZES = { 64, 1024, 16 * 1024, 1024 * 1024 }
+local NUM_SAMPLES_PER_SIZE = 16
+local KEY = openssl.random(32)
+local NONCE = openssl.random(12)
+local ASSOCIATED_DATA = "benchmark-header"
+
+printf("Generating %d randomized samples for each message size", NUM_SAMPLES_PER_SIZE)
+console.startTimer("Generate random samples")
+
+local inputs = {}
+
+for _, messageSize in ipairs(MESSAGE_SIZES) do
+	inputs[messageSize] = {}
+	for i = 1, NUM_SAMPLES_PER_SIZE, 1 do
+		tinsert(inputs[messageSize], openssl.random(messageSize))
+	end
+end
+
+console.stopTimer("Generate random samples")
+
+local algorithms = {
+	crypto.AEAD_AES_256_GCM,
+	crypto.AEAD_CHACHA20_POLY1305,
+}
+
+math.randomseed(os.clock())
+local availableBenchmarks = {}
+
+for _, algorithm in ipairs(algorithms) do
+	for _, messageSize in ipairs(MESSAGE_SIZES) do
+		local samples = inputs[messageSize]
+		local numMessages = math.max(NUM_SAMPLES_PER_SIZE, BYTES_PER_BENCHMARK / messageSize)
+
+		-- Doesn't compute the tag, so this is only a lower bound for the cost of using LuaOpenSSL here
+		tinsert(availableBenchmarks, function()
+			local label = format("[%s] Encrypting %d x %d bytes with LuaOpenSSL", algorithm, numMessages, messageSize)
+			console.startTimer(label)
+			for i = 1, numMessages, 1 do
+				openssl.cipher.encrypt(algorithm, samples[i % NUM_SAMPLES_PER_SIZE + 1], KEY, NONCE)
+			end
+			console.stopTimer(label)
+		end)
+
+		tinsert(availableBenchmarks, function()
+			local label = format("[%s] Sealing %d x %d bytes with FFI bindings", algorithm, numMessages, messageSize)
+			local aeadKey = crypto.createAEADKey(algorithm, KEY)
+			console.startTimer(label)
+			for i = 1, numMessages, 1 do
+				aeadKey:seal(samples[i % NUM_SAMPLES_PER_SIZE + 1], ASSOCIATED_DATA)
+			end
+			console.stopTimer(label)
+		end)
+
+		tinsert(availableBenchmarks, function()
+			local label =
+				format("[%s] Sealing %d x %d bytes with FFI bindings (batched)", algorithm, numMessages, messageSize)
+			local aeadKey = crypto.createAEADKey(algorithm, KEY)
+			local batch = {}
+			for i = 1, numMessages, 1 do
+				batch[i] = samples[i % NUM_SAMPLES_PER_SIZE + 1]
+			end
+			console.startTimer(label)
+			aeadKey:sealBatch(batch, ASSOCIATED_DATA)
+			console.stopTimer(label)
+		end)
+
+		tinsert(availableBenchmarks, function()
+			local label = format("[%s] Opening %d x %d bytes with FFI bindings", algorithm, numMessages, messageSize)
+			local aeadKey = crypto.createAEADKey(algorithm, KEY)
+			local sealedMessages = {}
+			for i = 1, NUM_SAMPLES_PER_SIZE, 1 do
+				sealedMessages[i] = aeadKey:seal(samples[i], ASSOCIATED_DATA)
+			end
+			console.startTimer(label)
+			for i = 1, numMessages, 1 do
+				aeadKey:open(sealedMessages[i % NUM_SAMPLES_PER_SIZE + 1], ASSOCIATED_DATA)
+			end
+			console.stopTimer(label)
+		end)
+	end
+end
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
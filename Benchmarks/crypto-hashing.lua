@@ -0,0 +1,101 @@
+local console = require("console")
+local crypto = require("crypto")
+local openssl = require("openssl")
+
+local tinsert = table.insert
+
+local SAMPLE_SIZE = 10000
+local HMAC_KEY = "benchmark-key"
+
+printf("Generating %d randomized samples of varying lengths", SAMPLE_SIZE)
+console.startTimer("Generate random samples")
+
+local inputs = {}
+
+for i = 1, SAMPLE_SIZE, 1 do
+	tinsert(inputs, openssl.random(16))
+	tinsert(inputs, openssl.random(64))
+	tinsert(inputs, openssl.random(256))
+	tinsert(inputs, openssl.random(1024))
+	tinsert(inputs, openssl.random(4096))
+end
+
+console.stopTimer("Generate random samples")
+
+local algorithms = {
+	crypto.DIGEST_SHA1,
+	crypto.DIGEST_SHA256,
+	crypto.DIGEST_SHA512,
+	crypto.DIGEST_BLAKE2B512,
+}
+
+math.randomseed(os.clock())
+local availableBenchmarks = {}
+
+for _, algorithm in ipairs(algorithms) do
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] Hashing with LuaOpenSSL", algorithm)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			openssl.digest.digest(algorithm, inputs[i], true)
+		end
+		console.stopTimer(label)
+	end)
+
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] Hashing with FFI bindings (one-shot)", algorithm)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			crypto.digest(algorithm, inputs[i])
+		end
+		console.stopTimer(label)
+	end)
+
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] Hashing with FFI bindings (reused context)", algorithm)
+		local context = crypto.createHash(algorithm)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			context:update(inputs[i])
+			context:final()
+		end
+		console.stopTimer(label)
+	end)
+
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] Hashing with FFI bindings (batched)", algorithm)
+		local batch = {}
+		for i = 1, SAMPLE_SIZE, 1 do
+			batch[i] = inputs[i]
+		end
+		console.startTimer(label)
+		crypto.hashBuffers(algorithm, batch)
+		console.stopTimer(label)
+	end)
+
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] HMAC with LuaOpenSSL", algorithm)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			openssl.hmac.hmac(algorithm, inputs[i], HMAC_KEY, true)
+		end
+		console.stopTimer(label)
+	end)
+
+	tinsert(availableBenchmarks, function()
+		local label = format("[%s] HMAC with FFI bindings (reused context)", algorithm)
+		local context = crypto.createHMAC(algorithm, HMAC_KEY)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			context:update(inputs[i])
+			context:final()
+		end
+		console.stopTimer(label)
+	end)
+end
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
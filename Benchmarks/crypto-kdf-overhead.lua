@@ -0,0 +1,31 @@
+local console = require("console")
+local crypto = require("crypto")
+
+local SAMPLE_SIZE = 10000
+
+-- The work factors are as low as they go, so that the per-call overhead (fetching, context setup) dominates
+local availableParameters = {
+	PBKDF2 = { kdf = crypto.KDF_PBKDF2, iterations = 1, size = 32 },
+	SCRYPT = { kdf = crypto.KDF_SCRYPT, kilobytes = 2, lanes = 1, size = 32 },
+	ARGON2ID = { kdf = crypto.KDF_ARGON2ID, kilobytes = 8, iterations = 1, threads = 1, lanes = 1, size = 32 },
+}
+
+math.randomseed(os.clock())
+local availableBenchmarks = {}
+
+for name, parameters in pairs(availableParameters) do
+	table.insert(availableBenchmarks, function()
+		local label = format("[%s] Deriving %d keys with minimal work factors", name, SAMPLE_SIZE)
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			crypto.hash("password" .. i, "saltsalt", parameters)
+		end
+		console.stopTimer(label)
+	end)
+end
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
@@ -61,6 +61,28 @@ local function iconv_cpp(input)
 	return result, tostring(writeBuffer)
 end
 
+-- Same as iconv_cpp, except that a new descriptor is opened (and closed) for every conversion
+local inputSizeRef = ffi.new("size_t[1]")
+local inputRef = ffi.new("char*[1]")
+local outputSizeRef = ffi.new("size_t[1]")
+local outputRef = ffi.new("char*[1]")
+local function iconv_uncached(input)
+	readBuffer:reset()
+	readBuffer:put(input)
+	inputRef[0], inputSizeRef[0] = readBuffer:ref()
+
+	writeBuffer:reset()
+	local writeCursor, writeBufferSize = writeBuffer:reserve(#input * UTF_MAX_BYTES_PER_CODEPOINT)
+	outputRef[0], outputSizeRef[0] = writeCursor, writeBufferSize
+
+	local descriptor = iconv.bindings.iconv_open("UTF-8", "CP949")
+	iconv.bindings.iconv(descriptor, inputRef, inputSizeRef, outputRef, outputSizeRef)
+	iconv.bindings.iconv_close(descriptor)
+
+	writeBuffer:commit(writeBufferSize - tonumber(outputSizeRef[0]))
+	return ffi.C.ICONV_RESULT_OK, tostring(writeBuffer)
+end
+
 math.randomseed(os.clock())
 local availableBenchmarks = {
 	function()
@@ -74,7 +96,7 @@ local availableBenchmarks = {
 		console.stopTimer(label)
 	end,
 	function()
-		local label = "[FFI] Immediate conversion using iconv.bindings.iconv_convert (manual buffer management)"
+		local label = "[FFI] Immediate conversion using iconv.bindings.iconv_convert (cached descriptors)"
 		console.startTimer(label)
 		for i = 1, SAMPLE_SIZE, 1 do
 			local result, output = iconv_cpp(CP949_INPUT_STRING)
@@ -83,6 +105,16 @@ local availableBenchmarks = {
 		end
 		console.stopTimer(label)
 	end,
+	function()
+		local label = "[FFI] Immediate conversion using the libiconv API directly (uncached descriptors)"
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			local result, output = iconv_uncached(CP949_INPUT_STRING)
+			assert(result == ffi.C.ICONV_RESULT_OK, iconv.strerror(result))
+			assert(output == UTF8_OUTPUT_STRING, output)
+		end
+		console.stopTimer(label)
+	end,
 	function()
 		local label = "[FFI] Immediate conversion using iconv.convert (idiomatic Lua wrapper, with preallocation)"
 		console.startTimer(label)
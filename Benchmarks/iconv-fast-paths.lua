@@ -0,0 +1,66 @@
+local console = require("console")
+local ffi = require("ffi")
+local iconv = require("iconv")
+
+local tinsert = table.insert
+
+local BYTES_PER_BENCHMARK = 64 * 1024 * 1024
+local INPUT_SIZE = 64 * 1024
+
+local function createInput(fragment)
+	return string.rep(fragment, math.ceil(INPUT_SIZE / #fragment)):sub(1, INPUT_SIZE - INPUT_SIZE % 4)
+end
+
+local samples = {
+	ASCII = createInput("The quick brown fox jumps over the lazy dog. "),
+	Latin = createInput("Ça va très bien, merci! Où est la bibliothèque? "),
+	CJK = createInput("유저인터페이스 사용자 인터페이스 "),
+}
+
+-- Every sample is encoded in all of the fast path charsets first, so that only valid inputs are benchmarked
+local conversions = {
+	{ from = "UTF-8", to = "UTF-8", samples = { "ASCII", "Latin", "CJK" } },
+	{ from = "UTF-8", to = "ISO-8859-1", samples = { "ASCII", "Latin" } },
+	{ from = "ISO-8859-1", to = "UTF-8", samples = { "ASCII", "Latin" } },
+	{ from = "UTF-8", to = "UTF-16LE", samples = { "ASCII", "Latin", "CJK" } },
+	{ from = "UTF-16LE", to = "UTF-8", samples = { "ASCII", "Latin", "CJK" } },
+}
+
+math.randomseed(os.clock())
+local availableBenchmarks = {}
+
+for _, conversion in ipairs(conversions) do
+	for _, sampleName in ipairs(conversion.samples) do
+		local input, message = iconv.convert(samples[sampleName], "UTF-8", conversion.from)
+		assert(message == iconv.strerror(ffi.C.ICONV_RESULT_OK), message)
+		local numConversions = BYTES_PER_BENCHMARK / #input
+
+		for _, isFastPathEnabled in ipairs({ true, false }) do
+			tinsert(availableBenchmarks, function()
+				local label = format(
+					"[%s] Converting %d x %d bytes from %s to %s (%s)",
+					sampleName,
+					numConversions,
+					#input,
+					conversion.from,
+					conversion.to,
+					isFastPathEnabled and "fast path" or "libiconv"
+				)
+				iconv.bindings.iconv_set_fast_paths(isFastPathEnabled)
+				console.startTimer(label)
+				for i = 1, numConversions, 1 do
+					iconv.convert(input, conversion.from, conversion.to)
+				end
+				console.stopTimer(label)
+			end)
+		end
+	end
+end
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
+
+iconv.bindings.iconv_set_fast_paths(true)
@@ -0,0 +1,73 @@
+local console = require("console")
+local runtime = require("runtime")
+local uv = require("uv")
+
+-- Allocators can't be swapped at runtime, so compare by running this with EVO_LUA_ALLOCATOR=pooled (or similar)
+local SAMPLE_SIZE = 2500000
+
+local function formatMegabytes(numBytes)
+	return format("%.2f MB", numBytes / 1024 / 1024)
+end
+
+local function printMemoryUsage(label)
+	printf("%s: RSS is %s", label, formatMegabytes(uv.resident_set_memory()))
+
+	local stats = runtime.getAllocatorStats()
+	if not stats then
+		printf("%s: Using the default allocator (no statistics available)", label)
+		return
+	end
+
+	printf(
+		"%s: Allocator %s reserved %s (%d allocations, %d reallocations, %d deallocations)",
+		label,
+		stats.name,
+		formatMegabytes(stats.bytesReserved),
+		stats.numAllocations,
+		stats.numReallocations,
+		stats.numDeallocations
+	)
+end
+
+printMemoryUsage("Before")
+
+math.randomseed(os.clock())
+local availableBenchmarks = {
+	function()
+		local label = "[Lua] Create short-lived strings (request handler simulation)"
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			local requestID = "request-" .. i
+			local _ = requestID .. ":" .. (i % 1000)
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = "[Lua] Create short-lived tables (request handler simulation)"
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE, 1 do
+			local _ = { method = "GET", url = "/", headers = { i, i + 1, i + 2 } }
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = "[Lua] Grow arrays of varying sizes"
+		console.startTimer(label)
+		for i = 1, SAMPLE_SIZE / 100, 1 do
+			local array = {}
+			for j = 1, i % 200, 1 do
+				array[j] = j
+			end
+		end
+		console.stopTimer(label)
+	end,
+}
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
+
+collectgarbage()
+printMemoryUsage("After")
@@ -1,11 +1,16 @@
 local console = require("console")
 local ffi = require("ffi")
 local stbi = require("stbi")
+local uv = require("uv")
 
 local FIXTURES_DIR = path.join("Tests", "Fixtures")
 
 local SAMPLE_SIZE = 50000000
 
+-- The fixture is tiny, so the per-call overhead dominates; a larger image is needed to compare the SIMD paths
+local SYNTHETIC_IMAGE_WIDTH, SYNTHETIC_IMAGE_HEIGHT = 2048, 2048
+local SYNTHETIC_SAMPLE_SIZE = 250
+
 function stbi.replace_pixel_color_rgba(image, sourceColor, replacementColor)
 	local pixelCount = image.width * image.height
 	local pixelBuffer = ffi.cast("stbi_color_t*", image.data)
@@ -39,6 +44,46 @@ local function replacePixelColorsFFI()
 	stbi.bindings.stbi_replace_pixel_color_rgba(image, sourceColor, replacementColor)
 end
 
+local syntheticImage = ffi.new("stbi_image_t")
+syntheticImage.width = SYNTHETIC_IMAGE_WIDTH
+syntheticImage.height = SYNTHETIC_IMAGE_HEIGHT
+syntheticImage.channels = 4
+local syntheticImageSize = SYNTHETIC_IMAGE_WIDTH * SYNTHETIC_IMAGE_HEIGHT * 4
+local syntheticPixels = ffi.new("uint8_t[?]", syntheticImageSize)
+for index = 0, syntheticImageSize - 1 do
+	syntheticPixels[index] = math.random(0, 1) * 255
+end
+syntheticImage.data = syntheticPixels
+
+local SIMD_LEVEL_NAMES = {
+	[tonumber(ffi.C.STBI_SIMD_SCALAR)] = "Scalar",
+	[tonumber(ffi.C.STBI_SIMD_SSE2)] = "SSE2",
+	[tonumber(ffi.C.STBI_SIMD_AVX2)] = "AVX2",
+}
+
+local function measureThroughput(label, level, transformPixels)
+	stbi.bindings.stbi_set_simd_level(level)
+
+	console.startTimer(label)
+	local startTime = uv.hrtime()
+	for i = 1, SYNTHETIC_SAMPLE_SIZE, 1 do
+		transformPixels()
+	end
+	local elapsedTimeInSeconds = tonumber(uv.hrtime() - startTime) / 1E9
+	console.stopTimer(label)
+
+	local numProcessedMegabytes = SYNTHETIC_SAMPLE_SIZE * syntheticImageSize / (1024 * 1024)
+	printf("%s: %.2f MB/s", label, numProcessedMegabytes / elapsedTimeInSeconds)
+end
+
+local function replacePixelColorsSynthetic()
+	stbi.bindings.stbi_replace_pixel_color_rgba(syntheticImage, sourceColor, replacementColor)
+end
+
+local function swizzlePixelsSynthetic()
+	stbi.bindings.stbi_abgr_to_rgba(syntheticImage)
+end
+
 math.randomseed(os.clock())
 local availableBenchmarks = {
 	function()
@@ -59,6 +104,21 @@ local availableBenchmarks = {
 	end,
 }
 
+-- Only the paths that the CPU supports can be compared (the scalar one is always available)
+local bestSupportedLevel = stbi.bindings.stbi_get_simd_level()
+local syntheticImageDimensions = string.format("%dx%d", SYNTHETIC_IMAGE_WIDTH, SYNTHETIC_IMAGE_HEIGHT)
+for level = ffi.C.STBI_SIMD_SCALAR, bestSupportedLevel do
+	local levelName = SIMD_LEVEL_NAMES[level]
+	table.insert(availableBenchmarks, function()
+		local label = string.format("[%s] Replace pixel colors (%s)", levelName, syntheticImageDimensions)
+		measureThroughput(label, level, replacePixelColorsSynthetic)
+	end)
+	table.insert(availableBenchmarks, function()
+		local label = string.format("[%s] Swizzle ABGR to RGBA (%s)", levelName, syntheticImageDimensions)
+		measureThroughput(label, level, swizzlePixelsSynthetic)
+	end)
+end
+
 local function shuffle(tbl)
 	for i = #tbl, 2, -1 do
 		local j = math.random(i)
@@ -69,5 +129,8 @@ end
 shuffle(availableBenchmarks)
 
 for _, benchmark in ipairs(availableBenchmarks) do
+	stbi.bindings.stbi_set_simd_level(bestSupportedLevel)
 	benchmark()
 end
+
+stbi.bindings.stbi_set_simd_level(bestSupportedLevel)
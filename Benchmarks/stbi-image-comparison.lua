@@ -0,0 +1,117 @@
+local console = require("console")
+local ffi = require("ffi")
+local stbi = require("stbi")
+local uv = require("uv")
+
+local IMAGE_WIDTH, IMAGE_HEIGHT = 2048, 2048
+local SAMPLE_SIZE = 100
+
+local imageSize = IMAGE_WIDTH * IMAGE_HEIGHT * 4
+local function createSyntheticImage()
+	local image = ffi.new("stbi_image_t")
+	image.width = IMAGE_WIDTH
+	image.height = IMAGE_HEIGHT
+	image.channels = 4
+	local pixels = ffi.new("uint8_t[?]", imageSize)
+	for index = 0, imageSize - 1 do
+		pixels[index] = math.random(0, 255)
+	end
+	image.data = pixels
+	return image, pixels -- The image doesn't keep the pixels alive
+end
+
+local firstImage, firstPixels = createSyntheticImage()
+local secondImage, secondPixels = createSyntheticImage()
+
+local diffImage = ffi.new("stbi_image_t")
+local diffPixels = ffi.new("uint8_t[?]", imageSize)
+diffImage.data = diffPixels
+
+local result = ffi.new("stbi_comparison_result_t")
+
+-- Roughly what a snapshot test would do without the native kernels (per-pixel metrics only, no SSIM)
+local function compareImagesLua()
+	local numMismatchedPixels, sumOfSquaredDifferences = 0, 0
+	for pixelIndex = 0, IMAGE_WIDTH * IMAGE_HEIGHT - 1 do
+		local isMismatched = false
+		for channel = 0, 3 do
+			local offset = pixelIndex * 4 + channel
+			local difference = math.abs(firstPixels[offset] - secondPixels[offset])
+			sumOfSquaredDifferences = sumOfSquaredDifferences + difference * difference
+			isMismatched = isMismatched or difference > 0
+		end
+		if isMismatched then
+			numMismatchedPixels = numMismatchedPixels + 1
+		end
+	end
+	return numMismatchedPixels, sumOfSquaredDifferences
+end
+
+local function compareImagesFFI()
+	stbi.bindings.stbi_compare_images(firstImage, secondImage, 0, result, nil)
+end
+
+local function compareImagesWithDiffFFI()
+	stbi.bindings.stbi_compare_images(firstImage, secondImage, 0, result, diffImage)
+end
+
+local SIMD_LEVEL_NAMES = {
+	[tonumber(ffi.C.STBI_SIMD_SCALAR)] = "Scalar",
+	[tonumber(ffi.C.STBI_SIMD_SSE2)] = "SSE2",
+	[tonumber(ffi.C.STBI_SIMD_AVX2)] = "AVX2",
+}
+
+local function measureThroughput(label, level, compareImages)
+	stbi.bindings.stbi_set_simd_level(level)
+
+	console.startTimer(label)
+	local startTime = uv.hrtime()
+	for i = 1, SAMPLE_SIZE, 1 do
+		compareImages()
+	end
+	local elapsedTimeInSeconds = tonumber(uv.hrtime() - startTime) / 1E9
+	console.stopTimer(label)
+
+	-- Both images are read in full, so that's what the throughput should be based on
+	local numProcessedMegabytes = SAMPLE_SIZE * 2 * imageSize / (1024 * 1024)
+	printf("%s: %.2f MB/s", label, numProcessedMegabytes / elapsedTimeInSeconds)
+end
+
+math.randomseed(os.clock())
+local imageDimensions = string.format("%dx%d", IMAGE_WIDTH, IMAGE_HEIGHT)
+local availableBenchmarks = {
+	function()
+		local label = string.format("[Lua] Compare images (%s)", imageDimensions)
+		measureThroughput(label, ffi.C.STBI_SIMD_SCALAR, compareImagesLua)
+	end,
+}
+
+-- Only the paths that the CPU supports can be compared (the scalar one is always available)
+local bestSupportedLevel = stbi.bindings.stbi_get_simd_level()
+for level = ffi.C.STBI_SIMD_SCALAR, bestSupportedLevel do
+	local levelName = SIMD_LEVEL_NAMES[level]
+	table.insert(availableBenchmarks, function()
+		local label = string.format("[%s] Compare images (%s)", levelName, imageDimensions)
+		measureThroughput(label, level, compareImagesFFI)
+	end)
+	table.insert(availableBenchmarks, function()
+		local label = string.format("[%s] Compare images with diff (%s)", levelName, imageDimensions)
+		measureThroughput(label, level, compareImagesWithDiffFFI)
+	end)
+end
+
+local function shuffle(tbl)
+	for i = #tbl, 2, -1 do
+		local j = math.random(i)
+		tbl[i], tbl[j] = tbl[j], tbl[i]
+	end
+end
+
+shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	stbi.bindings.stbi_set_simd_level(bestSupportedLevel)
+	benchmark()
+end
+
+stbi.bindings.stbi_set_simd_level(bestSupportedLevel)
@@ -0,0 +1,77 @@
+local console = require("console")
+local ffi = require("ffi")
+local stbi = require("stbi")
+local uv = require("uv")
+
+-- Images below two megapixels are still encoded by stb_image_write, so Full HD is the baseline at roughly the same size
+local IMAGE_SIZES = {
+	{ 1024, 768 },
+	{ 1920, 1080 },
+	{ 2048, 1024 },
+	{ 4096, 4096 },
+	{ 8192, 6144 },
+}
+
+local JPEG_QUALITY = 90
+local MIN_PARALLEL_ENCODING_PIXELS = 2 * 1024 * 1024 -- Same threshold as the native side
+local NUM_PIXELS_PER_SAMPLE = 500000000
+
+-- Random noise would be unrealistically expensive to encode, so use smooth gradients with a bit of texture instead
+local function createSyntheticPixels(width, height)
+	local pixels = ffi.new("uint8_t[?]", width * height * 4)
+	for y = 0, height - 1 do
+		for x = 0, width - 1 do
+			local offset = (y * width + x) * 4
+			pixels[offset + 0] = (x + math.random(0, 7)) % 256
+			pixels[offset + 1] = (y + math.random(0, 7)) % 256
+			pixels[offset + 2] = (x + y) % 256
+			pixels[offset + 3] = 255
+		end
+	end
+	return pixels
+end
+
+local function measureEncodingTime(width, height)
+	local pixels = createSyntheticPixels(width, height)
+	local image = ffi.new("stbi_image_t", { data = pixels, width = width, height = height, channels = 4 })
+	local result = ffi.new("stbi_growable_buffer_t")
+
+	local numMegapixels = width * height / 1E6
+	local numIterations = math.max(1, math.floor(NUM_PIXELS_PER_SAMPLE / (width * height)))
+	local encoderName = (width * height >= MIN_PARALLEL_ENCODING_PIXELS) and "parallel" or "stb_image_write"
+	local label = string.format("[%s] Encode %dx%d JPEG (%d iterations)", encoderName, width, height, numIterations)
+
+	console.startTimer(label)
+	local startTime = uv.hrtime()
+	for i = 1, numIterations, 1 do
+		stbi.bindings.stbi_encode_jpg_growable(image, result, JPEG_QUALITY)
+	end
+	local elapsedTimeInSeconds = tonumber(uv.hrtime() - startTime) / 1E9
+	console.stopTimer(label)
+
+	local throughput = numIterations * numMegapixels / elapsedTimeInSeconds
+	printf("%s: %.2f MP/s, %d bytes", label, throughput, tonumber(result.size))
+
+	stbi.bindings.stbi_growable_buffer_free(result)
+end
+
+math.randomseed(os.clock())
+local availableBenchmarks = {}
+for _, dimensions in ipairs(IMAGE_SIZES) do
+	table.insert(availableBenchmarks, function()
+		measureEncodingTime(dimensions[1], dimensions[2])
+	end)
+end
+
+local function shuffle(tbl)
+	for i = #tbl, 2, -1 do
+		local j = math.random(i)
+		tbl[i], tbl[j] = tbl[j], tbl[i]
+	end
+end
+
+shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
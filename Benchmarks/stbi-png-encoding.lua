@@ -0,0 +1,82 @@
+local console = require("console")
+local uv = require("uv")
+
+local FIXTURES_DIR = path.join("Tests", "Fixtures")
+local PNG_FIXTURES = {
+	"rgba-pixels.png",
+	"test-icon.png",
+}
+
+-- Tiny images finish in microseconds, so the number of iterations is scaled to keep the total work roughly constant
+local NUM_PIXELS_PER_SAMPLE = 50000000
+
+local encoders = {
+	{
+		label = "stb_image_write",
+		encode = function(pixels, width, height)
+			return C_ImageProcessing.EncodePNG(pixels, width, height)
+		end,
+	},
+}
+
+for presetName in pairs(C_ImageProcessing.PNG_COMPRESSION_PRESETS) do
+	table.insert(encoders, {
+		label = "miniz (" .. presetName .. ")",
+		encode = function(pixels, width, height)
+			return C_ImageProcessing.EncodePNG(pixels, width, height, presetName)
+		end,
+	})
+end
+
+for filterName in pairs(C_ImageProcessing.PNG_FILTERS) do
+	local options = { compressionLevel = 6, filter = filterName }
+	table.insert(encoders, {
+		label = "miniz (level 6, " .. filterName .. " filter)",
+		encode = function(pixels, width, height)
+			return C_ImageProcessing.EncodePNG(pixels, width, height, options)
+		end,
+	})
+end
+
+local function measureEncodingTime(fixtureName, encoder, pixels, width, height)
+	local numIterations = math.max(1, math.floor(NUM_PIXELS_PER_SAMPLE / (width * height * 100)))
+	local label = string.format("[%s] Encode %s (%d iterations)", encoder.label, fixtureName, numIterations)
+
+	local fileContents
+	console.startTimer(label)
+	local startTime = uv.hrtime()
+	for i = 1, numIterations, 1 do
+		fileContents = encoder.encode(pixels, width, height)
+	end
+	local elapsedTimeInMilliseconds = tonumber(uv.hrtime() - startTime) / 1E6
+	console.stopTimer(label)
+
+	printf("%s: %.3f ms per image, %d bytes", label, elapsedTimeInMilliseconds / numIterations, #fileContents)
+end
+
+local availableBenchmarks = {}
+for _, fixtureName in ipairs(PNG_FIXTURES) do
+	local originalFileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, fixtureName))
+	local pixels, width, height = C_ImageProcessing.DecodeFileContents(originalFileContents)
+	printf("Loaded fixture %s (%dx%d, %d bytes)", fixtureName, width, height, #originalFileContents)
+
+	for _, encoder in ipairs(encoders) do
+		table.insert(availableBenchmarks, function()
+			measureEncodingTime(fixtureName, encoder, pixels, width, height)
+		end)
+	end
+end
+
+local function shuffle(tbl)
+	for i = #tbl, 2, -1 do
+		local j = math.random(i)
+		tbl[i], tbl[j] = tbl[j], tbl[i]
+	end
+end
+
+math.randomseed(os.clock())
+shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
\ No newline at end of file
@@ -0,0 +1,76 @@
+local console = require("console")
+local uuid = require("uuid")
+
+local tinsert = table.insert
+
+local NUM_UUIDS_PER_BENCHMARK = 1000000
+local BATCH_SIZES = { 100, 10000 }
+
+math.randomseed(os.clock())
+local availableBenchmarks = {
+	function()
+		local label = format("[uuid.createBasicUUID] Generating %d UUIDs one by one", NUM_UUIDS_PER_BENCHMARK)
+		console.startTimer(label)
+		for i = 1, NUM_UUIDS_PER_BENCHMARK, 1 do
+			uuid.createBasicUUID()
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = format("[uuid.createMersenneTwistedUUID] Generating %d UUIDs one by one", NUM_UUIDS_PER_BENCHMARK)
+		console.startTimer(label)
+		for i = 1, NUM_UUIDS_PER_BENCHMARK, 1 do
+			uuid.createMersenneTwistedUUID()
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = format("[uuid.createTimeOrderedUUID] Generating %d UUIDs one by one", NUM_UUIDS_PER_BENCHMARK)
+		console.startTimer(label)
+		for i = 1, NUM_UUIDS_PER_BENCHMARK, 1 do
+			uuid.createTimeOrderedUUID()
+		end
+		console.stopTimer(label)
+	end,
+}
+
+for _, version in ipairs({ uuid.VERSION_RANDOM, uuid.VERSION_TIME_ORDERED }) do
+	for _, batchSize in ipairs(BATCH_SIZES) do
+		local numBatches = NUM_UUIDS_PER_BENCHMARK / batchSize
+
+		tinsert(availableBenchmarks, function()
+			local label =
+				format("[uuid.createBatch] Generating %d x %d %s UUIDs as strings", numBatches, batchSize, version)
+			console.startTimer(label)
+			for i = 1, numBatches, 1 do
+				uuid.createBatch(batchSize, version)
+			end
+			console.stopTimer(label)
+		end)
+
+		for _, outputFormat in ipairs({ uuid.FORMAT_RFC_STRING, uuid.FORMAT_BINARY }) do
+			tinsert(availableBenchmarks, function()
+				local label = format(
+					"[uuid.createBatch] Generating %d x %d %s UUIDs into a buffer (%s)",
+					numBatches,
+					batchSize,
+					version,
+					outputFormat
+				)
+				local outputBuffer = buffer.new()
+				console.startTimer(label)
+				for i = 1, numBatches, 1 do
+					outputBuffer:reset()
+					uuid.createBatch(batchSize, version, outputFormat, outputBuffer)
+				end
+				console.stopTimer(label)
+			end)
+		end
+	end
+end
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
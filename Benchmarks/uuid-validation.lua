@@ -0,0 +1,50 @@
+local console = require("console")
+local uuid = require("uuid")
+
+local NUM_INPUTS = 1000000
+
+-- Roughly what an API server might see: Mostly valid IDs, with the occasional bogus one in between
+local inputs = uuid.createBatch(NUM_INPUTS)
+for index = 1, NUM_INPUTS, 100 do
+	inputs[index] = inputs[index]:sub(1, 35) .. "x"
+end
+
+math.randomseed(os.clock())
+local availableBenchmarks = {
+	function()
+		local label = format("[uuid.isCanonical] Validating %d UUID strings using Lua patterns", NUM_INPUTS)
+		console.startTimer(label)
+		for index = 1, NUM_INPUTS, 1 do
+			uuid.isCanonical(inputs[index])
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = format("[uuid.isValid] Validating %d UUID strings one by one", NUM_INPUTS)
+		console.startTimer(label)
+		for index = 1, NUM_INPUTS, 1 do
+			uuid.isValid(inputs[index])
+		end
+		console.stopTimer(label)
+	end,
+	function()
+		local label = format("[uuid.validateBatch] Validating %d UUID strings at once", NUM_INPUTS)
+		console.startTimer(label)
+		uuid.validateBatch(inputs)
+		console.stopTimer(label)
+	end,
+	function()
+		local label = format("[uuid.parse] Parsing %d UUID strings one by one", NUM_INPUTS)
+		console.startTimer(label)
+		for index = 1, NUM_INPUTS, 1 do
+			uuid.parse(inputs[index])
+		end
+		console.stopTimer(label)
+	end,
+}
+
+table.shuffle(availableBenchmarks)
+
+for _, benchmark in ipairs(availableBenchmarks) do
+	benchmark()
+end
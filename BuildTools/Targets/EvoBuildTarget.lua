@@ -21,6 +21,7 @@ local EvoBuildTarget = {
 		"BuildTools/NinjaFile.lua",
 		-- Standard libraries
 		"Runtime/evo.lua",
+		"Runtime/guest.lua",
 		"Runtime/API/C_CommandLine.lua",
 		"Runtime/API/C_FileSystem.lua",
 		"Runtime/API/C_ImageProcessing.lua",
@@ -73,11 +74,19 @@ local EvoBuildTarget = {
 	cppSources = {
 		"Runtime/main.cpp",
 		"Runtime/Bindings/FFI/cpp/cpp_ffi.cpp",
+		"Runtime/Bindings/FFI/crypto/crypto_aead.cpp",
 		"Runtime/Bindings/FFI/crypto/crypto_argon2.cpp",
+		"Runtime/Bindings/FFI/crypto/crypto_async.cpp",
+		"Runtime/Bindings/FFI/crypto/crypto_base64.cpp",
 		"Runtime/Bindings/FFI/crypto/crypto_ffi.cpp",
+		"Runtime/Bindings/FFI/crypto/crypto_hash.cpp",
+		"Runtime/Bindings/FFI/crypto/crypto_kdf.cpp",
 		"Runtime/Bindings/FFI/curl/curl_ffi.cpp",
 		"Runtime/Bindings/FFI/glfw/glfw_ffi.cpp",
+		"Runtime/Bindings/FFI/iconv/iconv_cache.cpp",
 		"Runtime/Bindings/FFI/iconv/iconv_ffi.cpp",
+		"Runtime/Bindings/FFI/iconv/iconv_stream.cpp",
+		"Runtime/Bindings/FFI/iconv/iconv_transcode.cpp",
 		"Runtime/Bindings/FFI/interop/interop_ffi.cpp",
 		"Runtime/Bindings/FFI/labsound/labsound_ffi.cpp",
 		"Runtime/Bindings/lpeg.cpp",
@@ -85,14 +94,29 @@ local EvoBuildTarget = {
 		"Runtime/Bindings/FFI/RmlUi_Renderer_WebGPU.cpp",
 		"Runtime/Bindings/FFI/rml/rml_ffi.cpp",
 		"Runtime/Bindings/FFI/runtime/runtime_ffi.cpp",
+		"Runtime/Bindings/FFI/runtime/runtime_threadpool.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_atlas.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_batch.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_compare.cpp",
 		"Runtime/Bindings/FFI/stbi/stbi_ffi.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_jpeg.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_png.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_pool.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_simd.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_stream.cpp",
+		"Runtime/Bindings/FFI/stbi/stbi_transform.cpp",
+		"Runtime/Bindings/FFI/stduuid/stduuid_codec.cpp",
 		"Runtime/Bindings/FFI/stduuid/stduuid_ffi.cpp",
+		"Runtime/Bindings/FFI/stduuid/stduuid_generator.cpp",
 		"Runtime/Bindings/FFI/uws/uws_ffi.cpp",
 		"Runtime/Bindings/FFI/wgpu/wgpu_ffi.cpp",
 		"Runtime/Bindings/FFI/webview/webview_ffi.cpp",
 		"Runtime/Bindings/lrexlib.cpp",
 		"Runtime/Bindings/lzlib.cpp",
 		"Runtime/Bindings/FFI/WebServer.cpp",
+		"Runtime/EventLoopMetrics.cpp",
+		"Runtime/GuestVirtualMachine.cpp",
+		"Runtime/LuaMemoryAllocator.cpp",
 		"Runtime/LuaVirtualMachine.cpp",
 	},
 	includeDirectories = {
@@ -1,18 +1,256 @@
 local ffi = require("ffi")
+local interop = require("interop")
+local runtime = require("runtime")
 local stbi = require("stbi")
+local uv = require("uv")
 local validation = require("validation")
 
 local assert = assert
+local format = string.format
+local ipairs = ipairs
 local tonumber = tonumber
 local tostring = tostring
 local type = type
 
+local ffi_cast = ffi.cast
+local ffi_gc = ffi.gc
+local ffi_istype = ffi.istype
 local ffi_new = ffi.new
+local ffi_sizeof = ffi.sizeof
 local ffi_string = ffi.string
+local ffi_typeof = ffi.typeof
+local validateFunction = validation.validateFunction
 local validateNumber = validation.validateNumber
 local validateString = validation.validateString
+local validateStruct = validation.validateStruct
+local validateTable = validation.validateTable
+
+local C_ImageProcessing = {
+	RESIZE_FILTERS = {
+		box = "STBI_FILTER_BOX",
+		bilinear = "STBI_FILTER_BILINEAR",
+		lanczos = "STBI_FILTER_LANCZOS",
+	},
+	FLIP_AXES = {
+		horizontal = "STBI_FLIP_HORIZONTAL",
+		vertical = "STBI_FLIP_VERTICAL",
+	},
+	ROTATIONS = {
+		[90] = "STBI_ROTATE_CLOCKWISE_90",
+		[180] = "STBI_ROTATE_CLOCKWISE_180",
+		[270] = "STBI_ROTATE_CLOCKWISE_270",
+	},
+	OUTPUT_FORMATS = {
+		bmp = "STBI_FORMAT_BMP",
+		png = "STBI_FORMAT_PNG",
+		jpg = "STBI_FORMAT_JPG",
+		tga = "STBI_FORMAT_TGA",
+	},
+	PNG_FILTERS = {
+		none = "STBI_PNG_FILTER_NONE",
+		sub = "STBI_PNG_FILTER_SUB",
+		up = "STBI_PNG_FILTER_UP",
+		average = "STBI_PNG_FILTER_AVERAGE",
+		paeth = "STBI_PNG_FILTER_PAETH",
+		adaptive = "STBI_PNG_FILTER_ADAPTIVE",
+	},
+	PNG_COMPRESSION_PRESETS = {
+		fast = { compressionLevel = 1, filter = "up" },
+		small = { compressionLevel = 9, filter = "adaptive" },
+	},
+	DEFAULT_TRANSCODING_OPTIONS = {
+		format = "png",
+		quality = 100,
+		maxBytesInFlight = 256 * 1024 * 1024,
+	},
+	DEFAULT_ATLAS_OPTIONS = {
+		maxWidth = 4096,
+		maxHeight = 4096,
+		padding = 1,
+	},
+}
+
+local function toTransformationStep(step, index)
+	validateTable(step, "transformationSteps[" .. index .. "]")
+
+	local transform = {}
+	if step.type == "resize" then
+		transform.type = "STBI_TRANSFORM_RESIZE"
+		transform.width = step.width
+		transform.height = step.height
+		transform.filter = C_ImageProcessing.RESIZE_FILTERS[step.filter or "bilinear"]
+		if not transform.filter then
+			error(format("Invalid transformation step %d (unknown resize filter: %s)", index, step.filter), 0)
+		end
+	elseif step.type == "crop" then
+		transform.type = "STBI_TRANSFORM_CROP"
+		transform.offset_x = step.x
+		transform.offset_y = step.y
+		transform.width = step.width
+		transform.height = step.height
+	elseif step.type == "rotate" then
+		transform.type = "STBI_TRANSFORM_ROTATE"
+		transform.rotation = C_ImageProcessing.ROTATIONS[step.degrees]
+		if not transform.rotation then
+			error(format("Invalid transformation step %d (cannot rotate by %s degrees)", index, step.degrees), 0)
+		end
+	elseif step.type == "flip" then
+		transform.type = "STBI_TRANSFORM_FLIP"
+		transform.axis = C_ImageProcessing.FLIP_AXES[step.axis]
+		if not transform.axis then
+			error(format("Invalid transformation step %d (unknown flip axis: %s)", index, step.axis), 0)
+		end
+	elseif step.type == "premultiply" then
+		transform.type = "STBI_TRANSFORM_PREMULTIPLY_ALPHA"
+	elseif step.type == "convert" then
+		transform.type = "STBI_TRANSFORM_CONVERT_COLOR_DEPTH"
+		transform.channels = step.channels
+	else
+		error(format("Invalid transformation step %d (unknown type: %s)", index, step.type), 0)
+	end
+
+	return transform
+end
+
+-- Byte arrays and pooled images know how large they are, but there's no telling where a raw pointer's allocation ends
+local NATIVE_PIXEL_ARRAY_TYPES = {
+	ffi_typeof("uint8_t[?]"),
+	ffi_typeof("char[?]"),
+}
+
+local function getNativePixelArray(cdata)
+	if ffi_istype("stbi_image_t", cdata) then
+		return cdata.data, cdata.width * cdata.height * cdata.channels
+	end
+
+	for _, arrayType in ipairs(NATIVE_PIXEL_ARRAY_TYPES) do
+		if ffi_istype(arrayType, cdata) then
+			return cdata, ffi_sizeof(cdata)
+		end
+	end
+
+	-- Fixed-size arrays each have their own type, so they're matched by size (pointers and structs of that size aren't)
+	local size = ffi_sizeof(cdata)
+	if size and ffi_istype(ffi_typeof("uint8_t[$]", size), cdata) then
+		return cdata, size
+	end
+end
+
+-- Pixels are only ever read, so strings, string buffers, and native arrays can be used in place
+local function createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local pixelBuffer, pixelArraySize
+	local isNativePixelArray = (type(rgbaPixelArray) == "cdata")
+	if type(rgbaPixelArray) == "userdata" then
+		pixelBuffer, pixelArraySize = rgbaPixelArray:ref()
+	elseif isNativePixelArray then
+		pixelBuffer, pixelArraySize = getNativePixelArray(rgbaPixelArray)
+		if pixelBuffer == nil then
+			local errorMessage =
+				"Expected argument rgbaPixelArray to be a byte array or pooled image (other cdata has no known size)"
+			error(errorMessage, 0)
+		end
+	else
+		validateString(rgbaPixelArray, "rgbaPixelArray")
+		pixelBuffer, pixelArraySize = rgbaPixelArray, #rgbaPixelArray
+	end
+
+	validateNumber(imageWidthInPixels, "imageWidthInPixels")
+	validateNumber(imageHeightInPixels, "imageHeightInPixels")
 
-local C_ImageProcessing = {}
+	-- Native buffers may well be larger than needed (e.g., if they're reused), but they must never be too small
+	local expectedPixelArraySize = imageWidthInPixels * imageHeightInPixels * 4
+	if isNativePixelArray and pixelArraySize < expectedPixelArraySize then
+		local errorMessage =
+			"Expected argument rgbaPixelArray to contain at least %d bytes (%dx%d RGBA pixels), but got %d"
+		error(
+			format(errorMessage, expectedPixelArraySize, imageWidthInPixels, imageHeightInPixels, pixelArraySize),
+			0
+		)
+	elseif not isNativePixelArray and pixelArraySize ~= expectedPixelArraySize then
+		local errorMessage = "Expected argument rgbaPixelArray to contain %d bytes (%dx%d RGBA pixels), but got %d"
+		error(
+			format(errorMessage, expectedPixelArraySize, imageWidthInPixels, imageHeightInPixels, pixelArraySize),
+			0
+		)
+	end
+
+	local image = ffi_new("stbi_image_t")
+	image.width = imageWidthInPixels
+	image.height = imageHeightInPixels
+	image.data = ffi_cast("stbi_pixelbuffer_t", pixelBuffer)
+	image.channels = 4
+
+	return image
+end
+
+-- Encoding into a native buffer means the encoder only needs to run once, since the output size isn't known upfront
+local MAX_RETAINED_ENCODING_BUFFER_SIZE = 16 * 1024 * 1024
+local sharedEncodingBuffer
+
+local function getEncodingBuffer()
+	sharedEncodingBuffer = sharedEncodingBuffer or ffi_new("stbi_growable_buffer_t")
+	return sharedEncodingBuffer
+end
+
+local function readEncodingBuffer(growableBuffer)
+	local fileContents = ffi_string(growableBuffer.data, growableBuffer.size)
+
+	-- The buffer is reused to avoid reallocating it for every image, but huge ones shouldn't be kept around forever
+	if growableBuffer.capacity > MAX_RETAINED_ENCODING_BUFFER_SIZE then
+		stbi.bindings.stbi_growable_buffer_free(growableBuffer)
+	end
+
+	return fileContents
+end
+
+-- Results are delivered via a deferred event queue that is only ever written to from the main thread (libuv callbacks)
+local transcodingEventQueue
+local transcodingEventChecker
+local pendingTranscodingBatches = {}
+local numPendingTranscodingBatches = 0
+
+local function processTranscodingEvents()
+	while tonumber(interop.bindings.queue_size(transcodingEventQueue)) > 0 do
+		local event = interop.bindings.queue_pop_event(transcodingEventQueue)
+		local details = event.image_transcoding_details
+
+		local fileContents = details.success and ffi_string(details.data, details.size) or nil
+		stbi.bindings.stbi_release_transcoded_image(details.data, details.capacity)
+
+		-- Bookkeeping comes first, so that errors raised by the callbacks can't leave the batch in limbo
+		local batch = pendingTranscodingBatches[details.batch_id]
+		batch.numRemainingImages = batch.numRemainingImages - 1
+		local isBatchCompleted = (batch.numRemainingImages == 0)
+		if isBatchCompleted then
+			pendingTranscodingBatches[details.batch_id] = nil
+			numPendingTranscodingBatches = numPendingTranscodingBatches - 1
+		end
+
+		local width = fileContents and tonumber(details.width) or nil
+		local height = fileContents and tonumber(details.height) or nil
+		batch.onImageTranscoded(tonumber(details.index) + 1, fileContents, width, height)
+
+		if isBatchCompleted and batch.onBatchCompleted then
+			batch.onBatchCompleted()
+		end
+	end
+
+	if numPendingTranscodingBatches == 0 then
+		transcodingEventChecker:stop()
+	end
+end
+
+local function startTranscodingEventChecker()
+	if not transcodingEventQueue then
+		transcodingEventQueue = interop.bindings.queue_create()
+		transcodingEventChecker = uv.new_check()
+		transcodingEventChecker:unref() -- The pending work requests already keep the loop alive
+	end
+
+	if numPendingTranscodingBatches == 0 then
+		transcodingEventChecker:start(processTranscodingEvents)
+	end
+end
 
 function C_ImageProcessing.DecodeFileContents(imageFileContents)
 	if type(imageFileContents) == "userdata" then
@@ -32,120 +270,352 @@ function C_ImageProcessing.DecodeFileContents(imageFileContents)
 	return pixelArray, tonumber(image.width), tonumber(image.height)
 end
 
-function C_ImageProcessing.EncodeBMP(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
-	if type(rgbaPixelArray) == "userdata" then
-		rgbaPixelArray = tostring(rgbaPixelArray)
-	end
-
-	validateString(rgbaPixelArray, "rgbaPixelArray")
-	validateNumber(imageWidthInPixels, "imageWidthInPixels")
-	validateNumber(imageHeightInPixels, "imageHeightInPixels")
+local function releasePooledImage(image)
+	stbi.bindings.stbi_image_free(image)
+end
 
-	local rgbaPixelBuffer = buffer.new(#rgbaPixelArray):put(rgbaPixelArray)
+-- Copying the pixels into a Lua string would defeat the purpose of pooling, so the native image is returned instead
+function C_ImageProcessing.DecodePooledImage(imageFileContents)
+	local fileContents, fileSize
+	if type(imageFileContents) == "userdata" then
+		fileContents, fileSize = imageFileContents:ref()
+	else
+		validateString(imageFileContents, "imageFileContents")
+		fileContents, fileSize = imageFileContents, #imageFileContents
+	end
 
 	local image = ffi_new("stbi_image_t")
-	image.width = imageWidthInPixels
-	image.height = imageHeightInPixels
-	image.data = rgbaPixelBuffer
+	local success = stbi.bindings.stbi_load_rgba(fileContents, fileSize, image)
+	if not success then
+		error("Failed to decode image data (stbi_load_rgba returned NULL)", 0)
+	end
 	image.channels = 4
 
-	local requiredBufferSize = stbi.bindings.stbi_get_required_bmp_size(image)
-	local outputBuffer = buffer.new()
-	local startPointer, reservedBufferSize = outputBuffer:reserve(requiredBufferSize)
+	-- The pixel buffer goes back to the pool once released, or when the image is garbage-collected (whichever is first)
+	ffi_gc(image, releasePooledImage)
 
-	local numBytesWritten = stbi.bindings.stbi_encode_bmp(image, startPointer, reservedBufferSize)
-	assert(numBytesWritten > 0, "Failed to encode BMP image (preallocated buffer too small?)")
-	outputBuffer:commit(numBytesWritten)
+	return image, tonumber(image.width), tonumber(image.height)
+end
 
-	return tostring(outputBuffer)
+function C_ImageProcessing.ReleasePooledImage(pooledImage)
+	validateStruct(pooledImage, "pooledImage")
+	if pooledImage.data == nil then
+		return -- Already released
+	end
+
+	ffi_gc(pooledImage, nil)
+	stbi.bindings.stbi_image_free(pooledImage)
+	pooledImage.data = nil
 end
 
-function C_ImageProcessing.EncodePNG(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
-	local strideInBytes = 0
+-- Reads from the file directly, so the compressed contents never have to be loaded into memory all at once
+function C_ImageProcessing.DecodeFile(imageFilePath)
+	validateString(imageFilePath, "imageFilePath")
 
-	if type(rgbaPixelArray) == "userdata" then
-		rgbaPixelArray = tostring(rgbaPixelArray)
+	local image = ffi_new("stbi_image_t")
+	local success = stbi.bindings.stbi_load_from_path(imageFilePath, image, ffi.C.CONVERT_TO_RGB_WITH_ALPHA)
+	if not success then
+		error(format("Failed to decode image file %s (stbi_load_from_path returned NULL)", imageFilePath), 0)
 	end
 
-	validateString(rgbaPixelArray, "rgbaPixelArray")
-	validateNumber(imageWidthInPixels, "imageWidthInPixels")
-	validateNumber(imageHeightInPixels, "imageHeightInPixels")
+	local pixelArray = ffi_string(image.data, image.width * image.height * 4)
+	stbi.bindings.stbi_image_free(image)
+
+	return pixelArray, tonumber(image.width), tonumber(image.height)
+end
 
-	local rgbaPixelBuffer = buffer.new(#rgbaPixelArray):put(rgbaPixelArray)
+-- Only the first few KB are read, which is enough to reject oversized images before committing to decoding them
+function C_ImageProcessing.GetImageInfo(imageFilePath)
+	validateString(imageFilePath, "imageFilePath")
 
 	local image = ffi_new("stbi_image_t")
-	image.width = imageWidthInPixels
-	image.height = imageHeightInPixels
-	image.data = rgbaPixelBuffer
-	image.channels = 4
+	local success = stbi.bindings.stbi_info_from_path(imageFilePath, image)
+	if not success then
+		error(format("Failed to read image header from %s (stbi_info_from_path returned false)", imageFilePath), 0)
+	end
+
+	return tonumber(image.width), tonumber(image.height), tonumber(image.channels)
+end
+
+function C_ImageProcessing.TransformImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels, transformationSteps)
+	local image = createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	validateTable(transformationSteps, "transformationSteps")
+
+	local steps = ffi_new("stbi_transform_t[?]", #transformationSteps)
+	for index, step in ipairs(transformationSteps) do
+		steps[index - 1] = toTransformationStep(step, index)
+	end
+
+	local result = ffi_new("stbi_image_t")
+	if not stbi.bindings.stbi_get_transformed_size(image, steps, #transformationSteps, result) then
+		error("Failed to transform image (invalid transformation steps?)", 0)
+	end
 
-	local requiredBufferSize = stbi.bindings.stbi_get_required_png_size(image, strideInBytes)
 	local outputBuffer = buffer.new()
-	local startPointer, reservedBufferSize = outputBuffer:reserve(requiredBufferSize)
+	local resultSize = result.width * result.height * result.channels
+	result.data = outputBuffer:reserve(resultSize)
 
-	local numBytesWritten = stbi.bindings.stbi_encode_png(image, startPointer, reservedBufferSize, strideInBytes)
-	assert(numBytesWritten > 0, "Failed to encode PNG image (preallocated buffer too small?)")
-	outputBuffer:commit(numBytesWritten)
+	local success = stbi.bindings.stbi_transform_image(image, steps, #transformationSteps, result)
+	assert(success, "Failed to transform image (stbi_transform_image returned false)")
+	outputBuffer:commit(resultSize)
 
-	return tostring(outputBuffer)
+	return tostring(outputBuffer), tonumber(result.width), tonumber(result.height), tonumber(result.channels)
 end
 
-function C_ImageProcessing.EncodeJPG(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
-	local qualityPercentage = 100
+function C_ImageProcessing.TranscodeImages(imageFileContentsList, options, onImageTranscoded, onBatchCompleted)
+	validateTable(imageFileContentsList, "imageFileContentsList")
+	options = options or C_ImageProcessing.DEFAULT_TRANSCODING_OPTIONS
+	validateTable(options, "options")
+	validateFunction(onImageTranscoded, "onImageTranscoded")
+	if onBatchCompleted ~= nil then
+		validateFunction(onBatchCompleted, "onBatchCompleted")
+	end
 
-	if type(rgbaPixelArray) == "userdata" then
-		rgbaPixelArray = tostring(rgbaPixelArray)
+	local numImages = #imageFileContentsList
+	if numImages == 0 then
+		error("Cannot transcode images (the list of file contents is empty)", 0)
 	end
 
-	validateString(rgbaPixelArray, "rgbaPixelArray")
-	validateNumber(imageWidthInPixels, "imageWidthInPixels")
-	validateNumber(imageHeightInPixels, "imageHeightInPixels")
+	local defaults = C_ImageProcessing.DEFAULT_TRANSCODING_OPTIONS
+	local outputFormat = C_ImageProcessing.OUTPUT_FORMATS[options.format or defaults.format]
+	if not outputFormat then
+		error(format("Cannot transcode images (unknown output format: %s)", options.format), 0)
+	end
 
-	local rgbaPixelBuffer = buffer.new(#rgbaPixelArray):put(rgbaPixelArray)
+	-- The workers read the file contents in place, so they must not be collected before the batch is completed
+	local anchoredFileContents = {}
+	local inputs = ffi_new("stbi_file_contents_t[?]", numImages)
+	for index, fileContents in ipairs(imageFileContentsList) do
+		if type(fileContents) == "userdata" then
+			inputs[index - 1].data, inputs[index - 1].size = fileContents:ref()
+		else
+			validateString(fileContents, "imageFileContentsList[" .. index .. "]")
+			inputs[index - 1].data = ffi_cast("const uint8_t*", fileContents)
+			inputs[index - 1].size = #fileContents
+		end
+		anchoredFileContents[index] = fileContents
+	end
 
-	local image = ffi_new("stbi_image_t")
-	image.width = imageWidthInPixels
-	image.height = imageHeightInPixels
-	image.data = rgbaPixelBuffer
-	image.channels = 4
+	local transformationSteps = options.steps or {}
+	validateTable(transformationSteps, "options.steps")
+	local steps = ffi_new("stbi_transform_t[?]", #transformationSteps)
+	for index, step in ipairs(transformationSteps) do
+		steps[index - 1] = toTransformationStep(step, index)
+	end
 
-	local requiredBufferSize = stbi.bindings.stbi_get_required_jpg_size(image, qualityPercentage)
-	local outputBuffer = buffer.new()
-	local startPointer, reservedBufferSize = outputBuffer:reserve(requiredBufferSize)
+	local transcodingOptions = ffi_new("stbi_transcoding_options_t")
+	transcodingOptions.steps = steps
+	transcodingOptions.num_steps = #transformationSteps
+	transcodingOptions.format = outputFormat
+	transcodingOptions.quality = options.quality or defaults.quality
+	transcodingOptions.max_bytes_in_flight = options.maxBytesInFlight or defaults.maxBytesInFlight
+	transcodingOptions.max_concurrent_jobs = options.maxConcurrentJobs or runtime.getThreadPoolSize()
+
+	startTranscodingEventChecker()
+
+	local batchID = stbi.bindings.stbi_transcode_batch(transcodingEventQueue, inputs, numImages, transcodingOptions)
+	if batchID == 0 then
+		if numPendingTranscodingBatches == 0 then
+			transcodingEventChecker:stop()
+		end
+		error("Failed to transcode images (stbi_transcode_batch returned 0)", 0)
+	end
 
-	local numBytesWritten = stbi.bindings.stbi_encode_jpg(image, startPointer, reservedBufferSize, qualityPercentage)
-	assert(numBytesWritten > 0, "Failed to encode JPG image (preallocated buffer too small?)")
-	outputBuffer:commit(numBytesWritten)
+	pendingTranscodingBatches[batchID] = {
+		fileContents = anchoredFileContents,
+		numRemainingImages = numImages,
+		onImageTranscoded = onImageTranscoded,
+		onBatchCompleted = onBatchCompleted,
+	}
+	numPendingTranscodingBatches = numPendingTranscodingBatches + 1
 
-	return tostring(outputBuffer)
+	return batchID
 end
 
-function C_ImageProcessing.EncodeTGA(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
-	if type(rgbaPixelArray) == "userdata" then
-		rgbaPixelArray = tostring(rgbaPixelArray)
+function C_ImageProcessing.CompareImages(
+	firstPixelArray,
+	secondPixelArray,
+	imageWidthInPixels,
+	imageHeightInPixels,
+	options
+)
+	local firstImage = createSourceImage(firstPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local secondImage = createSourceImage(secondPixelArray, imageWidthInPixels, imageHeightInPixels)
+
+	options = options or {}
+	validateTable(options, "options")
+	local tolerance = options.tolerance or 0
+	validateNumber(tolerance, "tolerance")
+	if tolerance < 0 or tolerance > 255 then
+		error(format("Invalid tolerance %s (must be between 0 and 255)", tolerance), 0)
 	end
 
-	validateString(rgbaPixelArray, "rgbaPixelArray")
-	validateNumber(imageWidthInPixels, "imageWidthInPixels")
-	validateNumber(imageHeightInPixels, "imageHeightInPixels")
+	local diffImage, diffBuffer
+	local diffImageSize = imageWidthInPixels * imageHeightInPixels * 4
+	if options.createDiffImage then
+		diffBuffer = buffer.new()
+		diffImage = ffi_new("stbi_image_t")
+		diffImage.data = diffBuffer:reserve(diffImageSize)
+	end
 
-	local rgbaPixelBuffer = buffer.new(#rgbaPixelArray):put(rgbaPixelArray)
+	local result = ffi_new("stbi_comparison_result_t")
+	local success = stbi.bindings.stbi_compare_images(firstImage, secondImage, tolerance, result, diffImage)
+	assert(success, "Failed to compare images (stbi_compare_images returned false)")
+
+	local comparison = {
+		numMismatchedPixels = tonumber(result.num_mismatched_pixels),
+		meanAbsoluteDifference = {},
+		maxAbsoluteDifference = {},
+		meanSquaredError = result.mean_squared_error,
+		peakSignalToNoiseRatio = result.peak_signal_to_noise_ratio,
+		structuralSimilarity = result.structural_similarity,
+	}
+	for channel = 1, 4 do
+		comparison.meanAbsoluteDifference[channel] = result.mean_absolute_difference[channel - 1]
+		comparison.maxAbsoluteDifference[channel] = result.max_absolute_difference[channel - 1]
+	end
 
-	local image = ffi_new("stbi_image_t")
-	image.width = imageWidthInPixels
-	image.height = imageHeightInPixels
-	image.data = rgbaPixelBuffer
-	image.channels = 4
+	if not diffBuffer then
+		return comparison
+	end
 
-	local requiredBufferSize = stbi.bindings.stbi_get_required_tga_size(image)
-	local outputBuffer = buffer.new()
-	local startPointer, reservedBufferSize = outputBuffer:reserve(requiredBufferSize)
+	diffBuffer:commit(diffImageSize)
+	return comparison, tostring(diffBuffer)
+end
+
+-- The regions can be stored alongside the encoded atlas, so that it's possible to pre-bake atlases for distribution
+function C_ImageProcessing.CreateTextureAtlas(images, options)
+	validateTable(images, "images")
+	options = options or C_ImageProcessing.DEFAULT_ATLAS_OPTIONS
+	validateTable(options, "options")
+
+	local numImages = #images
+	if numImages == 0 then
+		error("Cannot create texture atlas (the list of images is empty)", 0)
+	end
+
+	local defaults = C_ImageProcessing.DEFAULT_ATLAS_OPTIONS
+	local atlasOptions = ffi_new("stbi_atlas_options_t")
+	atlasOptions.max_width = options.maxWidth or defaults.maxWidth
+	atlasOptions.max_height = options.maxHeight or defaults.maxHeight
+	atlasOptions.padding = options.padding or defaults.padding
+
+	-- The pixels are read in place, but the list of images keeps them alive for the duration of the call
+	local sourceImages = ffi_new("stbi_image_t[?]", numImages)
+	for index, image in ipairs(images) do
+		validateTable(image, "images[" .. index .. "]")
+		sourceImages[index - 1] = createSourceImage(image.pixels, image.width, image.height)
+	end
+
+	local regions = ffi_new("stbi_atlas_region_t[?]", numImages)
+	local atlas = ffi_new("stbi_image_t")
+	if not stbi.bindings.stbi_pack_atlas(sourceImages, numImages, atlasOptions, regions, atlas) then
+		local errorMessage = "Failed to pack %d images into a texture atlas of up to %dx%d pixels"
+		error(format(errorMessage, numImages, atlasOptions.max_width, atlasOptions.max_height), 0)
+	end
+
+	local atlasBuffer = buffer.new()
+	local atlasSize = atlas.width * atlas.height * atlas.channels
+	atlas.data = atlasBuffer:reserve(atlasSize)
+	local success = stbi.bindings.stbi_render_atlas(sourceImages, numImages, regions, atlas)
+	assert(success, "Failed to render texture atlas (stbi_render_atlas returned false)")
+	atlasBuffer:commit(atlasSize)
+
+	local atlasRegions = {}
+	for index = 1, numImages do
+		local region = regions[index - 1]
+		atlasRegions[index] = {
+			x = region.x,
+			y = region.y,
+			width = region.width,
+			height = region.height,
+			minU = region.min_u,
+			minV = region.min_v,
+			maxU = region.max_u,
+			maxV = region.max_v,
+		}
+	end
+
+	return tostring(atlasBuffer), atlas.width, atlas.height, atlasRegions
+end
+
+function C_ImageProcessing.EncodeBMP(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local image = createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local encodingBuffer = getEncodingBuffer()
+
+	local success = stbi.bindings.stbi_encode_bmp_growable(image, encodingBuffer)
+	assert(success, "Failed to encode BMP image (stbi_encode_bmp_growable returned false)")
+
+	return readEncodingBuffer(encodingBuffer)
+end
+
+local function toPngOptions(compressionOptions)
+	if type(compressionOptions) == "string" then
+		local preset = C_ImageProcessing.PNG_COMPRESSION_PRESETS[compressionOptions]
+		if not preset then
+			error(format("Invalid PNG compression options (unknown preset: %s)", compressionOptions), 0)
+		end
+		compressionOptions = preset
+	end
+	validateTable(compressionOptions, "compressionOptions")
+
+	local compressionLevel = compressionOptions.compressionLevel or 6
+	validateNumber(compressionLevel, "compressionLevel")
+	if compressionLevel < 0 or compressionLevel > 9 then
+		error(format("Invalid PNG compression options (level %s is out of range)", compressionLevel), 0)
+	end
+
+	local filter = C_ImageProcessing.PNG_FILTERS[compressionOptions.filter or "adaptive"]
+	if not filter then
+		error(format("Invalid PNG compression options (unknown filter: %s)", compressionOptions.filter), 0)
+	end
+
+	local options = ffi_new("stbi_png_options_t")
+	options.compression_level = compressionLevel
+	options.filter = filter
+	return options
+end
+
+function C_ImageProcessing.EncodePNG(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels, compressionOptions)
+	local strideInBytes = 0
+
+	local image = createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local encodingBuffer = getEncodingBuffer()
+
+	-- The stb_image_write encoder remains the default, since it's guaranteed to produce the exact same output
+	if compressionOptions == nil then
+		local success = stbi.bindings.stbi_encode_png_growable(image, encodingBuffer, strideInBytes)
+		assert(success, "Failed to encode PNG image (stbi_encode_png_growable returned false)")
+		return readEncodingBuffer(encodingBuffer)
+	end
+
+	local options = toPngOptions(compressionOptions)
+	local success = stbi.bindings.stbi_encode_png_with_options(image, encodingBuffer, options)
+	assert(success, "Failed to encode PNG image (stbi_encode_png_with_options returned false)")
+
+	return readEncodingBuffer(encodingBuffer)
+end
+
+function C_ImageProcessing.EncodeJPG(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local qualityPercentage = 100
+
+	local image = createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local encodingBuffer = getEncodingBuffer()
+
+	local success = stbi.bindings.stbi_encode_jpg_growable(image, encodingBuffer, qualityPercentage)
+	assert(success, "Failed to encode JPG image (stbi_encode_jpg_growable returned false)")
+
+	return readEncodingBuffer(encodingBuffer)
+end
+
+function C_ImageProcessing.EncodeTGA(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local image = createSourceImage(rgbaPixelArray, imageWidthInPixels, imageHeightInPixels)
+	local encodingBuffer = getEncodingBuffer()
 
-	local numBytesWritten = stbi.bindings.stbi_encode_tga(image, startPointer, reservedBufferSize)
-	assert(numBytesWritten > 0, "Failed to encode TGA image (preallocated buffer too small?)")
-	outputBuffer:commit(numBytesWritten)
+	local success = stbi.bindings.stbi_encode_tga_growable(image, encodingBuffer)
+	assert(success, "Failed to encode TGA image (stbi_encode_tga_growable returned false)")
 
-	return tostring(outputBuffer)
+	return readEncodingBuffer(encodingBuffer)
 end
 
 return C_ImageProcessing
@@ -9,6 +9,14 @@ local validation = require("validation")
 -- This namespace is created in C++ land, so just assume it exists here
 local C_Runtime = _G.C_Runtime
 
+local NANOSECONDS_PER_MILLISECOND = 1E6
+
+local eventLoopSamplingTimer
+
+local function toMilliseconds(nanoseconds)
+	return tonumber(nanoseconds) / NANOSECONDS_PER_MILLISECOND
+end
+
 function C_Runtime.RunBasicTests(specFiles)
 	validation.validateTable(specFiles, "specFiles")
 
@@ -79,6 +87,135 @@ function C_Runtime.PrintVersionString()
 	print(semanticVersionString)
 end
 
+function C_Runtime.CreateGuest(name, scriptPath, limits)
+	validation.validateString(name, "name")
+	validation.validateString(scriptPath, "scriptPath")
+	limits = limits or {}
+	validation.validateTable(limits, "limits")
+
+	local guestLimits = ffi.new("runtime_guest_limits_t")
+	guestLimits.max_memory_in_bytes = limits.maxMemoryInBytes or 0
+	guestLimits.max_instructions_per_callback = limits.maxInstructionsPerCallback or 0
+	guestLimits.max_cpu_time_per_window_in_nanoseconds = (limits.maxCpuTimePerWindowInMilliseconds or 0) * 1E6
+
+	return runtime.bindings.runtime_guest_create(name, scriptPath, guestLimits)
+end
+
+function C_Runtime.GetGuestStats(name)
+	validation.validateString(name, "name")
+
+	local stats = ffi.new("runtime_guest_stats_t")
+	local success = runtime.bindings.runtime_guest_stats(name, stats)
+	if not success then
+		return nil
+	end
+
+	return {
+		numCallbacks = tonumber(stats.num_callbacks),
+		numFailedCallbacks = tonumber(stats.num_failed_callbacks),
+		numDeferredCallbacks = tonumber(stats.num_deferred_callbacks),
+		numPendingCallbacks = tonumber(stats.num_pending_callbacks),
+		numTimesThrottled = tonumber(stats.num_times_throttled),
+		totalCpuTimeInMilliseconds = tonumber(stats.total_cpu_time_in_nanoseconds) / 1E6,
+		windowCpuTimeInMilliseconds = tonumber(stats.window_cpu_time_in_nanoseconds) / 1E6,
+		maxCallbackTimeInMilliseconds = tonumber(stats.max_callback_time_in_nanoseconds) / 1E6,
+		accountingWindowInMilliseconds = tonumber(runtime.bindings.runtime_guest_accounting_window()) / 1E6,
+		bytesInUse = tonumber(stats.bytes_in_use),
+		peakBytesInUse = tonumber(stats.peak_bytes_in_use),
+		numFailedAllocations = tonumber(stats.num_failed_allocations),
+		isThrottled = stats.is_throttled,
+	}
+end
+
+function C_Runtime.GetEventLoopMetrics()
+	local metrics = ffi.new("runtime_event_loop_metrics_t")
+	local success = runtime.bindings.runtime_event_loop_metrics(metrics)
+	if not success then
+		return nil
+	end
+
+	local lagHistogram = {}
+	for index = 0, ffi.C.EVENT_LOOP_LAG_HISTOGRAM_SIZE - 1, 1 do
+		local isLastBucket = (index == ffi.C.EVENT_LOOP_LAG_HISTOGRAM_SIZE - 1)
+		lagHistogram[index + 1] = {
+			maxLagInMilliseconds = (not isLastBucket) and 2 ^ index or math.huge,
+			numIterations = tonumber(metrics.lag_histogram[index]),
+		}
+	end
+
+	local runTime = toMilliseconds(metrics.run_time_in_nanoseconds)
+	local idleTime = toMilliseconds(metrics.idle_time_in_nanoseconds)
+	return {
+		numIterations = tonumber(metrics.num_iterations),
+		numCallbacks = tonumber(metrics.num_callbacks),
+		runTimeInMilliseconds = runTime,
+		idleTimeInMilliseconds = idleTime,
+		utilization = (runTime > 0) and (runTime - idleTime) / runTime or 0,
+		callbackTimeInMilliseconds = toMilliseconds(metrics.total_callback_time_in_nanoseconds),
+		maxLagInMilliseconds = toMilliseconds(metrics.max_lag_in_nanoseconds),
+		maxCallbackTimeInMilliseconds = toMilliseconds(metrics.max_callback_time_in_nanoseconds),
+		slowestCallback = ffi.string(metrics.slowest_callback),
+		lagHistogram = lagHistogram,
+	}
+end
+
+function C_Runtime.StartEventLoopSampling(intervalInMilliseconds, onSampleCollected)
+	validation.validateNumber(intervalInMilliseconds, "intervalInMilliseconds")
+	validation.validateFunction(onSampleCollected, "onSampleCollected")
+
+	C_Runtime.StopEventLoopSampling()
+
+	-- Peaks are reset after each sample, so that they always refer to the last interval (unlike the counters)
+	local previousMetrics = C_Runtime.GetEventLoopMetrics()
+	runtime.bindings.runtime_event_loop_reset_peaks()
+
+	eventLoopSamplingTimer = uv.new_timer()
+	eventLoopSamplingTimer:start(intervalInMilliseconds, intervalInMilliseconds, function()
+		local metrics = C_Runtime.GetEventLoopMetrics()
+		runtime.bindings.runtime_event_loop_reset_peaks()
+
+		local runTime = metrics.runTimeInMilliseconds - previousMetrics.runTimeInMilliseconds
+		local idleTime = metrics.idleTimeInMilliseconds - previousMetrics.idleTimeInMilliseconds
+		local callbackTime = metrics.callbackTimeInMilliseconds - previousMetrics.callbackTimeInMilliseconds
+		local lagHistogram = {}
+		for index, bucket in ipairs(metrics.lagHistogram) do
+			lagHistogram[index] = {
+				maxLagInMilliseconds = bucket.maxLagInMilliseconds,
+				numIterations = bucket.numIterations - previousMetrics.lagHistogram[index].numIterations,
+			}
+		end
+
+		local sample = {
+			numIterations = metrics.numIterations - previousMetrics.numIterations,
+			numCallbacks = metrics.numCallbacks - previousMetrics.numCallbacks,
+			runTimeInMilliseconds = runTime,
+			idleTimeInMilliseconds = idleTime,
+			utilization = (runTime > 0) and (runTime - idleTime) / runTime or 0,
+			callbackTimeInMilliseconds = callbackTime,
+			maxLagInMilliseconds = metrics.maxLagInMilliseconds,
+			maxCallbackTimeInMilliseconds = metrics.maxCallbackTimeInMilliseconds,
+			slowestCallback = metrics.slowestCallback,
+			lagHistogram = lagHistogram,
+		}
+		previousMetrics = metrics
+
+		onSampleCollected(sample)
+	end)
+
+	-- Sampling alone shouldn't keep the process alive
+	uv.unref(eventLoopSamplingTimer)
+end
+
+function C_Runtime.StopEventLoopSampling()
+	if not eventLoopSamplingTimer then
+		return
+	end
+
+	eventLoopSamplingTimer:stop()
+	eventLoopSamplingTimer:close()
+	eventLoopSamplingTimer = nil
+end
+
 local function shell_exec(command, environmentVariables)
 	environmentVariables = environmentVariables or {}
 	local tempFile, tempFileName = uv.fs_mkstemp("evo-runtime-test-XXXXXX")
@@ -1,22 +1,44 @@
 local buffer = require("string.buffer")
 local ffi = require("ffi")
+local interop = require("interop")
+local table_new = require("table.new")
+local uv = require("uv")
 
+local ffi_gc = ffi.gc
+local ffi_cast = ffi.cast
+local ffi_copy = ffi.copy
 local ffi_new = ffi.new
 local ffi_string = ffi.string
+local format = string.format
 local math_ceil = math.ceil
 local tostring = tostring
 local math_floor = math.floor
+local math_max = math.max
 local math_min = math.min
+local type = type
 
 local crypto = {
 	-- Should match parameters for EVP_KDF_fetch (OpenSSL)
 	KDF_ARGON2D = "ARGON2D",
 	KDF_ARGON2I = "ARGON2I",
 	KDF_ARGON2ID = "ARGON2ID",
+	-- Not recommended for new applications, but needed to verify existing hashes (scrypt uses kilobytes as N and lanes as p)
+	KDF_PBKDF2 = "PBKDF2",
+	KDF_SCRYPT = "SCRYPT",
+	BASE64_ALPHABET_STANDARD = "standard",
+	BASE64_ALPHABET_URL_SAFE = "url",
+	-- Should match the names used by LuaOpenSSL (for interoperability)
+	DIGEST_SHA1 = "sha1",
+	DIGEST_SHA256 = "sha256",
+	DIGEST_SHA512 = "sha512",
+	DIGEST_BLAKE2S256 = "blake2s256",
+	DIGEST_BLAKE2B512 = "blake2b512",
+	AEAD_AES_256_GCM = "aes-256-gcm",
+	AEAD_CHACHA20_POLY1305 = "chacha20-poly1305",
 }
 
 crypto.cdefs = [[
-
+typedef void* deferred_event_queue_t; // Duplicated in the interop aliases (fix later)
 typedef struct kdf_parameters_t {
 	const char* kdf;
 	uint32_t version;
@@ -40,6 +62,55 @@ typedef struct kdf_result_t {
 	char* message;
 } kdf_result_t;
 
+typedef enum base64_alphabet_t {
+	BASE64_ALPHABET_STANDARD,
+	BASE64_ALPHABET_URL_SAFE,
+} base64_alphabet_t;
+
+typedef enum base64_simd_level_t {
+	BASE64_SIMD_SCALAR,
+	BASE64_SIMD_SSSE3,
+	BASE64_SIMD_AVX2,
+} base64_simd_level_t;
+
+typedef enum crypto_digest_algorithm_t {
+	CRYPTO_DIGEST_SHA1,
+	CRYPTO_DIGEST_SHA256,
+	CRYPTO_DIGEST_SHA512,
+	CRYPTO_DIGEST_BLAKE2S256,
+	CRYPTO_DIGEST_BLAKE2B512,
+	CRYPTO_DIGEST_NUM_ALGORITHMS,
+} crypto_digest_algorithm_t;
+
+typedef struct crypto_hash_context_t crypto_hash_context_t;
+
+typedef struct crypto_buffer_t {
+	const unsigned char* data;
+	size_t length;
+} crypto_buffer_t;
+
+enum {
+	CRYPTO_AEAD_KEY_SIZE = 32,
+	CRYPTO_AEAD_NONCE_SIZE = 12,
+	CRYPTO_AEAD_TAG_SIZE = 16,
+};
+
+typedef enum crypto_aead_algorithm_t {
+	CRYPTO_AEAD_AES_256_GCM,
+	CRYPTO_AEAD_CHACHA20_POLY1305,
+	CRYPTO_AEAD_NUM_ALGORITHMS,
+} crypto_aead_algorithm_t;
+
+typedef struct crypto_aead_key_t crypto_aead_key_t;
+
+typedef struct crypto_aead_message_t {
+	const unsigned char* nonce;
+	const unsigned char* plaintext;
+	size_t length;
+	unsigned char* ciphertext;
+	unsigned char* tag;
+} crypto_aead_message_t;
+
 struct static_crypto_exports_table {
 	// OpenSSL (libcrypto) metadata
 	const char* (*version_text)(void);
@@ -52,6 +123,35 @@ struct static_crypto_exports_table {
 	size_t (*argon2_from_base64)(unsigned char* dst, size_t dst_len, const char* src);
 	void (*openssl_kdf_derive)(kdf_input_t inputs, kdf_parameters_t parameters, kdf_result_t* result);
 
+	// Asynchronous key derivation (on dedicated worker threads, with completion events being queued on the main thread)
+	bool (*kdf_derive_async)(deferred_event_queue_t queue, const kdf_input_t* inputs, const kdf_parameters_t* parameters, kdf_result_t* result, uint32_t request_id);
+	size_t (*kdf_worker_threads)(void);
+	size_t (*kdf_pending_requests)(void);
+
+	// Base64 codec (RFC 4648)
+	size_t (*base64_encode)(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding);
+	bool (*base64_decode)(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding, size_t* num_bytes_written);
+	base64_simd_level_t (*base64_get_simd_level)(void);
+	bool (*base64_set_simd_level)(base64_simd_level_t level);
+
+	// Streaming digests and HMAC (contexts are reset after finalizing, so they can be reused)
+	crypto_hash_context_t* (*hash_context_new)(crypto_digest_algorithm_t algorithm);
+	crypto_hash_context_t* (*hmac_context_new)(crypto_digest_algorithm_t algorithm, const unsigned char* key, size_t key_len);
+	void (*hash_context_free)(crypto_hash_context_t* context);
+	bool (*hash_context_reset)(crypto_hash_context_t* context);
+	bool (*hash_context_update)(crypto_hash_context_t* context, const unsigned char* src, size_t src_len);
+	size_t (*hash_context_final)(crypto_hash_context_t* context, unsigned char* dst, size_t dst_len);
+	size_t (*hash_get_digest_size)(crypto_digest_algorithm_t algorithm);
+	bool (*hash_buffers)(crypto_digest_algorithm_t algorithm, const crypto_buffer_t* buffers, size_t num_buffers, unsigned char* dst, size_t dst_len);
+
+	// AEAD encryption (keys are expanded once, and the ciphertext is always exactly as long as the plaintext)
+	crypto_aead_key_t* (*aead_key_new)(crypto_aead_algorithm_t algorithm, const unsigned char* key, size_t key_len);
+	void (*aead_key_free)(crypto_aead_key_t* key);
+	bool (*aead_seal)(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, unsigned char* dst, unsigned char* tag);
+	bool (*aead_open)(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, const unsigned char* tag, unsigned char* dst);
+	size_t (*aead_seal_batch)(crypto_aead_key_t* key, const unsigned char* aad, size_t aad_len, const crypto_aead_message_t* messages, size_t num_messages);
+	bool (*random_bytes)(unsigned char* dst, size_t dst_len);
+
 	int (*openssl_crypto_memcmp)(const void* a, const void* b, size_t len);
 };
 
@@ -61,6 +161,14 @@ struct static_crypto_exports_table {
 local OPENSSL_MIN_ERROR_STRING_LENGTH = 120
 local preallocatedMessageExchangeBuffer = buffer:new(OPENSSL_MIN_ERROR_STRING_LENGTH)
 local preallocatedConversionBuffer = buffer.new(128)
+local MAX_DIGEST_SIZE_IN_BYTES = 64 -- Same as EVP_MAX_MD_SIZE
+local preallocatedDigestBuffer = ffi_new("unsigned char[?]", MAX_DIGEST_SIZE_IN_BYTES)
+local preallocatedDecodedSize = ffi_new("size_t[1]")
+-- Sealed messages are laid out as nonce .. ciphertext .. tag (with the sizes defined in the exports header)
+local AEAD_KEY_SIZE_IN_BYTES = 32
+local AEAD_NONCE_SIZE_IN_BYTES = 12
+local AEAD_TAG_SIZE_IN_BYTES = 16
+local AEAD_OVERHEAD_IN_BYTES = AEAD_NONCE_SIZE_IN_BYTES + AEAD_TAG_SIZE_IN_BYTES
 
 function crypto.initialize()
 	ffi.cdef(crypto.cdefs)
@@ -75,6 +183,172 @@ function crypto.initialize()
 		size = 32,
 		iterations = 3,
 	}
+
+	crypto.DEFAULT_BASE64_OPTIONS = {
+		alphabet = crypto.BASE64_ALPHABET_STANDARD,
+		padding = true,
+	}
+
+	crypto.digestAlgorithms = {
+		[crypto.DIGEST_SHA1] = ffi.C.CRYPTO_DIGEST_SHA1,
+		[crypto.DIGEST_SHA256] = ffi.C.CRYPTO_DIGEST_SHA256,
+		[crypto.DIGEST_SHA512] = ffi.C.CRYPTO_DIGEST_SHA512,
+		[crypto.DIGEST_BLAKE2S256] = ffi.C.CRYPTO_DIGEST_BLAKE2S256,
+		[crypto.DIGEST_BLAKE2B512] = ffi.C.CRYPTO_DIGEST_BLAKE2B512,
+	}
+
+	local hashContext = {}
+
+	function hashContext:update(input)
+		if not crypto.bindings.hash_context_update(self, input, #input) then
+			error("Failed to update the hash context", 0)
+		end
+	end
+
+	function hashContext:final()
+		local numBytesWritten =
+			crypto.bindings.hash_context_final(self, preallocatedDigestBuffer, MAX_DIGEST_SIZE_IN_BYTES)
+		if numBytesWritten == 0 then
+			error("Failed to finalize the hash context", 0)
+		end
+
+		return ffi_string(preallocatedDigestBuffer, numBytesWritten)
+	end
+
+	function hashContext:reset()
+		if not crypto.bindings.hash_context_reset(self) then
+			error("Failed to reset the hash context", 0)
+		end
+	end
+
+	hashContext.__index = hashContext
+
+	crypto.aeadAlgorithms = {
+		[crypto.AEAD_AES_256_GCM] = ffi.C.CRYPTO_AEAD_AES_256_GCM,
+		[crypto.AEAD_CHACHA20_POLY1305] = ffi.C.CRYPTO_AEAD_CHACHA20_POLY1305,
+	}
+
+	local aeadKey = {}
+
+	-- A random nonce is generated for each message, which is safe for up to 2^32 messages per key
+	function aeadKey:seal(plaintext, associatedData)
+		associatedData = associatedData or ""
+		local plaintextSize = #plaintext
+
+		preallocatedConversionBuffer:reset()
+		local nonce = preallocatedConversionBuffer:reserve(plaintextSize + AEAD_OVERHEAD_IN_BYTES)
+		if not crypto.bindings.random_bytes(nonce, AEAD_NONCE_SIZE_IN_BYTES) then
+			error("Failed to generate a random nonce", 0)
+		end
+
+		local ciphertext = nonce + AEAD_NONCE_SIZE_IN_BYTES
+		local tag = ciphertext + plaintextSize
+		local success = crypto.bindings.aead_seal(
+			self,
+			nonce,
+			associatedData,
+			#associatedData,
+			plaintext,
+			plaintextSize,
+			ciphertext,
+			tag
+		)
+		if not success then
+			error("Failed to seal message", 0)
+		end
+
+		preallocatedConversionBuffer:commit(plaintextSize + AEAD_OVERHEAD_IN_BYTES)
+		return tostring(preallocatedConversionBuffer)
+	end
+
+	function aeadKey:open(sealedMessage, associatedData)
+		associatedData = associatedData or ""
+		local ciphertextSize = #sealedMessage - AEAD_OVERHEAD_IN_BYTES
+		if ciphertextSize < 0 then
+			return nil, "Invalid sealed message (too short to contain the nonce and tag)"
+		end
+
+		local nonce = ffi_cast("const unsigned char*", sealedMessage)
+		local ciphertext = nonce + AEAD_NONCE_SIZE_IN_BYTES
+		local tag = ciphertext + ciphertextSize
+
+		preallocatedConversionBuffer:reset()
+		local plaintext = preallocatedConversionBuffer:reserve(ciphertextSize)
+		local success = crypto.bindings.aead_open(
+			self,
+			nonce,
+			associatedData,
+			#associatedData,
+			ciphertext,
+			ciphertextSize,
+			tag,
+			plaintext
+		)
+		if not success then
+			return nil, "Failed to authenticate sealed message (wrong key, associated data, or corrupted ciphertext)"
+		end
+
+		preallocatedConversionBuffer:commit(ciphertextSize)
+		return tostring(preallocatedConversionBuffer)
+	end
+
+	-- Same as sealing each message individually, but with only one call into OpenSSL for the nonces and encryption
+	function aeadKey:sealBatch(plaintexts, associatedData)
+		associatedData = associatedData or ""
+		local numMessages = #plaintexts
+		if numMessages == 0 then
+			return {}
+		end
+
+		local totalSize = numMessages * AEAD_OVERHEAD_IN_BYTES
+		for index = 1, numMessages, 1 do
+			totalSize = totalSize + #plaintexts[index]
+		end
+
+		local nonces = ffi_new("unsigned char[?]", numMessages * AEAD_NONCE_SIZE_IN_BYTES)
+		if not crypto.bindings.random_bytes(nonces, numMessages * AEAD_NONCE_SIZE_IN_BYTES) then
+			error("Failed to generate random nonces", 0)
+		end
+
+		preallocatedConversionBuffer:reset()
+		local ptr = preallocatedConversionBuffer:reserve(totalSize)
+		local messages = ffi_new("crypto_aead_message_t[?]", numMessages)
+		local offset = 0
+		for index = 1, numMessages, 1 do
+			local plaintext = plaintexts[index]
+			local message = messages[index - 1]
+			ffi_copy(ptr + offset, nonces + (index - 1) * AEAD_NONCE_SIZE_IN_BYTES, AEAD_NONCE_SIZE_IN_BYTES)
+			message.nonce = ptr + offset
+			message.plaintext = plaintext
+			message.length = #plaintext
+			message.ciphertext = ptr + offset + AEAD_NONCE_SIZE_IN_BYTES
+			message.tag = message.ciphertext + #plaintext
+			offset = offset + #plaintext + AEAD_OVERHEAD_IN_BYTES
+		end
+
+		local numSealedMessages =
+			crypto.bindings.aead_seal_batch(self, associatedData, #associatedData, messages, numMessages)
+		if tonumber(numSealedMessages) ~= numMessages then
+			error(format("Failed to seal message %d of %d", tonumber(numSealedMessages) + 1, numMessages), 0)
+		end
+
+		local sealedMessages = table_new(numMessages, 0)
+		offset = 0
+		for index = 1, numMessages, 1 do
+			local sealedSize = #plaintexts[index] + AEAD_OVERHEAD_IN_BYTES
+			sealedMessages[index] = ffi_string(ptr + offset, sealedSize)
+			offset = offset + sealedSize
+		end
+
+		return sealedMessages
+	end
+
+	aeadKey.__index = aeadKey
+
+	crypto.metatypes = {
+		hashContext = ffi.metatype("struct crypto_hash_context_t", hashContext),
+		aeadKey = ffi.metatype("struct crypto_aead_key_t", aeadKey),
+	}
 end
 
 function crypto.version()
@@ -172,7 +446,165 @@ function crypto.fromBase64(encodedHash)
 	return tostring(preallocatedConversionBuffer)
 end
 
-function crypto.hash(plaintextPassword, salt, kdfParameters)
+local function getBase64Options(options)
+	options = options or crypto.DEFAULT_BASE64_OPTIONS
+
+	local alphabet = options.alphabet or crypto.DEFAULT_BASE64_OPTIONS.alphabet
+	if alphabet ~= crypto.BASE64_ALPHABET_STANDARD and alphabet ~= crypto.BASE64_ALPHABET_URL_SAFE then
+		error(format("Invalid Base64 alphabet %s (must be standard or url)", tostring(alphabet)), 0)
+	end
+
+	local padding = options.padding
+	if padding == nil then
+		padding = crypto.DEFAULT_BASE64_OPTIONS.padding
+	end
+	if type(padding) ~= "boolean" then
+		error(format("Invalid Base64 padding %s (must be a boolean value)", tostring(padding)), 0)
+	end
+
+	local alphabetID = (alphabet == crypto.BASE64_ALPHABET_URL_SAFE) and ffi.C.BASE64_ALPHABET_URL_SAFE
+		or ffi.C.BASE64_ALPHABET_STANDARD
+	return alphabetID, padding
+end
+
+function crypto.getSizeOfBase64(input, options)
+	local _, padding = getBase64Options(options)
+
+	local numLeftoverBytes = #input % 3
+	local requiredSpace = math_floor(#input / 3) * 4
+	if numLeftoverBytes == 0 then
+		return requiredSpace
+	end
+
+	return requiredSpace + (padding and 4 or numLeftoverBytes + 1)
+end
+
+-- Unlike toBase64, there are no line breaks (and the SIMD codec is much faster than OpenSSL)
+function crypto.encodeBase64(input, options)
+	local alphabet, padding = getBase64Options(options)
+	local requiredSpace = crypto.getSizeOfBase64(input, options)
+
+	preallocatedConversionBuffer:reset()
+	local ptr, len = preallocatedConversionBuffer:reserve(requiredSpace)
+	local numBytesWritten = crypto.bindings.base64_encode(ptr, len, input, #input, alphabet, padding)
+	preallocatedConversionBuffer:commit(numBytesWritten)
+
+	return tostring(preallocatedConversionBuffer)
+end
+
+function crypto.decodeBase64(encodedInput, options)
+	local alphabet, padding = getBase64Options(options)
+	local requiredSpace = math_ceil(#encodedInput * 3 / 4) -- Worst case (no padding bytes)
+
+	preallocatedConversionBuffer:reset()
+	local ptr, len = preallocatedConversionBuffer:reserve(requiredSpace)
+	local success =
+		crypto.bindings.base64_decode(ptr, len, encodedInput, #encodedInput, alphabet, padding, preallocatedDecodedSize)
+	if not success then
+		preallocatedConversionBuffer:reset()
+		return nil, "Invalid Base64 input (the string contains unexpected characters or padding)"
+	end
+	preallocatedConversionBuffer:commit(preallocatedDecodedSize[0])
+
+	return tostring(preallocatedConversionBuffer)
+end
+
+local function getDigestAlgorithm(algorithm)
+	local algorithmID = crypto.digestAlgorithms[algorithm]
+	if not algorithmID then
+		error(format("Unsupported digest algorithm %s", tostring(algorithm)), 0)
+	end
+
+	return algorithmID
+end
+
+-- Contexts are reset after finalizing, so the same one can be used to hash any number of inputs
+function crypto.createHash(algorithm)
+	local context = crypto.bindings.hash_context_new(getDigestAlgorithm(algorithm))
+	if context == nil then
+		error(format("Failed to create hash context for algorithm %s", algorithm), 0)
+	end
+
+	return ffi_gc(context, crypto.bindings.hash_context_free)
+end
+
+function crypto.createHMAC(algorithm, key)
+	local context = crypto.bindings.hmac_context_new(getDigestAlgorithm(algorithm), key, #key)
+	if context == nil then
+		error(format("Failed to create HMAC context for algorithm %s", algorithm), 0)
+	end
+
+	return ffi_gc(context, crypto.bindings.hash_context_free)
+end
+
+local cachedHashContexts = {}
+function crypto.digest(algorithm, input)
+	local context = cachedHashContexts[algorithm]
+	if not context then
+		context = crypto.createHash(algorithm)
+		cachedHashContexts[algorithm] = context
+	end
+
+	context:update(input)
+	return context:final()
+end
+
+local numPreallocatedBufferDescriptors = 0
+local preallocatedBufferDescriptors
+
+-- All digests are returned as one string (stored back to back), since creating one string per digest would cost more than the FFI calls saved
+function crypto.hashBuffers(algorithm, inputs)
+	local algorithmID = getDigestAlgorithm(algorithm)
+	local digestSize = tonumber(crypto.bindings.hash_get_digest_size(algorithmID))
+
+	local numBuffers = #inputs
+	if numBuffers > numPreallocatedBufferDescriptors then
+		numPreallocatedBufferDescriptors = math_max(numBuffers, 2 * numPreallocatedBufferDescriptors)
+		preallocatedBufferDescriptors = ffi_new("crypto_buffer_t[?]", numPreallocatedBufferDescriptors)
+	end
+
+	local buffers = preallocatedBufferDescriptors
+	for index = 1, numBuffers, 1 do
+		local input = inputs[index]
+		buffers[index - 1].data = input
+		buffers[index - 1].length = #input
+	end
+
+	preallocatedConversionBuffer:reset()
+	local ptr, len = preallocatedConversionBuffer:reserve(numBuffers * digestSize)
+	if not crypto.bindings.hash_buffers(algorithmID, buffers, numBuffers, ptr, len) then
+		error(format("Failed to hash %d buffers with algorithm %s", numBuffers, algorithm), 0)
+	end
+	preallocatedConversionBuffer:commit(numBuffers * digestSize)
+
+	return tostring(preallocatedConversionBuffer), digestSize
+end
+
+-- The key is expanded once, so reusing the same object for many messages is much cheaper than creating a new one
+function crypto.createAEADKey(algorithm, keyBytes)
+	local algorithmID = crypto.aeadAlgorithms[algorithm]
+	if not algorithmID then
+		error(format("Unsupported AEAD algorithm %s", tostring(algorithm)), 0)
+	end
+
+	-- The key itself must never end up in the error message (or any logs that it's written to)
+	if type(keyBytes) ~= "string" then
+		error(format("Invalid AEAD key (expected a string, got %s)", type(keyBytes)), 0)
+	end
+
+	if #keyBytes ~= AEAD_KEY_SIZE_IN_BYTES then
+		error(format("Invalid AEAD key (expected %d bytes, got %d)", AEAD_KEY_SIZE_IN_BYTES, #keyBytes), 0)
+	end
+
+	local key = crypto.bindings.aead_key_new(algorithmID, keyBytes, #keyBytes)
+	if key == nil then
+		error(format("Failed to create AEAD key for algorithm %s", algorithm), 0)
+	end
+
+	return ffi_gc(key, crypto.bindings.aead_key_free)
+end
+
+local function createKdfParameters(kdfParameters)
 	kdfParameters = kdfParameters or crypto.DEFAULT_KDF_PARAMETERS
 
 	local parameters = ffi_new("kdf_parameters_t")
@@ -184,12 +616,23 @@ function crypto.hash(plaintextPassword, salt, kdfParameters)
 	parameters.size = kdfParameters.size or crypto.DEFAULT_KDF_PARAMETERS.size
 	parameters.iterations = kdfParameters.iterations or crypto.DEFAULT_KDF_PARAMETERS.iterations
 
+	return parameters
+end
+
+local function createKdfInputs(plaintextPassword, salt)
 	local inputs = ffi_new("kdf_input_t")
 	inputs.password = plaintextPassword
 	inputs.pw_length = #plaintextPassword
 	inputs.salt = salt
 	inputs.salt_length = #salt
 
+	return inputs
+end
+
+function crypto.hash(plaintextPassword, salt, kdfParameters)
+	local parameters = createKdfParameters(kdfParameters)
+	local inputs = createKdfInputs(plaintextPassword, salt)
+
 	preallocatedConversionBuffer:reset()
 	preallocatedMessageExchangeBuffer:reset()
 	local result = ffi_new("kdf_result_t")
@@ -206,6 +649,103 @@ function crypto.hash(plaintextPassword, salt, kdfParameters)
 	return tostring(preallocatedConversionBuffer)
 end
 
+-- Results are delivered via a deferred event queue, so that errors raised by the callbacks propagate like any other
+local derivationEventQueue
+local derivationEventChecker
+local pendingDerivations = {}
+local numPendingDerivations = 0
+local nextDerivationID = 0
+
+local function processDerivationEvents()
+	while tonumber(interop.bindings.queue_size(derivationEventQueue)) > 0 do
+		local event = interop.bindings.queue_pop_event(derivationEventQueue)
+		local requestID = tonumber(event.key_derivation_details.request_id)
+
+		-- Bookkeeping comes first, so that errors raised by the callbacks can't leave the request in limbo
+		local derivation = pendingDerivations[requestID]
+		pendingDerivations[requestID] = nil -- Also unpins the inputs and buffers (if nothing else references them)
+		numPendingDerivations = numPendingDerivations - 1
+
+		local hash, errorMessage
+		if derivation.result.success then
+			hash = ffi_string(derivation.result.hash, derivation.parameters.size)
+		else
+			errorMessage = "OpenSSL " .. ffi_string(derivation.result.message)
+		end
+
+		if derivation.thread then
+			local success, resumeError = coroutine.resume(derivation.thread, hash, errorMessage)
+			if not success then
+				error(debug.traceback(derivation.thread, resumeError), 0)
+			end
+		else
+			derivation.onCompletion(hash, errorMessage)
+		end
+	end
+
+	if numPendingDerivations == 0 then
+		derivationEventChecker:stop()
+	end
+end
+
+local function startDerivationEventChecker()
+	if not derivationEventQueue then
+		derivationEventQueue = interop.bindings.queue_create()
+		derivationEventChecker = uv.new_check()
+		derivationEventChecker:unref() -- The worker threads' completion signal already keeps the loop alive
+	end
+
+	if numPendingDerivations == 0 then
+		derivationEventChecker:start(processDerivationEvents)
+	end
+end
+
+-- Same as crypto.hash, but the key is derived on a separate thread (so that the event loop can keep running)
+function crypto.hashAsync(plaintextPassword, salt, kdfParameters, onCompletion)
+	local currentThread, isMainThread = coroutine.running()
+	if onCompletion == nil and isMainThread then
+		error("Cannot yield from the main thread (pass a completion handler or wrap async task in a coroutine)", 0)
+	end
+	if onCompletion ~= nil and type(onCompletion) ~= "function" then
+		error(format("Invalid completion handler %s (must be a function)", tostring(onCompletion)), 0)
+	end
+
+	local parameters = createKdfParameters(kdfParameters)
+	local inputs = createKdfInputs(plaintextPassword, salt)
+
+	-- The shared buffers can't be used here, since any number of derivations might be running at the same time
+	local result = ffi_new("kdf_result_t")
+	local hash = ffi_new("unsigned char[?]", parameters.size)
+	local message = ffi_new("char[?]", OPENSSL_MIN_ERROR_STRING_LENGTH)
+	result.hash = hash
+	result.message = message
+
+	local requestID = nextDerivationID
+	nextDerivationID = (nextDerivationID + 1) % 0xFFFFFFFF
+	pendingDerivations[requestID] = {
+		parameters = parameters,
+		result = result,
+		pinnedObjects = { plaintextPassword, salt, inputs, hash, message, kdfParameters },
+		onCompletion = onCompletion,
+		thread = (onCompletion == nil) and currentThread or nil,
+	}
+
+	startDerivationEventChecker()
+	local success = crypto.bindings.kdf_derive_async(derivationEventQueue, inputs, parameters, result, requestID)
+	if not success then
+		pendingDerivations[requestID] = nil
+		if numPendingDerivations == 0 then
+			derivationEventChecker:stop()
+		end
+		error("Failed to queue password hashing request (too many requests are already pending)", 0)
+	end
+	numPendingDerivations = numPendingDerivations + 1
+
+	if onCompletion == nil then
+		return coroutine.yield()
+	end
+end
+
 function crypto.verify(plaintextPassword, salt, hash, kdfParameters)
 	local rehash = crypto.hash(plaintextPassword, salt, kdfParameters)
 	local diff = crypto.bindings.openssl_crypto_memcmp(hash, rehash, math_min(#hash, #rehash))
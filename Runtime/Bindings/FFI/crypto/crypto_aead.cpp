@@ -0,0 +1,129 @@
+#include "crypto_aead.hpp"
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <climits>
+
+namespace crypto_aead {
+
+	// Must match the order of crypto_aead_algorithm_t
+	constexpr const char* CIPHER_NAMES[CRYPTO_AEAD_NUM_ALGORITHMS] = {
+		"AES-256-GCM",
+		"ChaCha20-Poly1305",
+	};
+
+	// The EVP API uses int for all lengths, so larger inputs must be split up
+	constexpr size_t MAX_CHUNK_SIZE = INT_MAX / 2;
+
+	// Fetched on first use and kept alive until exit (initialization of function-local statics is thread-safe)
+	struct FetchedCiphers {
+		EVP_CIPHER* ciphers[CRYPTO_AEAD_NUM_ALGORITHMS] = {};
+
+		FetchedCiphers() {
+			for(size_t index = 0; index < CRYPTO_AEAD_NUM_ALGORITHMS; index++)
+				ciphers[index] = EVP_CIPHER_fetch(nullptr, CIPHER_NAMES[index], nullptr);
+		}
+
+		~FetchedCiphers() {
+			for(EVP_CIPHER* cipher : ciphers)
+				EVP_CIPHER_free(cipher);
+		}
+	};
+
+	static const EVP_CIPHER* getCipher(crypto_aead_algorithm_t algorithm) {
+		static const FetchedCiphers fetchedCiphers;
+		if(algorithm < CRYPTO_AEAD_AES_256_GCM || algorithm >= CRYPTO_AEAD_NUM_ALGORITHMS) return nullptr;
+		return fetchedCiphers.ciphers[algorithm];
+	}
+
+	static EVP_CIPHER_CTX* createContext(const EVP_CIPHER* cipher, const unsigned char* keyBytes, bool isEncrypting) {
+		EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+		if(!context) return nullptr;
+
+		int success = isEncrypting ? EVP_EncryptInit_ex2(context, cipher, keyBytes, nullptr, nullptr) : EVP_DecryptInit_ex2(context, cipher, keyBytes, nullptr, nullptr);
+		if(success != 1) {
+			EVP_CIPHER_CTX_free(context);
+			return nullptr;
+		}
+
+		return context;
+	}
+
+	crypto_aead_key_t* createKey(crypto_aead_algorithm_t algorithm, const unsigned char* keyBytes, size_t keySize) {
+		const EVP_CIPHER* cipher = getCipher(algorithm);
+		if(!cipher) return nullptr;
+		if(keySize != CRYPTO_AEAD_KEY_SIZE || static_cast<int>(keySize) != EVP_CIPHER_get_key_length(cipher)) return nullptr;
+
+		EVP_CIPHER_CTX* encryptionContext = createContext(cipher, keyBytes, true);
+		EVP_CIPHER_CTX* decryptionContext = createContext(cipher, keyBytes, false);
+		if(!encryptionContext || !decryptionContext) {
+			EVP_CIPHER_CTX_free(encryptionContext);
+			EVP_CIPHER_CTX_free(decryptionContext);
+			return nullptr;
+		}
+
+		return new crypto_aead_key_t { algorithm, encryptionContext, decryptionContext };
+	}
+
+	void destroyKey(crypto_aead_key_t* key) {
+		// Freeing the contexts also wipes the expanded keys
+		EVP_CIPHER_CTX_free(key->encryptionContext);
+		EVP_CIPHER_CTX_free(key->decryptionContext);
+		delete key;
+	}
+
+	// Also used for the associated data, which is passed without an output buffer
+	static bool updateContext(EVP_CIPHER_CTX* context, bool isEncrypting, const unsigned char* input, size_t inputSize, unsigned char* output) {
+		for(size_t offset = 0; offset < inputSize; offset += MAX_CHUNK_SIZE) {
+			int chunkSize = static_cast<int>(std::min(inputSize - offset, MAX_CHUNK_SIZE));
+			int numBytesWritten = 0;
+			unsigned char* chunkOutput = output ? output + offset : nullptr;
+
+			int success = isEncrypting ? EVP_EncryptUpdate(context, chunkOutput, &numBytesWritten, input + offset, chunkSize) : EVP_DecryptUpdate(context, chunkOutput, &numBytesWritten, input + offset, chunkSize);
+			if(success != 1) return false;
+		}
+
+		return true;
+	}
+
+	bool seal(crypto_aead_key_t& key, const unsigned char* nonce, const unsigned char* aad, size_t aadSize, const unsigned char* input, size_t inputSize, unsigned char* output, unsigned char* tag) {
+		EVP_CIPHER_CTX* context = key.encryptionContext;
+		if(EVP_EncryptInit_ex2(context, nullptr, nullptr, nonce, nullptr) != 1) return false;
+		if(!updateContext(context, true, aad, aadSize, nullptr)) return false;
+		if(!updateContext(context, true, input, inputSize, output)) return false;
+
+		// Neither cipher buffers any data, so nothing is written here (but the output pointer must still be valid)
+		int numBytesWritten = 0;
+		if(EVP_EncryptFinal_ex(context, output + inputSize, &numBytesWritten) != 1) return false;
+
+		return EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_GET_TAG, CRYPTO_AEAD_TAG_SIZE, tag) == 1;
+	}
+
+	bool open(crypto_aead_key_t& key, const unsigned char* nonce, const unsigned char* aad, size_t aadSize, const unsigned char* input, size_t inputSize, const unsigned char* tag, unsigned char* output) {
+		EVP_CIPHER_CTX* context = key.decryptionContext;
+		bool success = EVP_DecryptInit_ex2(context, nullptr, nullptr, nonce, nullptr) == 1;
+		success = success && updateContext(context, false, aad, aadSize, nullptr);
+		success = success && updateContext(context, false, input, inputSize, output);
+		success = success && EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_TAG, CRYPTO_AEAD_TAG_SIZE, const_cast<unsigned char*>(tag)) == 1;
+
+		int numBytesWritten = 0;
+		success = success && EVP_DecryptFinal_ex(context, output + inputSize, &numBytesWritten) == 1;
+
+		if(!success) OPENSSL_cleanse(output, inputSize);
+		return success;
+	}
+
+	size_t sealMessages(crypto_aead_key_t& key, const unsigned char* aad, size_t aadSize, const crypto_aead_message_t* messages, size_t numMessages) {
+		for(size_t index = 0; index < numMessages; index++) {
+			const crypto_aead_message_t& message = messages[index];
+			if(!message.nonce || !message.ciphertext || !message.tag) return index;
+			if(!message.plaintext && message.length > 0) return index;
+
+			if(!seal(key, message.nonce, aad, aadSize, message.plaintext, message.length, message.ciphertext, message.tag)) return index;
+		}
+
+		return numMessages;
+	}
+
+}
\ No newline at end of file
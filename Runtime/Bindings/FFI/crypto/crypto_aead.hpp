@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include <openssl/evp.h>
+
+#include "crypto_ffi.hpp" // For the AEAD types (the exports header lacks include guards)
+
+// Both contexts are initialized with the key up front, so only the nonce needs to be set for each message
+// Keys aren't thread-safe: Each thread that encrypts or decrypts messages concurrently needs its own copy
+struct crypto_aead_key_t {
+	crypto_aead_algorithm_t algorithm;
+	EVP_CIPHER_CTX* encryptionContext;
+	EVP_CIPHER_CTX* decryptionContext;
+};
+
+namespace crypto_aead {
+	crypto_aead_key_t* createKey(crypto_aead_algorithm_t algorithm, const unsigned char* keyBytes, size_t keySize);
+	void destroyKey(crypto_aead_key_t* key);
+
+	bool seal(crypto_aead_key_t& key, const unsigned char* nonce, const unsigned char* aad, size_t aadSize, const unsigned char* input, size_t inputSize, unsigned char* output, unsigned char* tag);
+	// The output is wiped if authentication fails, so that unverified plaintext can't be used by accident
+	bool open(crypto_aead_key_t& key, const unsigned char* nonce, const unsigned char* aad, size_t aadSize, const unsigned char* input, size_t inputSize, const unsigned char* tag, unsigned char* output);
+	// Stops at the first message that can't be sealed, and returns how many were
+	size_t sealMessages(crypto_aead_key_t& key, const unsigned char* aad, size_t aadSize, const crypto_aead_message_t* messages, size_t numMessages);
+}
\ No newline at end of file
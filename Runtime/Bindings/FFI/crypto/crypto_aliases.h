@@ -0,0 +1 @@
+typedef void* deferred_event_queue_t; // Duplicated in the interop aliases (fix later)
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "crypto_async.hpp"
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace crypto_async {
+
+	struct DerivationRequest {
+		kdf_input_t inputs;
+		kdf_parameters_t parameters;
+		kdf_result_t* result;
+		uint32_t requestID;
+		deferred_event_queue_t queue;
+	};
+
+	// The queues are shared with the worker threads, but the threads themselves are only managed on the main thread
+	struct WorkerPool {
+		std::mutex mutex;
+		std::condition_variable hasQueuedRequests;
+		std::deque<DerivationRequest> queuedRequests;
+		std::vector<DerivationRequest> completedRequests;
+		std::vector<std::thread> workerThreads;
+		bool isShuttingDown = false;
+
+		// OpenSSL cleans up in an exit handler, which must be registered first so that it runs after the workers have stopped
+		WorkerPool() {
+			OPENSSL_init_crypto(0, nullptr);
+		}
+
+		// Should already have happened (before the Lua state was closed), so this is merely a fallback
+		~WorkerPool() {
+			stopWorkerThreads();
+		}
+
+		// Requests that haven't been started are dropped, but running derivations can't be interrupted (only waited for)
+		void stopWorkerThreads() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				isShuttingDown = true;
+				queuedRequests.clear();
+			}
+			hasQueuedRequests.notify_all();
+
+			for(std::thread& workerThread : workerThreads)
+				workerThread.join();
+			workerThreads.clear();
+			completedRequests.clear();
+		}
+	};
+
+	static uv_loop_t* assignedLoop = nullptr;
+	static uv_async_t completionSignal;
+	static size_t numPendingRequests = 0;
+
+	static WorkerPool& getWorkerPool() {
+		static WorkerPool pool;
+		return pool;
+	}
+
+	static static_crypto_exports_table* getCryptoExports() {
+		return static_cast<static_crypto_exports_table*>(crypto_ffi::getExportsTable());
+	}
+
+	static void runWorkerThread(WorkerPool& pool) {
+		while(true) {
+			DerivationRequest request;
+			{
+				std::unique_lock<std::mutex> lock(pool.mutex);
+				pool.hasQueuedRequests.wait(lock, [&pool]() {
+					return pool.isShuttingDown || !pool.queuedRequests.empty();
+				});
+				if(pool.isShuttingDown) return;
+
+				request = pool.queuedRequests.front();
+				pool.queuedRequests.pop_front();
+			}
+
+			getCryptoExports()->openssl_kdf_derive(request.inputs, request.parameters, request.result);
+
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				pool.completedRequests.push_back(request);
+			}
+			uv_async_send(&completionSignal);
+		}
+	}
+
+	static void pushDerivationEvent(const DerivationRequest& request) {
+		key_derivation_event_t details = {};
+		details.type = KEY_DERIVATION_EVENT;
+		details.request_id = request.requestID;
+
+		deferred_event_t event;
+		event.key_derivation_details = details;
+		request.queue->push(event);
+	}
+
+	// Runs on the main thread, so the (non-thread-safe) event queue doesn't require any locking
+	static void onDerivationsCompleted(uv_async_t* handle) {
+		WorkerPool& pool = getWorkerPool();
+		std::vector<DerivationRequest> completedRequests;
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			completedRequests.swap(pool.completedRequests);
+		}
+
+		// The events are processed later in the same loop iteration, so there's no need to keep the loop alive for them
+		numPendingRequests -= completedRequests.size();
+		if(numPendingRequests == 0) uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+
+		for(const DerivationRequest& request : completedRequests)
+			pushDerivationEvent(request);
+	}
+
+	void assignEventLoop(uv_loop_t* loop) {
+		assignedLoop = loop;
+
+		uv_async_init(loop, &completionSignal, onDerivationsCompleted);
+		uv_unref(reinterpret_cast<uv_handle_t*>(&completionSignal)); // Only needs to keep the loop alive while requests are pending
+	}
+
+	void unassignEventLoop() {
+		if(!assignedLoop) return;
+
+		// The workers signal the loop when they're done, so they must be stopped before the handle is closed
+		getWorkerPool().stopWorkerThreads();
+		numPendingRequests = 0;
+
+		uv_close(reinterpret_cast<uv_handle_t*>(&completionSignal), nullptr);
+		assignedLoop = nullptr;
+	}
+
+	size_t getNumWorkerThreads() {
+		return std::clamp<size_t>(uv_available_parallelism() / 2, 1, MAX_NUM_WORKER_THREADS);
+	}
+
+	size_t getNumPendingRequests() {
+		return numPendingRequests;
+	}
+
+	bool submitDerivation(deferred_event_queue_t queue, const kdf_input_t& inputs, const kdf_parameters_t& parameters, kdf_result_t* result, uint32_t requestID) {
+		if(!assignedLoop) return false;
+
+		// Most applications never hash any passwords, so the threads are only started once they're needed
+		WorkerPool& pool = getWorkerPool();
+		try {
+			while(pool.workerThreads.size() < getNumWorkerThreads())
+				pool.workerThreads.emplace_back(runWorkerThread, std::ref(pool));
+		} catch(const std::system_error&) {
+			if(pool.workerThreads.empty()) return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			if(pool.queuedRequests.size() >= MAX_NUM_QUEUED_REQUESTS) return false;
+
+			pool.queuedRequests.push_back({ inputs, parameters, result, requestID, queue });
+		}
+		pool.hasQueuedRequests.notify_one();
+
+		if(numPendingRequests == 0) uv_ref(reinterpret_cast<uv_handle_t*>(&completionSignal));
+		numPendingRequests++;
+
+		return true;
+	}
+
+}
\ No newline at end of file
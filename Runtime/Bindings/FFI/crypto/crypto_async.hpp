@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crypto_ffi.hpp" // For the KDF types (the exports header lacks include guards)
+
+extern "C" {
+#include "uv.h"
+}
+
+// Password hashing is slow by design, so running it on the main thread would stall the event loop for every login
+// It gets its own threads (instead of libuv's pool) so that a burst of logins can't starve file system requests
+namespace crypto_async {
+	constexpr size_t MAX_NUM_WORKER_THREADS = 4; // Each Argon2 derivation can easily use dozens of megabytes
+	constexpr size_t MAX_NUM_QUEUED_REQUESTS = 256; // Excluding those that are already running
+
+	void assignEventLoop(uv_loop_t* loop);
+	// Must be called before the Lua state is closed, since the workers write to buffers that it owns
+	void unassignEventLoop();
+
+	// The result (and everything the inputs point to) must stay alive until the completion event has been processed
+	bool submitDerivation(deferred_event_queue_t queue, const kdf_input_t& inputs, const kdf_parameters_t& parameters, kdf_result_t* result, uint32_t requestID);
+
+	size_t getNumWorkerThreads();
+	size_t getNumPendingRequests();
+}
\ No newline at end of file
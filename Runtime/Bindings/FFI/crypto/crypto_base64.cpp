@@ -0,0 +1,334 @@
+#include "crypto_base64.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CRYPTO_BASE64_X86 1
+#include <immintrin.h>
+#else
+#define CRYPTO_BASE64_X86 0
+#endif
+
+namespace crypto_base64 {
+
+	constexpr char STANDARD_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	constexpr char URL_SAFE_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	constexpr uint8_t PADDING_CHARACTER = '=';
+	constexpr uint8_t INVALID_CHARACTER = 0xFF;
+
+	struct DecodingTable {
+		uint8_t values[256];
+	};
+
+	static constexpr DecodingTable createDecodingTable(const char* alphabet) {
+		DecodingTable table = {};
+		for(size_t character = 0; character < 256; character++)
+			table.values[character] = INVALID_CHARACTER;
+		for(uint8_t value = 0; value < 64; value++)
+			table.values[static_cast<uint8_t>(alphabet[value])] = value;
+		return table;
+	}
+
+	constexpr DecodingTable STANDARD_DECODING_TABLE = createDecodingTable(STANDARD_ALPHABET);
+	constexpr DecodingTable URL_SAFE_DECODING_TABLE = createDecodingTable(URL_SAFE_ALPHABET);
+
+	static const char* getAlphabet(base64_alphabet_t alphabet) {
+		return (alphabet == BASE64_ALPHABET_URL_SAFE) ? URL_SAFE_ALPHABET : STANDARD_ALPHABET;
+	}
+
+	static const DecodingTable& getDecodingTable(base64_alphabet_t alphabet) {
+		return (alphabet == BASE64_ALPHABET_URL_SAFE) ? URL_SAFE_DECODING_TABLE : STANDARD_DECODING_TABLE;
+	}
+
+	static base64_simd_level_t detectSupportedLevel() {
+#if CRYPTO_BASE64_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) return BASE64_SIMD_AVX2;
+		if(__builtin_cpu_supports("ssse3")) return BASE64_SIMD_SSSE3;
+#endif
+		return BASE64_SIMD_SCALAR;
+	}
+
+	static const base64_simd_level_t supportedLevel = detectSupportedLevel();
+	static std::atomic<base64_simd_level_t> activeLevel = supportedLevel; // Read by worker threads, too
+
+	base64_simd_level_t getSupportedLevel() {
+		return supportedLevel;
+	}
+
+	base64_simd_level_t getActiveLevel() {
+		return activeLevel.load(std::memory_order_relaxed);
+	}
+
+	bool setActiveLevel(base64_simd_level_t level) {
+		if(level < BASE64_SIMD_SCALAR || level > supportedLevel) return false;
+
+		activeLevel.store(level, std::memory_order_relaxed);
+		return true;
+	}
+
+	size_t getEncodedSize(size_t inputSize, bool hasPadding) {
+		size_t numLeftoverBytes = inputSize % 3;
+		size_t encodedSize = inputSize / 3 * 4;
+		if(numLeftoverBytes == 0) return encodedSize;
+
+		return encodedSize + (hasPadding ? 4 : numLeftoverBytes + 1);
+	}
+
+	// Two characters are needed for the first byte of a group, and every additional one adds another byte
+	static size_t getDecodedSize(size_t numCharacters) {
+		return numCharacters / 4 * 3 + numCharacters % 4 * 3 / 4;
+	}
+
+	static void encodeScalar(uint8_t* output, const uint8_t* input, size_t inputSize, const char* alphabet, bool hasPadding) {
+		size_t offset = 0;
+		for(; offset + 3 <= inputSize; offset += 3, output += 4) {
+			uint32_t group = (input[offset] << 16) | (input[offset + 1] << 8) | input[offset + 2];
+			output[0] = alphabet[(group >> 18) & 0x3F];
+			output[1] = alphabet[(group >> 12) & 0x3F];
+			output[2] = alphabet[(group >> 6) & 0x3F];
+			output[3] = alphabet[group & 0x3F];
+		}
+
+		size_t numLeftoverBytes = inputSize - offset;
+		if(numLeftoverBytes == 0) return;
+
+		uint32_t group = input[offset] << 16;
+		if(numLeftoverBytes == 2) group |= input[offset + 1] << 8;
+
+		*output++ = alphabet[(group >> 18) & 0x3F];
+		*output++ = alphabet[(group >> 12) & 0x3F];
+		if(numLeftoverBytes == 2) *output++ = alphabet[(group >> 6) & 0x3F];
+		if(!hasPadding) return;
+
+		*output++ = PADDING_CHARACTER;
+		if(numLeftoverBytes == 1) *output++ = PADDING_CHARACTER;
+	}
+
+	// Padding is only allowed at the very end, and the bits that don't fit into the last byte must all be zero
+	static bool decodeScalar(uint8_t* output, const uint8_t* input, size_t inputSize, const DecodingTable& table, bool hasPadding, size_t& numBytesWritten) {
+		size_t numPaddingCharacters = 0;
+		if(hasPadding) {
+			if(inputSize % 4 != 0) return false;
+			if(inputSize > 0 && input[inputSize - 1] == PADDING_CHARACTER) {
+				numPaddingCharacters++;
+				if(input[inputSize - 2] == PADDING_CHARACTER) numPaddingCharacters++;
+			}
+		}
+
+		size_t numCharacters = inputSize - numPaddingCharacters;
+		if(numCharacters % 4 == 1) return false;
+
+		const uint8_t* start = output;
+		size_t offset = 0;
+		for(; offset + 4 <= numCharacters; offset += 4, output += 3) {
+			uint8_t first = table.values[input[offset]];
+			uint8_t second = table.values[input[offset + 1]];
+			uint8_t third = table.values[input[offset + 2]];
+			uint8_t fourth = table.values[input[offset + 3]];
+			if((first | second | third | fourth) == INVALID_CHARACTER) return false;
+
+			uint32_t group = (first << 18) | (second << 12) | (third << 6) | fourth;
+			output[0] = static_cast<uint8_t>(group >> 16);
+			output[1] = static_cast<uint8_t>(group >> 8);
+			output[2] = static_cast<uint8_t>(group);
+		}
+
+		size_t numLeftoverCharacters = numCharacters - offset;
+		if(numLeftoverCharacters > 0) {
+			uint8_t first = table.values[input[offset]];
+			uint8_t second = table.values[input[offset + 1]];
+			uint8_t third = (numLeftoverCharacters == 3) ? table.values[input[offset + 2]] : 0;
+			if((first | second | third) == INVALID_CHARACTER) return false;
+
+			uint32_t group = (first << 18) | (second << 12) | (third << 6);
+			uint32_t unusedBitsMask = (numLeftoverCharacters == 2) ? 0xFFFF : 0xFF;
+			if(group & unusedBitsMask) return false;
+
+			*output++ = static_cast<uint8_t>(group >> 16);
+			if(numLeftoverCharacters == 3) *output++ = static_cast<uint8_t>(group >> 8);
+		}
+
+		numBytesWritten = static_cast<size_t>(output - start);
+		return true;
+	}
+
+#if CRYPTO_BASE64_X86
+	// Maps 6-bit values to characters by adding an offset that only depends on which range the value falls into
+	// The offsets for the last two characters differ between alphabets, so they're the only part that's configurable
+	static inline __m128i createEncodingOffsets128(const char* alphabet) {
+		return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, static_cast<char>(alphabet[62] - 62), static_cast<char>(alphabet[63] - 63), 'A', 0, 0);
+	}
+
+	// Splits every three bytes into four 6-bit values (one per byte), using the multiplication trick by Wojciech Muła
+	__attribute__((target("ssse3"))) static inline __m128i encodeBlockSSSE3(__m128i input, __m128i encodingOffsets) {
+		input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+		__m128i upperValues = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		__m128i lowerValues = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		__m128i values = _mm_or_si128(upperValues, lowerValues);
+
+		__m128i rangeIndices = _mm_subs_epu8(values, _mm_set1_epi8(51));
+		__m128i isUppercase = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+		rangeIndices = _mm_or_si128(rangeIndices, _mm_and_si128(isUppercase, _mm_set1_epi8(13)));
+		return _mm_add_epi8(values, _mm_shuffle_epi8(encodingOffsets, rangeIndices));
+	}
+
+	// Only 12 of the 16 loaded bytes are used, so the loop stops early to avoid reading past the end of the input
+	__attribute__((target("ssse3"))) static size_t encodeSSSE3(uint8_t* output, const uint8_t* input, size_t inputSize, const char* alphabet) {
+		__m128i encodingOffsets = createEncodingOffsets128(alphabet);
+
+		size_t offset = 0;
+		for(; offset + 16 <= inputSize; offset += 12, output += 16) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output), encodeBlockSSSE3(block, encodingOffsets));
+		}
+
+		return offset;
+	}
+
+	// Same as the SSSE3 version, but with 24 bytes split across both lanes (loading them separately is simpler than permuting)
+	__attribute__((target("avx2"))) static size_t encodeAVX2(uint8_t* output, const uint8_t* input, size_t inputSize, const char* alphabet) {
+		__m256i encodingOffsets = _mm256_broadcastsi128_si256(createEncodingOffsets128(alphabet));
+		__m256i shuffleMask = _mm256_broadcastsi128_si256(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+		size_t offset = 0;
+		for(; offset + 28 <= inputSize; offset += 24, output += 32) {
+			__m128i lowerHalf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+			__m128i upperHalf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset + 12));
+			__m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(lowerHalf), upperHalf, 1);
+
+			block = _mm256_shuffle_epi8(block, shuffleMask);
+			__m256i upperValues = _mm256_mulhi_epu16(_mm256_and_si256(block, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+			__m256i lowerValues = _mm256_mullo_epi16(_mm256_and_si256(block, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+			__m256i values = _mm256_or_si256(upperValues, lowerValues);
+
+			__m256i rangeIndices = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+			__m256i isUppercase = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), values);
+			rangeIndices = _mm256_or_si256(rangeIndices, _mm256_and_si256(isUppercase, _mm256_set1_epi8(13)));
+			__m256i characters = _mm256_add_epi8(values, _mm256_shuffle_epi8(encodingOffsets, rangeIndices));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), characters);
+		}
+
+		return offset;
+	}
+
+	// Characters are classified by range (signed comparisons also reject anything above 0x7F), which works for both alphabets
+	// Blocks with invalid characters are left to the scalar fallback, since that's where the error is reported anyway
+	__attribute__((target("ssse3"))) static size_t decodeSSSE3(uint8_t* output, const uint8_t* input, size_t inputSize, const char* alphabet) {
+		__m128i character62 = _mm_set1_epi8(alphabet[62]);
+		__m128i character63 = _mm_set1_epi8(alphabet[63]);
+		__m128i offset62 = _mm_set1_epi8(static_cast<char>(62 - alphabet[62]));
+		__m128i offset63 = _mm_set1_epi8(static_cast<char>(63 - alphabet[63]));
+
+		// All 16 bytes are stored even though only 12 are decoded, so there must be enough characters left to overwrite the rest
+		size_t offset = 0;
+		for(; offset + 24 <= inputSize; offset += 16, output += 12) {
+			__m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+
+			__m128i isUppercase = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8('Z' + 1)));
+			__m128i isLowercase = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8('z' + 1)));
+			__m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(characters, _mm_set1_epi8('9' + 1)));
+			__m128i is62 = _mm_cmpeq_epi8(characters, character62);
+			__m128i is63 = _mm_cmpeq_epi8(characters, character63);
+
+			__m128i isValid = _mm_or_si128(_mm_or_si128(_mm_or_si128(isUppercase, isLowercase), _mm_or_si128(isDigit, is62)), is63);
+			if(_mm_movemask_epi8(isValid) != 0xFFFF) break;
+
+			__m128i offsets = _mm_or_si128(_mm_and_si128(isUppercase, _mm_set1_epi8(-'A')), _mm_and_si128(isLowercase, _mm_set1_epi8(26 - 'a')));
+			offsets = _mm_or_si128(offsets, _mm_and_si128(isDigit, _mm_set1_epi8(52 - '0')));
+			offsets = _mm_or_si128(offsets, _mm_or_si128(_mm_and_si128(is62, offset62), _mm_and_si128(is63, offset63)));
+			__m128i values = _mm_add_epi8(characters, offsets);
+
+			// Merges pairs of 6-bit values into 12 bits, then pairs of those into 24 bits (and finally drops the unused byte)
+			__m128i mergedPairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+			__m128i mergedGroups = _mm_madd_epi16(mergedPairs, _mm_set1_epi32(0x00011000));
+			__m128i bytes = _mm_shuffle_epi8(mergedGroups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output), bytes);
+		}
+
+		return offset;
+	}
+
+	__attribute__((target("avx2"))) static size_t decodeAVX2(uint8_t* output, const uint8_t* input, size_t inputSize, const char* alphabet) {
+		__m256i character62 = _mm256_set1_epi8(alphabet[62]);
+		__m256i character63 = _mm256_set1_epi8(alphabet[63]);
+		__m256i offset62 = _mm256_set1_epi8(static_cast<char>(62 - alphabet[62]));
+		__m256i offset63 = _mm256_set1_epi8(static_cast<char>(63 - alphabet[63]));
+		__m256i shuffleMask = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+		size_t offset = 0;
+		for(; offset + 48 <= inputSize; offset += 32, output += 24) {
+			__m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + offset));
+
+			__m256i isUppercase = _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), characters));
+			__m256i isLowercase = _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), characters));
+			__m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), characters));
+			__m256i is62 = _mm256_cmpeq_epi8(characters, character62);
+			__m256i is63 = _mm256_cmpeq_epi8(characters, character63);
+
+			__m256i isValid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(isUppercase, isLowercase), _mm256_or_si256(isDigit, is62)), is63);
+			if(_mm256_movemask_epi8(isValid) != -1) break;
+
+			__m256i offsets = _mm256_or_si256(_mm256_and_si256(isUppercase, _mm256_set1_epi8(-'A')), _mm256_and_si256(isLowercase, _mm256_set1_epi8(26 - 'a')));
+			offsets = _mm256_or_si256(offsets, _mm256_and_si256(isDigit, _mm256_set1_epi8(52 - '0')));
+			offsets = _mm256_or_si256(offsets, _mm256_or_si256(_mm256_and_si256(is62, offset62), _mm256_and_si256(is63, offset63)));
+			__m256i values = _mm256_add_epi8(characters, offsets);
+
+			__m256i mergedPairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+			__m256i mergedGroups = _mm256_madd_epi16(mergedPairs, _mm256_set1_epi32(0x00011000));
+			__m256i bytes = _mm256_shuffle_epi8(mergedGroups, shuffleMask);
+
+			// Each lane now holds 12 bytes, which need to be moved next to each other
+			bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), bytes);
+		}
+
+		return offset;
+	}
+#endif
+
+	bool encode(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, base64_alphabet_t alphabet, bool hasPadding, size_t& numBytesWritten) {
+		size_t encodedSize = getEncodedSize(inputSize, hasPadding);
+		if(outputSize < encodedSize) return false;
+
+		const char* characters = getAlphabet(alphabet);
+		size_t numBytesConsumed = 0;
+#if CRYPTO_BASE64_X86
+		const base64_simd_level_t level = activeLevel.load(std::memory_order_relaxed);
+		if(level == BASE64_SIMD_AVX2) numBytesConsumed = encodeAVX2(output, input, inputSize, characters);
+		if(level >= BASE64_SIMD_SSSE3) {
+			numBytesConsumed += encodeSSSE3(output + numBytesConsumed / 3 * 4, input + numBytesConsumed, inputSize - numBytesConsumed, characters);
+		}
+#endif
+		encodeScalar(output + numBytesConsumed / 3 * 4, input + numBytesConsumed, inputSize - numBytesConsumed, characters, hasPadding);
+
+		numBytesWritten = encodedSize;
+		return true;
+	}
+
+	bool decode(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, base64_alphabet_t alphabet, bool hasPadding, size_t& numBytesWritten) {
+		// The SIMD paths write a few bytes past the end of each block, which is only safe if the buffer is large enough
+		size_t numCharacters = inputSize;
+		while(numCharacters > 0 && inputSize - numCharacters < 2 && input[numCharacters - 1] == PADDING_CHARACTER)
+			numCharacters--;
+		if(outputSize < getDecodedSize(numCharacters)) return false;
+
+		const char* characters = getAlphabet(alphabet);
+		size_t numCharactersConsumed = 0;
+#if CRYPTO_BASE64_X86
+		const base64_simd_level_t level = activeLevel.load(std::memory_order_relaxed);
+		if(level == BASE64_SIMD_AVX2) numCharactersConsumed = decodeAVX2(output, input, inputSize, characters);
+		if(level >= BASE64_SIMD_SSSE3) {
+			numCharactersConsumed += decodeSSSE3(output + numCharactersConsumed / 4 * 3, input + numCharactersConsumed, inputSize - numCharactersConsumed, characters);
+		}
+#endif
+		size_t numDecodedBytes = numCharactersConsumed / 4 * 3;
+		size_t numRemainingBytes = 0;
+		const DecodingTable& table = getDecodingTable(alphabet);
+		if(!decodeScalar(output + numDecodedBytes, input + numCharactersConsumed, inputSize - numCharactersConsumed, table, hasPadding, numRemainingBytes)) return false;
+
+		numBytesWritten = numDecodedBytes + numRemainingBytes;
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crypto_ffi.hpp" // For the enums (the exports header lacks include guards)
+
+// Base64 (RFC 4648) without line breaks, which is what JSON APIs and the like expect (unlike PEM-style OpenSSL output)
+// Decoding is strict: Only the selected alphabet is accepted, padding must be used consistently, and unused bits must be zero
+namespace crypto_base64 {
+	base64_simd_level_t getSupportedLevel();
+	base64_simd_level_t getActiveLevel();
+	bool setActiveLevel(base64_simd_level_t level);
+
+	size_t getEncodedSize(size_t inputSize, bool hasPadding);
+
+	// Both return false if the output buffer is too small (and decoding also fails if the input isn't valid)
+	bool encode(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, base64_alphabet_t alphabet, bool hasPadding, size_t& numBytesWritten);
+	bool decode(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, base64_alphabet_t alphabet, bool hasPadding, size_t& numBytesWritten);
+}
\ No newline at end of file
@@ -21,6 +21,55 @@ typedef struct kdf_result_t {
 	char* message;
 } kdf_result_t;
 
+typedef enum base64_alphabet_t {
+	BASE64_ALPHABET_STANDARD,
+	BASE64_ALPHABET_URL_SAFE,
+} base64_alphabet_t;
+
+typedef enum base64_simd_level_t {
+	BASE64_SIMD_SCALAR,
+	BASE64_SIMD_SSSE3,
+	BASE64_SIMD_AVX2,
+} base64_simd_level_t;
+
+typedef enum crypto_digest_algorithm_t {
+	CRYPTO_DIGEST_SHA1,
+	CRYPTO_DIGEST_SHA256,
+	CRYPTO_DIGEST_SHA512,
+	CRYPTO_DIGEST_BLAKE2S256,
+	CRYPTO_DIGEST_BLAKE2B512,
+	CRYPTO_DIGEST_NUM_ALGORITHMS,
+} crypto_digest_algorithm_t;
+
+typedef struct crypto_hash_context_t crypto_hash_context_t;
+
+typedef struct crypto_buffer_t {
+	const unsigned char* data;
+	size_t length;
+} crypto_buffer_t;
+
+enum {
+	CRYPTO_AEAD_KEY_SIZE = 32,
+	CRYPTO_AEAD_NONCE_SIZE = 12,
+	CRYPTO_AEAD_TAG_SIZE = 16,
+};
+
+typedef enum crypto_aead_algorithm_t {
+	CRYPTO_AEAD_AES_256_GCM,
+	CRYPTO_AEAD_CHACHA20_POLY1305,
+	CRYPTO_AEAD_NUM_ALGORITHMS,
+} crypto_aead_algorithm_t;
+
+typedef struct crypto_aead_key_t crypto_aead_key_t;
+
+typedef struct crypto_aead_message_t {
+	const unsigned char* nonce;
+	const unsigned char* plaintext;
+	size_t length;
+	unsigned char* ciphertext;
+	unsigned char* tag;
+} crypto_aead_message_t;
+
 struct static_crypto_exports_table {
 	// OpenSSL (libcrypto) metadata
 	const char* (*version_text)(void);
@@ -33,5 +82,34 @@ struct static_crypto_exports_table {
 	size_t (*argon2_from_base64)(unsigned char* dst, size_t dst_len, const char* src);
 	void (*openssl_kdf_derive)(kdf_input_t inputs, kdf_parameters_t parameters, kdf_result_t* result);
 
+	// Asynchronous key derivation (on dedicated worker threads, with completion events being queued on the main thread)
+	bool (*kdf_derive_async)(deferred_event_queue_t queue, const kdf_input_t* inputs, const kdf_parameters_t* parameters, kdf_result_t* result, uint32_t request_id);
+	size_t (*kdf_worker_threads)(void);
+	size_t (*kdf_pending_requests)(void);
+
+	// Base64 codec (RFC 4648)
+	size_t (*base64_encode)(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding);
+	bool (*base64_decode)(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding, size_t* num_bytes_written);
+	base64_simd_level_t (*base64_get_simd_level)(void);
+	bool (*base64_set_simd_level)(base64_simd_level_t level);
+
+	// Streaming digests and HMAC (contexts are reset after finalizing, so they can be reused)
+	crypto_hash_context_t* (*hash_context_new)(crypto_digest_algorithm_t algorithm);
+	crypto_hash_context_t* (*hmac_context_new)(crypto_digest_algorithm_t algorithm, const unsigned char* key, size_t key_len);
+	void (*hash_context_free)(crypto_hash_context_t* context);
+	bool (*hash_context_reset)(crypto_hash_context_t* context);
+	bool (*hash_context_update)(crypto_hash_context_t* context, const unsigned char* src, size_t src_len);
+	size_t (*hash_context_final)(crypto_hash_context_t* context, unsigned char* dst, size_t dst_len);
+	size_t (*hash_get_digest_size)(crypto_digest_algorithm_t algorithm);
+	bool (*hash_buffers)(crypto_digest_algorithm_t algorithm, const crypto_buffer_t* buffers, size_t num_buffers, unsigned char* dst, size_t dst_len);
+
+	// AEAD encryption (keys are expanded once, and the ciphertext is always exactly as long as the plaintext)
+	crypto_aead_key_t* (*aead_key_new)(crypto_aead_algorithm_t algorithm, const unsigned char* key, size_t key_len);
+	void (*aead_key_free)(crypto_aead_key_t* key);
+	bool (*aead_seal)(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, unsigned char* dst, unsigned char* tag);
+	bool (*aead_open)(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, const unsigned char* tag, unsigned char* dst);
+	size_t (*aead_seal_batch)(crypto_aead_key_t* key, const unsigned char* aad, size_t aad_len, const crypto_aead_message_t* messages, size_t num_messages);
+	bool (*random_bytes)(unsigned char* dst, size_t dst_len);
+
 	int (*openssl_crypto_memcmp)(const void* a, const void* b, size_t len);
 };
\ No newline at end of file
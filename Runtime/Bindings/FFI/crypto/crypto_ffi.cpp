@@ -1,16 +1,17 @@
 #include "crypto_ffi.hpp"
+#include "crypto_aead.hpp"
 #include "crypto_argon2.hpp"
+#include "crypto_async.hpp"
+#include "crypto_base64.hpp"
+#include "crypto_hash.hpp"
+#include "crypto_kdf.hpp"
 
-#include <openssl/core_names.h>
 #include <openssl/crypto.h>
-#include <openssl/err.h>
 #include <openssl/evp.h>
-#include <openssl/kdf.h>
-#include <openssl/params.h>
-#include <openssl/thread.h>
+#include <openssl/rand.h>
 
+#include <climits>
 #include <cstddef>
-#include <iostream>
 
 size_t openssl_to_base64(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len) {
 	EVP_ENCODE_CTX* ctx = EVP_ENCODE_CTX_new();
@@ -50,61 +51,147 @@ size_t openssl_from_base64(unsigned char* dst, size_t dst_len, const unsigned ch
 	return out_len;
 }
 
-// Must match the number of parameters passed via kdf_parameters_t (plus end tag)
-constexpr size_t NUM_SUPPORTED_KDF_PARAMS = 7 + 1;
+size_t base64_encode(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding) {
+	if(!dst || (!src && src_len > 0)) return 0;
+	if(alphabet != BASE64_ALPHABET_STANDARD && alphabet != BASE64_ALPHABET_URL_SAFE) return 0;
+
+	size_t num_bytes_written = 0;
+	if(!crypto_base64::encode(dst, dst_len, src, src_len, alphabet, padding, num_bytes_written)) return 0;
+	return num_bytes_written;
+}
+
+bool base64_decode(unsigned char* dst, size_t dst_len, const unsigned char* src, size_t src_len, base64_alphabet_t alphabet, bool padding, size_t* num_bytes_written) {
+	if(!dst || !num_bytes_written || (!src && src_len > 0)) return false;
+	if(alphabet != BASE64_ALPHABET_STANDARD && alphabet != BASE64_ALPHABET_URL_SAFE) return false;
+
+	return crypto_base64::decode(dst, dst_len, src, src_len, alphabet, padding, *num_bytes_written);
+}
+
+base64_simd_level_t base64_get_simd_level() {
+	return crypto_base64::getActiveLevel();
+}
+
+bool base64_set_simd_level(base64_simd_level_t level) {
+	return crypto_base64::setActiveLevel(level);
+}
+
+crypto_hash_context_t* hash_context_new(crypto_digest_algorithm_t algorithm) {
+	return crypto_hash::createDigestContext(algorithm);
+}
+
+crypto_hash_context_t* hmac_context_new(crypto_digest_algorithm_t algorithm, const unsigned char* key, size_t key_len) {
+	if(!key && key_len > 0) return nullptr;
+
+	return crypto_hash::createMacContext(algorithm, key, key_len);
+}
+
+void hash_context_free(crypto_hash_context_t* context) {
+	if(!context) return;
+
+	crypto_hash::destroyContext(context);
+}
+
+bool hash_context_reset(crypto_hash_context_t* context) {
+	if(!context) return false;
+
+	return crypto_hash::resetContext(context);
+}
+
+bool hash_context_update(crypto_hash_context_t* context, const unsigned char* src, size_t src_len) {
+	if(!context) return false;
+	if(!src && src_len > 0) return false;
+
+	return crypto_hash::updateContext(context, src, src_len);
+}
+
+size_t hash_context_final(crypto_hash_context_t* context, unsigned char* dst, size_t dst_len) {
+	if(!context || !dst) return 0;
+
+	return crypto_hash::finalizeContext(context, dst, dst_len);
+}
+
+size_t hash_get_digest_size(crypto_digest_algorithm_t algorithm) {
+	return crypto_hash::getDigestSize(algorithm);
+}
+
+bool hash_buffers(crypto_digest_algorithm_t algorithm, const crypto_buffer_t* buffers, size_t num_buffers, unsigned char* dst, size_t dst_len) {
+	if(num_buffers == 0) return true;
+	if(!buffers || !dst) return false;
+
+	return crypto_hash::hashBuffers(algorithm, buffers, num_buffers, dst, dst_len);
+}
 
 void openssl_kdf_derive(kdf_input_t inputs, kdf_parameters_t parameters, kdf_result_t* result) {
-	result->success = false;
+	crypto_kdf::deriveKey(inputs, parameters, result);
+}
 
-	EVP_KDF* kdf = nullptr;
-	EVP_KDF_CTX* kctx = nullptr;
-	OSSL_PARAM params[NUM_SUPPORTED_KDF_PARAMS], *p = params;
+bool kdf_derive_async(deferred_event_queue_t queue, const kdf_input_t* inputs, const kdf_parameters_t* parameters, kdf_result_t* result, uint32_t request_id) {
+	if(!queue || !inputs || !parameters || !result) return false;
+	if(!result->hash || !result->message) return false;
 
-	if(OSSL_set_max_threads(nullptr, parameters.threads) != 1) {
-		std::cerr << "Failed to set_max_threads" << std::endl;
-		goto fail;
-	}
+	return crypto_async::submitDerivation(queue, *inputs, *parameters, result, request_id);
+}
 
-	p = params;
-	*p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_PASSWORD, const_cast<char*>(inputs.password), inputs.pw_length);
-	*p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, const_cast<char*>(inputs.salt), inputs.salt_length);
-	*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_VERSION, &parameters.version);
-	*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ITER, &parameters.iterations);
-	*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_THREADS, &parameters.threads);
-	*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_LANES, &parameters.lanes);
-	*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_MEMCOST, &parameters.kilobytes);
-	*p++ = OSSL_PARAM_construct_end();
-
-	if((kdf = EVP_KDF_fetch(nullptr, parameters.kdf, nullptr)) == nullptr) {
-		std::cerr << "Failed to fetch KDF " << parameters.kdf << std::endl;
-		goto fail;
-	}
+size_t kdf_worker_threads() {
+	return crypto_async::getNumWorkerThreads();
+}
 
-	if((kctx = EVP_KDF_CTX_new(kdf)) == nullptr) {
-		std::cerr << "Failed to create hashing context" << std::endl;
-		goto fail;
-	}
+size_t kdf_pending_requests() {
+	return crypto_async::getNumPendingRequests();
+}
 
-	if(EVP_KDF_derive(kctx, &result->hash[0], parameters.size, params) != 1) {
-		std::cerr << "Failed to derive key" << std::endl;
-		goto fail;
-	}
+crypto_aead_key_t* aead_key_new(crypto_aead_algorithm_t algorithm, const unsigned char* key, size_t key_len) {
+	if(!key) return nullptr;
+
+	return crypto_aead::createKey(algorithm, key, key_len);
+}
+
+void aead_key_free(crypto_aead_key_t* key) {
+	if(!key) return;
 
-	result->success = true;
-	return;
+	crypto_aead::destroyKey(key);
+}
+
+bool aead_seal(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, unsigned char* dst, unsigned char* tag) {
+	if(!key || !nonce || !dst || !tag) return false;
+	if(!aad && aad_len > 0) return false;
+	if(!src && src_len > 0) return false;
+
+	return crypto_aead::seal(*key, nonce, aad, aad_len, src, src_len, dst, tag);
+}
+
+bool aead_open(crypto_aead_key_t* key, const unsigned char* nonce, const unsigned char* aad, size_t aad_len, const unsigned char* src, size_t src_len, const unsigned char* tag, unsigned char* dst) {
+	if(!key || !nonce || !tag || !dst) return false;
+	if(!aad && aad_len > 0) return false;
+	if(!src && src_len > 0) return false;
+
+	return crypto_aead::open(*key, nonce, aad, aad_len, src, src_len, tag, dst);
+}
 
-fail:
-	unsigned long error_code = ERR_get_error();
-	ERR_error_string(error_code, result->message);
-	std::cerr << "OpenSSL Error: " << result->message << std::endl;
+size_t aead_seal_batch(crypto_aead_key_t* key, const unsigned char* aad, size_t aad_len, const crypto_aead_message_t* messages, size_t num_messages) {
+	if(!key || !messages) return 0;
+	if(!aad && aad_len > 0) return 0;
 
-	EVP_KDF_free(kdf);
-	EVP_KDF_CTX_free(kctx);
-	OSSL_set_max_threads(nullptr, 0);
+	return crypto_aead::sealMessages(*key, aad, aad_len, messages, num_messages);
+}
+
+bool random_bytes(unsigned char* dst, size_t dst_len) {
+	if(!dst) return false;
+	if(dst_len > INT_MAX) return false;
+
+	return RAND_bytes(dst, static_cast<int>(dst_len)) == 1;
 }
 
 namespace crypto_ffi {
 
+	void assignEventLoop(uv_loop_t* loop) {
+		crypto_async::assignEventLoop(loop);
+	}
+
+	void unassignEventLoop() {
+		crypto_async::unassignEventLoop();
+	}
+
 	void* getExportsTable() {
 		static struct static_crypto_exports_table exports = {
 			.version_text = &getVersionText,
@@ -115,6 +202,27 @@ namespace crypto_ffi {
 			.argon2_to_base64 = &argon2_to_base64,
 			.argon2_from_base64 = &argon2_from_base64,
 			.openssl_kdf_derive = &openssl_kdf_derive,
+			.kdf_derive_async = &kdf_derive_async,
+			.kdf_worker_threads = &kdf_worker_threads,
+			.kdf_pending_requests = &kdf_pending_requests,
+			.base64_encode = &base64_encode,
+			.base64_decode = &base64_decode,
+			.base64_get_simd_level = &base64_get_simd_level,
+			.base64_set_simd_level = &base64_set_simd_level,
+			.hash_context_new = &hash_context_new,
+			.hmac_context_new = &hmac_context_new,
+			.hash_context_free = &hash_context_free,
+			.hash_context_reset = &hash_context_reset,
+			.hash_context_update = &hash_context_update,
+			.hash_context_final = &hash_context_final,
+			.hash_get_digest_size = &hash_get_digest_size,
+			.hash_buffers = &hash_buffers,
+			.aead_key_new = &aead_key_new,
+			.aead_key_free = &aead_key_free,
+			.aead_seal = &aead_seal,
+			.aead_open = &aead_open,
+			.aead_seal_batch = &aead_seal_batch,
+			.random_bytes = &random_bytes,
 			.openssl_crypto_memcmp = &CRYPTO_memcmp,
 		};
 
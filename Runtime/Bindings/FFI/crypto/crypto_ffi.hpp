@@ -3,10 +3,17 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "interop_ffi.hpp"
 #include "crypto_exports.h"
 
+extern "C" {
+#include "uv.h"
+}
+
 namespace crypto_ffi {
 
+	void assignEventLoop(uv_loop_t* loop);
+	void unassignEventLoop();
 	void* getExportsTable();
 	const char* getVersionText();
 	long int getVersionNumber();
@@ -0,0 +1,148 @@
+#include "crypto_hash.hpp"
+
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+
+#include <memory>
+
+namespace crypto_hash {
+
+	// Must match the order of crypto_digest_algorithm_t
+	constexpr const char* DIGEST_NAMES[CRYPTO_DIGEST_NUM_ALGORITHMS] = {
+		"SHA1",
+		"SHA2-256",
+		"SHA2-512",
+		"BLAKE2S-256",
+		"BLAKE2B-512",
+	};
+
+	// Fetched on first use and kept alive until exit (initialization of function-local statics is thread-safe)
+	struct FetchedAlgorithms {
+		EVP_MD* digests[CRYPTO_DIGEST_NUM_ALGORITHMS] = {};
+		EVP_MAC* hmac = nullptr;
+
+		FetchedAlgorithms() {
+			for(size_t index = 0; index < CRYPTO_DIGEST_NUM_ALGORITHMS; index++)
+				digests[index] = EVP_MD_fetch(nullptr, DIGEST_NAMES[index], nullptr);
+			hmac = EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr);
+		}
+
+		~FetchedAlgorithms() {
+			for(EVP_MD* digest : digests)
+				EVP_MD_free(digest);
+			EVP_MAC_free(hmac);
+		}
+	};
+
+	static const FetchedAlgorithms& getFetchedAlgorithms() {
+		static const FetchedAlgorithms algorithms;
+		return algorithms;
+	}
+
+	static const EVP_MD* getDigest(crypto_digest_algorithm_t algorithm) {
+		return getFetchedAlgorithms().digests[algorithm];
+	}
+
+	bool isValidAlgorithm(crypto_digest_algorithm_t algorithm) {
+		if(algorithm < CRYPTO_DIGEST_SHA1 || algorithm >= CRYPTO_DIGEST_NUM_ALGORITHMS) return false;
+		return getDigest(algorithm) != nullptr;
+	}
+
+	size_t getDigestSize(crypto_digest_algorithm_t algorithm) {
+		if(!isValidAlgorithm(algorithm)) return 0;
+		return static_cast<size_t>(EVP_MD_get_size(getDigest(algorithm)));
+	}
+
+	crypto_hash_context_t* createDigestContext(crypto_digest_algorithm_t algorithm) {
+		if(!isValidAlgorithm(algorithm)) return nullptr;
+
+		EVP_MD_CTX* digestContext = EVP_MD_CTX_new();
+		if(!digestContext) return nullptr;
+
+		if(EVP_DigestInit_ex2(digestContext, getDigest(algorithm), nullptr) != 1) {
+			EVP_MD_CTX_free(digestContext);
+			return nullptr;
+		}
+
+		return new crypto_hash_context_t { algorithm, digestContext, nullptr };
+	}
+
+	crypto_hash_context_t* createMacContext(crypto_digest_algorithm_t algorithm, const unsigned char* key, size_t keySize) {
+		if(!isValidAlgorithm(algorithm)) return nullptr;
+
+		EVP_MAC* hmac = getFetchedAlgorithms().hmac;
+		if(!hmac) return nullptr;
+
+		EVP_MAC_CTX* macContext = EVP_MAC_CTX_new(hmac);
+		if(!macContext) return nullptr;
+
+		OSSL_PARAM params[] = {
+			OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>(DIGEST_NAMES[algorithm]), 0),
+			OSSL_PARAM_construct_end(),
+		};
+
+		// Passing no key would mean "reuse the previous one", so empty keys still need a valid pointer
+		static const unsigned char EMPTY_KEY = 0;
+		if(EVP_MAC_init(macContext, key ? key : &EMPTY_KEY, key ? keySize : 0, params) != 1) {
+			EVP_MAC_CTX_free(macContext);
+			return nullptr;
+		}
+
+		return new crypto_hash_context_t { algorithm, nullptr, macContext };
+	}
+
+	void destroyContext(crypto_hash_context_t* context) {
+		EVP_MD_CTX_free(context->digestContext);
+		EVP_MAC_CTX_free(context->macContext);
+		delete context;
+	}
+
+	bool resetContext(crypto_hash_context_t* context) {
+		if(context->macContext) return EVP_MAC_init(context->macContext, nullptr, 0, nullptr) == 1;
+		return EVP_DigestInit_ex2(context->digestContext, getDigest(context->algorithm), nullptr) == 1;
+	}
+
+	bool updateContext(crypto_hash_context_t* context, const unsigned char* input, size_t inputSize) {
+		if(context->macContext) return EVP_MAC_update(context->macContext, input, inputSize) == 1;
+		return EVP_DigestUpdate(context->digestContext, input, inputSize) == 1;
+	}
+
+	size_t finalizeContext(crypto_hash_context_t* context, unsigned char* output, size_t outputSize) {
+		size_t digestSize = getDigestSize(context->algorithm);
+		if(outputSize < digestSize) return 0;
+
+		if(context->macContext) {
+			size_t numBytesWritten = 0;
+			if(EVP_MAC_final(context->macContext, output, &numBytesWritten, outputSize) != 1) return 0;
+		} else {
+			if(EVP_DigestFinal_ex(context->digestContext, output, nullptr) != 1) return 0;
+		}
+
+		if(!resetContext(context)) return 0;
+		return digestSize;
+	}
+
+	bool hashBuffers(crypto_digest_algorithm_t algorithm, const crypto_buffer_t* buffers, size_t numBuffers, unsigned char* output, size_t outputSize) {
+		size_t digestSize = getDigestSize(algorithm);
+		if(digestSize == 0 || outputSize / digestSize < numBuffers) return false;
+
+		// One pair of contexts per thread is enough, since each buffer is hashed from start to finish before moving on
+		using ContextPointer = std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>;
+		thread_local ContextPointer initialContext(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+		thread_local ContextPointer batchContext(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+		if(!initialContext || !batchContext) return false;
+
+		// Copying the initial state is cheaper than going through the provider to initialize the context for every buffer
+		if(EVP_DigestInit_ex2(initialContext.get(), getDigest(algorithm), nullptr) != 1) return false;
+		for(size_t index = 0; index < numBuffers; index++) {
+			if(!buffers[index].data && buffers[index].length > 0) return false;
+
+			if(EVP_MD_CTX_copy_ex(batchContext.get(), initialContext.get()) != 1) return false;
+			if(EVP_DigestUpdate(batchContext.get(), buffers[index].data, buffers[index].length) != 1) return false;
+			if(EVP_DigestFinal_ex(batchContext.get(), output + index * digestSize, nullptr) != 1) return false;
+		}
+
+		return true;
+	}
+
+}
\ No newline at end of file
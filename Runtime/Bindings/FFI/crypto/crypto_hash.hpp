@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+#include <openssl/evp.h>
+
+#include "crypto_ffi.hpp" // For the context types (the exports header lacks include guards)
+
+// Exactly one of the two OpenSSL contexts is used, depending on whether the context was created with a key
+struct crypto_hash_context_t {
+	crypto_digest_algorithm_t algorithm;
+	EVP_MD_CTX* digestContext;
+	EVP_MAC_CTX* macContext;
+};
+
+// Contexts can be reused (and the algorithms are only fetched once), so that hashing many inputs doesn't allocate every time
+// This also avoids going through the implicit fetches of the legacy APIs, which look up the provider on every call
+namespace crypto_hash {
+	bool isValidAlgorithm(crypto_digest_algorithm_t algorithm);
+	size_t getDigestSize(crypto_digest_algorithm_t algorithm);
+
+	crypto_hash_context_t* createDigestContext(crypto_digest_algorithm_t algorithm);
+	crypto_hash_context_t* createMacContext(crypto_digest_algorithm_t algorithm, const unsigned char* key, size_t keySize);
+	void destroyContext(crypto_hash_context_t* context);
+
+	bool resetContext(crypto_hash_context_t* context);
+	bool updateContext(crypto_hash_context_t* context, const unsigned char* input, size_t inputSize);
+	size_t finalizeContext(crypto_hash_context_t* context, unsigned char* output, size_t outputSize);
+
+	// Digests are stored back to back, so the output must fit one digest per buffer
+	bool hashBuffers(crypto_digest_algorithm_t algorithm, const crypto_buffer_t* buffers, size_t numBuffers, unsigned char* output, size_t outputSize);
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "crypto_kdf.hpp"
+
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/params.h>
+#include <openssl/thread.h>
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace crypto_kdf {
+
+	// Must be large enough for the parameters of any supported algorithm (plus end tag)
+	constexpr size_t MAX_NUM_KDF_PARAMS = 7 + 1;
+
+	// With r = 8, every increment of N adds 1 KB of memory (which is the unit that the parameters use)
+	constexpr uint32_t SCRYPT_BLOCK_SIZE = 8;
+
+	// OpenSSL still defaults to SHA-1, which is no longer recommended for new applications
+	constexpr const char* PBKDF2_DIGEST_NAME = "SHA2-256";
+
+	struct CachedAlgorithm {
+		EVP_KDF* kdf = nullptr;
+		EVP_KDF_CTX* context = nullptr;
+	};
+
+	// Algorithms are fetched from the default library context, so that the configuration file and its providers are respected
+	struct ThreadCache {
+		std::unordered_map<std::string, CachedAlgorithm> algorithms;
+
+		~ThreadCache() {
+			for(auto& [name, algorithm] : algorithms) {
+				EVP_KDF_CTX_free(algorithm.context);
+				EVP_KDF_free(algorithm.kdf);
+			}
+		}
+
+		CachedAlgorithm* getAlgorithm(const char* name) {
+			auto existingEntry = algorithms.find(name);
+			if(existingEntry != algorithms.end()) return &existingEntry->second;
+
+			CachedAlgorithm algorithm;
+			algorithm.kdf = EVP_KDF_fetch(nullptr, name, nullptr);
+			if(!algorithm.kdf) return nullptr;
+
+			algorithm.context = EVP_KDF_CTX_new(algorithm.kdf);
+			if(!algorithm.context) {
+				EVP_KDF_free(algorithm.kdf);
+				return nullptr;
+			}
+
+			return &algorithms.emplace(name, algorithm).first->second;
+		}
+	};
+
+	static std::mutex maxThreadsMutex;
+	static uint64_t maxThreads = 0;
+
+	// The limit applies to the whole (default) library context, so it's only ever raised (lowering it could break derivations on other threads)
+	static bool ensureMaxThreads(uint64_t numThreads) {
+		std::lock_guard<std::mutex> lock(maxThreadsMutex);
+		if(numThreads <= maxThreads) return true;
+
+		if(OSSL_set_max_threads(nullptr, numThreads) != 1) return false;
+		maxThreads = numThreads;
+		return true;
+	}
+
+	void deriveKey(const kdf_input_t& inputs, kdf_parameters_t parameters, kdf_result_t* result) {
+		result->success = false;
+
+		thread_local ThreadCache cache;
+		CachedAlgorithm* algorithm = nullptr;
+		OSSL_PARAM params[MAX_NUM_KDF_PARAMS], *p = params;
+		uint32_t scryptBlockSize = SCRYPT_BLOCK_SIZE;
+
+		if(!ensureMaxThreads(parameters.threads)) {
+			std::cerr << "Failed to set_max_threads" << std::endl;
+			goto fail;
+		}
+
+		if((algorithm = cache.getAlgorithm(parameters.kdf)) == nullptr) {
+			std::cerr << "Failed to fetch KDF " << parameters.kdf << std::endl;
+			goto fail;
+		}
+
+		*p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_PASSWORD, const_cast<char*>(inputs.password), inputs.pw_length);
+		*p++ = OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT, const_cast<char*>(inputs.salt), inputs.salt_length);
+		if(EVP_KDF_is_a(algorithm->kdf, "PBKDF2")) {
+			*p++ = OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char*>(PBKDF2_DIGEST_NAME), 0);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ITER, &parameters.iterations);
+		} else if(EVP_KDF_is_a(algorithm->kdf, "SCRYPT")) {
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_SCRYPT_N, &parameters.kilobytes);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_SCRYPT_R, &scryptBlockSize);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_SCRYPT_P, &parameters.lanes);
+		} else {
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_VERSION, &parameters.version);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ITER, &parameters.iterations);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_THREADS, &parameters.threads);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_LANES, &parameters.lanes);
+			*p++ = OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_MEMCOST, &parameters.kilobytes);
+		}
+		*p++ = OSSL_PARAM_construct_end();
+
+		if(EVP_KDF_derive(algorithm->context, &result->hash[0], parameters.size, params) != 1) {
+			std::cerr << "Failed to derive key" << std::endl;
+			goto fail;
+		}
+
+		// Also wipes the password, which would otherwise linger in the cached context until the next derivation
+		EVP_KDF_CTX_reset(algorithm->context);
+		result->success = true;
+		return;
+
+	fail:
+		unsigned long error_code = ERR_get_error();
+		ERR_error_string(error_code, result->message);
+		std::cerr << "OpenSSL Error: " << result->message << std::endl;
+
+		if(algorithm) EVP_KDF_CTX_reset(algorithm->context);
+	}
+
+}
\ No newline at end of file
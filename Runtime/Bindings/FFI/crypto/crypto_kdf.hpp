@@ -0,0 +1,10 @@
+#pragma once
+
+#include "crypto_ffi.hpp" // For the KDF types (the exports header lacks include guards)
+
+// Fetching the algorithm and creating a context can cost more than the derivation itself (e.g., for PBKDF2 or small scrypt keys)
+// So both are cached per thread and algorithm, and contexts are reset after each use (which also wipes the password)
+namespace crypto_kdf {
+	// Parameters that don't apply to the selected algorithm are ignored (for scrypt, N is the memory cost and p the number of lanes)
+	void deriveKey(const kdf_input_t& inputs, kdf_parameters_t parameters, kdf_result_t* result);
+}
\ No newline at end of file
@@ -1,12 +1,16 @@
 local ffi = require("ffi")
 local validation = require("validation")
 
+local validateFunction = validation.validateFunction
 local validateString = validation.validateString
 
+local ffi_gc = ffi.gc
+local ffi_new = ffi.new
 local tonumber = tonumber
 local tostring = tostring
 
 local UTF_MAX_BYTES_PER_CODEPOINT = 4
+local MIN_STREAM_WRITEBUFFER_SIZE = 64 -- Room for the escape sequences of stateful encodings, even for tiny chunks
 
 local iconv = {}
 
@@ -24,6 +28,10 @@ typedef enum iconv_result_t {
 	ICONV_RESULT_LAST,
 } iconv_result_t;
 
+enum {
+	ICONV_MAX_CACHED_DESCRIPTORS = 8, // Per thread (the least recently used descriptor is closed once the limit is reached)
+};
+
 typedef char* iconv_cursor_t;
 typedef const char* iconv_encoding_t; // Aliased for now, replace with enum later
 
@@ -40,6 +48,8 @@ typedef struct iconv_request_t {
 	iconv_t handle;
 } iconv_request_t;
 
+typedef struct iconv_stream_t iconv_stream_t;
+
 struct static_iconv_exports_table {
 
 	// Exports from iconv.h
@@ -51,15 +61,110 @@ struct static_iconv_exports_table {
 	iconv_result_t (*iconv_convert)(iconv_request_t* conversion_details);
 	iconv_result_t (*iconv_try_close)(iconv_request_t* request);
 
+	// Streaming API (the charsets of the memory fields are ignored, since they're set when the stream is created)
+	iconv_stream_t* (*iconv_stream_new)(const char* input_encoding, const char* output_encoding);
+	void (*iconv_stream_free)(iconv_stream_t* stream);
+	iconv_result_t (*iconv_stream_convert)(iconv_stream_t* stream, iconv_memory_t* input, iconv_memory_t* output);
+	iconv_result_t (*iconv_stream_finish)(iconv_stream_t* stream, iconv_memory_t* output);
+	void (*iconv_stream_reset)(iconv_stream_t* stream);
+	size_t (*iconv_stream_pending)(const iconv_stream_t* stream);
+
 	// Utility methods
 	const char* (*iconv_strerror)(iconv_result_t status);
 	bool (*iconv_check_result)(iconv_t handle);
+	size_t (*iconv_cached_descriptors)(void);
+	void (*iconv_set_fast_paths)(bool enabled); // UTF-8 validation, and conversions between UTF-8 and Latin-1 or UTF-16LE
 };
 
 ]]
 
 function iconv.initialize()
 	ffi.cdef(iconv.cdefs)
+
+	local inputMemory, outputMemory, chunkBuffer, preallocatedStreamBuffer
+
+	-- Grows the output buffer until everything fits, so that ICONV_WRITEBUFFER_FULL never reaches the caller
+	local function convertIntoBuffer(stream, outputBuffer, minRequiredWriteBufferSize, convert)
+		local result
+		repeat
+			local writeCursor, writeBufferCapacity = outputBuffer:reserve(minRequiredWriteBufferSize)
+			outputMemory.buffer = writeCursor
+			outputMemory.length = writeBufferCapacity
+			outputMemory.remaining = writeBufferCapacity
+
+			result = convert(stream, inputMemory, outputMemory)
+			outputBuffer:commit(tonumber(outputMemory.length - outputMemory.remaining))
+			minRequiredWriteBufferSize = minRequiredWriteBufferSize * 2
+		until result ~= ffi.C.ICONV_WRITEBUFFER_FULL
+
+		return result
+	end
+
+	local function finishStream(stream, _, output)
+		return iconv.bindings.iconv_stream_finish(stream, output)
+	end
+
+	local streamingConverter = {}
+
+	-- Appends to the given buffer (if any) and returns it, otherwise the converted chunk is returned as a string
+	function streamingConverter:write(chunk, outputBuffer)
+		validateString(chunk, "chunk")
+		if #chunk == 0 then
+			return outputBuffer or "", iconv.strerror(ffi.C.ICONV_RESULT_OK)
+		end
+
+		inputMemory = inputMemory or ffi_new("iconv_memory_t")
+		outputMemory = outputMemory or ffi_new("iconv_memory_t")
+		chunkBuffer = chunkBuffer or buffer.new()
+		preallocatedStreamBuffer = preallocatedStreamBuffer or buffer.new(256)
+
+		-- Converting straight from the string avoids copying large chunks
+		chunkBuffer:set(chunk)
+		inputMemory.buffer = chunkBuffer:ref()
+		inputMemory.length = #chunk
+		inputMemory.remaining = #chunk
+
+		local writeBuffer = outputBuffer or preallocatedStreamBuffer:reset()
+		local minRequiredWriteBufferSize = math.max(MIN_STREAM_WRITEBUFFER_SIZE, #chunk * UTF_MAX_BYTES_PER_CODEPOINT)
+		local convert = iconv.bindings.iconv_stream_convert
+		local result = convertIntoBuffer(self, writeBuffer, minRequiredWriteBufferSize, convert)
+		chunkBuffer:reset()
+
+		if result ~= ffi.C.ICONV_RESULT_OK then
+			return nil, iconv.strerror(result)
+		end
+
+		return outputBuffer or tostring(preallocatedStreamBuffer), iconv.strerror(result)
+	end
+
+	-- Must be called after the last chunk to detect truncated input (the converter can be reused afterwards)
+	function streamingConverter:finish(outputBuffer)
+		outputMemory = outputMemory or ffi_new("iconv_memory_t")
+		preallocatedStreamBuffer = preallocatedStreamBuffer or buffer.new(256)
+
+		local writeBuffer = outputBuffer or preallocatedStreamBuffer:reset()
+		local result = convertIntoBuffer(self, writeBuffer, MIN_STREAM_WRITEBUFFER_SIZE, finishStream)
+
+		if result ~= ffi.C.ICONV_RESULT_OK then
+			return nil, iconv.strerror(result)
+		end
+
+		return outputBuffer or tostring(preallocatedStreamBuffer), iconv.strerror(result)
+	end
+
+	function streamingConverter:reset()
+		iconv.bindings.iconv_stream_reset(self)
+	end
+
+	function streamingConverter:getNumPendingBytes()
+		return tonumber(iconv.bindings.iconv_stream_pending(self))
+	end
+
+	streamingConverter.__index = streamingConverter
+
+	iconv.metatypes = {
+		streamingConverter = ffi.metatype("struct iconv_stream_t", streamingConverter),
+	}
 end
 
 local request, readBuffer, writeBuffer
@@ -102,6 +207,46 @@ function iconv.convert(input, inputEncoding, outputEncoding)
 	return tostring(writeBuffer), iconv.strerror(result)
 end
 
+-- Partial multibyte sequences at the end of a chunk are kept and completed by the next one
+function iconv.createStreamingConverter(inputEncoding, outputEncoding)
+	validateString(inputEncoding, "inputEncoding")
+	validateString(outputEncoding, "outputEncoding")
+
+	local stream = iconv.bindings.iconv_stream_new(inputEncoding, outputEncoding)
+	if stream == nil then
+		error(format("Unsupported conversion from %s to %s", inputEncoding, outputEncoding), 0)
+	end
+
+	return ffi_gc(stream, iconv.bindings.iconv_stream_free)
+end
+
+-- Returns a FILE_CHUNK_AVAILABLE listener that converts the chunks of the given file as AsyncFileReader loads them
+-- The callback receives the same values as iconv.convert, with the event payload appended; other files are ignored
+function iconv.createFileChunkListener(fileSystemPath, converter, onChunkConverted)
+	validateString(fileSystemPath, "fileSystemPath")
+	validateFunction(onChunkConverted, "onChunkConverted")
+
+	local outputBuffer = buffer.new()
+	return function(event, payload)
+		if payload.fileSystemPath ~= fileSystemPath then
+			return
+		end
+
+		outputBuffer:reset()
+		local output, message = converter:write(payload.chunk, outputBuffer)
+		if output and payload.chunkIndex == payload.lastChunkIndex then
+			output, message = converter:finish(outputBuffer)
+		end
+
+		if not output then
+			converter:reset()
+			return onChunkConverted(nil, message, payload)
+		end
+
+		onChunkConverted(tostring(outputBuffer), message, payload)
+	end
+end
+
 function iconv.strerror(result)
 	return ffi.string(iconv.bindings.iconv_strerror(result))
 end
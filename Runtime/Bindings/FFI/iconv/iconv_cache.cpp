@@ -0,0 +1,83 @@
+#include "iconv_cache.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+
+namespace iconv_cache {
+
+	struct CachedDescriptor {
+		std::string fromCharset;
+		std::string toCharset;
+		iconv_t handle = nullptr;
+		uint64_t lastUsed = 0;
+	};
+
+	// Most applications only ever convert between a handful of charsets, so a linear search is fine here
+	struct ThreadCache {
+		CachedDescriptor entries[ICONV_MAX_CACHED_DESCRIPTORS];
+		size_t numEntries = 0;
+		uint64_t numLookups = 0;
+
+		~ThreadCache() {
+			for(size_t index = 0; index < numEntries; index++)
+				iconv_close(entries[index].handle);
+		}
+
+		CachedDescriptor* find(const char* fromCharset, const char* toCharset) {
+			for(size_t index = 0; index < numEntries; index++) {
+				CachedDescriptor& entry = entries[index];
+				if(entry.fromCharset == fromCharset && entry.toCharset == toCharset) return &entry;
+			}
+			return nullptr;
+		}
+
+		// Evicts the least recently used descriptor once the cache is full
+		CachedDescriptor& reserve() {
+			if(numEntries < ICONV_MAX_CACHED_DESCRIPTORS) return entries[numEntries++];
+
+			CachedDescriptor* leastRecentlyUsed = &entries[0];
+			for(CachedDescriptor& entry : entries) {
+				if(entry.lastUsed < leastRecentlyUsed->lastUsed) leastRecentlyUsed = &entry;
+			}
+			iconv_close(leastRecentlyUsed->handle);
+
+			return *leastRecentlyUsed;
+		}
+	};
+
+	static thread_local ThreadCache cache;
+
+	iconv_t acquireDescriptor(const char* fromCharset, const char* toCharset) {
+		const iconv_t INVALID_DESCRIPTOR = reinterpret_cast<iconv_t>(-1);
+		if(!fromCharset || !toCharset) {
+			errno = EINVAL; // Same as what iconv_open reports for unsupported charsets
+			return INVALID_DESCRIPTOR;
+		}
+
+		CachedDescriptor* entry = cache.find(fromCharset, toCharset);
+		if(entry) {
+			// Discards any shift state that a previous (possibly failed) conversion may have left behind
+			iconv(entry->handle, nullptr, nullptr, nullptr, nullptr);
+			entry->lastUsed = ++cache.numLookups;
+			return entry->handle;
+		}
+
+		// Unsupported conversions aren't cached, so that the caller can inspect errno every time
+		iconv_t handle = iconv_open(toCharset, fromCharset);
+		if(handle == INVALID_DESCRIPTOR) return handle;
+
+		CachedDescriptor& newEntry = cache.reserve();
+		newEntry.fromCharset = fromCharset;
+		newEntry.toCharset = toCharset;
+		newEntry.handle = handle;
+		newEntry.lastUsed = ++cache.numLookups;
+
+		return handle;
+	}
+
+	size_t getNumCachedDescriptors() {
+		return cache.numEntries;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+#include "iconv_ffi.hpp" // For the iconv types (the exports header lacks include guards)
+
+// Opening a descriptor can cost more than converting a short string, so they're kept around after use
+// The cache is per thread since descriptors carry conversion state (and iconv_convert also runs on the thread pool)
+namespace iconv_cache {
+	// Returns an invalid descriptor (with errno set by iconv_open) if the conversion isn't supported
+	// Otherwise, the descriptor is reset to its initial state and remains owned by the cache (don't close it)
+	iconv_t acquireDescriptor(const char* fromCharset, const char* toCharset);
+	size_t getNumCachedDescriptors();
+}
\ No newline at end of file
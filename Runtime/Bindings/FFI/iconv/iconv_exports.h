@@ -10,6 +10,10 @@ typedef enum iconv_result_t {
 	ICONV_RESULT_LAST,
 } iconv_result_t;
 
+enum {
+	ICONV_MAX_CACHED_DESCRIPTORS = 8, // Per thread (the least recently used descriptor is closed once the limit is reached)
+};
+
 typedef char* iconv_cursor_t;
 typedef const char* iconv_encoding_t; // Aliased for now, replace with enum later
 
@@ -26,6 +30,8 @@ typedef struct iconv_request_t {
 	iconv_t handle;
 } iconv_request_t;
 
+typedef struct iconv_stream_t iconv_stream_t;
+
 struct static_iconv_exports_table {
 
 	// Exports from iconv.h
@@ -37,7 +43,17 @@ struct static_iconv_exports_table {
 	iconv_result_t (*iconv_convert)(iconv_request_t* conversion_details);
 	iconv_result_t (*iconv_try_close)(iconv_request_t* request);
 
+	// Streaming API (the charsets of the memory fields are ignored, since they're set when the stream is created)
+	iconv_stream_t* (*iconv_stream_new)(const char* input_encoding, const char* output_encoding);
+	void (*iconv_stream_free)(iconv_stream_t* stream);
+	iconv_result_t (*iconv_stream_convert)(iconv_stream_t* stream, iconv_memory_t* input, iconv_memory_t* output);
+	iconv_result_t (*iconv_stream_finish)(iconv_stream_t* stream, iconv_memory_t* output);
+	void (*iconv_stream_reset)(iconv_stream_t* stream);
+	size_t (*iconv_stream_pending)(const iconv_stream_t* stream);
+
 	// Utility methods
 	const char* (*iconv_strerror)(iconv_result_t status);
 	bool (*iconv_check_result)(iconv_t handle);
+	size_t (*iconv_cached_descriptors)(void);
+	void (*iconv_set_fast_paths)(bool enabled); // UTF-8 validation, and conversions between UTF-8 and Latin-1 or UTF-16LE
 };
\ No newline at end of file
@@ -1,4 +1,7 @@
+#include "iconv_cache.hpp"
 #include "iconv_ffi.hpp"
+#include "iconv_stream.hpp"
+#include "iconv_transcode.hpp"
 #include "macros.hpp"
 
 #include <iostream>
@@ -18,7 +21,7 @@ namespace iconv_ffi {
 	inline bool sanity_check_buffer(const iconv_memory_t* workload) {
 		if(workload->buffer == nullptr) return false;
 
-		ASSUME(workload->remaining >= workload->length, "Cursors should never escape the memory field");
+		ASSUME(workload->remaining <= workload->length, "Cursors should never escape the memory field");
 		if(workload->remaining > workload->length) return false;
 
 		return true;
@@ -79,26 +82,72 @@ namespace iconv_ffi {
 			return ICONV_INVALID_OUTPUT;
 		};
 
+		// Common charset pairs don't need a descriptor at all (and the results are the same as iconv's)
+		iconv_transcode::TranscodingKernel transcode = iconv_transcode::findKernel(request->input.charset, request->output.charset);
+		if(transcode) {
+			request->handle = nullptr;
+			return transcode(request->input, request->output);
+		}
+
 		// This currently fails if an invalid charset identifier is provided -> Fix later so the error is unique
-		request->handle = iconv_open(request->output.charset, request->input.charset);
+		request->handle = iconv_cache::acquireDescriptor(request->input.charset, request->output.charset);
 		if(!sanity_check_descriptor(request->handle)) {
 			return iconv_check_errno();
 		}
 
 		size_t numBytesIrreversiblyWritten = iconv(request->handle, &request->input.buffer, &request->input.remaining, &request->output.buffer, &request->output.remaining);
+		// The descriptor is owned by the cache, so the caller mustn't close it (but it's fine to call iconv_try_close)
+		request->handle = nullptr;
 		if(numBytesIrreversiblyWritten == ICONV_INVALID_SIZE) {
 			return iconv_check_errno();
 		}
 
-		if(!sanity_check_descriptor(request->handle)) {
-			// Clearly the handle was valid before, so the request couldn't be completed (caller should close or retry)
-			auto result = iconv_check_errno();
-			ASSUME(iconv_try_close(request) == ICONV_INVALID_DESCRIPTOR, "Closing an invalid handle should be a NOOP");
-			return result;
-		}
-		auto result = iconv_try_close(request);
-		ASSUME(result == ICONV_RESULT_OK, "Closing a valid handle should never fail");
-		return result;
+		return ICONV_RESULT_OK;
+	}
+
+	iconv_stream_t* iconv_stream_new(const char* input_encoding, const char* output_encoding) {
+		return iconv_stream::createStream(input_encoding, output_encoding);
+	}
+
+	void iconv_stream_free(iconv_stream_t* stream) {
+		if(stream == nullptr) return;
+
+		iconv_stream::destroyStream(stream);
+	}
+
+	iconv_result_t iconv_stream_convert(iconv_stream_t* stream, iconv_memory_t* input, iconv_memory_t* output) {
+		if(stream == nullptr) return ICONV_INVALID_DESCRIPTOR;
+		if(input == nullptr || !sanity_check_buffer(input)) return ICONV_INVALID_INPUT;
+		if(output == nullptr || !sanity_check_buffer(output)) return ICONV_INVALID_OUTPUT;
+
+		return iconv_stream::convertChunk(*stream, *input, *output);
+	}
+
+	iconv_result_t iconv_stream_finish(iconv_stream_t* stream, iconv_memory_t* output) {
+		if(stream == nullptr) return ICONV_INVALID_DESCRIPTOR;
+		if(output == nullptr || !sanity_check_buffer(output)) return ICONV_INVALID_OUTPUT;
+
+		return iconv_stream::finish(*stream, *output);
+	}
+
+	void iconv_stream_reset(iconv_stream_t* stream) {
+		if(stream == nullptr) return;
+
+		iconv_stream::reset(*stream);
+	}
+
+	size_t iconv_stream_pending(const iconv_stream_t* stream) {
+		if(stream == nullptr) return 0;
+
+		return stream->numPendingBytes;
+	}
+
+	size_t iconv_cached_descriptors() {
+		return iconv_cache::getNumCachedDescriptors();
+	}
+
+	void iconv_set_fast_paths(bool enabled) {
+		iconv_transcode::setEnabled(enabled);
 	}
 
 	void* getExportsTable() {
@@ -114,9 +163,19 @@ namespace iconv_ffi {
 			.iconv_convert = &iconv_convert,
 			.iconv_try_close = &iconv_try_close,
 
+			// Streaming API
+			.iconv_stream_new = &iconv_stream_new,
+			.iconv_stream_free = &iconv_stream_free,
+			.iconv_stream_convert = &iconv_stream_convert,
+			.iconv_stream_finish = &iconv_stream_finish,
+			.iconv_stream_reset = &iconv_stream_reset,
+			.iconv_stream_pending = &iconv_stream_pending,
+
 			// Utility methods
 			.iconv_strerror = &iconv_strerror,
 			.iconv_check_result = &iconv_check_result,
+			.iconv_cached_descriptors = &iconv_cached_descriptors,
+			.iconv_set_fast_paths = &iconv_set_fast_paths,
 		};
 
 		return &exports;
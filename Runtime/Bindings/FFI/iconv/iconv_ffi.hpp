@@ -20,5 +20,8 @@ namespace iconv_ffi {
 		[ICONV_RESULT_LAST] = "Undefined: This should never happen",
 	};
 
+	// Maps the errno set by iconv (or iconv_open) to the corresponding result
+	iconv_result_t iconv_check_errno();
+
 	void* getExportsTable();
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "iconv_stream.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace iconv_stream {
+
+	constexpr size_t ICONV_INVALID_SIZE = SIZE_MAX;
+
+	iconv_stream_t* createStream(const char* fromCharset, const char* toCharset) {
+		const iconv_t INVALID_DESCRIPTOR = reinterpret_cast<iconv_t>(-1);
+		if(!fromCharset || !toCharset) {
+			errno = EINVAL; // Same as what iconv_open reports for unsupported charsets
+			return nullptr;
+		}
+
+		iconv_transcode::TranscodingKernel transcode = iconv_transcode::findKernel(fromCharset, toCharset);
+		iconv_t handle = nullptr;
+		if(!transcode) {
+			handle = iconv_open(toCharset, fromCharset);
+			if(handle == INVALID_DESCRIPTOR) return nullptr;
+		}
+
+		return new iconv_stream_t { handle, transcode, 0, {} };
+	}
+
+	void destroyStream(iconv_stream_t* stream) {
+		if(stream->handle) iconv_close(stream->handle);
+		delete stream;
+	}
+
+	static iconv_result_t convert(iconv_stream_t& stream, iconv_memory_t& input, iconv_memory_t& output) {
+		if(stream.transcode) return stream.transcode(input, output);
+
+		size_t numBytesIrreversiblyWritten = iconv(stream.handle, &input.buffer, &input.remaining, &output.buffer, &output.remaining);
+		if(numBytesIrreversiblyWritten == ICONV_INVALID_SIZE) return iconv_ffi::iconv_check_errno();
+
+		return ICONV_RESULT_OK;
+	}
+
+	// Completes the pending sequence with the first few bytes of the input, which are then consumed if that worked
+	static iconv_result_t convertPendingBytes(iconv_stream_t& stream, iconv_memory_t& input, iconv_memory_t& output) {
+		size_t numPendingBytes = stream.numPendingBytes;
+		size_t numCopiedBytes = std::min(input.remaining, ICONV_STREAM_MAX_PENDING_BYTES - numPendingBytes);
+		memcpy(stream.pendingBytes + numPendingBytes, input.buffer, numCopiedBytes);
+
+		iconv_memory_t pendingInput = { input.charset, stream.pendingBytes, numPendingBytes + numCopiedBytes, numPendingBytes + numCopiedBytes };
+		iconv_result_t result = convert(stream, pendingInput, output);
+		size_t numConsumedBytes = pendingInput.length - pendingInput.remaining;
+
+		// Whatever wasn't converted is now part of the input again (and will be handled by the caller)
+		if(numConsumedBytes >= numPendingBytes) {
+			size_t numConsumedInputBytes = numConsumedBytes - numPendingBytes;
+			input.buffer += numConsumedInputBytes;
+			input.remaining -= numConsumedInputBytes;
+			stream.numPendingBytes = 0;
+			return result == ICONV_INCOMPLETE_INPUT ? ICONV_RESULT_OK : result;
+		}
+
+		// The pending sequence is still incomplete, so it keeps growing unless there's enough input to complete it
+		if(result == ICONV_INCOMPLETE_INPUT) {
+			if(numCopiedBytes < input.remaining) return ICONV_CONVERSION_FAILED;
+
+			memmove(stream.pendingBytes, stream.pendingBytes + numConsumedBytes, pendingInput.remaining);
+			stream.numPendingBytes = pendingInput.remaining;
+			input.buffer += numCopiedBytes;
+			input.remaining -= numCopiedBytes;
+			return ICONV_RESULT_OK;
+		}
+
+		// Nothing was taken from the input, so the caller can retry after dealing with the error (e.g., a full output buffer)
+		stream.numPendingBytes = numPendingBytes - numConsumedBytes;
+		memmove(stream.pendingBytes, stream.pendingBytes + numConsumedBytes, stream.numPendingBytes);
+		return result;
+	}
+
+	iconv_result_t convertChunk(iconv_stream_t& stream, iconv_memory_t& input, iconv_memory_t& output) {
+		if(stream.numPendingBytes > 0 && input.remaining > 0) {
+			iconv_result_t result = convertPendingBytes(stream, input, output);
+			if(result != ICONV_RESULT_OK) return result;
+		}
+
+		iconv_result_t result = convert(stream, input, output);
+		if(result != ICONV_INCOMPLETE_INPUT) return result;
+
+		// Since iconv only reports incomplete sequences at the very end of the input, this should always fit
+		if(input.remaining > ICONV_STREAM_MAX_PENDING_BYTES) return ICONV_CONVERSION_FAILED;
+
+		memcpy(stream.pendingBytes, input.buffer, input.remaining);
+		stream.numPendingBytes = input.remaining;
+		input.buffer += input.remaining;
+		input.remaining = 0;
+
+		return ICONV_RESULT_OK;
+	}
+
+	iconv_result_t finish(iconv_stream_t& stream, iconv_memory_t& output) {
+		if(stream.handle) {
+			size_t numBytesIrreversiblyWritten = iconv(stream.handle, nullptr, nullptr, &output.buffer, &output.remaining);
+			if(numBytesIrreversiblyWritten == ICONV_INVALID_SIZE) return iconv_ffi::iconv_check_errno();
+		}
+
+		bool isInputIncomplete = stream.numPendingBytes > 0;
+		reset(stream);
+
+		return isInputIncomplete ? ICONV_INCOMPLETE_INPUT : ICONV_RESULT_OK;
+	}
+
+	void reset(iconv_stream_t& stream) {
+		if(stream.handle) iconv(stream.handle, nullptr, nullptr, nullptr, nullptr);
+		stream.numPendingBytes = 0;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+#include "iconv_ffi.hpp" // For the iconv types (the exports header lacks include guards)
+#include "iconv_transcode.hpp"
+
+// Long enough for any multibyte sequence (or escape sequence, in stateful encodings) that iconv might split up
+constexpr size_t ICONV_STREAM_MAX_PENDING_BYTES = 32;
+
+// Streams own their descriptor since the conversion state must survive between chunks (so they can't use the cache)
+// Like descriptors, streams aren't thread-safe: Each thread that converts data concurrently needs its own stream
+struct iconv_stream_t {
+	iconv_t handle;
+	iconv_transcode::TranscodingKernel transcode; // Used instead of the descriptor if there's a dedicated kernel
+	size_t numPendingBytes;
+	char pendingBytes[ICONV_STREAM_MAX_PENDING_BYTES];
+};
+
+namespace iconv_stream {
+	// Returns nullptr (with errno set by iconv_open) if the conversion isn't supported
+	iconv_stream_t* createStream(const char* fromCharset, const char* toCharset);
+	void destroyStream(iconv_stream_t* stream);
+
+	// Incomplete sequences at the end of the input are consumed and kept until the next chunk arrives to complete them
+	// If the output buffer is full, the input cursor remains where the conversion stopped and nothing is lost
+	iconv_result_t convertChunk(iconv_stream_t& stream, iconv_memory_t& input, iconv_memory_t& output);
+	// Writes the sequence that returns stateful encodings to their initial state, then resets the stream for reuse
+	// Pending bytes are discarded as well, but it's still reported since that means the input ended prematurely
+	iconv_result_t finish(iconv_stream_t& stream, iconv_memory_t& output);
+	void reset(iconv_stream_t& stream);
+}
\ No newline at end of file
@@ -0,0 +1,581 @@
+#include "iconv_transcode.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ICONV_TRANSCODE_X86 1
+#include <immintrin.h>
+#else
+#define ICONV_TRANSCODE_X86 0
+#endif
+
+namespace iconv_transcode {
+
+	// Switching back to SIMD after every character would be wasteful if the input isn't mostly ASCII
+	constexpr size_t SCALAR_RUN_LENGTH = 16;
+
+	struct Cursor {
+		const uint8_t* input;
+		size_t inputRemaining;
+		uint8_t* output;
+		size_t outputRemaining;
+
+		void advance(size_t numBytesRead, size_t numBytesWritten) {
+			input += numBytesRead;
+			inputRemaining -= numBytesRead;
+			output += numBytesWritten;
+			outputRemaining -= numBytesWritten;
+		}
+	};
+
+	typedef iconv_result_t (*Decoder)(const uint8_t* input, size_t size, uint32_t& codepoint, size_t& length);
+	typedef iconv_result_t (*Encoder)(uint32_t codepoint, uint8_t* output, size_t size, size_t& length);
+	typedef void (*VectorizedStep)(Cursor& cursor);
+
+	// Same as iconv: Leading bytes for sequences longer than four bytes are still recognized (but always rejected)
+	static inline size_t getExpectedSequenceLength(uint8_t leadingByte) {
+		if(leadingByte < 0x80) return 1;
+		if(leadingByte < 0xC2) return 0; // Continuation byte, or leading byte of an overlong encoding
+		if(leadingByte < 0xE0) return 2;
+		if(leadingByte < 0xF0) return 3;
+		if(leadingByte < 0xF8) return 4;
+		if(leadingByte < 0xFC) return 5;
+		if(leadingByte < 0xFE) return 6;
+		return 0;
+	}
+
+	static iconv_result_t decodeUTF8(const uint8_t* input, size_t size, uint32_t& codepoint, size_t& length) {
+		uint8_t leadingByte = input[0];
+		length = getExpectedSequenceLength(leadingByte);
+		if(length == 1) {
+			codepoint = leadingByte;
+			return ICONV_RESULT_OK;
+		}
+		if(length == 0) return ICONV_CONVERSION_FAILED;
+
+		// Like iconv, truncated sequences are reported as incomplete unless one of the available bytes can't be part of them
+		if(length > size) {
+			for(size_t index = 1; index < size; index++) {
+				if((input[index] & 0xC0) != 0x80) return ICONV_CONVERSION_FAILED;
+			}
+			return ICONV_INCOMPLETE_INPUT;
+		}
+
+		// The second byte is constrained further to reject overlong encodings, surrogates, and values above U+10FFFF
+		uint8_t minSecondByte = 0x80;
+		uint8_t maxSecondByte = 0xBF;
+		switch(leadingByte) {
+		case 0xE0:
+			minSecondByte = 0xA0;
+			break;
+		case 0xED:
+			maxSecondByte = 0x9F;
+			break;
+		case 0xF0:
+			minSecondByte = 0x90;
+			break;
+		case 0xF4:
+			maxSecondByte = 0x8F;
+			break;
+		default:
+			if(leadingByte > 0xF4) return ICONV_CONVERSION_FAILED;
+		}
+
+		codepoint = leadingByte & (0x7F >> length);
+		for(size_t index = 1; index < length; index++) {
+			uint8_t continuationByte = input[index];
+			bool isValid = (index == 1) ? (continuationByte >= minSecondByte && continuationByte <= maxSecondByte) : ((continuationByte & 0xC0) == 0x80);
+			if(!isValid) return ICONV_CONVERSION_FAILED;
+
+			codepoint = (codepoint << 6) | (continuationByte & 0x3F);
+		}
+
+		return ICONV_RESULT_OK;
+	}
+
+	static iconv_result_t decodeLatin1(const uint8_t* input, size_t size, uint32_t& codepoint, size_t& length) {
+		codepoint = input[0];
+		length = 1;
+		return ICONV_RESULT_OK;
+	}
+
+	static iconv_result_t decodeUTF16LE(const uint8_t* input, size_t size, uint32_t& codepoint, size_t& length) {
+		if(size < 2) return ICONV_INCOMPLETE_INPUT;
+
+		uint16_t firstUnit = input[0] | (input[1] << 8);
+		if(firstUnit < 0xD800 || firstUnit > 0xDFFF) {
+			codepoint = firstUnit;
+			length = 2;
+			return ICONV_RESULT_OK;
+		}
+
+		if(firstUnit > 0xDBFF) return ICONV_CONVERSION_FAILED; // Unpaired low surrogate
+		if(size < 4) return ICONV_INCOMPLETE_INPUT;
+
+		uint16_t secondUnit = input[2] | (input[3] << 8);
+		if(secondUnit < 0xDC00 || secondUnit > 0xDFFF) return ICONV_CONVERSION_FAILED;
+
+		codepoint = 0x10000 + ((firstUnit - 0xD800) << 10) + (secondUnit - 0xDC00);
+		length = 4;
+		return ICONV_RESULT_OK;
+	}
+
+	static iconv_result_t encodeUTF8(uint32_t codepoint, uint8_t* output, size_t size, size_t& length) {
+		length = (codepoint < 0x80) ? 1 : (codepoint < 0x800) ? 2 : (codepoint < 0x10000) ? 3 : 4;
+		if(length > size) return ICONV_WRITEBUFFER_FULL;
+
+		switch(length) {
+		case 1:
+			output[0] = static_cast<uint8_t>(codepoint);
+			break;
+		case 2:
+			output[0] = static_cast<uint8_t>(0xC0 | (codepoint >> 6));
+			output[1] = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+			break;
+		case 3:
+			output[0] = static_cast<uint8_t>(0xE0 | (codepoint >> 12));
+			output[1] = static_cast<uint8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+			output[2] = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+			break;
+		default:
+			output[0] = static_cast<uint8_t>(0xF0 | (codepoint >> 18));
+			output[1] = static_cast<uint8_t>(0x80 | ((codepoint >> 12) & 0x3F));
+			output[2] = static_cast<uint8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+			output[3] = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+		}
+
+		return ICONV_RESULT_OK;
+	}
+
+	static iconv_result_t encodeLatin1(uint32_t codepoint, uint8_t* output, size_t size, size_t& length) {
+		if(size < 1) return ICONV_WRITEBUFFER_FULL; // Checked first, since that's what iconv does
+
+		// Tag characters are invisible, so iconv drops them instead of failing the conversion
+		if(codepoint >= 0xE0000 && codepoint <= 0xE007F) {
+			length = 0;
+			return ICONV_RESULT_OK;
+		}
+		if(codepoint > 0xFF) return ICONV_CONVERSION_FAILED; // Same as iconv without //TRANSLIT or //IGNORE
+
+		output[0] = static_cast<uint8_t>(codepoint);
+		length = 1;
+		return ICONV_RESULT_OK;
+	}
+
+	static iconv_result_t encodeUTF16LE(uint32_t codepoint, uint8_t* output, size_t size, size_t& length) {
+		length = (codepoint < 0x10000) ? 2 : 4;
+		if(length > size) return ICONV_WRITEBUFFER_FULL;
+
+		if(length == 2) {
+			output[0] = static_cast<uint8_t>(codepoint);
+			output[1] = static_cast<uint8_t>(codepoint >> 8);
+			return ICONV_RESULT_OK;
+		}
+
+		uint32_t offset = codepoint - 0x10000;
+		uint16_t highSurrogate = static_cast<uint16_t>(0xD800 + (offset >> 10));
+		uint16_t lowSurrogate = static_cast<uint16_t>(0xDC00 + (offset & 0x3FF));
+		output[0] = static_cast<uint8_t>(highSurrogate);
+		output[1] = static_cast<uint8_t>(highSurrogate >> 8);
+		output[2] = static_cast<uint8_t>(lowSurrogate);
+		output[3] = static_cast<uint8_t>(lowSurrogate >> 8);
+		return ICONV_RESULT_OK;
+	}
+
+	template <Decoder decode, Encoder encode>
+	static iconv_result_t transcodeScalar(Cursor& cursor, size_t maxNumCharacters) {
+		for(size_t numCharacters = 0; numCharacters < maxNumCharacters && cursor.inputRemaining > 0; numCharacters++) {
+			uint32_t codepoint = 0;
+			size_t numBytesRead = 0;
+			size_t numBytesWritten = 0;
+
+			iconv_result_t result = decode(cursor.input, cursor.inputRemaining, codepoint, numBytesRead);
+			if(result != ICONV_RESULT_OK) return result;
+
+			result = encode(codepoint, cursor.output, cursor.outputRemaining, numBytesWritten);
+			if(result != ICONV_RESULT_OK) return result;
+
+			cursor.advance(numBytesRead, numBytesWritten);
+		}
+
+		return ICONV_RESULT_OK;
+	}
+
+#if ICONV_TRANSCODE_X86
+
+	static bool detectSSSE3() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3");
+	}
+
+	static const bool hasSSSE3 = detectSSSE3();
+
+	// Error flags for the UTF-8 validation algorithm by Keiser and Lemire (https://arxiv.org/abs/2010.03090)
+	constexpr uint8_t TOO_SHORT = 1 << 0; // Leading byte followed by another leading byte or ASCII
+	constexpr uint8_t TOO_LONG = 1 << 1; // ASCII followed by a continuation byte
+	constexpr uint8_t OVERLONG_3 = 1 << 2;
+	constexpr uint8_t TOO_LARGE = 1 << 3;
+	constexpr uint8_t SURROGATE = 1 << 4;
+	constexpr uint8_t OVERLONG_2 = 1 << 5;
+	constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+	constexpr uint8_t OVERLONG_4 = 1 << 6;
+	constexpr uint8_t TWO_CONTS = 1 << 7; // Continuation byte not preceded by a leading byte (unless it's the 3rd/4th byte)
+	constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+	__attribute__((target("ssse3"))) static inline __m128i lookupNibbles(__m128i nibbles, __m128i table) {
+		return _mm_shuffle_epi8(table, nibbles);
+	}
+
+	__attribute__((target("ssse3"))) static inline __m128i getHighNibbles(__m128i bytes) {
+		return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+	}
+
+	// Every byte is checked against the three bytes before it, which is why the previous block needs to be passed in
+	__attribute__((target("ssse3"))) static inline __m128i findUTF8Errors(__m128i input, __m128i previousInput) {
+		const __m128i firstByteHighNibbleTable = _mm_setr_epi8(
+			TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+			TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+			TOO_SHORT | OVERLONG_2,
+			TOO_SHORT,
+			TOO_SHORT | OVERLONG_3 | SURROGATE,
+			static_cast<char>(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4));
+		const __m128i firstByteLowNibbleTable = _mm_setr_epi8(
+			static_cast<char>(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+			static_cast<char>(CARRY | OVERLONG_2),
+			static_cast<char>(CARRY),
+			static_cast<char>(CARRY),
+			static_cast<char>(CARRY | TOO_LARGE),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000),
+			static_cast<char>(CARRY | TOO_LARGE | TOO_LARGE_1000));
+		const __m128i secondByteHighNibbleTable = _mm_setr_epi8(
+			TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+			static_cast<char>(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+			static_cast<char>(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+			static_cast<char>(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+			static_cast<char>(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+			TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+		const __m128i previous1 = _mm_alignr_epi8(input, previousInput, 15);
+		const __m128i previous2 = _mm_alignr_epi8(input, previousInput, 14);
+		const __m128i previous3 = _mm_alignr_epi8(input, previousInput, 13);
+
+		__m128i specialCases = lookupNibbles(getHighNibbles(previous1), firstByteHighNibbleTable);
+		specialCases = _mm_and_si128(specialCases, lookupNibbles(_mm_and_si128(previous1, _mm_set1_epi8(0x0F)), firstByteLowNibbleTable));
+		specialCases = _mm_and_si128(specialCases, lookupNibbles(getHighNibbles(input), secondByteHighNibbleTable));
+
+		// The high bit is set if the byte must be the third or fourth byte of a sequence (only then is TWO_CONTS valid)
+		const __m128i isThirdByte = _mm_subs_epu8(previous2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+		const __m128i isFourthByte = _mm_subs_epu8(previous3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+		const __m128i mustBeContinuation = _mm_and_si128(_mm_or_si128(isThirdByte, isFourthByte), _mm_set1_epi8(static_cast<char>(0x80)));
+
+		return _mm_xor_si128(mustBeContinuation, specialCases);
+	}
+
+	// A validated block may end in the middle of a character, which only the next block can confirm
+	static inline size_t getNumIncompleteTrailingBytes(const uint8_t* blockEnd) {
+		if(blockEnd[-1] >= 0xC0) return 1;
+		if(blockEnd[-2] >= 0xE0) return 2;
+		if(blockEnd[-3] >= 0xF0) return 3;
+		return 0;
+	}
+
+	__attribute__((target("ssse3"))) static void validateUTF8(Cursor& cursor) {
+		const size_t size = std::min(cursor.inputRemaining, cursor.outputRemaining);
+		size_t numValidatedBytes = 0;
+		__m128i previousBlock = _mm_setzero_si128();
+
+		for(size_t offset = 0; offset + 16 <= size; offset += 16) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor.input + offset));
+			const bool isAtCharacterBoundary = (numValidatedBytes == offset);
+
+			if(!isAtCharacterBoundary || _mm_movemask_epi8(block) != 0) {
+				const __m128i errors = findUTF8Errors(block, previousBlock);
+				if(_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xFFFF) break;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(cursor.output + offset), block);
+			numValidatedBytes = offset + 16 - getNumIncompleteTrailingBytes(cursor.input + offset + 16);
+			previousBlock = block;
+		}
+
+		// Any bytes that were copied past this point will be overwritten, or at least not reported as converted
+		cursor.advance(numValidatedBytes, numValidatedBytes);
+	}
+
+	struct CompressionTable {
+		alignas(16) uint8_t shuffleMasks[256][16];
+		uint8_t lengths[256];
+	};
+
+	// Each bit of the mask selects one of eight lanes (the first byte of a lane can also be kept unconditionally)
+	static constexpr CompressionTable createCompressionTable(uint8_t laneSize, bool isFirstByteAlwaysKept) {
+		CompressionTable table = {};
+		for(size_t laneMask = 0; laneMask < 256; laneMask++) {
+			uint8_t length = 0;
+			for(uint8_t lane = 0; lane < 8; lane++) {
+				for(uint8_t byte = 0; byte < laneSize; byte++) {
+					bool isKept = (laneMask & (1 << lane)) || (byte == 0 && isFirstByteAlwaysKept);
+					if(isKept) table.shuffleMasks[laneMask][length++] = laneSize * lane + byte;
+				}
+			}
+			table.lengths[laneMask] = length;
+			for(size_t index = length; index < 16; index++)
+				table.shuffleMasks[laneMask][index] = 0x80;
+		}
+		return table;
+	}
+
+	// Drops the unused high byte of ASCII characters (the mask selects the two-byte characters)
+	static constexpr CompressionTable TWO_BYTE_ENCODING_TABLE = createCompressionTable(2, true);
+	// Drops the lanes of continuation bytes after decoding (the mask selects the leading bytes)
+	static constexpr CompressionTable CODE_UNIT_COMPRESSION_TABLE = createCompressionTable(2, false);
+	static constexpr CompressionTable BYTE_COMPRESSION_TABLE = createCompressionTable(1, false);
+
+	// Encodes eight 16-bit code points below U+0800 (always writes 16 bytes, but returns how many of them are used)
+	__attribute__((target("ssse3"))) static inline size_t encodeTwoByteBlock(__m128i codepoints, uint8_t* output) {
+		const __m128i isASCII = _mm_cmplt_epi16(codepoints, _mm_set1_epi16(0x80));
+		const __m128i leadingBytes = _mm_or_si128(_mm_srli_epi16(codepoints, 6), _mm_set1_epi16(0xC0));
+		const __m128i continuationBytes = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(codepoints, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80)), 8);
+		const __m128i twoByteCharacters = _mm_or_si128(leadingBytes, continuationBytes);
+		const __m128i encoded = _mm_or_si128(_mm_and_si128(isASCII, codepoints), _mm_andnot_si128(isASCII, twoByteCharacters));
+
+		const int twoByteMask = ~_mm_movemask_epi8(_mm_packs_epi16(isASCII, isASCII)) & 0xFF;
+		const __m128i shuffleMask = _mm_load_si128(reinterpret_cast<const __m128i*>(TWO_BYTE_ENCODING_TABLE.shuffleMasks[twoByteMask]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(encoded, shuffleMask));
+
+		return TWO_BYTE_ENCODING_TABLE.lengths[twoByteMask];
+	}
+
+	__attribute__((target("ssse3"))) static void transcodeLatin1ToUTF8(Cursor& cursor) {
+		while(cursor.inputRemaining >= 16 && cursor.outputRemaining >= 32) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor.input));
+			if(_mm_movemask_epi8(block) == 0) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cursor.output), block);
+				cursor.advance(16, 16);
+				continue;
+			}
+
+			size_t numBytesWritten = encodeTwoByteBlock(_mm_unpacklo_epi8(block, _mm_setzero_si128()), cursor.output);
+			numBytesWritten += encodeTwoByteBlock(_mm_unpackhi_epi8(block, _mm_setzero_si128()), cursor.output + numBytesWritten);
+			cursor.advance(16, numBytesWritten);
+		}
+	}
+
+	struct DecodedBlock {
+		__m128i lowCodepoints; // One 16-bit lane for each of the first eight bytes
+		__m128i highCodepoints; // Same for the last eight bytes
+		int leadingByteMask; // Lanes with continuation bytes (or an incomplete sequence at the end) must be discarded
+		size_t numBytesRead;
+	};
+
+	// Decodes a block of one- and two-byte characters that starts at a character boundary
+	// Anything else (including invalid UTF-8) is rejected, so that the scalar path can deal with it
+	__attribute__((target("ssse3"))) static inline bool decodeTwoByteBlock(__m128i block, uint8_t maxLeadingByte, DecodedBlock& decoded) {
+		const __m128i excessBytes = _mm_subs_epu8(block, _mm_set1_epi8(static_cast<char>(maxLeadingByte)));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(excessBytes, _mm_setzero_si128())) != 0xFFFF) return false;
+
+		const __m128i errors = findUTF8Errors(block, _mm_setzero_si128());
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xFFFF) return false;
+
+		// Continuation bytes are exactly those that are less than 0xC0 when compared as signed integers
+		const int continuationByteMask = _mm_movemask_epi8(_mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(0xC0))));
+		decoded.leadingByteMask = ~continuationByteMask & 0xFFFF;
+		decoded.numBytesRead = 16;
+
+		// A leading byte at the very end is only confirmed by the next block (and validated there)
+		if((decoded.leadingByteMask & 0x8000) && (_mm_movemask_epi8(block) & 0x8000)) {
+			decoded.leadingByteMask &= 0x7FFF;
+			decoded.numBytesRead = 15;
+		}
+
+		const __m128i nextBytes = _mm_srli_si128(block, 1);
+		const __m128i lowBytes = _mm_set1_epi16(0x3F);
+		const __m128i leadingBits = _mm_set1_epi16(0x1F);
+		const __m128i minLeadingByte = _mm_set1_epi16(0xBF);
+
+		const __m128i lowLeadingBytes = _mm_unpacklo_epi8(block, _mm_setzero_si128());
+		const __m128i lowNextBytes = _mm_unpacklo_epi8(nextBytes, _mm_setzero_si128());
+		const __m128i lowTwoByteCharacters = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(lowLeadingBytes, leadingBits), 6), _mm_and_si128(lowNextBytes, lowBytes));
+		const __m128i isLowTwoByte = _mm_cmpgt_epi16(lowLeadingBytes, minLeadingByte);
+		decoded.lowCodepoints = _mm_or_si128(_mm_and_si128(isLowTwoByte, lowTwoByteCharacters), _mm_andnot_si128(isLowTwoByte, lowLeadingBytes));
+
+		const __m128i highLeadingBytes = _mm_unpackhi_epi8(block, _mm_setzero_si128());
+		const __m128i highNextBytes = _mm_unpackhi_epi8(nextBytes, _mm_setzero_si128());
+		const __m128i highTwoByteCharacters = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(highLeadingBytes, leadingBits), 6), _mm_and_si128(highNextBytes, lowBytes));
+		const __m128i isHighTwoByte = _mm_cmpgt_epi16(highLeadingBytes, minLeadingByte);
+		decoded.highCodepoints = _mm_or_si128(_mm_and_si128(isHighTwoByte, highTwoByteCharacters), _mm_andnot_si128(isHighTwoByte, highLeadingBytes));
+
+		return true;
+	}
+
+	__attribute__((target("ssse3"))) static inline size_t compress(__m128i vector, const CompressionTable& table, int laneMask, uint8_t* output) {
+		const __m128i shuffleMask = _mm_load_si128(reinterpret_cast<const __m128i*>(table.shuffleMasks[laneMask]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(vector, shuffleMask));
+		return table.lengths[laneMask];
+	}
+
+	// The compressed halves are stored with 16 bytes each, so there must be room for 8 more bytes than are needed
+	__attribute__((target("ssse3"))) static void transcodeUTF8ToLatin1(Cursor& cursor) {
+		while(cursor.inputRemaining >= 16 && cursor.outputRemaining >= 24) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor.input));
+			if(_mm_movemask_epi8(block) == 0) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cursor.output), block);
+				cursor.advance(16, 16);
+				continue;
+			}
+
+			// Only C2 and C3 encode characters that fit into a single byte
+			DecodedBlock decoded;
+			if(!decodeTwoByteBlock(block, 0xC3, decoded)) return;
+
+			const __m128i codepoints = _mm_packus_epi16(decoded.lowCodepoints, decoded.highCodepoints);
+			size_t numBytesWritten = compress(codepoints, BYTE_COMPRESSION_TABLE, decoded.leadingByteMask & 0xFF, cursor.output);
+			numBytesWritten += compress(_mm_srli_si128(codepoints, 8), BYTE_COMPRESSION_TABLE, decoded.leadingByteMask >> 8, cursor.output + numBytesWritten);
+			cursor.advance(decoded.numBytesRead, numBytesWritten);
+		}
+	}
+
+	__attribute__((target("ssse3"))) static void transcodeUTF16LEToUTF8(Cursor& cursor) {
+		while(cursor.inputRemaining >= 16 && cursor.outputRemaining >= 16) {
+			const __m128i codeUnits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor.input));
+			const __m128i isBelow800 = _mm_cmpeq_epi16(_mm_and_si128(codeUnits, _mm_set1_epi16(static_cast<short>(0xF800))), _mm_setzero_si128());
+			if(_mm_movemask_epi8(isBelow800) != 0xFFFF) return; // Three-byte characters and surrogates are left to the scalar path
+
+			const __m128i isASCII = _mm_cmpeq_epi16(_mm_and_si128(codeUnits, _mm_set1_epi16(static_cast<short>(0xFF80))), _mm_setzero_si128());
+			if(_mm_movemask_epi8(isASCII) == 0xFFFF) {
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(cursor.output), _mm_packus_epi16(codeUnits, codeUnits));
+				cursor.advance(16, 8);
+				continue;
+			}
+
+			cursor.advance(16, encodeTwoByteBlock(codeUnits, cursor.output));
+		}
+	}
+
+	__attribute__((target("ssse3"))) static void transcodeUTF8ToUTF16LE(Cursor& cursor) {
+		while(cursor.inputRemaining >= 16 && cursor.outputRemaining >= 32) {
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor.input));
+			if(_mm_movemask_epi8(block) == 0) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cursor.output), _mm_unpacklo_epi8(block, _mm_setzero_si128()));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cursor.output + 16), _mm_unpackhi_epi8(block, _mm_setzero_si128()));
+				cursor.advance(16, 32);
+				continue;
+			}
+
+			DecodedBlock decoded;
+			if(!decodeTwoByteBlock(block, 0xDF, decoded)) return;
+
+			size_t numBytesWritten = compress(decoded.lowCodepoints, CODE_UNIT_COMPRESSION_TABLE, decoded.leadingByteMask & 0xFF, cursor.output);
+			numBytesWritten += compress(decoded.highCodepoints, CODE_UNIT_COMPRESSION_TABLE, decoded.leadingByteMask >> 8, cursor.output + numBytesWritten);
+			cursor.advance(decoded.numBytesRead, numBytesWritten);
+		}
+	}
+
+#else
+
+	static const bool hasSSSE3 = false;
+
+	static void validateUTF8(Cursor& cursor) {}
+	static void transcodeLatin1ToUTF8(Cursor& cursor) {}
+	static void transcodeUTF8ToLatin1(Cursor& cursor) {}
+	static void transcodeUTF16LEToUTF8(Cursor& cursor) {}
+	static void transcodeUTF8ToUTF16LE(Cursor& cursor) {}
+
+#endif
+
+	// The vectorized step converts as many whole blocks as it can, and the scalar step takes over where it stopped
+	template <VectorizedStep transcodeBlocks, Decoder decode, Encoder encode>
+	static iconv_result_t transcode(iconv_memory_t& input, iconv_memory_t& output) {
+		Cursor cursor = { reinterpret_cast<const uint8_t*>(input.buffer), input.remaining, reinterpret_cast<uint8_t*>(output.buffer), output.remaining };
+
+		iconv_result_t result = ICONV_RESULT_OK;
+		while(cursor.inputRemaining > 0 && result == ICONV_RESULT_OK) {
+			if(hasSSSE3) transcodeBlocks(cursor);
+			result = transcodeScalar<decode, encode>(cursor, SCALAR_RUN_LENGTH);
+		}
+
+		input.buffer += input.remaining - cursor.inputRemaining;
+		input.remaining = cursor.inputRemaining;
+		output.buffer += output.remaining - cursor.outputRemaining;
+		output.remaining = cursor.outputRemaining;
+
+		return result;
+	}
+
+	enum Charset {
+		CHARSET_UTF8,
+		CHARSET_LATIN1,
+		CHARSET_UTF16LE,
+		CHARSET_UNSUPPORTED,
+	};
+
+	struct CharsetAlias {
+		const char* name;
+		Charset charset;
+	};
+
+	// Only names that iconv itself treats as exact aliases can be used here (suffixes like //TRANSLIT are excluded on purpose)
+	constexpr CharsetAlias CHARSET_ALIASES[] = {
+		{ "UTF-8", CHARSET_UTF8 },
+		{ "UTF8", CHARSET_UTF8 },
+		{ "ISO-8859-1", CHARSET_LATIN1 },
+		{ "ISO8859-1", CHARSET_LATIN1 },
+		{ "ISO_8859-1", CHARSET_LATIN1 },
+		{ "LATIN1", CHARSET_LATIN1 },
+		{ "UTF-16LE", CHARSET_UTF16LE },
+		{ "UTF16LE", CHARSET_UTF16LE },
+	};
+
+	static bool isSameCharsetName(const char* name, const char* alias) {
+		for(; *name && *alias; name++, alias++) {
+			char character = (*name >= 'a' && *name <= 'z') ? static_cast<char>(*name - 'a' + 'A') : *name;
+			if(character != *alias) return false;
+		}
+		return *name == *alias;
+	}
+
+	static Charset findCharset(const char* name) {
+		if(name == nullptr) return CHARSET_UNSUPPORTED;
+
+		for(const CharsetAlias& alias : CHARSET_ALIASES) {
+			if(isSameCharsetName(name, alias.name)) return alias.charset;
+		}
+		return CHARSET_UNSUPPORTED;
+	}
+
+	static std::atomic<bool> isEnabled = true;
+
+	TranscodingKernel findKernel(const char* fromCharset, const char* toCharset) {
+		if(!isEnabled.load(std::memory_order_relaxed)) return nullptr;
+
+		Charset inputCharset = findCharset(fromCharset);
+		Charset outputCharset = findCharset(toCharset);
+		if(inputCharset == CHARSET_UNSUPPORTED || outputCharset == CHARSET_UNSUPPORTED) return nullptr;
+
+		// Validation is by far the most common use case, so the copy is fused with the validation kernel
+		if(inputCharset == CHARSET_UTF8 && outputCharset == CHARSET_UTF8) return &transcode<validateUTF8, decodeUTF8, encodeUTF8>;
+		if(inputCharset == CHARSET_LATIN1 && outputCharset == CHARSET_UTF8) return &transcode<transcodeLatin1ToUTF8, decodeLatin1, encodeUTF8>;
+		if(inputCharset == CHARSET_UTF8 && outputCharset == CHARSET_LATIN1) return &transcode<transcodeUTF8ToLatin1, decodeUTF8, encodeLatin1>;
+		if(inputCharset == CHARSET_UTF16LE && outputCharset == CHARSET_UTF8) return &transcode<transcodeUTF16LEToUTF8, decodeUTF16LE, encodeUTF8>;
+		if(inputCharset == CHARSET_UTF8 && outputCharset == CHARSET_UTF16LE) return &transcode<transcodeUTF8ToUTF16LE, decodeUTF8, encodeUTF16LE>;
+
+		return nullptr;
+	}
+
+	void setEnabled(bool enabled) {
+		isEnabled.store(enabled, std::memory_order_relaxed);
+	}
+
+}
\ No newline at end of file
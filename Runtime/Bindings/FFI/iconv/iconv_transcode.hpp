@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+#include "iconv_ffi.hpp" // For the iconv types (the exports header lacks include guards)
+
+// Dedicated kernels for the most common conversions, which are much faster than going through iconv's generic machinery
+// They behave like iconv does: Cursors end up after the last converted character, and errors map to the same results
+namespace iconv_transcode {
+	typedef iconv_result_t (*TranscodingKernel)(iconv_memory_t& input, iconv_memory_t& output);
+
+	// Returns nullptr if there's no dedicated kernel for the given charsets (or they've been disabled)
+	TranscodingKernel findKernel(const char* fromCharset, const char* toCharset);
+	void setEnabled(bool enabled);
+}
\ No newline at end of file
@@ -31,6 +31,10 @@ typedef enum {
 	TEXTURE_GENERATION_EVENT,
 	TEXTURE_RELEASE_EVENT,
 	TRANSFORMATION_UPDATE_EVENT,
+	// Image processing events
+	IMAGE_TRANSCODING_EVENT,
+	// Cryptography events
+	KEY_DERIVATION_EVENT,
 } EventType;
 
 // Stack-allocated payload events
@@ -203,6 +207,25 @@ typedef struct transformation_update_event_t {
 	float w4;
 } transformation_update_event_t;
 
+// Image processing events (the encoded file must be released via stbi_release_transcoded_image)
+typedef struct image_transcoding_event_t {
+	int type;
+	uint32_t batch_id;
+	size_t index;
+	bool success;
+	int width;
+	int height;
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+} image_transcoding_event_t;
+
+// Cryptography events (the key is written to the result that was passed when the request was submitted)
+typedef struct key_derivation_event_t {
+	int type;
+	uint32_t request_id;
+} key_derivation_event_t;
+
 typedef union deferred_event_t {
 	error_event_t error_details;
 	// GLFW
@@ -231,6 +254,10 @@ typedef union deferred_event_t {
 	texture_generation_event_t texture_generation_details;
 	texture_release_event_t texture_release_details;
 	transformation_update_event_t transformation_update_details;
+	// Image processing
+	image_transcoding_event_t image_transcoding_details;
+	// Cryptography
+	key_derivation_event_t key_derivation_details;
 } deferred_event_t;
 
 struct static_interop_exports_table {
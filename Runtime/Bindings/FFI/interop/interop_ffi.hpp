@@ -4,6 +4,7 @@
 
 #include <queue>
 #include <cstddef>
+#include <cstdint>
 
 typedef WGPUTexture wgpu_texture_t;
 typedef WGPUBuffer wgpu_buffer_t;
@@ -5,10 +5,62 @@ local ffi = require("ffi")
 local oop = require("oop")
 local syslog = require("syslog")
 local uv = require("uv")
+local validation = require("validation")
 local versions = require("versions")
 
 local require = require
 
+local pendingWork = {}
+local nextRequestID = 0
+local workCompletionCallback
+
+-- Each whitelisted export needs to know how its arguments map onto the generic work request (and back)
+local offloadableExports = {
+	stbi_load_rgba = {
+		type = "RUNTIME_WORK_STBI_LOAD_RGBA",
+		pack = function(arguments, fileContents, image)
+			arguments.input = fileContents
+			arguments.input_size = #fileContents
+			arguments.output = image
+		end,
+		unpack = function(arguments)
+			return arguments.result ~= 0
+		end,
+	},
+	stbi_encode_png = {
+		type = "RUNTIME_WORK_STBI_ENCODE_PNG",
+		pack = function(arguments, image, buffer, bufferSize, stride)
+			arguments.context = image
+			arguments.output = buffer
+			arguments.output_size = bufferSize
+			arguments.option = stride
+		end,
+		unpack = function(arguments)
+			return tonumber(arguments.result)
+		end,
+	},
+	openssl_kdf_derive = {
+		type = "RUNTIME_WORK_OPENSSL_KDF_DERIVE",
+		pack = function(arguments, inputs, parameters, result)
+			arguments.input = inputs
+			arguments.context = parameters
+			arguments.output = result
+		end,
+		unpack = function(arguments)
+			return arguments.result ~= 0
+		end,
+	},
+	iconv_convert = {
+		type = "RUNTIME_WORK_ICONV_CONVERT",
+		pack = function(arguments, request)
+			arguments.context = request
+		end,
+		unpack = function(arguments)
+			return tonumber(arguments.result)
+		end,
+	},
+}
+
 local runtime = {
 	signals = {},
 	aliases = {},
@@ -21,12 +73,106 @@ local runtime = {
 
 runtime.cdefs = [[
 
+enum {
+	// The last class holds all allocations that are too large to be pooled
+	LUA_ALLOCATOR_NUM_SIZE_CLASSES = 17,
+	// Bucket N counts iterations that took less than 2^N milliseconds (the last one holds everything else)
+	EVENT_LOOP_LAG_HISTOGRAM_SIZE = 12,
+	EVENT_LOOP_CALLBACK_LOCATION_SIZE = 256,
+};
+
+typedef struct lua_allocator_stats_t {
+	const char* name;
+	size_t num_allocations;
+	size_t num_reallocations;
+	size_t num_deallocations;
+	size_t num_failed_allocations;
+	size_t bytes_in_use;
+	size_t peak_bytes_in_use;
+	size_t bytes_reserved;
+	size_t size_class_limits[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+	size_t num_allocations_by_size_class[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+	size_t bytes_allocated_by_size_class[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+} lua_allocator_stats_t;
+
+typedef struct runtime_guest_limits_t {
+	// Zero means unlimited for all of these
+	size_t max_memory_in_bytes;
+	int max_instructions_per_callback;
+	uint64_t max_cpu_time_per_window_in_nanoseconds;
+} runtime_guest_limits_t;
+
+typedef struct runtime_guest_stats_t {
+	size_t num_callbacks;
+	size_t num_failed_callbacks;
+	size_t num_deferred_callbacks;
+	size_t num_pending_callbacks;
+	size_t num_times_throttled;
+	uint64_t total_cpu_time_in_nanoseconds;
+	uint64_t window_cpu_time_in_nanoseconds;
+	uint64_t max_callback_time_in_nanoseconds;
+	size_t bytes_in_use;
+	size_t peak_bytes_in_use;
+	size_t num_failed_allocations;
+	bool is_throttled;
+} runtime_guest_stats_t;
+
+typedef struct runtime_event_loop_metrics_t {
+	uint64_t num_iterations;
+	uint64_t num_callbacks;
+	uint64_t run_time_in_nanoseconds;
+	uint64_t idle_time_in_nanoseconds;
+	uint64_t total_callback_time_in_nanoseconds;
+	uint64_t max_lag_in_nanoseconds;
+	uint64_t max_callback_time_in_nanoseconds;
+	uint64_t lag_histogram[EVENT_LOOP_LAG_HISTOGRAM_SIZE];
+	char slowest_callback[EVENT_LOOP_CALLBACK_LOCATION_SIZE];
+} runtime_event_loop_metrics_t;
+
+typedef enum {
+	RUNTIME_WORK_STBI_LOAD_RGBA,
+	RUNTIME_WORK_STBI_ENCODE_PNG,
+	RUNTIME_WORK_OPENSSL_KDF_DERIVE,
+	RUNTIME_WORK_ICONV_CONVERT,
+	RUNTIME_WORK_TYPE_COUNT,
+} runtime_work_type_t;
+
+// Borrowed by a worker thread: Neither this nor the buffers it points to may be modified (or collected) until it is done
+typedef struct runtime_work_arguments_t {
+	const void* input;
+	size_t input_size;
+	void* output;
+	size_t output_size;
+	void* context;
+	int option;
+	int status;
+	int64_t result;
+} runtime_work_arguments_t;
+
+typedef void (*runtime_work_callback_t)(uint32_t request_id);
+
 struct static_runtime_exports_table {
 	// Build configuration
 	const char* (*runtime_version)(void);
 
 	// REPL
 	void (*runtime_repl_start)(void);
+
+	// Memory management
+	bool (*runtime_allocator_stats)(lua_allocator_stats_t* stats);
+
+	// Guest VMs
+	bool (*runtime_guest_create)(const char* name, const char* script_path, const runtime_guest_limits_t* limits);
+	bool (*runtime_guest_stats)(const char* name, runtime_guest_stats_t* stats);
+	uint64_t (*runtime_guest_accounting_window)(void);
+
+	// Event loop metrics
+	bool (*runtime_event_loop_metrics)(runtime_event_loop_metrics_t* metrics);
+	void (*runtime_event_loop_reset_peaks)(void);
+
+	// Thread pool
+	bool (*runtime_work_submit)(runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t request_id, runtime_work_callback_t on_completion);
+	size_t (*runtime_threadpool_size)(void);
 };
 
 ]]
@@ -111,6 +257,113 @@ function runtime.version()
 	return versionString, tonumber(majorVersion), tonumber(minorVersion), tonumber(patchVersion)
 end
 
+function runtime.getAllocatorStats()
+	local stats = ffi.new("lua_allocator_stats_t")
+	local hasCustomAllocator = runtime.bindings.runtime_allocator_stats(stats)
+	if not hasCustomAllocator then
+		return nil
+	end
+
+	local sizeClasses = {}
+	for index = 0, ffi.C.LUA_ALLOCATOR_NUM_SIZE_CLASSES - 1, 1 do
+		local isLargeAllocation = (index == ffi.C.LUA_ALLOCATOR_NUM_SIZE_CLASSES - 1)
+		sizeClasses[index + 1] = {
+			maxSizeInBytes = (not isLargeAllocation) and tonumber(stats.size_class_limits[index]) or math.huge,
+			numAllocations = tonumber(stats.num_allocations_by_size_class[index]),
+			numAllocatedBytes = tonumber(stats.bytes_allocated_by_size_class[index]),
+		}
+	end
+
+	return {
+		name = ffi.string(stats.name),
+		numAllocations = tonumber(stats.num_allocations),
+		numReallocations = tonumber(stats.num_reallocations),
+		numDeallocations = tonumber(stats.num_deallocations),
+		numFailedAllocations = tonumber(stats.num_failed_allocations),
+		bytesInUse = tonumber(stats.bytes_in_use),
+		peakBytesInUse = tonumber(stats.peak_bytes_in_use),
+		bytesReserved = tonumber(stats.bytes_reserved),
+		sizeClasses = sizeClasses,
+	}
+end
+
+local function reportUncaughtWorkError(errorMessage)
+	-- Raising errors here would unwind through libuv's C frames, so the best that can be done is to report them
+	io.stderr:write("Uncaught error in work completion handler: " .. tostring(errorMessage) .. "\n")
+end
+
+local function onWorkCompleted(requestID)
+	local work = pendingWork[requestID]
+	pendingWork[requestID] = nil -- Also unpins the arguments (if nothing else references them)
+
+	local result, errorMessage
+	if work.arguments.status == 0 then
+		result = offloadableExports[work.exportName].unpack(work.arguments)
+	else
+		local status = work.arguments.status
+		errorMessage = string.format("Failed to run %s in the thread pool (status: %d)", work.exportName, status)
+	end
+
+	if work.thread then
+		local success, resumeError = coroutine.resume(work.thread, result, errorMessage)
+		if not success then
+			reportUncaughtWorkError(debug.traceback(work.thread, resumeError))
+		end
+		return
+	end
+
+	xpcall(work.onCompletion, function(callbackError)
+		reportUncaughtWorkError(debug.traceback(callbackError, 2))
+	end, result, errorMessage)
+end
+
+function runtime.offload(exportName, onCompletion, ...)
+	local offloadableExport = offloadableExports[exportName]
+	if not offloadableExport then
+		local message = "Cannot offload %s (only whitelisted exports can be run in the thread pool)"
+		error(string.format(message, exportName), 0)
+	end
+
+	local currentThread, isMainThread = coroutine.running()
+	if onCompletion == nil and isMainThread then
+		error("Cannot yield from the main thread (pass a completion handler or wrap async task in a coroutine)", 0)
+	end
+	if onCompletion ~= nil then
+		validation.validateFunction(onCompletion, "onCompletion")
+	end
+
+	workCompletionCallback = workCompletionCallback or ffi.cast("runtime_work_callback_t", onWorkCompleted)
+
+	local arguments = ffi.new("runtime_work_arguments_t")
+	offloadableExport.pack(arguments, ...)
+
+	-- The varargs include all buffers that the worker thread reads from or writes to, so they must be kept alive
+	local requestID = nextRequestID
+	nextRequestID = (nextRequestID + 1) % 0xFFFFFFFF
+	pendingWork[requestID] = {
+		exportName = exportName,
+		arguments = arguments,
+		pinnedObjects = { ... },
+		onCompletion = onCompletion,
+		thread = (onCompletion == nil) and currentThread or nil,
+	}
+
+	local workType = ffi.C[offloadableExport.type]
+	local success = runtime.bindings.runtime_work_submit(workType, arguments, requestID, workCompletionCallback)
+	if not success then
+		pendingWork[requestID] = nil
+		error(string.format("Failed to queue %s for execution in the thread pool", exportName), 0)
+	end
+
+	if onCompletion == nil then
+		return coroutine.yield()
+	end
+end
+
+function runtime.getThreadPoolSize()
+	return tonumber(runtime.bindings.runtime_threadpool_size())
+end
+
 function runtime.search(moduleName)
 	EVENT("MODULE_SEARCH_STARTED", { moduleName = moduleName })
 end
@@ -1,7 +1,101 @@
+enum {
+	// The last class holds all allocations that are too large to be pooled
+	LUA_ALLOCATOR_NUM_SIZE_CLASSES = 17,
+	// Bucket N counts iterations that took less than 2^N milliseconds (the last one holds everything else)
+	EVENT_LOOP_LAG_HISTOGRAM_SIZE = 12,
+	EVENT_LOOP_CALLBACK_LOCATION_SIZE = 256,
+};
+
+typedef struct lua_allocator_stats_t {
+	const char* name;
+	size_t num_allocations;
+	size_t num_reallocations;
+	size_t num_deallocations;
+	size_t num_failed_allocations;
+	size_t bytes_in_use;
+	size_t peak_bytes_in_use;
+	size_t bytes_reserved;
+	size_t size_class_limits[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+	size_t num_allocations_by_size_class[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+	size_t bytes_allocated_by_size_class[LUA_ALLOCATOR_NUM_SIZE_CLASSES];
+} lua_allocator_stats_t;
+
+typedef struct runtime_guest_limits_t {
+	// Zero means unlimited for all of these
+	size_t max_memory_in_bytes;
+	int max_instructions_per_callback;
+	uint64_t max_cpu_time_per_window_in_nanoseconds;
+} runtime_guest_limits_t;
+
+typedef struct runtime_guest_stats_t {
+	size_t num_callbacks;
+	size_t num_failed_callbacks;
+	size_t num_deferred_callbacks;
+	size_t num_pending_callbacks;
+	size_t num_times_throttled;
+	uint64_t total_cpu_time_in_nanoseconds;
+	uint64_t window_cpu_time_in_nanoseconds;
+	uint64_t max_callback_time_in_nanoseconds;
+	size_t bytes_in_use;
+	size_t peak_bytes_in_use;
+	size_t num_failed_allocations;
+	bool is_throttled;
+} runtime_guest_stats_t;
+
+typedef struct runtime_event_loop_metrics_t {
+	uint64_t num_iterations;
+	uint64_t num_callbacks;
+	uint64_t run_time_in_nanoseconds;
+	uint64_t idle_time_in_nanoseconds;
+	uint64_t total_callback_time_in_nanoseconds;
+	uint64_t max_lag_in_nanoseconds;
+	uint64_t max_callback_time_in_nanoseconds;
+	uint64_t lag_histogram[EVENT_LOOP_LAG_HISTOGRAM_SIZE];
+	char slowest_callback[EVENT_LOOP_CALLBACK_LOCATION_SIZE];
+} runtime_event_loop_metrics_t;
+
+typedef enum {
+	RUNTIME_WORK_STBI_LOAD_RGBA,
+	RUNTIME_WORK_STBI_ENCODE_PNG,
+	RUNTIME_WORK_OPENSSL_KDF_DERIVE,
+	RUNTIME_WORK_ICONV_CONVERT,
+	RUNTIME_WORK_TYPE_COUNT,
+} runtime_work_type_t;
+
+// Borrowed by a worker thread: Neither this nor the buffers it points to may be modified (or collected) until it is done
+typedef struct runtime_work_arguments_t {
+	const void* input;
+	size_t input_size;
+	void* output;
+	size_t output_size;
+	void* context;
+	int option;
+	int status;
+	int64_t result;
+} runtime_work_arguments_t;
+
+typedef void (*runtime_work_callback_t)(uint32_t request_id);
+
 struct static_runtime_exports_table {
 	// Build configuration
 	const char* (*runtime_version)(void);
 
 	// REPL
 	void (*runtime_repl_start)(void);
+
+	// Memory management
+	bool (*runtime_allocator_stats)(lua_allocator_stats_t* stats);
+
+	// Guest VMs
+	bool (*runtime_guest_create)(const char* name, const char* script_path, const runtime_guest_limits_t* limits);
+	bool (*runtime_guest_stats)(const char* name, runtime_guest_stats_t* stats);
+	uint64_t (*runtime_guest_accounting_window)(void);
+
+	// Event loop metrics
+	bool (*runtime_event_loop_metrics)(runtime_event_loop_metrics_t* metrics);
+	void (*runtime_event_loop_reset_peaks)(void);
+
+	// Thread pool
+	bool (*runtime_work_submit)(runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t request_id, runtime_work_callback_t on_completion);
+	size_t (*runtime_threadpool_size)(void);
 };
\ No newline at end of file
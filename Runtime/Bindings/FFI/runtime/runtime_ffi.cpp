@@ -1,6 +1,10 @@
 #include "runtime_ffi.hpp"
+#include "runtime_threadpool.hpp"
 #include "lua.hpp"
 
+#include "LuaMemoryAllocator.hpp"
+#include "SharedEventLoop.hpp"
+
 extern "C" {
 #include "luajit_repl.h"
 }
@@ -11,6 +15,11 @@ namespace runtime_ffi {
 		assignedLuaState = L;
 	}
 
+	SharedEventLoop* assignedEventLoop;
+	void assignEventLoop(SharedEventLoop* eventLoop) {
+		assignedEventLoop = eventLoop;
+	}
+
 	const char* runtime_version() {
 		return EVO_VERSION;
 	}
@@ -19,6 +28,69 @@ namespace runtime_ffi {
 		dotty(assignedLuaState);
 	}
 
+	bool runtime_allocator_stats(lua_allocator_stats_t* stats) {
+		if(!stats) return false;
+
+		// If the VM was created with luaL_newstate, there's no way to tell what LuaJIT's own allocator is doing
+		void* userdata = nullptr;
+		lua_Alloc allocator = lua_getallocf(assignedLuaState, &userdata);
+		if(allocator != &LuaMemoryAllocator::Allocate) return false;
+
+		static_cast<LuaMemoryAllocator*>(userdata)->GetStats(stats);
+		return true;
+	}
+
+	bool runtime_guest_create(const char* name, const char* script_path, const runtime_guest_limits_t* limits) {
+		if(!name || !script_path || !assignedEventLoop) return false;
+
+		runtime_guest_limits_t unlimited = {};
+		auto guest = assignedEventLoop->CreateGuest(name, limits ? *limits : unlimited);
+		if(!guest) return false;
+
+		if(guest->RunScript(script_path)) return true;
+
+		// The name can be reused afterwards, but the VM stays alive (unused) since the script may have queued some requests
+		assignedEventLoop->RemoveGuest(name);
+		return false;
+	}
+
+	bool runtime_guest_stats(const char* name, runtime_guest_stats_t* stats) {
+		if(!name || !stats || !assignedEventLoop) return false;
+
+		auto guest = assignedEventLoop->FindGuest(name);
+		if(!guest) return false;
+
+		guest->GetStats(stats);
+		return true;
+	}
+
+	uint64_t runtime_guest_accounting_window() {
+		return GUEST_ACCOUNTING_WINDOW_IN_MILLISECONDS * 1000 * 1000;
+	}
+
+	bool runtime_event_loop_metrics(runtime_event_loop_metrics_t* metrics) {
+		if(!metrics || !assignedEventLoop) return false;
+
+		assignedEventLoop->GetMetrics().GetMetrics(metrics);
+		return true;
+	}
+
+	void runtime_event_loop_reset_peaks() {
+		if(!assignedEventLoop) return;
+
+		assignedEventLoop->GetMetrics().ResetPeaks();
+	}
+
+	bool runtime_work_submit(runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t request_id, runtime_work_callback_t on_completion) {
+		if(!assignedEventLoop) return false;
+
+		return runtime_threadpool::submitWork(assignedEventLoop->GetLoop(), type, arguments, request_id, on_completion);
+	}
+
+	size_t runtime_threadpool_size() {
+		return runtime_threadpool::getThreadPoolSize();
+	}
+
 	void* getExportsTable() {
 		static struct static_runtime_exports_table exports = {
 			// Build configuration
@@ -26,6 +98,22 @@ namespace runtime_ffi {
 
 			// REPL
 			.runtime_repl_start = &runtime_repl_start,
+
+			// Memory management
+			.runtime_allocator_stats = &runtime_allocator_stats,
+
+			// Guest VMs
+			.runtime_guest_create = &runtime_guest_create,
+			.runtime_guest_stats = &runtime_guest_stats,
+			.runtime_guest_accounting_window = &runtime_guest_accounting_window,
+
+			// Event loop metrics
+			.runtime_event_loop_metrics = &runtime_event_loop_metrics,
+			.runtime_event_loop_reset_peaks = &runtime_event_loop_reset_peaks,
+
+			// Thread pool
+			.runtime_work_submit = &runtime_work_submit,
+			.runtime_threadpool_size = &runtime_threadpool_size,
 		};
 
 		return &exports;
@@ -2,10 +2,15 @@
 
 #include "lua.hpp"
 
+#include <cstdint>
+
 #include "runtime_exports.h"
 
+class SharedEventLoop;
+
 namespace runtime_ffi {
 	void assignLuaState(lua_State* L);
+	void assignEventLoop(SharedEventLoop* eventLoop);
 
 	// Build configuration
 	const char* runtime_version();
@@ -13,5 +18,21 @@ namespace runtime_ffi {
 	// REPL
 	void runtime_repl_start();
 
+	// Memory management
+	bool runtime_allocator_stats(lua_allocator_stats_t* stats);
+
+	// Guest VMs
+	bool runtime_guest_create(const char* name, const char* script_path, const runtime_guest_limits_t* limits);
+	bool runtime_guest_stats(const char* name, runtime_guest_stats_t* stats);
+	uint64_t runtime_guest_accounting_window();
+
+	// Event loop metrics
+	bool runtime_event_loop_metrics(runtime_event_loop_metrics_t* metrics);
+	void runtime_event_loop_reset_peaks();
+
+	// Thread pool
+	bool runtime_work_submit(runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t request_id, runtime_work_callback_t on_completion);
+	size_t runtime_threadpool_size();
+
 	void* getExportsTable();
 }
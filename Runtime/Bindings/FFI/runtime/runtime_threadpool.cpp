@@ -0,0 +1,116 @@
+#include "runtime_threadpool.hpp"
+
+#include "crypto_ffi.hpp"
+#include "iconv_ffi.hpp"
+#include "stbi_ffi.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace runtime_threadpool {
+
+	struct OffloadedWork {
+		uv_work_t request;
+		runtime_work_type_t type;
+		runtime_work_arguments_t* arguments;
+		uint32_t requestID;
+		runtime_work_callback_t onCompletion;
+	};
+
+	static size_t effectiveThreadPoolSize = DEFAULT_THREADPOOL_SIZE;
+
+	// Same rules as libuv's init_threads, which reads the variable only once (when the pool is started)
+	static size_t parseThreadPoolSize() {
+		char value[32];
+		size_t size = sizeof(value);
+		if(uv_os_getenv("UV_THREADPOOL_SIZE", value, &size) != 0) return DEFAULT_THREADPOOL_SIZE;
+
+		unsigned int numThreads = static_cast<unsigned int>(std::atoi(value));
+		if(numThreads == 0) return 1;
+		return std::min(static_cast<size_t>(numThreads), MAX_THREADPOOL_SIZE);
+	}
+
+	void configureThreadPoolSize() {
+		// Users can still override this, but the default is too low for batch workloads on anything but tiny machines
+		char existingValue[32];
+		size_t size = sizeof(existingValue);
+		if(uv_os_getenv("UV_THREADPOOL_SIZE", existingValue, &size) == UV_ENOENT) {
+			size_t numThreads = std::max<size_t>(uv_available_parallelism(), DEFAULT_THREADPOOL_SIZE);
+			uv_os_setenv("UV_THREADPOOL_SIZE", std::to_string(numThreads).c_str());
+		}
+
+		// Nothing has been queued yet, so this is the value that libuv will see (scripts changing it later aren't supported)
+		effectiveThreadPoolSize = parseThreadPoolSize();
+	}
+
+	size_t getThreadPoolSize() {
+		return effectiveThreadPoolSize;
+	}
+
+	static void runWork(uv_work_t* request) {
+		OffloadedWork* work = static_cast<OffloadedWork*>(request->data);
+		runtime_work_arguments_t* arguments = work->arguments;
+
+		switch(work->type) {
+		case RUNTIME_WORK_STBI_LOAD_RGBA: {
+			auto stbi = static_cast<static_stbi_exports_table*>(stbi_ffi::getExportsTable());
+			auto buffer = static_cast<stbi_readonly_file_contents_t>(arguments->input);
+			auto image = static_cast<stbi_image_t*>(arguments->output);
+			arguments->result = stbi->stbi_load_rgba(buffer, arguments->input_size, image);
+		} break;
+		case RUNTIME_WORK_STBI_ENCODE_PNG: {
+			auto stbi = static_cast<static_stbi_exports_table*>(stbi_ffi::getExportsTable());
+			auto image = static_cast<stbi_image_t*>(arguments->context);
+			auto buffer = static_cast<uint8_t*>(arguments->output);
+			arguments->result = stbi->stbi_encode_png(image, buffer, arguments->output_size, arguments->option);
+		} break;
+		case RUNTIME_WORK_OPENSSL_KDF_DERIVE: {
+			auto crypto = static_cast<static_crypto_exports_table*>(crypto_ffi::getExportsTable());
+			auto inputs = static_cast<const kdf_input_t*>(arguments->input);
+			auto parameters = static_cast<const kdf_parameters_t*>(arguments->context);
+			auto result = static_cast<kdf_result_t*>(arguments->output);
+			crypto->openssl_kdf_derive(*inputs, *parameters, result);
+			arguments->result = result->success;
+		} break;
+		case RUNTIME_WORK_ICONV_CONVERT: {
+			auto iconv = static_cast<static_iconv_exports_table*>(iconv_ffi::getExportsTable());
+			auto conversionDetails = static_cast<iconv_request_t*>(arguments->context);
+			arguments->result = iconv->iconv_convert(conversionDetails);
+		} break;
+		default:
+			break; // Can't happen since the type is validated before queueing
+		}
+	}
+
+	static void onWorkDone(uv_work_t* request, int status) {
+		OffloadedWork* work = static_cast<OffloadedWork*>(request->data);
+
+		// Must notify even if the work was cancelled, or the pinned buffers would never be released
+		work->arguments->status = status;
+		work->onCompletion(work->requestID);
+
+		delete work;
+	}
+
+	bool submitWork(uv_loop_t* loop, runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t requestID, runtime_work_callback_t onCompletion) {
+		if(!loop || !arguments || !onCompletion) return false;
+		if(type < 0 || type >= RUNTIME_WORK_TYPE_COUNT) return false;
+
+		OffloadedWork* work = new OffloadedWork();
+		work->request.data = work;
+		work->type = type;
+		work->arguments = arguments;
+		work->requestID = requestID;
+		work->onCompletion = onCompletion;
+
+		int errorCode = uv_queue_work(loop, &work->request, runWork, onWorkDone);
+		if(errorCode != 0) {
+			delete work;
+			return false;
+		}
+
+		return true;
+	}
+
+}
\ No newline at end of file
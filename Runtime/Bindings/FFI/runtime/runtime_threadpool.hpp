@@ -0,0 +1,22 @@
+#pragma once
+
+#include "runtime_ffi.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include "uv.h"
+}
+
+// Runs some of the more expensive exports on libuv's thread pool, instead of blocking the main thread's event loop
+// Only functions that are known to be thread-safe are whitelisted (and each needs an adapter to unpack the arguments)
+namespace runtime_threadpool {
+	constexpr size_t DEFAULT_THREADPOOL_SIZE = 4; // Same as libuv's
+	constexpr size_t MAX_THREADPOOL_SIZE = 1024; // Same as libuv's
+
+	void configureThreadPoolSize();
+	size_t getThreadPoolSize();
+
+	bool submitWork(uv_loop_t* loop, runtime_work_type_t type, runtime_work_arguments_t* arguments, uint32_t requestID, runtime_work_callback_t onCompletion);
+}
\ No newline at end of file
@@ -16,11 +16,16 @@ local stbi = {
 }
 
 stbi.cdefs = [[
-
+typedef void* deferred_event_queue_t; // Duplicated in the interop aliases (fix later)
 typedef unsigned char stbi_unsigned_char_t;
 typedef unsigned char* stbi_pixelbuffer_t;
 typedef unsigned char const* stbi_readonly_file_contents_t;
 
+enum {
+	// The first class starts at 64 KB, and each one after that is twice as large (smaller images aren't worth pooling)
+	STBI_POOL_NUM_SIZE_CLASSES = 11,
+};
+
 typedef enum {
 	NO_CONVERSION = 0,
 	CONVERT_TO_GREYSCALE = 1,
@@ -29,6 +34,54 @@ typedef enum {
 	CONVERT_TO_RGB_WITH_ALPHA = 4
 } stbi_color_depth_t;
 
+typedef enum {
+	STBI_SIMD_SCALAR = 0,
+	STBI_SIMD_SSE2 = 1,
+	STBI_SIMD_AVX2 = 2,
+} stbi_simd_level_t;
+
+typedef enum {
+	STBI_FILTER_BOX = 0,
+	STBI_FILTER_BILINEAR = 1,
+	STBI_FILTER_LANCZOS = 2,
+} stbi_resize_filter_t;
+
+typedef enum {
+	STBI_ROTATE_CLOCKWISE_90 = 90,
+	STBI_ROTATE_CLOCKWISE_180 = 180,
+	STBI_ROTATE_CLOCKWISE_270 = 270,
+} stbi_rotation_t;
+
+typedef enum {
+	STBI_FLIP_HORIZONTAL = 0,
+	STBI_FLIP_VERTICAL = 1,
+} stbi_flip_axis_t;
+
+typedef enum {
+	STBI_TRANSFORM_RESIZE = 0,
+	STBI_TRANSFORM_CROP = 1,
+	STBI_TRANSFORM_ROTATE = 2,
+	STBI_TRANSFORM_FLIP = 3,
+	STBI_TRANSFORM_PREMULTIPLY_ALPHA = 4,
+	STBI_TRANSFORM_CONVERT_COLOR_DEPTH = 5,
+} stbi_transform_type_t;
+
+typedef enum {
+	STBI_FORMAT_BMP = 0,
+	STBI_FORMAT_PNG = 1,
+	STBI_FORMAT_JPG = 2,
+	STBI_FORMAT_TGA = 3,
+} stbi_image_format_t;
+
+typedef enum {
+	STBI_PNG_FILTER_NONE = 0,
+	STBI_PNG_FILTER_SUB = 1,
+	STBI_PNG_FILTER_UP = 2,
+	STBI_PNG_FILTER_AVERAGE = 3,
+	STBI_PNG_FILTER_PAETH = 4,
+	STBI_PNG_FILTER_ADAPTIVE = 5,
+} stbi_png_filter_t;
+
 typedef struct stbi_color {
 	uint8_t red;
 	uint8_t green;
@@ -43,12 +96,86 @@ typedef struct {
 	int channels;
 } stbi_image_t;
 
+typedef struct {
+	stbi_transform_type_t type;
+	int offset_x;
+	int offset_y;
+	int width;
+	int height;
+	stbi_resize_filter_t filter;
+	stbi_rotation_t rotation;
+	stbi_flip_axis_t axis;
+	int channels;
+} stbi_transform_t;
+
 typedef struct {
 	uint8_t* data;
 	const size_t capacity;
 	size_t num_bytes_used;
 } luajit_stringbuffer_t;
 
+typedef struct {
+	uint8_t* data;
+	size_t size;
+	size_t capacity;
+} stbi_growable_buffer_t;
+
+typedef struct {
+	stbi_readonly_file_contents_t data;
+	size_t size;
+} stbi_file_contents_t;
+
+typedef struct {
+	const stbi_transform_t* steps;
+	size_t num_steps;
+	stbi_image_format_t format;
+	int quality;
+	size_t max_bytes_in_flight;
+	size_t max_concurrent_jobs;
+} stbi_transcoding_options_t;
+
+typedef struct {
+	int compression_level;
+	stbi_png_filter_t filter;
+} stbi_png_options_t;
+
+typedef struct {
+	size_t num_allocations;
+	size_t num_reused_allocations;
+	size_t num_unpooled_allocations;
+	size_t bytes_in_use;
+	size_t bytes_retained;
+	size_t max_bytes_retained;
+	size_t size_class_limits[STBI_POOL_NUM_SIZE_CLASSES];
+	size_t num_retained_by_size_class[STBI_POOL_NUM_SIZE_CLASSES];
+} stbi_pool_stats_t;
+
+typedef struct {
+	size_t num_mismatched_pixels;
+	double mean_absolute_difference[4];
+	uint8_t max_absolute_difference[4];
+	double mean_squared_error;
+	double peak_signal_to_noise_ratio;
+	double structural_similarity;
+} stbi_comparison_result_t;
+
+typedef struct {
+	int max_width;
+	int max_height;
+	int padding;
+} stbi_atlas_options_t;
+
+typedef struct {
+	int x;
+	int y;
+	int width;
+	int height;
+	float min_u;
+	float min_v;
+	float max_u;
+	float max_v;
+} stbi_atlas_region_t;
+
 typedef void (*stbi_write_callback_t)(void*, void*, int);
 
 struct static_stbi_exports_table {
@@ -68,6 +195,12 @@ struct static_stbi_exports_table {
 	size_t (*stbi_encode_jpg)(stbi_image_t* image, uint8_t* buffer, const size_t buffer_size, int quality);
 	size_t (*stbi_encode_tga)(stbi_image_t* image, uint8_t* buffer, const size_t buffer_size);
 
+	bool (*stbi_encode_bmp_growable)(stbi_image_t* image, stbi_growable_buffer_t* buffer);
+	bool (*stbi_encode_png_growable)(stbi_image_t* image, stbi_growable_buffer_t* buffer, const int stride);
+	bool (*stbi_encode_jpg_growable)(stbi_image_t* image, stbi_growable_buffer_t* buffer, int quality);
+	bool (*stbi_encode_tga_growable)(stbi_image_t* image, stbi_growable_buffer_t* buffer);
+	void (*stbi_growable_buffer_free)(stbi_growable_buffer_t* buffer);
+
 	void (*stbi_flip_vertically_on_write)(int flag);
 
 	size_t (*stbi_get_required_bmp_size)(stbi_image_t* image);
@@ -77,6 +210,38 @@ struct static_stbi_exports_table {
 
 	void (*stbi_abgr_to_rgba)(stbi_image_t* image);
 	void (*stbi_replace_pixel_color_rgba)(stbi_image_t* image, const stbi_color_t* source_color, const stbi_color_t* replacement_color);
+
+	stbi_simd_level_t (*stbi_get_simd_level)(void);
+	bool (*stbi_set_simd_level)(stbi_simd_level_t level);
+
+	bool (*stbi_resize_image)(const stbi_image_t* source, stbi_image_t* destination, stbi_resize_filter_t filter);
+	bool (*stbi_crop_image)(const stbi_image_t* source, stbi_image_t* destination, int offset_x, int offset_y);
+	bool (*stbi_rotate_image)(const stbi_image_t* source, stbi_image_t* destination, stbi_rotation_t rotation);
+	bool (*stbi_flip_image)(stbi_image_t* image, stbi_flip_axis_t axis);
+	bool (*stbi_premultiply_alpha)(stbi_image_t* image);
+	bool (*stbi_convert_color_depth)(const stbi_image_t* source, stbi_image_t* destination);
+	bool (*stbi_get_transformed_size)(const stbi_image_t* source, const stbi_transform_t* steps, size_t num_steps, stbi_image_t* result);
+	bool (*stbi_transform_image)(const stbi_image_t* source, const stbi_transform_t* steps, size_t num_steps, stbi_image_t* destination);
+
+	uint32_t (*stbi_transcode_batch)(deferred_event_queue_t queue, const stbi_file_contents_t* inputs, size_t num_inputs, const stbi_transcoding_options_t* options);
+	void (*stbi_release_transcoded_image)(uint8_t* data, size_t capacity);
+	size_t (*stbi_get_transcoding_memory_usage)(void);
+
+	bool (*stbi_encode_png_with_options)(stbi_image_t* image, stbi_growable_buffer_t* buffer, const stbi_png_options_t* options);
+
+	bool (*stbi_load_from_path)(const char* file_path, stbi_image_t* image, stbi_color_depth_t color_depth);
+	bool (*stbi_load_from_fd)(int fd, stbi_image_t* image, stbi_color_depth_t color_depth);
+	bool (*stbi_info_from_path)(const char* file_path, stbi_image_t* image);
+	bool (*stbi_info_from_fd)(int fd, stbi_image_t* image);
+
+	void (*stbi_get_pool_stats)(stbi_pool_stats_t* stats);
+	void (*stbi_set_pool_limit)(size_t max_bytes_retained);
+	void (*stbi_trim_pool)(void);
+
+	bool (*stbi_compare_images)(const stbi_image_t* first, const stbi_image_t* second, uint8_t tolerance, stbi_comparison_result_t* result, stbi_image_t* diff_image);
+
+	bool (*stbi_pack_atlas)(const stbi_image_t* images, size_t num_images, const stbi_atlas_options_t* options, stbi_atlas_region_t* regions, stbi_image_t* atlas);
+	bool (*stbi_render_atlas)(const stbi_image_t* images, size_t num_images, const stbi_atlas_region_t* regions, stbi_image_t* atlas);
 };
 
 ]]
@@ -0,0 +1,229 @@
+#include "stbi_atlas.hpp"
+#include "stbi_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace stbi_atlas {
+
+	// The top edge of the area that's already been filled, as a list of horizontal segments (ordered left to right)
+	struct SkylineSegment {
+		int x;
+		int y;
+		int width;
+	};
+
+	struct Placement {
+		size_t segmentIndex;
+		int x;
+		int y;
+	};
+
+	bool isValidOptions(const stbi_atlas_options_t& options) {
+		if(options.max_width <= 0 || options.max_height <= 0) return false;
+		return options.padding >= 0;
+	}
+
+	static int getNextPowerOfTwo(int value) {
+		int powerOfTwo = 1;
+		while(powerOfTwo < value && powerOfTwo < INT32_MAX / 2)
+			powerOfTwo *= 2;
+		return powerOfTwo;
+	}
+
+	// The rectangle rests on the highest segment it spans, leaving gaps under it (which is the price of being fast)
+	static bool findPlacement(const std::vector<SkylineSegment>& skyline, int atlasWidth, int maxHeight, int width, int height, Placement& bestPlacement) {
+		bool hasFoundPlacement = false;
+
+		for(size_t index = 0; index < skyline.size(); index++) {
+			int x = skyline[index].x;
+			if(x + width > atlasWidth) break;
+
+			int y = 0;
+			int remainingWidth = width;
+			for(size_t spannedIndex = index; remainingWidth > 0; spannedIndex++) {
+				y = std::max(y, skyline[spannedIndex].y);
+				remainingWidth -= skyline[spannedIndex].width;
+			}
+
+			if(y + height > maxHeight) continue;
+
+			// Bottom-left rule: prefer the lowest position, and the leftmost one if there's a tie
+			if(!hasFoundPlacement || y < bestPlacement.y) {
+				bestPlacement = { index, x, y };
+				hasFoundPlacement = true;
+			}
+		}
+
+		return hasFoundPlacement;
+	}
+
+	static void addToSkyline(std::vector<SkylineSegment>& skyline, const Placement& placement, int width, int height) {
+		SkylineSegment newSegment = { placement.x, placement.y + height, width };
+		skyline.insert(skyline.begin() + static_cast<ptrdiff_t>(placement.segmentIndex), newSegment);
+
+		// Segments that are now (partially) covered by the new one need to be shortened or removed
+		size_t index = placement.segmentIndex + 1;
+		while(index < skyline.size()) {
+			SkylineSegment& segment = skyline[index];
+			int overlap = newSegment.x + newSegment.width - segment.x;
+			if(overlap <= 0) break;
+
+			if(overlap < segment.width) {
+				segment.x += overlap;
+				segment.width -= overlap;
+				break;
+			}
+
+			skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(index));
+		}
+
+		// Adjacent segments at the same height are merged, or the skyline would keep growing (and slow down every search)
+		for(size_t segmentIndex = 0; segmentIndex + 1 < skyline.size();) {
+			if(skyline[segmentIndex].y == skyline[segmentIndex + 1].y) {
+				skyline[segmentIndex].width += skyline[segmentIndex + 1].width;
+				skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(segmentIndex + 1));
+			} else {
+				segmentIndex++;
+			}
+		}
+	}
+
+	static bool tryPackImages(const stbi_image_t* images, const std::vector<size_t>& packingOrder, int atlasWidth, const stbi_atlas_options_t& options, stbi_atlas_region_t* regions, int& usedWidth, int& usedHeight) {
+		std::vector<SkylineSegment> skyline = { { 0, 0, atlasWidth } };
+		usedWidth = 0;
+		usedHeight = 0;
+
+		for(size_t imageIndex : packingOrder) {
+			const stbi_image_t& image = images[imageIndex];
+
+			// Only the right and bottom edges are padded, since there's nothing to bleed into at the atlas borders
+			int paddedWidth = std::min(image.width + options.padding, atlasWidth);
+			int paddedHeight = image.height + options.padding;
+
+			Placement placement = {};
+			if(!findPlacement(skyline, atlasWidth, options.max_height, paddedWidth, paddedHeight, placement)) {
+				// The padding isn't needed if the image ends up at the bottom of the atlas, so try again without it
+				if(!findPlacement(skyline, atlasWidth, options.max_height, paddedWidth, image.height, placement)) return false;
+				paddedHeight = image.height;
+			}
+
+			addToSkyline(skyline, placement, paddedWidth, paddedHeight);
+			regions[imageIndex].x = placement.x;
+			regions[imageIndex].y = placement.y;
+			regions[imageIndex].width = image.width;
+			regions[imageIndex].height = image.height;
+			usedWidth = std::max(usedWidth, placement.x + image.width);
+			usedHeight = std::max(usedHeight, placement.y + image.height);
+		}
+
+		return true;
+	}
+
+	bool packImages(const stbi_image_t* images, size_t numImages, const stbi_atlas_options_t& options, stbi_atlas_region_t* regions, stbi_image_t& atlas) {
+		if(!isValidOptions(options)) return false;
+		if(numImages == 0) return false;
+
+		size_t totalArea = 0;
+		int maxImageWidth = 0;
+		for(size_t index = 0; index < numImages; index++) {
+			const stbi_image_t& image = images[index];
+			if(image.width <= 0 || image.height <= 0) return false;
+			if(image.width > options.max_width || image.height > options.max_height) return false;
+
+			size_t paddedWidth = static_cast<size_t>(image.width) + static_cast<size_t>(options.padding);
+			size_t paddedHeight = static_cast<size_t>(image.height) + static_cast<size_t>(options.padding);
+			totalArea += paddedWidth * paddedHeight;
+			maxImageWidth = std::max(maxImageWidth, image.width);
+		}
+
+		// Tallest images first, since they would otherwise leave the largest gaps under the skyline
+		std::vector<size_t> packingOrder(numImages);
+		std::iota(packingOrder.begin(), packingOrder.end(), 0);
+		std::stable_sort(packingOrder.begin(), packingOrder.end(), [images](size_t first, size_t second) {
+			if(images[first].height != images[second].height) return images[first].height > images[second].height;
+			return images[first].width > images[second].width;
+		});
+
+		// A square atlas would need at least this width, but the images won't fit perfectly (so it's likely to grow)
+		int minimumWidth = static_cast<int>(std::sqrt(static_cast<double>(totalArea)));
+		int atlasWidth = std::min(getNextPowerOfTwo(std::max(minimumWidth, maxImageWidth)), options.max_width);
+
+		// The atlas is cropped to the area that's actually used, since there's no point in wasting memory on the rest
+		while(true) {
+			int usedWidth = 0, usedHeight = 0;
+			if(tryPackImages(images, packingOrder, atlasWidth, options, regions, usedWidth, usedHeight)) {
+				atlas.width = usedWidth;
+				atlas.height = usedHeight;
+				atlas.channels = ATLAS_CHANNELS;
+				break;
+			}
+
+			if(atlasWidth == options.max_width) return false;
+			atlasWidth = std::min(atlasWidth * 2, options.max_width);
+		}
+
+		for(size_t index = 0; index < numImages; index++) {
+			stbi_atlas_region_t& region = regions[index];
+			region.min_u = static_cast<float>(region.x) / static_cast<float>(atlas.width);
+			region.min_v = static_cast<float>(region.y) / static_cast<float>(atlas.height);
+			region.max_u = static_cast<float>(region.x + region.width) / static_cast<float>(atlas.width);
+			region.max_v = static_cast<float>(region.y + region.height) / static_cast<float>(atlas.height);
+		}
+
+		return true;
+	}
+
+	// Images with fewer channels are expanded the same way stb_image does it (greyscale is replicated, alpha is opaque)
+	static void copyRow(const uint8_t* source, int numChannels, int width, uint8_t* destination) {
+		if(numChannels == ATLAS_CHANNELS) {
+			memcpy(destination, source, static_cast<size_t>(width) * ATLAS_CHANNELS);
+			return;
+		}
+
+		for(int x = 0; x < width; x++, source += numChannels, destination += ATLAS_CHANNELS) {
+			bool isGreyscale = numChannels < 3;
+			destination[0] = source[0];
+			destination[1] = isGreyscale ? source[0] : source[1];
+			destination[2] = isGreyscale ? source[0] : source[2];
+			destination[3] = (numChannels == 2) ? source[1] : 255;
+		}
+	}
+
+	bool renderImages(const stbi_image_t* images, size_t numImages, const stbi_atlas_region_t* regions, stbi_image_t& atlas) {
+		if(!atlas.data) return false;
+		if(atlas.width <= 0 || atlas.height <= 0 || atlas.channels != ATLAS_CHANNELS) return false;
+
+		for(size_t index = 0; index < numImages; index++) {
+			const stbi_image_t& image = images[index];
+			const stbi_atlas_region_t& region = regions[index];
+			if(!stbi_transform::isValidImage(image)) return false;
+			if(region.width != image.width || region.height != image.height) return false;
+			if(region.x < 0 || region.y < 0) return false;
+			if(region.x + region.width > atlas.width || region.y + region.height > atlas.height) return false;
+		}
+
+		// Padding and unused areas must be transparent, or they'll show up when the atlas is sampled with filtering
+		size_t atlasRowSize = static_cast<size_t>(atlas.width) * ATLAS_CHANNELS;
+		memset(atlas.data, 0, atlasRowSize * static_cast<size_t>(atlas.height));
+
+		for(size_t index = 0; index < numImages; index++) {
+			const stbi_image_t& image = images[index];
+			const stbi_atlas_region_t& region = regions[index];
+			size_t imageRowSize = static_cast<size_t>(image.width) * static_cast<size_t>(image.channels);
+
+			for(int y = 0; y < image.height; y++) {
+				const uint8_t* sourceRow = image.data + static_cast<size_t>(y) * imageRowSize;
+				uint8_t* destinationRow = atlas.data + static_cast<size_t>(region.y + y) * atlasRowSize + static_cast<size_t>(region.x) * ATLAS_CHANNELS;
+				copyRow(sourceRow, image.channels, image.width, destinationRow);
+			}
+		}
+
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+#include "stbi_ffi.hpp" // For the atlas types (the exports header lacks include guards)
+
+// Uploading lots of tiny images (icons, UI decorations) one by one is wasteful, so they can be packed into a single atlas
+// Packing only needs the image dimensions, so layouts can also be computed offline and baked into the application bundle
+namespace stbi_atlas {
+	constexpr int ATLAS_CHANNELS = 4;
+
+	bool isValidOptions(const stbi_atlas_options_t& options);
+
+	// Skyline bottom-left heuristic, trying wider atlases (powers of two) until all images fit
+	bool packImages(const stbi_image_t* images, size_t numImages, const stbi_atlas_options_t& options, stbi_atlas_region_t* regions, stbi_image_t& atlas);
+	bool renderImages(const stbi_image_t* images, size_t numImages, const stbi_atlas_region_t* regions, stbi_image_t& atlas);
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "stbi_batch.hpp"
+#include "stbi_transform.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace stbi_batch {
+
+	// Only the inputs and options are shared with the worker threads, and they're never modified after submission
+	struct TranscodingBatch {
+		uint32_t id;
+		deferred_event_queue_t queue;
+		std::vector<stbi_file_contents_t> inputs;
+		std::vector<stbi_transform_t> steps;
+		stbi_image_format_t format;
+		int quality;
+		size_t maxBytesInFlight;
+		size_t maxConcurrentJobs;
+		size_t nextInputIndex = 0;
+		size_t nextInputEstimatedSize = 0;
+		bool hasNextInputEstimate = false;
+		size_t numActiveJobs = 0;
+		size_t numCompletedJobs = 0;
+	};
+
+	struct TranscodingJob {
+		uv_work_t request;
+		TranscodingBatch* batch;
+		size_t index;
+		size_t estimatedSize;
+		stbi_growable_buffer_t result;
+		int width;
+		int height;
+		bool success;
+	};
+
+	static uv_loop_t* assignedLoop = nullptr;
+	static uint32_t nextBatchID = 1;
+	static size_t numBytesInFlight = 0;
+	static std::vector<std::unique_ptr<TranscodingBatch>> activeBatches;
+
+	static void scheduleJobs();
+
+	static static_stbi_exports_table* getStbiExports() {
+		return static_cast<static_stbi_exports_table*>(stbi_ffi::getExportsTable());
+	}
+
+	void assignEventLoop(uv_loop_t* loop) {
+		assignedLoop = loop;
+	}
+
+	size_t getNumBytesInFlight() {
+		return numBytesInFlight;
+	}
+
+	// Reading the header is cheap, and it's enough to tell how much memory the pipeline will need (roughly)
+	static size_t estimateMemoryUsage(const TranscodingBatch& batch, const stbi_file_contents_t& input) {
+		stbi_image_t image = {};
+		if(!getStbiExports()->stbi_image_info(input.data, input.size, &image)) return 0; // Will fail fast, anyway
+
+		// Only the dimensions are needed here, but the pointer must be set or the image would be considered invalid
+		image.data = const_cast<stbi_pixelbuffer_t>(input.data);
+		image.channels = 4;
+		size_t decodedSize = static_cast<size_t>(image.width) * static_cast<size_t>(image.height) * 4;
+
+		stbi_image_t result = {};
+		if(!stbi_transform::getTransformedSize(image, batch.steps.data(), batch.steps.size(), result)) return decodedSize;
+		size_t transformedSize = static_cast<size_t>(result.width) * static_cast<size_t>(result.height) * static_cast<size_t>(result.channels);
+
+		// Scratch buffer, transformed pixels, and the encoded file (which is unlikely to be larger than the raw pixels)
+		return decodedSize + 3 * transformedSize;
+	}
+
+	static bool encodeImage(const TranscodingBatch& batch, stbi_image_t& image, stbi_growable_buffer_t* result) {
+		static_stbi_exports_table* stbi = getStbiExports();
+
+		switch(batch.format) {
+		case STBI_FORMAT_BMP:
+			return stbi->stbi_encode_bmp_growable(&image, result);
+		case STBI_FORMAT_PNG:
+			return stbi->stbi_encode_png_growable(&image, result, 0);
+		case STBI_FORMAT_JPG:
+			return stbi->stbi_encode_jpg_growable(&image, result, batch.quality);
+		case STBI_FORMAT_TGA:
+			return stbi->stbi_encode_tga_growable(&image, result);
+		}
+
+		return false;
+	}
+
+	// Runs on one of the thread pool's workers
+	static void transcodeImage(uv_work_t* request) {
+		TranscodingJob* job = static_cast<TranscodingJob*>(request->data);
+		const TranscodingBatch& batch = *job->batch;
+		const stbi_file_contents_t& input = batch.inputs[job->index];
+		static_stbi_exports_table* stbi = getStbiExports();
+
+		stbi_image_t decodedImage = {};
+		if(!stbi->stbi_load_rgba(input.data, input.size, &decodedImage)) return;
+		decodedImage.channels = 4; // stb_image reports the number of channels in the file, not the converted ones
+
+		// All workers are already busy with other images, so splitting them up further would just add overhead
+		stbi_transform::setParallelExecutionEnabled(false);
+
+		stbi_image_t transformedImage = decodedImage;
+		std::vector<uint8_t> transformedPixels;
+		if(!batch.steps.empty()) {
+			bool success = stbi_transform::getTransformedSize(decodedImage, batch.steps.data(), batch.steps.size(), transformedImage);
+			if(success) {
+				transformedPixels.resize(static_cast<size_t>(transformedImage.width) * transformedImage.height * transformedImage.channels);
+				transformedImage.data = transformedPixels.data();
+				success = stbi_transform::applyTransforms(decodedImage, batch.steps.data(), batch.steps.size(), transformedImage);
+			}
+
+			if(!success) {
+				stbi_transform::setParallelExecutionEnabled(true);
+				stbi->stbi_image_free(&decodedImage);
+				return;
+			}
+		}
+
+		job->success = encodeImage(batch, transformedImage, &job->result);
+		job->width = transformedImage.width;
+		job->height = transformedImage.height;
+
+		stbi_transform::setParallelExecutionEnabled(true);
+		stbi->stbi_image_free(&decodedImage);
+	}
+
+	static void pushTranscodingEvent(TranscodingJob* job) {
+		image_transcoding_event_t details = {};
+		details.type = IMAGE_TRANSCODING_EVENT;
+		details.batch_id = job->batch->id;
+		details.index = job->index;
+		details.success = job->success;
+		details.width = job->width;
+		details.height = job->height;
+		details.data = job->result.data;
+		details.size = job->result.size;
+		details.capacity = job->result.capacity;
+
+		deferred_event_t event;
+		event.image_transcoding_details = details;
+		job->batch->queue->push(event);
+	}
+
+	// Runs on the main thread, so the bookkeeping and the (non-thread-safe) event queue don't require any locking
+	static void onImageTranscoded(uv_work_t* request, int status) {
+		TranscodingJob* job = static_cast<TranscodingJob*>(request->data);
+		TranscodingBatch* batch = job->batch;
+
+		if(!job->success) {
+			free(job->result.data);
+			job->result = {};
+		}
+
+		// The estimate is replaced by the actual size, which remains in flight until the result has been released
+		numBytesInFlight -= std::min(numBytesInFlight, job->estimatedSize);
+		numBytesInFlight += job->result.capacity;
+
+		pushTranscodingEvent(job);
+		delete job;
+
+		batch->numActiveJobs--;
+		batch->numCompletedJobs++;
+
+		std::erase_if(activeBatches, [](const std::unique_ptr<TranscodingBatch>& candidate) {
+			return candidate->numCompletedJobs == candidate->inputs.size();
+		});
+
+		scheduleJobs();
+	}
+
+	static bool startNextJob(TranscodingBatch& batch) {
+		if(!batch.hasNextInputEstimate) {
+			batch.nextInputEstimatedSize = estimateMemoryUsage(batch, batch.inputs[batch.nextInputIndex]);
+			batch.hasNextInputEstimate = true;
+		}
+
+		// Images that exceed the budget on their own can't ever fit, so they're processed once nothing else is in flight
+		bool isWithinBudget = numBytesInFlight + batch.nextInputEstimatedSize <= batch.maxBytesInFlight;
+		if(!isWithinBudget && numBytesInFlight > 0) return false;
+
+		TranscodingJob* job = new TranscodingJob();
+		job->request.data = job;
+		job->batch = &batch;
+		job->index = batch.nextInputIndex;
+		job->estimatedSize = batch.nextInputEstimatedSize;
+
+		batch.nextInputIndex++;
+		batch.hasNextInputEstimate = false;
+		batch.numActiveJobs++;
+		numBytesInFlight += job->estimatedSize;
+
+		// Can't fail unless the work callback is missing, but it's better not to lose track of the image if it does
+		int status = uv_queue_work(assignedLoop, &job->request, transcodeImage, onImageTranscoded);
+		if(status != 0) {
+			numBytesInFlight -= job->estimatedSize;
+			batch.numActiveJobs--;
+			batch.nextInputIndex--;
+			delete job;
+			return false;
+		}
+
+		return true;
+	}
+
+	static void scheduleJobs() {
+		// Batches are scheduled in order, so that a large one can't be starved by others that were submitted later
+		for(size_t index = 0; index < activeBatches.size(); index++) {
+			TranscodingBatch& batch = *activeBatches[index];
+			while(batch.nextInputIndex < batch.inputs.size() && batch.numActiveJobs < batch.maxConcurrentJobs) {
+				if(!startNextJob(batch)) return;
+			}
+		}
+	}
+
+	uint32_t submitBatch(deferred_event_queue_t queue, const stbi_file_contents_t* inputs, size_t numInputs, const stbi_transcoding_options_t& options) {
+		if(!assignedLoop) return 0;
+		if(numInputs == 0) return 0;
+		if(!options.steps && options.num_steps > 0) return 0;
+		if(options.format < STBI_FORMAT_BMP || options.format > STBI_FORMAT_TGA) return 0;
+
+		auto batch = std::make_unique<TranscodingBatch>();
+		batch->id = nextBatchID++;
+		batch->queue = queue;
+		batch->inputs.assign(inputs, inputs + numInputs);
+		batch->steps.assign(options.steps, options.steps + options.num_steps);
+		batch->format = options.format;
+		batch->quality = options.quality;
+		batch->maxBytesInFlight = (options.max_bytes_in_flight > 0) ? options.max_bytes_in_flight : SIZE_MAX;
+		batch->maxConcurrentJobs = std::max<size_t>(options.max_concurrent_jobs, 1);
+
+		uint32_t batchID = batch->id;
+		activeBatches.push_back(std::move(batch));
+		scheduleJobs();
+
+		return batchID;
+	}
+
+	void releaseTranscodedImage(uint8_t* data, size_t capacity) {
+		free(data);
+
+		numBytesInFlight -= std::min(numBytesInFlight, capacity);
+		scheduleJobs();
+	}
+
+}
\ No newline at end of file
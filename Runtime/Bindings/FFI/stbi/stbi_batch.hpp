@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "stbi_ffi.hpp" // For the batch options (the exports header lacks include guards)
+
+extern "C" {
+#include "uv.h"
+}
+
+// Transcodes many images (decode, transform, encode) on libuv's thread pool while the main thread keeps going
+// Results are pushed to the given event queue as they come in, and the scheduling happens on the main thread only
+namespace stbi_batch {
+	void assignEventLoop(uv_loop_t* loop);
+
+	uint32_t submitBatch(deferred_event_queue_t queue, const stbi_file_contents_t* inputs, size_t numInputs, const stbi_transcoding_options_t& options);
+	void releaseTranscodedImage(uint8_t* data, size_t capacity);
+
+	size_t getNumBytesInFlight();
+}
\ No newline at end of file
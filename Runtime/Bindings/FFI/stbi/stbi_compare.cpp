@@ -0,0 +1,99 @@
+#include "stbi_compare.hpp"
+#include "stbi_simd.hpp"
+#include "stbi_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stbi_compare {
+
+	// Constants from the original paper (Wang et al., 2004), assuming 8-bit channels
+	constexpr double SSIM_C1 = (0.01 * 255) * (0.01 * 255);
+	constexpr double SSIM_C2 = (0.03 * 255) * (0.03 * 255);
+
+	// Same weights as the color depth conversion, so that a greyscale image compares equal to its RGB source
+	static double getLuminance(const stbi_image_t& image, size_t x, size_t y) {
+		const uint8_t* pixel = image.data + (y * static_cast<size_t>(image.width) + x) * static_cast<size_t>(image.channels);
+		if(image.channels < 3) return pixel[0];
+		return static_cast<double>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+	}
+
+	double computeStructuralSimilarity(const stbi_image_t& first, const stbi_image_t& second) {
+		size_t width = static_cast<size_t>(first.width);
+		size_t height = static_cast<size_t>(first.height);
+
+		double sumOfSimilarities = 0;
+		size_t numWindows = 0;
+
+		// Windows at the right and bottom edges may be smaller, but that's better than ignoring the pixels there
+		for(size_t windowY = 0; windowY < height; windowY += SSIM_WINDOW_SIZE) {
+			for(size_t windowX = 0; windowX < width; windowX += SSIM_WINDOW_SIZE) {
+				size_t endX = std::min(windowX + SSIM_WINDOW_SIZE, width);
+				size_t endY = std::min(windowY + SSIM_WINDOW_SIZE, height);
+
+				double sumFirst = 0, sumSecond = 0;
+				double sumFirstSquared = 0, sumSecondSquared = 0, sumProducts = 0;
+				for(size_t y = windowY; y < endY; y++) {
+					for(size_t x = windowX; x < endX; x++) {
+						double firstLuminance = getLuminance(first, x, y);
+						double secondLuminance = getLuminance(second, x, y);
+
+						sumFirst += firstLuminance;
+						sumSecond += secondLuminance;
+						sumFirstSquared += firstLuminance * firstLuminance;
+						sumSecondSquared += secondLuminance * secondLuminance;
+						sumProducts += firstLuminance * secondLuminance;
+					}
+				}
+
+				double numSamples = static_cast<double>((endX - windowX) * (endY - windowY));
+				double meanFirst = sumFirst / numSamples;
+				double meanSecond = sumSecond / numSamples;
+				double varianceFirst = sumFirstSquared / numSamples - meanFirst * meanFirst;
+				double varianceSecond = sumSecondSquared / numSamples - meanSecond * meanSecond;
+				double covariance = sumProducts / numSamples - meanFirst * meanSecond;
+
+				double numerator = (2 * meanFirst * meanSecond + SSIM_C1) * (2 * covariance + SSIM_C2);
+				double denominator = (meanFirst * meanFirst + meanSecond * meanSecond + SSIM_C1) * (varianceFirst + varianceSecond + SSIM_C2);
+				sumOfSimilarities += numerator / denominator;
+				numWindows++;
+			}
+		}
+
+		return sumOfSimilarities / static_cast<double>(numWindows);
+	}
+
+	bool compareImages(const stbi_image_t& first, const stbi_image_t& second, uint8_t tolerance, stbi_comparison_result_t& result, stbi_image_t* diffImage) {
+		if(!stbi_transform::isValidImage(first) || !stbi_transform::isValidImage(second)) return false;
+		if(first.width != second.width || first.height != second.height) return false;
+		if(first.channels != second.channels) return false;
+		if(diffImage && !diffImage->data) return false;
+
+		uint8_t* diffPixels = nullptr;
+		if(diffImage) {
+			diffImage->width = first.width;
+			diffImage->height = first.height;
+			diffImage->channels = first.channels;
+			diffPixels = diffImage->data;
+		}
+
+		size_t numPixels = static_cast<size_t>(first.width) * static_cast<size_t>(first.height);
+		size_t numChannels = static_cast<size_t>(first.channels);
+		stbi_simd::PixelDifferenceStats stats = {};
+		stbi_simd::comparePixels(first.data, second.data, numPixels, numChannels, tolerance, diffPixels, stats);
+
+		result = {};
+		result.num_mismatched_pixels = stats.numMismatchedPixels;
+		for(size_t channel = 0; channel < numChannels; channel++) {
+			result.mean_absolute_difference[channel] = static_cast<double>(stats.sumOfAbsoluteDifferences[channel]) / static_cast<double>(numPixels);
+			result.max_absolute_difference[channel] = stats.maxAbsoluteDifference[channel];
+		}
+
+		result.mean_squared_error = static_cast<double>(stats.sumOfSquaredDifferences) / static_cast<double>(numPixels * numChannels);
+		result.peak_signal_to_noise_ratio = (result.mean_squared_error > 0) ? 10 * std::log10(255.0 * 255.0 / result.mean_squared_error) : INFINITY;
+		result.structural_similarity = computeStructuralSimilarity(first, second);
+
+		return true;
+	}
+
+}
\ No newline at end of file
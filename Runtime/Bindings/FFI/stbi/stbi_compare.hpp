@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+#include "stbi_ffi.hpp" // For the comparison results (the exports header lacks include guards)
+
+// Snapshot tests need to know how far off an image is (and where), since encoders and scalers rarely agree bit for bit
+// The per-pixel metrics use the SIMD kernels, while SSIM is computed on the luminance in non-overlapping 8x8 windows
+namespace stbi_compare {
+	constexpr int SSIM_WINDOW_SIZE = 8;
+
+	bool compareImages(const stbi_image_t& first, const stbi_image_t& second, uint8_t tolerance, stbi_comparison_result_t& result, stbi_image_t* diffImage);
+	double computeStructuralSimilarity(const stbi_image_t& first, const stbi_image_t& second);
+}
\ No newline at end of file
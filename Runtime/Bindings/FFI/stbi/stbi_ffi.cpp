@@ -1,13 +1,27 @@
 #include "macros.hpp"
+#include "stbi_atlas.hpp"
+#include "stbi_batch.hpp"
+#include "stbi_compare.hpp"
 #include "stbi_ffi.hpp"
-
+#include "stbi_jpeg.hpp"
+#include "stbi_png.hpp"
+#include "stbi_pool.hpp"
+#include "stbi_simd.hpp"
+#include "stbi_stream.hpp"
+#include "stbi_transform.hpp"
+
+// Decoded pixels end up in pooled buffers, which are recycled once the image has been freed
+#define STBI_MALLOC(size) stbi_pool::allocate(size)
+#define STBI_REALLOC(pointer, newSize) stbi_pool::reallocate(pointer, newSize)
+#define STBI_FREE(pointer) stbi_pool::release(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
-#include <utility>
+#include <algorithm>
+#include <cstring>
 
 const char* stbi_version() {
 	// There's no versioned releases or semver here, so this is as good as it gets
@@ -61,6 +75,54 @@ bool stbi_load_monochrome_with_alpha(stbi_readonly_file_contents_t buffer, const
 	return image->data != nullptr;
 }
 
+bool stbi_load_from_path(const char* file_path, stbi_image_t* image, stbi_color_depth_t color_depth) {
+	if(!file_path) return false;
+	if(!image) return false;
+
+	uv_file fd;
+	if(!stbi_stream::openFile(file_path, fd)) return false;
+
+	stbi_stream::FileReader reader;
+	stbi_stream::initializeReader(reader, fd, stbi_stream::DEFAULT_READ_BUFFER_SIZE, SIZE_MAX);
+	bool success = stbi_stream::loadImage(reader, *image, color_depth);
+
+	stbi_stream::closeFile(fd);
+	return success;
+}
+
+bool stbi_load_from_fd(int fd, stbi_image_t* image, stbi_color_depth_t color_depth) {
+	if(fd < 0) return false;
+	if(!image) return false;
+
+	stbi_stream::FileReader reader;
+	stbi_stream::initializeReader(reader, fd, stbi_stream::DEFAULT_READ_BUFFER_SIZE, SIZE_MAX);
+	return stbi_stream::loadImage(reader, *image, color_depth);
+}
+
+bool stbi_info_from_path(const char* file_path, stbi_image_t* image) {
+	if(!file_path) return false;
+	if(!image) return false;
+
+	uv_file fd;
+	if(!stbi_stream::openFile(file_path, fd)) return false;
+
+	stbi_stream::FileReader reader;
+	stbi_stream::initializeReader(reader, fd, stbi_stream::HEADER_READ_BUFFER_SIZE, stbi_stream::MAX_HEADER_SIZE);
+	bool success = stbi_stream::readImageInfo(reader, *image);
+
+	stbi_stream::closeFile(fd);
+	return success;
+}
+
+bool stbi_info_from_fd(int fd, stbi_image_t* image) {
+	if(fd < 0) return false;
+	if(!image) return false;
+
+	stbi_stream::FileReader reader;
+	stbi_stream::initializeReader(reader, fd, stbi_stream::HEADER_READ_BUFFER_SIZE, stbi_stream::MAX_HEADER_SIZE);
+	return stbi_stream::readImageInfo(reader, *image);
+}
+
 bool stbi_image_free(stbi_image_t* image) {
 	if(!image) return false;
 	if(!image->data) return false;
@@ -95,18 +157,52 @@ size_t stbi_encode_bmp(stbi_image_t* image, uint8_t* buffer, const size_t buffer
 	return result.num_bytes_used;
 }
 
+struct fixed_buffer_writer_t {
+	luajit_stringbuffer_t* buffer;
+	bool has_failed;
+};
+
+// The PNG encoder streams its output, so running out of space halfway through must fail the whole encoding
+static void append_to_fixed_buffer(void* context, void* chunk, int chunk_size) {
+	fixed_buffer_writer_t* writer = static_cast<fixed_buffer_writer_t*>(context);
+	if(writer->has_failed) return;
+
+	luajit_stringbuffer_t* result = writer->buffer;
+	if(result->num_bytes_used + chunk_size > result->capacity) {
+		writer->has_failed = true;
+		return;
+	}
+
+	memcpy(result->data + result->num_bytes_used, chunk, chunk_size);
+	result->num_bytes_used += chunk_size;
+}
+
+// Doesn't touch any of stb_image_write's globals, which is why it can be offloaded to the thread pool
 size_t stbi_encode_png(stbi_image_t* image, uint8_t* buffer, const size_t buffer_size, const int stride) {
 	if(!buffer) return 0;
 	if(!image) return 0;
 	if(!image->data) return 0;
 
 	luajit_stringbuffer_t result = { buffer, buffer_size, 0 };
-	auto write_callback = reinterpret_cast<stbi_write_callback_t>(append_to_buffer);
-	stbi_write_png_to_func(write_callback, &result, image->width, image->height, image->channels, image->data, stride);
+	fixed_buffer_writer_t writer = { &result, false };
+	bool success = stbi_png::encodeImage(*image, stbi_png::DEFAULT_OPTIONS, stride, append_to_fixed_buffer, &writer);
+	if(!success || writer.has_failed) return 0;
 
 	return result.num_bytes_used;
 }
 
+// Very large images are split into strips that are encoded in parallel, which stb_image_write can't do
+static int write_jpg_to_func(stbi_write_callback_t write_callback, void* context, stbi_image_t* image, int quality) {
+	if(stbi_jpeg::shouldEncodeInParallel(*image)) return stbi_jpeg::encodeImage(*image, quality, write_callback, context);
+	return stbi_write_jpg_to_func(write_callback, context, image->width, image->height, image->channels, image->data, quality);
+}
+
+static void flip_vertically_on_write(int flag) {
+	stbi_flip_vertically_on_write(flag);
+	stbi_jpeg::setFlipVertically(flag != 0);
+	stbi_png::setFlipVertically(flag != 0);
+}
+
 size_t stbi_encode_jpg(stbi_image_t* image, uint8_t* buffer, const size_t buffer_size, int quality) {
 	if(!buffer) return 0;
 	if(!image) return 0;
@@ -116,7 +212,7 @@ size_t stbi_encode_jpg(stbi_image_t* image, uint8_t* buffer, const size_t buffer
 
 	luajit_stringbuffer_t result = { buffer, buffer_size, 0 };
 	auto write_callback = reinterpret_cast<stbi_write_callback_t>(append_to_buffer);
-	stbi_write_jpg_to_func(write_callback, &result, image->width, image->height, image->channels, image->data, quality);
+	write_jpg_to_func(write_callback, &result, image, quality);
 
 	return result.num_bytes_used;
 }
@@ -133,6 +229,113 @@ size_t stbi_encode_tga(stbi_image_t* image, uint8_t* buffer, const size_t buffer
 	return result.num_bytes_used;
 }
 
+struct growable_buffer_writer_t {
+	stbi_growable_buffer_t* buffer;
+	bool has_failed;
+};
+
+static bool reserve_growable_buffer(stbi_growable_buffer_t* buffer, size_t required_capacity) {
+	if(required_capacity <= buffer->capacity) return true;
+
+	// Doubling keeps the number of reallocations (and copies) logarithmic, even if the estimate was way off
+	size_t new_capacity = std::max(required_capacity, buffer->capacity * 2);
+	uint8_t* new_data = static_cast<uint8_t*>(realloc(buffer->data, new_capacity));
+	if(!new_data) return false;
+
+	buffer->data = new_data;
+	buffer->capacity = new_capacity;
+	return true;
+}
+
+static void append_to_growable_buffer(void* context, void* chunk, int chunk_size) {
+	growable_buffer_writer_t* writer = static_cast<growable_buffer_writer_t*>(context);
+	if(writer->has_failed) return;
+
+	stbi_growable_buffer_t* buffer = writer->buffer;
+	if(!reserve_growable_buffer(buffer, buffer->size + chunk_size)) {
+		writer->has_failed = true;
+		return;
+	}
+
+	memcpy(buffer->data + buffer->size, chunk, chunk_size);
+	buffer->size += chunk_size;
+}
+
+// Only a rough guess, but it avoids most reallocations without requiring a separate pass just to count bytes
+static size_t estimate_encoded_size(stbi_image_t* image, bool is_compressed) {
+	size_t raw_size = static_cast<size_t>(image->width) * static_cast<size_t>(image->height) * static_cast<size_t>(image->channels);
+	const size_t MAX_HEADER_SIZE = 1024;
+	return (is_compressed ? raw_size / 4 : raw_size) + MAX_HEADER_SIZE;
+}
+
+static bool start_growable_encoding(stbi_image_t* image, stbi_growable_buffer_t* buffer, bool is_compressed) {
+	if(!image) return false;
+	if(!image->data) return false;
+	if(!buffer) return false;
+
+	// Buffers can be reused to avoid hitting the allocator every time, so any previous contents are discarded
+	buffer->size = 0;
+	return reserve_growable_buffer(buffer, estimate_encoded_size(image, is_compressed));
+}
+
+bool stbi_encode_bmp_growable(stbi_image_t* image, stbi_growable_buffer_t* buffer) {
+	if(!start_growable_encoding(image, buffer, false)) return false;
+
+	growable_buffer_writer_t writer = { buffer, false };
+	int success = stbi_write_bmp_to_func(append_to_growable_buffer, &writer, image->width, image->height, image->channels, image->data);
+
+	return success && !writer.has_failed;
+}
+
+bool stbi_encode_png_growable(stbi_image_t* image, stbi_growable_buffer_t* buffer, const int stride) {
+	if(!start_growable_encoding(image, buffer, true)) return false;
+
+	growable_buffer_writer_t writer = { buffer, false };
+	int success = stbi_write_png_to_func(append_to_growable_buffer, &writer, image->width, image->height, image->channels, image->data, stride);
+
+	return success && !writer.has_failed;
+}
+
+bool stbi_encode_jpg_growable(stbi_image_t* image, stbi_growable_buffer_t* buffer, int quality) {
+	if(!start_growable_encoding(image, buffer, true)) return false;
+
+	if(quality < 0 || quality > 100) quality = 100;
+
+	growable_buffer_writer_t writer = { buffer, false };
+	int success = write_jpg_to_func(append_to_growable_buffer, &writer, image, quality);
+
+	return success && !writer.has_failed;
+}
+
+bool stbi_encode_tga_growable(stbi_image_t* image, stbi_growable_buffer_t* buffer) {
+	if(!start_growable_encoding(image, buffer, false)) return false;
+
+	growable_buffer_writer_t writer = { buffer, false };
+	int success = stbi_write_tga_to_func(append_to_growable_buffer, &writer, image->width, image->height, image->channels, image->data);
+
+	return success && !writer.has_failed;
+}
+
+bool stbi_encode_png_with_options(stbi_image_t* image, stbi_growable_buffer_t* buffer, const stbi_png_options_t* options) {
+	if(!options) return false;
+	if(!stbi_png::isValidOptions(*options)) return false;
+	if(!start_growable_encoding(image, buffer, true)) return false;
+
+	growable_buffer_writer_t writer = { buffer, false };
+	bool success = stbi_png::encodeImage(*image, *options, 0, append_to_growable_buffer, &writer);
+
+	return success && !writer.has_failed;
+}
+
+void stbi_growable_buffer_free(stbi_growable_buffer_t* buffer) {
+	if(!buffer) return;
+
+	free(buffer->data);
+	buffer->data = nullptr;
+	buffer->size = 0;
+	buffer->capacity = 0;
+}
+
 // There's no more reliable way to get the required buffer size AFAICT
 static void count_bytes(void* context, void* data, int size) {
 	size_t* byte_counter = static_cast<size_t*>(context);
@@ -157,7 +360,7 @@ size_t stbi_get_required_png_size(stbi_image_t* image, const int stride) {
 
 	size_t byte_counter = 0;
 
-	int success = stbi_write_png_to_func(count_bytes, &byte_counter, image->width, image->height, image->channels, image->data, stride);
+	bool success = stbi_png::encodeImage(*image, stbi_png::DEFAULT_OPTIONS, stride, count_bytes, &byte_counter);
 	if(!success) return 0;
 
 	return byte_counter;
@@ -169,7 +372,7 @@ size_t stbi_get_required_jpg_size(stbi_image_t* image, int quality) {
 
 	size_t byte_counter = 0;
 
-	int success = stbi_write_jpg_to_func(count_bytes, &byte_counter, image->width, image->height, image->channels, image->data, quality);
+	int success = write_jpg_to_func(count_bytes, &byte_counter, image, quality);
 	if(!success) return 0;
 
 	return byte_counter;
@@ -187,21 +390,13 @@ size_t stbi_get_required_tga_size(stbi_image_t* image) {
 	return byte_counter;
 }
 
-const size_t ABGR_RED_INDEX = 3;
-const size_t ABGR_GREEN_INDEX = 2;
-const size_t ABGR_BLUE_INDEX = 1;
-const size_t ABGR_ALPHA_INDEX = 0;
-
 void stbi_abgr_to_rgba(stbi_image_t* image) {
 	if(!image) return;
 	if(!image->data) return;
 
+	// Swapping ABGR to RGBA just reverses the byte order of each pixel, which can be done with a single shuffle
 	const size_t num_pixels = static_cast<size_t>(image->width) * static_cast<size_t>(image->height);
-	for(size_t i = 0; i < num_pixels; i++) {
-		uint8_t* pixel = image->data + i * 4;
-		std::swap(pixel[ABGR_ALPHA_INDEX], pixel[ABGR_RED_INDEX]);
-		std::swap(pixel[ABGR_BLUE_INDEX], pixel[ABGR_GREEN_INDEX]);
-	}
+	stbi_simd::convertABGRToRGBA(image->data, num_pixels);
 }
 
 void stbi_replace_pixel_color_rgba(stbi_image_t* image, const stbi_color_t* source_color, const stbi_color_t* replacement_color) {
@@ -210,21 +405,137 @@ void stbi_replace_pixel_color_rgba(stbi_image_t* image, const stbi_color_t* sour
 
 	size_t pixelCount
 		= static_cast<size_t>(image->width) * static_cast<size_t>(image->height);
-	stbi_color_t* pixelBuffer = reinterpret_cast<stbi_color_t*>(image->data);
 
-	for(size_t index = 0; index < pixelCount; ++index) {
-		stbi_color_t* pixel = &pixelBuffer[index];
+	// Comparing all four channels at once is the same as comparing them individually (since the layout matches)
+	uint32_t sourceColor, replacementColor;
+	memcpy(&sourceColor, source_color, sizeof(sourceColor));
+	memcpy(&replacementColor, replacement_color, sizeof(replacementColor));
 
-		bool shouldReplacePixel = pixel->red == source_color->red && pixel->green == source_color->green && pixel->blue == source_color->blue && pixel->alpha == source_color->alpha;
+	stbi_simd::replaceColorRGBA(image->data, pixelCount, sourceColor, replacementColor);
+}
 
-		if(shouldReplacePixel) {
-			*pixel = *replacement_color;
-		}
-	}
+stbi_simd_level_t stbi_get_simd_level() {
+	return stbi_simd::getActiveLevel();
+}
+
+bool stbi_set_simd_level(stbi_simd_level_t level) {
+	return stbi_simd::setActiveLevel(level);
+}
+
+bool stbi_resize_image(const stbi_image_t* source, stbi_image_t* destination, stbi_resize_filter_t filter) {
+	if(!source) return false;
+	if(!destination) return false;
+
+	return stbi_transform::resizeImage(*source, *destination, filter);
+}
+
+bool stbi_crop_image(const stbi_image_t* source, stbi_image_t* destination, int offset_x, int offset_y) {
+	if(!source) return false;
+	if(!destination) return false;
+
+	return stbi_transform::cropImage(*source, *destination, offset_x, offset_y);
+}
+
+bool stbi_rotate_image(const stbi_image_t* source, stbi_image_t* destination, stbi_rotation_t rotation) {
+	if(!source) return false;
+	if(!destination) return false;
+
+	return stbi_transform::rotateImage(*source, *destination, rotation);
+}
+
+bool stbi_flip_image(stbi_image_t* image, stbi_flip_axis_t axis) {
+	if(!image) return false;
+
+	return stbi_transform::flipImage(*image, axis);
+}
+
+bool stbi_premultiply_alpha(stbi_image_t* image) {
+	if(!image) return false;
+
+	return stbi_transform::premultiplyAlpha(*image);
+}
+
+bool stbi_convert_color_depth(const stbi_image_t* source, stbi_image_t* destination) {
+	if(!source) return false;
+	if(!destination) return false;
+
+	return stbi_transform::convertColorDepth(*source, *destination);
+}
+
+bool stbi_get_transformed_size(const stbi_image_t* source, const stbi_transform_t* steps, size_t num_steps, stbi_image_t* result) {
+	if(!source) return false;
+	if(!result) return false;
+
+	return stbi_transform::getTransformedSize(*source, steps, num_steps, *result);
+}
+
+bool stbi_transform_image(const stbi_image_t* source, const stbi_transform_t* steps, size_t num_steps, stbi_image_t* destination) {
+	if(!source) return false;
+	if(!destination) return false;
+
+	return stbi_transform::applyTransforms(*source, steps, num_steps, *destination);
+}
+
+uint32_t stbi_transcode_batch(deferred_event_queue_t queue, const stbi_file_contents_t* inputs, size_t num_inputs, const stbi_transcoding_options_t* options) {
+	if(!queue) return 0;
+	if(!inputs) return 0;
+	if(!options) return 0;
+
+	return stbi_batch::submitBatch(queue, inputs, num_inputs, *options);
+}
+
+void stbi_release_transcoded_image(uint8_t* data, size_t capacity) {
+	stbi_batch::releaseTranscodedImage(data, capacity);
+}
+
+size_t stbi_get_transcoding_memory_usage() {
+	return stbi_batch::getNumBytesInFlight();
+}
+
+void stbi_get_pool_stats(stbi_pool_stats_t* stats) {
+	if(!stats) return;
+	stbi_pool::getStats(*stats);
+}
+
+void stbi_set_pool_limit(size_t max_bytes_retained) {
+	stbi_pool::setMaxBytesRetained(max_bytes_retained);
+}
+
+void stbi_trim_pool() {
+	stbi_pool::trim();
+}
+
+bool stbi_compare_images(const stbi_image_t* first, const stbi_image_t* second, uint8_t tolerance, stbi_comparison_result_t* result, stbi_image_t* diff_image) {
+	if(!first) return false;
+	if(!second) return false;
+	if(!result) return false;
+
+	return stbi_compare::compareImages(*first, *second, tolerance, *result, diff_image);
+}
+
+bool stbi_pack_atlas(const stbi_image_t* images, size_t num_images, const stbi_atlas_options_t* options, stbi_atlas_region_t* regions, stbi_image_t* atlas) {
+	if(!images) return false;
+	if(!options) return false;
+	if(!regions) return false;
+	if(!atlas) return false;
+
+	return stbi_atlas::packImages(images, num_images, *options, regions, *atlas);
+}
+
+bool stbi_render_atlas(const stbi_image_t* images, size_t num_images, const stbi_atlas_region_t* regions, stbi_image_t* atlas) {
+	if(!images) return false;
+	if(!regions) return false;
+	if(!atlas) return false;
+
+	return stbi_atlas::renderImages(images, num_images, regions, *atlas);
 }
 
 namespace stbi_ffi {
 
+	void assignEventLoop(uv_loop_t* loop) {
+		stbi_batch::assignEventLoop(loop);
+	}
+
 	void* getExportsTable() {
 		static struct static_stbi_exports_table exports = {
 
@@ -244,7 +555,13 @@ namespace stbi_ffi {
 			.stbi_encode_jpg = stbi_encode_jpg,
 			.stbi_encode_tga = stbi_encode_tga,
 
-			.stbi_flip_vertically_on_write = stbi_flip_vertically_on_write,
+			.stbi_encode_bmp_growable = stbi_encode_bmp_growable,
+			.stbi_encode_png_growable = stbi_encode_png_growable,
+			.stbi_encode_jpg_growable = stbi_encode_jpg_growable,
+			.stbi_encode_tga_growable = stbi_encode_tga_growable,
+			.stbi_growable_buffer_free = stbi_growable_buffer_free,
+
+			.stbi_flip_vertically_on_write = flip_vertically_on_write,
 
 			.stbi_get_required_bmp_size = stbi_get_required_bmp_size,
 			.stbi_get_required_png_size = stbi_get_required_png_size,
@@ -253,6 +570,34 @@ namespace stbi_ffi {
 
 			.stbi_abgr_to_rgba = stbi_abgr_to_rgba,
 			.stbi_replace_pixel_color_rgba = stbi_replace_pixel_color_rgba,
+
+			.stbi_get_simd_level = stbi_get_simd_level,
+			.stbi_set_simd_level = stbi_set_simd_level,
+
+			.stbi_resize_image = stbi_resize_image,
+			.stbi_crop_image = stbi_crop_image,
+			.stbi_rotate_image = stbi_rotate_image,
+			.stbi_flip_image = stbi_flip_image,
+			.stbi_premultiply_alpha = stbi_premultiply_alpha,
+			.stbi_convert_color_depth = stbi_convert_color_depth,
+			.stbi_get_transformed_size = stbi_get_transformed_size,
+			.stbi_transform_image = stbi_transform_image,
+
+			.stbi_transcode_batch = stbi_transcode_batch,
+			.stbi_release_transcoded_image = stbi_release_transcoded_image,
+			.stbi_get_transcoding_memory_usage = stbi_get_transcoding_memory_usage,
+			.stbi_encode_png_with_options = stbi_encode_png_with_options,
+			.stbi_load_from_path = stbi_load_from_path,
+			.stbi_load_from_fd = stbi_load_from_fd,
+			.stbi_info_from_path = stbi_info_from_path,
+			.stbi_info_from_fd = stbi_info_from_fd,
+			.stbi_get_pool_stats = stbi_get_pool_stats,
+			.stbi_set_pool_limit = stbi_set_pool_limit,
+			.stbi_trim_pool = stbi_trim_pool,
+			.stbi_compare_images = stbi_compare_images,
+
+			.stbi_pack_atlas = stbi_pack_atlas,
+			.stbi_render_atlas = stbi_render_atlas,
 		};
 
 		return &exports;
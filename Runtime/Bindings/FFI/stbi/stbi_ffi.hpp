@@ -3,8 +3,14 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "interop_ffi.hpp"
 #include "stbi_exports.h"
 
+extern "C" {
+#include "uv.h"
+}
+
 namespace stbi_ffi {
+	void assignEventLoop(uv_loop_t* loop);
 	void* getExportsTable();
 }
\ No newline at end of file
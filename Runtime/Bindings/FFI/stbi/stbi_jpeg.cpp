@@ -0,0 +1,485 @@
+#include "stbi_jpeg.hpp"
+#include "stbi_transform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace stbi_jpeg {
+
+	// The encoding parameters are the same as stb_image_write's, so that decoded images look identical either way
+	constexpr uint8_t ZIGZAG_INDICES[64] = {
+		0, 1, 5, 6, 14, 15, 27, 28,
+		2, 4, 7, 13, 16, 26, 29, 42,
+		3, 8, 12, 17, 25, 30, 41, 43,
+		9, 11, 18, 24, 31, 40, 44, 53,
+		10, 19, 23, 32, 39, 45, 52, 54,
+		20, 22, 33, 38, 46, 51, 55, 60,
+		21, 34, 37, 47, 50, 56, 59, 61,
+		35, 36, 48, 49, 57, 58, 62, 63
+	};
+
+	constexpr int LUMINANCE_QUANTIZATION_TABLE[64] = {
+		16, 11, 10, 16, 24, 40, 51, 61,
+		12, 12, 14, 19, 26, 58, 60, 55,
+		14, 13, 16, 24, 40, 57, 69, 56,
+		14, 17, 22, 29, 51, 87, 80, 62,
+		18, 22, 37, 56, 68, 109, 103, 77,
+		24, 35, 55, 64, 81, 104, 113, 92,
+		49, 64, 78, 87, 103, 121, 120, 101,
+		72, 92, 95, 98, 112, 100, 103, 99
+	};
+
+	constexpr int CHROMINANCE_QUANTIZATION_TABLE[64] = {
+		17, 18, 24, 47, 99, 99, 99, 99,
+		18, 21, 26, 66, 99, 99, 99, 99,
+		24, 26, 56, 99, 99, 99, 99, 99,
+		47, 66, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99
+	};
+
+	// Scale factors of the AAN DCT (times 2 * sqrt(2)), which are folded into the quantization step
+	constexpr float DCT_SCALE_FACTORS[8] = {
+		1.0f * 2.828427125f,
+		1.387039845f * 2.828427125f,
+		1.306562965f * 2.828427125f,
+		1.175875602f * 2.828427125f,
+		1.0f * 2.828427125f,
+		0.785694958f * 2.828427125f,
+		0.541196100f * 2.828427125f,
+		0.275899379f * 2.828427125f,
+	};
+
+	// Standard Huffman tables (ITU T.81, Annex K.3), as the number of codes per bit length followed by the symbols
+	constexpr uint8_t LUMINANCE_DC_CODE_LENGTHS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+	constexpr uint8_t LUMINANCE_DC_SYMBOLS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+	constexpr uint8_t CHROMINANCE_DC_CODE_LENGTHS[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+	constexpr uint8_t CHROMINANCE_DC_SYMBOLS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+	constexpr uint8_t LUMINANCE_AC_CODE_LENGTHS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+	constexpr uint8_t LUMINANCE_AC_SYMBOLS[162] = {
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+		0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+		0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+		0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+		0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+		0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA
+	};
+
+	constexpr uint8_t CHROMINANCE_AC_CODE_LENGTHS[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+	constexpr uint8_t CHROMINANCE_AC_SYMBOLS[162] = {
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+		0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+		0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+		0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+		0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+		0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+		0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+		0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA
+	};
+
+	constexpr uint8_t END_OF_BLOCK = 0x00;
+	constexpr uint8_t SIXTEEN_ZEROES = 0xF0;
+	constexpr uint8_t FIRST_RESTART_MARKER = 0xD0;
+	constexpr int NUM_RESTART_MARKERS = 8;
+
+	static std::atomic<bool> isFlippedVertically = false;
+
+	void setFlipVertically(bool isFlipped) {
+		isFlippedVertically = isFlipped;
+	}
+
+	struct HuffmanCode {
+		uint16_t bits;
+		uint8_t length;
+	};
+
+	using HuffmanTable = std::array<HuffmanCode, 256>;
+
+	static HuffmanTable createHuffmanTable(const uint8_t* codeLengths, const uint8_t* symbols) {
+		HuffmanTable table = {};
+		uint16_t code = 0;
+		size_t symbolIndex = 0;
+		for(uint8_t length = 1; length <= 16; length++) {
+			for(uint8_t count = 0; count < codeLengths[length - 1]; count++) {
+				table[symbols[symbolIndex++]] = { code++, length };
+			}
+			code <<= 1;
+		}
+		return table;
+	}
+
+	struct HuffmanTables {
+		HuffmanTable luminanceDC = createHuffmanTable(LUMINANCE_DC_CODE_LENGTHS, LUMINANCE_DC_SYMBOLS);
+		HuffmanTable luminanceAC = createHuffmanTable(LUMINANCE_AC_CODE_LENGTHS, LUMINANCE_AC_SYMBOLS);
+		HuffmanTable chrominanceDC = createHuffmanTable(CHROMINANCE_DC_CODE_LENGTHS, CHROMINANCE_DC_SYMBOLS);
+		HuffmanTable chrominanceAC = createHuffmanTable(CHROMINANCE_AC_CODE_LENGTHS, CHROMINANCE_AC_SYMBOLS);
+	};
+
+	static const HuffmanTables& getHuffmanTables() {
+		static const HuffmanTables tables;
+		return tables;
+	}
+
+	struct EncoderSettings {
+		const stbi_image_t& image;
+		bool isFlipped;
+		bool isSubsampled;
+		int mcuSize;
+		int numMcusPerRow;
+		int numMcuRows;
+		uint8_t luminanceTable[64]; // In zigzag order, as stored in the file
+		uint8_t chrominanceTable[64];
+		float luminanceDivisors[64]; // In natural order, with the DCT scale factors already applied
+		float chrominanceDivisors[64];
+	};
+
+	static void initializeQuantizationTables(EncoderSettings& settings, int quality) {
+		for(size_t index = 0; index < 64; index++) {
+			int luminanceStep = (LUMINANCE_QUANTIZATION_TABLE[index] * quality + 50) / 100;
+			int chrominanceStep = (CHROMINANCE_QUANTIZATION_TABLE[index] * quality + 50) / 100;
+			settings.luminanceTable[ZIGZAG_INDICES[index]] = static_cast<uint8_t>(std::clamp(luminanceStep, 1, 255));
+			settings.chrominanceTable[ZIGZAG_INDICES[index]] = static_cast<uint8_t>(std::clamp(chrominanceStep, 1, 255));
+		}
+
+		for(size_t row = 0, index = 0; row < 8; row++) {
+			for(size_t column = 0; column < 8; column++, index++) {
+				float scaleFactor = DCT_SCALE_FACTORS[row] * DCT_SCALE_FACTORS[column];
+				settings.luminanceDivisors[index] = 1 / (settings.luminanceTable[ZIGZAG_INDICES[index]] * scaleFactor);
+				settings.chrominanceDivisors[index] = 1 / (settings.chrominanceTable[ZIGZAG_INDICES[index]] * scaleFactor);
+			}
+		}
+	}
+
+	// Entropy-coded data must never contain markers, so every 0xFF byte is followed by a zero (byte stuffing)
+	class BitWriter {
+	public:
+		explicit BitWriter(std::vector<uint8_t>& output)
+			: output(output) {}
+
+		void write(uint32_t bits, int length) {
+			numBufferedBits += length;
+			bitBuffer |= bits << (24 - numBufferedBits);
+			while(numBufferedBits >= 8) {
+				uint8_t byte = static_cast<uint8_t>(bitBuffer >> 16);
+				output.push_back(byte);
+				if(byte == 0xFF) output.push_back(0);
+				bitBuffer <<= 8;
+				numBufferedBits -= 8;
+			}
+		}
+
+		void write(const HuffmanCode& code) {
+			write(code.bits, code.length);
+		}
+
+		// Padding with one bits is mandatory before a marker (and at the end of the scan)
+		void flush() {
+			write(0x7F, 7);
+			bitBuffer = 0;
+			numBufferedBits = 0;
+		}
+
+	private:
+		std::vector<uint8_t>& output;
+		uint32_t bitBuffer = 0;
+		int numBufferedBits = 0;
+	};
+
+	// Same as the DC difference and AC coefficient encoding of the standard: the bit length, then the (adjusted) value bits
+	static void getMagnitudeBits(int value, uint32_t& bits, int& length) {
+		int magnitude = value < 0 ? -value : value;
+		length = 0;
+		while(magnitude) {
+			magnitude >>= 1;
+			length++;
+		}
+		if(value < 0) value--;
+		bits = static_cast<uint32_t>(value) & ((1u << length) - 1);
+	}
+
+	// Arai, Agui, and Nakajima's scaled 1D DCT (the output still needs to be multiplied by the scale factors)
+	static void transformVector(float* data, size_t stride) {
+		float& d0 = data[0 * stride];
+		float& d1 = data[1 * stride];
+		float& d2 = data[2 * stride];
+		float& d3 = data[3 * stride];
+		float& d4 = data[4 * stride];
+		float& d5 = data[5 * stride];
+		float& d6 = data[6 * stride];
+		float& d7 = data[7 * stride];
+
+		float tmp0 = d0 + d7;
+		float tmp7 = d0 - d7;
+		float tmp1 = d1 + d6;
+		float tmp6 = d1 - d6;
+		float tmp2 = d2 + d5;
+		float tmp5 = d2 - d5;
+		float tmp3 = d3 + d4;
+		float tmp4 = d3 - d4;
+
+		// Even part
+		float tmp10 = tmp0 + tmp3;
+		float tmp13 = tmp0 - tmp3;
+		float tmp11 = tmp1 + tmp2;
+		float tmp12 = tmp1 - tmp2;
+
+		d0 = tmp10 + tmp11;
+		d4 = tmp10 - tmp11;
+
+		float z1 = (tmp12 + tmp13) * 0.707106781f;
+		d2 = tmp13 + z1;
+		d6 = tmp13 - z1;
+
+		// Odd part
+		tmp10 = tmp4 + tmp5;
+		tmp11 = tmp5 + tmp6;
+		tmp12 = tmp6 + tmp7;
+
+		float z5 = (tmp10 - tmp12) * 0.382683433f;
+		float z2 = tmp10 * 0.541196100f + z5;
+		float z4 = tmp12 * 1.306562965f + z5;
+		float z3 = tmp11 * 0.707106781f;
+
+		float z11 = tmp7 + z3;
+		float z13 = tmp7 - z3;
+
+		d5 = z13 + z2;
+		d3 = z13 - z2;
+		d1 = z11 + z4;
+		d7 = z11 - z4;
+	}
+
+	static int encodeBlock(BitWriter& writer, float* block, const float* divisors, int previousDC, const HuffmanTable& dcTable, const HuffmanTable& acTable) {
+		for(size_t row = 0; row < 8; row++)
+			transformVector(block + row * 8, 1);
+		for(size_t column = 0; column < 8; column++)
+			transformVector(block + column, 8);
+
+		int coefficients[64];
+		for(size_t index = 0; index < 64; index++) {
+			float value = block[index] * divisors[index];
+			coefficients[ZIGZAG_INDICES[index]] = static_cast<int>(value < 0 ? value - 0.5f : value + 0.5f);
+		}
+
+		uint32_t bits;
+		int length;
+
+		int difference = coefficients[0] - previousDC;
+		if(difference == 0) {
+			writer.write(dcTable[0]);
+		} else {
+			getMagnitudeBits(difference, bits, length);
+			writer.write(dcTable[length]);
+			writer.write(bits, length);
+		}
+
+		int lastNonZeroIndex = 63;
+		while(lastNonZeroIndex > 0 && coefficients[lastNonZeroIndex] == 0)
+			lastNonZeroIndex--;
+
+		for(int index = 1; index <= lastNonZeroIndex; index++) {
+			int numZeroes = 0;
+			while(coefficients[index] == 0) {
+				numZeroes++;
+				index++;
+			}
+
+			for(; numZeroes >= 16; numZeroes -= 16)
+				writer.write(acTable[SIXTEEN_ZEROES]);
+
+			getMagnitudeBits(coefficients[index], bits, length);
+			writer.write(acTable[(numZeroes << 4) + length]);
+			writer.write(bits, length);
+		}
+
+		if(lastNonZeroIndex != 63) writer.write(acTable[END_OF_BLOCK]);
+		return coefficients[0];
+	}
+
+	// Pixels outside of the image are clamped to the edge, which avoids ringing artifacts in the partial MCUs
+	static void loadMcu(const EncoderSettings& settings, int mcuX, int mcuY, float* luminance, float* blueDifference, float* redDifference) {
+		const stbi_image_t& image = settings.image;
+		size_t numChannels = static_cast<size_t>(image.channels);
+		size_t greenOffset = numChannels > 2 ? 1 : 0;
+		size_t blueOffset = numChannels > 2 ? 2 : 0;
+
+		for(int offsetY = 0, index = 0; offsetY < settings.mcuSize; offsetY++) {
+			int y = std::min(mcuY * settings.mcuSize + offsetY, image.height - 1);
+			if(settings.isFlipped) y = image.height - 1 - y;
+			const uint8_t* row = image.data + static_cast<size_t>(y) * static_cast<size_t>(image.width) * numChannels;
+
+			for(int offsetX = 0; offsetX < settings.mcuSize; offsetX++, index++) {
+				int x = std::min(mcuX * settings.mcuSize + offsetX, image.width - 1);
+				const uint8_t* pixel = row + static_cast<size_t>(x) * numChannels;
+				float red = pixel[0], green = pixel[greenOffset], blue = pixel[blueOffset];
+
+				luminance[index] = +0.29900f * red + 0.58700f * green + 0.11400f * blue - 128;
+				blueDifference[index] = -0.16874f * red - 0.33126f * green + 0.50000f * blue;
+				redDifference[index] = +0.50000f * red - 0.41869f * green - 0.08131f * blue;
+			}
+		}
+	}
+
+	static void copyBlock(const float* source, size_t stride, float* block) {
+		for(size_t row = 0; row < 8; row++) {
+			for(size_t column = 0; column < 8; column++)
+				block[row * 8 + column] = source[row * stride + column];
+		}
+	}
+
+	static void downsampleBlock(const float* source, float* block) {
+		for(size_t row = 0; row < 8; row++) {
+			for(size_t column = 0; column < 8; column++) {
+				const float* samples = source + row * 32 + column * 2;
+				block[row * 8 + column] = (samples[0] + samples[1] + samples[16] + samples[17]) * 0.25f;
+			}
+		}
+	}
+
+	// Each MCU row is a restart interval, so the DC predictions start over and the output only depends on the row itself
+	static void encodeMcuRow(const EncoderSettings& settings, int mcuY, std::vector<uint8_t>& output) {
+		const HuffmanTables& tables = getHuffmanTables();
+		BitWriter writer(output);
+
+		float luminance[256], blueDifference[256], redDifference[256];
+		float block[64];
+		int luminanceDC = 0, blueDifferenceDC = 0, redDifferenceDC = 0;
+
+		for(int mcuX = 0; mcuX < settings.numMcusPerRow; mcuX++) {
+			loadMcu(settings, mcuX, mcuY, luminance, blueDifference, redDifference);
+
+			if(settings.isSubsampled) {
+				const size_t blockOffsets[4] = { 0, 8, 128, 136 };
+				for(size_t blockOffset : blockOffsets) {
+					copyBlock(luminance + blockOffset, 16, block);
+					luminanceDC = encodeBlock(writer, block, settings.luminanceDivisors, luminanceDC, tables.luminanceDC, tables.luminanceAC);
+				}
+
+				downsampleBlock(blueDifference, block);
+				blueDifferenceDC = encodeBlock(writer, block, settings.chrominanceDivisors, blueDifferenceDC, tables.chrominanceDC, tables.chrominanceAC);
+				downsampleBlock(redDifference, block);
+				redDifferenceDC = encodeBlock(writer, block, settings.chrominanceDivisors, redDifferenceDC, tables.chrominanceDC, tables.chrominanceAC);
+			} else {
+				luminanceDC = encodeBlock(writer, luminance, settings.luminanceDivisors, luminanceDC, tables.luminanceDC, tables.luminanceAC);
+				blueDifferenceDC = encodeBlock(writer, blueDifference, settings.chrominanceDivisors, blueDifferenceDC, tables.chrominanceDC, tables.chrominanceAC);
+				redDifferenceDC = encodeBlock(writer, redDifference, settings.chrominanceDivisors, redDifferenceDC, tables.chrominanceDC, tables.chrominanceAC);
+			}
+		}
+
+		writer.flush();
+		if(mcuY == settings.numMcuRows - 1) return;
+
+		output.push_back(0xFF);
+		output.push_back(static_cast<uint8_t>(FIRST_RESTART_MARKER + mcuY % NUM_RESTART_MARKERS));
+	}
+
+	static void writeUint16(std::vector<uint8_t>& output, size_t value) {
+		output.push_back(static_cast<uint8_t>(value >> 8));
+		output.push_back(static_cast<uint8_t>(value));
+	}
+
+	static void writeHuffmanTable(std::vector<uint8_t>& output, uint8_t tableClassAndID, const uint8_t* codeLengths, const uint8_t* symbols, size_t numSymbols) {
+		output.push_back(tableClassAndID);
+		output.insert(output.end(), codeLengths, codeLengths + 16);
+		output.insert(output.end(), symbols, symbols + numSymbols);
+	}
+
+	static std::vector<uint8_t> createHeader(const EncoderSettings& settings) {
+		std::vector<uint8_t> header = {
+			0xFF, 0xD8, // Start of image
+			0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00 // JFIF 1.1, no thumbnail
+		};
+
+		header.insert(header.end(), { 0xFF, 0xDB, 0x00, 0x84, 0x00 });
+		header.insert(header.end(), settings.luminanceTable, settings.luminanceTable + 64);
+		header.push_back(0x01);
+		header.insert(header.end(), settings.chrominanceTable, settings.chrominanceTable + 64);
+
+		// Baseline DCT with three components (greyscale images are encoded as RGB, like stb_image_write does)
+		header.insert(header.end(), { 0xFF, 0xC0, 0x00, 0x11, 0x08 });
+		writeUint16(header, static_cast<size_t>(settings.image.height));
+		writeUint16(header, static_cast<size_t>(settings.image.width));
+		uint8_t luminanceSamplingFactors = settings.isSubsampled ? 0x22 : 0x11;
+		header.insert(header.end(), { 0x03, 0x01, luminanceSamplingFactors, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01 });
+
+		header.insert(header.end(), { 0xFF, 0xC4, 0x01, 0xA2 });
+		writeHuffmanTable(header, 0x00, LUMINANCE_DC_CODE_LENGTHS, LUMINANCE_DC_SYMBOLS, sizeof(LUMINANCE_DC_SYMBOLS));
+		writeHuffmanTable(header, 0x10, LUMINANCE_AC_CODE_LENGTHS, LUMINANCE_AC_SYMBOLS, sizeof(LUMINANCE_AC_SYMBOLS));
+		writeHuffmanTable(header, 0x01, CHROMINANCE_DC_CODE_LENGTHS, CHROMINANCE_DC_SYMBOLS, sizeof(CHROMINANCE_DC_SYMBOLS));
+		writeHuffmanTable(header, 0x11, CHROMINANCE_AC_CODE_LENGTHS, CHROMINANCE_AC_SYMBOLS, sizeof(CHROMINANCE_AC_SYMBOLS));
+
+		// The restart interval is counted in MCUs, and there's one interval per MCU row
+		header.insert(header.end(), { 0xFF, 0xDD, 0x00, 0x04 });
+		writeUint16(header, static_cast<size_t>(settings.numMcusPerRow));
+
+		header.insert(header.end(), { 0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00 });
+		return header;
+	}
+
+	bool shouldEncodeInParallel(const stbi_image_t& image) {
+		size_t numPixels = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
+		return numPixels >= MIN_PARALLEL_ENCODING_PIXELS;
+	}
+
+	bool encodeImage(const stbi_image_t& image, int quality, stbi_write_callback_t write, void* context) {
+		if(!stbi_transform::isValidImage(image)) return false;
+		if(image.width > UINT16_MAX || image.height > UINT16_MAX) return false;
+
+		// Same quality scaling as stb_image_write (zero means default, and chroma subsampling is only disabled for high quality)
+		quality = quality ? quality : 90;
+		bool isSubsampled = quality <= 90;
+		quality = std::clamp(quality, 1, 100);
+		quality = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+		int mcuSize = isSubsampled ? 16 : 8;
+		EncoderSettings settings = {
+			.image = image,
+			.isFlipped = isFlippedVertically,
+			.isSubsampled = isSubsampled,
+			.mcuSize = mcuSize,
+			.numMcusPerRow = (image.width + mcuSize - 1) / mcuSize,
+			.numMcuRows = (image.height + mcuSize - 1) / mcuSize,
+			.luminanceTable = {},
+			.chrominanceTable = {},
+			.luminanceDivisors = {},
+			.chrominanceDivisors = {},
+		};
+		initializeQuantizationTables(settings, quality);
+
+		// Rows are encoded into separate buffers, so the output doesn't depend on how they're split across threads
+		std::vector<std::vector<uint8_t>> encodedRows(static_cast<size_t>(settings.numMcuRows));
+		size_t numPixelsPerMcuRow = static_cast<size_t>(image.width) * static_cast<size_t>(mcuSize);
+		stbi_transform::forEachRowRange(settings.numMcuRows, numPixelsPerMcuRow, [&](int firstRow, int lastRow) {
+			for(int mcuY = firstRow; mcuY < lastRow; mcuY++) {
+				std::vector<uint8_t>& output = encodedRows[static_cast<size_t>(mcuY)];
+				output.reserve(numPixelsPerMcuRow / 2); // Rough guess, assuming a compression ratio of at least 6:1 for RGB
+				encodeMcuRow(settings, mcuY, output);
+			}
+		});
+
+		std::vector<uint8_t> header = createHeader(settings);
+		write(context, header.data(), static_cast<int>(header.size()));
+		for(std::vector<uint8_t>& output : encodedRows) {
+			if(!output.empty()) write(context, output.data(), static_cast<int>(output.size()));
+		}
+
+		uint8_t endOfImage[] = { 0xFF, 0xD9 };
+		write(context, endOfImage, sizeof(endOfImage));
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+#include "stbi_ffi.hpp" // For the image types (the exports header lacks include guards)
+
+// stb_image_write encodes JPEGs on a single thread, which dominates the latency for very large (e.g., 50+ megapixel) images
+// Each row of MCUs is a separate restart interval here, so that strips can be entropy-coded in parallel and then stitched
+namespace stbi_jpeg {
+	// Smaller images are left to stb_image_write, since splitting them up wouldn't pay off (and the output stays the same)
+	constexpr size_t MIN_PARALLEL_ENCODING_PIXELS = 2 * 1024 * 1024;
+
+	// Mirrors the global setting of stb_image_write, which can't be queried from the outside
+	void setFlipVertically(bool isFlipped);
+
+	bool shouldEncodeInParallel(const stbi_image_t& image);
+	bool encodeImage(const stbi_image_t& image, int quality, stbi_write_callback_t write, void* context);
+}
\ No newline at end of file
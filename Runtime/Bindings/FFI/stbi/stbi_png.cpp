@@ -0,0 +1,190 @@
+#include "stbi_png.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+namespace stbi_png {
+
+	constexpr uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	constexpr size_t IHDR_CHUNK_SIZE = 13;
+	constexpr size_t NUM_FILTER_TYPES = 5;
+
+	// Indexed by the number of channels: greyscale, greyscale with alpha, RGB, RGBA
+	constexpr uint8_t COLOR_TYPES[] = { 0, 0, 4, 2, 6 };
+
+	static std::atomic<bool> isFlippedVertically = false;
+
+	void setFlipVertically(bool isFlipped) {
+		isFlippedVertically = isFlipped;
+	}
+
+	struct ChunkWriter {
+		stbi_write_callback_t write;
+		void* context;
+	};
+
+	static void writeBigEndian(uint8_t* destination, uint32_t value) {
+		destination[0] = static_cast<uint8_t>(value >> 24);
+		destination[1] = static_cast<uint8_t>(value >> 16);
+		destination[2] = static_cast<uint8_t>(value >> 8);
+		destination[3] = static_cast<uint8_t>(value);
+	}
+
+	static void writeChunk(const ChunkWriter& writer, const char* type, const uint8_t* data, size_t size) {
+		uint8_t header[8];
+		writeBigEndian(header, static_cast<uint32_t>(size));
+		memcpy(header + 4, type, 4);
+
+		// The checksum covers the chunk type as well as the data (but not the length)
+		mz_ulong checksum = mz_crc32(MZ_CRC32_INIT, header + 4, 4);
+		if(size > 0) checksum = mz_crc32(checksum, data, size);
+		uint8_t footer[4];
+		writeBigEndian(footer, static_cast<uint32_t>(checksum));
+
+		writer.write(writer.context, header, sizeof(header));
+		if(size > 0) writer.write(writer.context, const_cast<uint8_t*>(data), static_cast<int>(size));
+		writer.write(writer.context, footer, sizeof(footer));
+	}
+
+	// The compressor flushes whenever its output buffer is full, and every flush becomes its own IDAT chunk
+	static mz_bool writeDataChunk(const void* data, int size, void* context) {
+		writeChunk(*static_cast<ChunkWriter*>(context), "IDAT", static_cast<const uint8_t*>(data), static_cast<size_t>(size));
+		return MZ_TRUE;
+	}
+
+	static uint8_t predictPaeth(int left, int above, int upperLeft) {
+		int estimate = left + above - upperLeft;
+		int distanceLeft = abs(estimate - left);
+		int distanceAbove = abs(estimate - above);
+		int distanceUpperLeft = abs(estimate - upperLeft);
+
+		if(distanceLeft <= distanceAbove && distanceLeft <= distanceUpperLeft) return static_cast<uint8_t>(left);
+		if(distanceAbove <= distanceUpperLeft) return static_cast<uint8_t>(above);
+		return static_cast<uint8_t>(upperLeft);
+	}
+
+	// The output starts with the filter type, as each row must be prefixed with it
+	static void filterRow(stbi_png_filter_t filter, const uint8_t* row, const uint8_t* previousRow, size_t rowSize, size_t bytesPerPixel, uint8_t* output) {
+		output[0] = static_cast<uint8_t>(filter);
+		uint8_t* filteredRow = output + 1;
+
+		switch(filter) {
+		case STBI_PNG_FILTER_NONE:
+			memcpy(filteredRow, row, rowSize);
+			break;
+		case STBI_PNG_FILTER_SUB:
+			memcpy(filteredRow, row, bytesPerPixel);
+			for(size_t index = bytesPerPixel; index < rowSize; index++)
+				filteredRow[index] = row[index] - row[index - bytesPerPixel];
+			break;
+		case STBI_PNG_FILTER_UP:
+			for(size_t index = 0; index < rowSize; index++)
+				filteredRow[index] = row[index] - previousRow[index];
+			break;
+		case STBI_PNG_FILTER_AVERAGE:
+			for(size_t index = 0; index < bytesPerPixel; index++)
+				filteredRow[index] = row[index] - (previousRow[index] >> 1);
+			for(size_t index = bytesPerPixel; index < rowSize; index++)
+				filteredRow[index] = row[index] - ((row[index - bytesPerPixel] + previousRow[index]) >> 1);
+			break;
+		case STBI_PNG_FILTER_PAETH:
+			for(size_t index = 0; index < bytesPerPixel; index++)
+				filteredRow[index] = row[index] - previousRow[index]; // Paeth degrades to "up" without a left neighbor
+			for(size_t index = bytesPerPixel; index < rowSize; index++)
+				filteredRow[index] = row[index] - predictPaeth(row[index - bytesPerPixel], previousRow[index], previousRow[index - bytesPerPixel]);
+			break;
+		case STBI_PNG_FILTER_ADAPTIVE:
+			break; // Not a real filter type (must be resolved by the caller)
+		}
+	}
+
+	// Standard heuristic (as suggested by the PNG spec): Pick whichever filter yields the smallest sum of signed residuals
+	static size_t getFilterCost(const uint8_t* filteredRow, size_t rowSize) {
+		size_t cost = 0;
+		for(size_t index = 0; index < rowSize; index++)
+			cost += static_cast<size_t>(abs(static_cast<int8_t>(filteredRow[index])));
+		return cost;
+	}
+
+	bool isValidOptions(const stbi_png_options_t& options) {
+		if(options.compression_level < MIN_COMPRESSION_LEVEL || options.compression_level > MAX_COMPRESSION_LEVEL) return false;
+		if(options.filter < STBI_PNG_FILTER_NONE || options.filter > STBI_PNG_FILTER_ADAPTIVE) return false;
+		return true;
+	}
+
+	bool encodeImage(const stbi_image_t& image, const stbi_png_options_t& options, int stride, stbi_write_callback_t write, void* context) {
+		if(!image.data || image.width <= 0 || image.height <= 0) return false;
+		if(image.channels < 1 || image.channels > 4) return false;
+		if(!write) return false;
+		if(!isValidOptions(options)) return false;
+
+		ChunkWriter writer = { write, context };
+		size_t bytesPerPixel = static_cast<size_t>(image.channels);
+		size_t rowSize = static_cast<size_t>(image.width) * bytesPerPixel;
+		if(stride < 0 || (stride > 0 && static_cast<size_t>(stride) < rowSize)) return false;
+		size_t rowStride = (stride == 0) ? rowSize : static_cast<size_t>(stride);
+		bool isFlipped = isFlippedVertically; // Changing the setting while encoding mustn't affect the remaining rows
+
+		writer.write(writer.context, const_cast<uint8_t*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+		uint8_t header[IHDR_CHUNK_SIZE] = {};
+		writeBigEndian(header, static_cast<uint32_t>(image.width));
+		writeBigEndian(header + 4, static_cast<uint32_t>(image.height));
+		header[8] = 8; // Bit depth (per channel)
+		header[9] = COLOR_TYPES[image.channels];
+		// Compression, filter, and interlace methods are all zero (deflate, adaptive, none)
+		writeChunk(writer, "IHDR", header, sizeof(header));
+
+		// The compressor state is several hundred KB, so it definitely shouldn't live on the stack
+		std::unique_ptr<tdefl_compressor, decltype(&free)> compressor(static_cast<tdefl_compressor*>(malloc(sizeof(tdefl_compressor))), free);
+		if(!compressor) return false;
+
+		int flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(options.compression_level, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+		if(tdefl_init(compressor.get(), writeDataChunk, &writer, flags) != TDEFL_STATUS_OKAY) return false;
+
+		bool isAdaptive = (options.filter == STBI_PNG_FILTER_ADAPTIVE);
+		size_t numCandidates = isAdaptive ? NUM_FILTER_TYPES : 1;
+		std::vector<uint8_t> filteredRows(numCandidates * (rowSize + 1));
+		std::vector<uint8_t> emptyRow(rowSize, 0);
+
+		const uint8_t* previousRow = emptyRow.data();
+		for(int y = 0; y < image.height; y++) {
+			int sourceRow = isFlipped ? image.height - 1 - y : y;
+			const uint8_t* row = image.data + static_cast<size_t>(sourceRow) * rowStride;
+
+			uint8_t* filteredRow = filteredRows.data();
+			if(isAdaptive) {
+				size_t lowestCost = SIZE_MAX;
+				for(size_t filter = 0; filter < NUM_FILTER_TYPES; filter++) {
+					uint8_t* candidate = filteredRows.data() + filter * (rowSize + 1);
+					filterRow(static_cast<stbi_png_filter_t>(filter), row, previousRow, rowSize, bytesPerPixel, candidate);
+
+					size_t cost = getFilterCost(candidate + 1, rowSize);
+					if(cost < lowestCost) {
+						lowestCost = cost;
+						filteredRow = candidate;
+					}
+				}
+			} else {
+				filterRow(options.filter, row, previousRow, rowSize, bytesPerPixel, filteredRow);
+			}
+
+			if(tdefl_compress_buffer(compressor.get(), filteredRow, rowSize + 1, TDEFL_NO_FLUSH) != TDEFL_STATUS_OKAY) return false;
+			previousRow = row;
+		}
+
+		if(tdefl_compress_buffer(compressor.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE) return false;
+
+		writeChunk(writer, "IEND", nullptr, 0);
+		return true;
+	}
+
+}
\ No newline at end of file
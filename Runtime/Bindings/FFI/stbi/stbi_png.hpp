@@ -0,0 +1,20 @@
+#pragma once
+
+#include "stbi_ffi.hpp" // For the image types (the exports header lacks include guards)
+
+// stb_image_write's deflate implementation is simple, but it's slow and doesn't compress particularly well
+// This encoder uses miniz instead, with a configurable compression level and filter heuristic (output is streamed)
+namespace stbi_png {
+	constexpr int MIN_COMPRESSION_LEVEL = 0;
+	constexpr int MAX_COMPRESSION_LEVEL = 9;
+
+	// Same as stb_image_write's (which stbi_encode_png used to rely on, and which can't be changed from Lua anyway)
+	constexpr stbi_png_options_t DEFAULT_OPTIONS = { 8, STBI_PNG_FILTER_ADAPTIVE };
+
+	// Mirrors the global setting of stb_image_write, which can't be queried from the outside
+	void setFlipVertically(bool isFlipped);
+
+	bool isValidOptions(const stbi_png_options_t& options);
+	// All settings are passed in (or read atomically), so images can be encoded on any thread; a stride of zero means tightly packed rows
+	bool encodeImage(const stbi_image_t& image, const stbi_png_options_t& options, int stride, stbi_write_callback_t write, void* context);
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "stbi_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace stbi_pool {
+
+	constexpr size_t MIN_POOLED_SIZE_LOG2 = 16;
+	constexpr size_t UNPOOLED_SIZE_CLASS = SIZE_MAX;
+
+	// Every block is prefixed with its size class, since stb_image doesn't pass the size when freeing
+	struct BlockHeader {
+		size_t sizeClass;
+		size_t capacity;
+	};
+
+	// Must preserve the alignment that malloc guarantees, or SIMD loads might fault
+	constexpr size_t HEADER_SIZE = 16;
+	static_assert(sizeof(BlockHeader) <= HEADER_SIZE);
+
+	static std::mutex poolMutex;
+	static std::array<std::vector<BlockHeader*>, STBI_POOL_NUM_SIZE_CLASSES> freeLists;
+	static size_t maxBytesRetained = DEFAULT_MAX_BYTES_RETAINED;
+	static stbi_pool_stats_t poolStats = {};
+
+	static BlockHeader* getHeader(void* pointer) {
+		return reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(pointer) - HEADER_SIZE);
+	}
+
+	static void* getPayload(BlockHeader* header) {
+		return reinterpret_cast<uint8_t*>(header) + HEADER_SIZE;
+	}
+
+	size_t getSizeClassLimit(size_t sizeClass) {
+		return static_cast<size_t>(1) << (MIN_POOLED_SIZE_LOG2 + sizeClass);
+	}
+
+	size_t getSizeClass(size_t size) {
+		if(size < getSizeClassLimit(0) / 2) return UNPOOLED_SIZE_CLASS; // Wasting up to half the block is fine, but not more
+		if(size > getSizeClassLimit(STBI_POOL_NUM_SIZE_CLASSES - 1)) return UNPOOLED_SIZE_CLASS;
+
+		size_t sizeClass = 0;
+		while(getSizeClassLimit(sizeClass) < size)
+			sizeClass++;
+		return sizeClass;
+	}
+
+	void* allocate(size_t size) {
+		size_t sizeClass = getSizeClass(size);
+		size_t capacity = (sizeClass == UNPOOLED_SIZE_CLASS) ? size : getSizeClassLimit(sizeClass);
+
+		BlockHeader* header = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			poolStats.num_allocations++;
+
+			if(sizeClass == UNPOOLED_SIZE_CLASS) {
+				poolStats.num_unpooled_allocations++;
+			} else if(!freeLists[sizeClass].empty()) {
+				header = freeLists[sizeClass].back();
+				freeLists[sizeClass].pop_back();
+				poolStats.num_reused_allocations++;
+				poolStats.bytes_retained -= capacity;
+			}
+
+			poolStats.bytes_in_use += capacity;
+		}
+
+		if(!header) {
+			header = static_cast<BlockHeader*>(malloc(HEADER_SIZE + capacity));
+			if(!header) {
+				std::lock_guard<std::mutex> lock(poolMutex);
+				poolStats.bytes_in_use -= capacity;
+				return nullptr;
+			}
+
+			header->sizeClass = sizeClass;
+			header->capacity = capacity;
+		}
+
+		return getPayload(header);
+	}
+
+	void* reallocate(void* pointer, size_t newSize) {
+		if(!pointer) return allocate(newSize);
+
+		// Pooled blocks usually have some room to spare, which avoids copying when stb_image grows its buffers
+		BlockHeader* header = getHeader(pointer);
+		if(newSize <= header->capacity) return pointer;
+
+		void* newPointer = allocate(newSize);
+		if(!newPointer) return nullptr; // The old block must remain valid, as per realloc's contract
+
+		memcpy(newPointer, pointer, std::min(header->capacity, newSize));
+		release(pointer);
+		return newPointer;
+	}
+
+	void release(void* pointer) {
+		if(!pointer) return;
+
+		BlockHeader* header = getHeader(pointer);
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			poolStats.bytes_in_use -= header->capacity;
+
+			bool isPooled = (header->sizeClass != UNPOOLED_SIZE_CLASS);
+			if(isPooled && poolStats.bytes_retained + header->capacity <= maxBytesRetained) {
+				freeLists[header->sizeClass].push_back(header);
+				poolStats.bytes_retained += header->capacity;
+				return;
+			}
+		}
+
+		free(header);
+	}
+
+	void getStats(stbi_pool_stats_t& stats) {
+		std::lock_guard<std::mutex> lock(poolMutex);
+		stats = poolStats;
+		stats.max_bytes_retained = maxBytesRetained;
+
+		for(size_t sizeClass = 0; sizeClass < STBI_POOL_NUM_SIZE_CLASSES; sizeClass++) {
+			stats.size_class_limits[sizeClass] = getSizeClassLimit(sizeClass);
+			stats.num_retained_by_size_class[sizeClass] = freeLists[sizeClass].size();
+		}
+	}
+
+	void setMaxBytesRetained(size_t newMaxBytesRetained) {
+		std::lock_guard<std::mutex> lock(poolMutex);
+		maxBytesRetained = newMaxBytesRetained;
+
+		// Largest blocks first, since they're the least likely to be reused (and it frees up the most memory)
+		for(size_t sizeClass = STBI_POOL_NUM_SIZE_CLASSES; sizeClass-- > 0 && poolStats.bytes_retained > maxBytesRetained;) {
+			std::vector<BlockHeader*>& freeList = freeLists[sizeClass];
+			while(!freeList.empty() && poolStats.bytes_retained > maxBytesRetained) {
+				poolStats.bytes_retained -= freeList.back()->capacity;
+				free(freeList.back());
+				freeList.pop_back();
+			}
+		}
+	}
+
+	void trim() {
+		std::lock_guard<std::mutex> lock(poolMutex);
+		for(std::vector<BlockHeader*>& freeList : freeLists) {
+			for(BlockHeader* header : freeList)
+				free(header);
+			freeList.clear();
+		}
+		poolStats.bytes_retained = 0;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+#include "stbi_ffi.hpp" // For the pool stats (the exports header lacks include guards)
+
+// Decoding at a high rate (e.g., thumbnails) means allocating and freeing similarly-sized pixel buffers all the time
+// stb_image allocates via these functions, so that freed buffers can be recycled (thread-safe, as decoding can be offloaded)
+namespace stbi_pool {
+	constexpr size_t DEFAULT_MAX_BYTES_RETAINED = 128 * 1024 * 1024;
+
+	size_t getSizeClass(size_t size);
+	size_t getSizeClassLimit(size_t sizeClass);
+
+	void* allocate(size_t size);
+	void* reallocate(void* pointer, size_t newSize);
+	void release(void* pointer);
+
+	void getStats(stbi_pool_stats_t& stats);
+	void setMaxBytesRetained(size_t maxBytesRetained);
+	void trim();
+}
\ No newline at end of file
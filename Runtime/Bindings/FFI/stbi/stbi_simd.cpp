@@ -0,0 +1,301 @@
+#include "stbi_simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STBI_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define STBI_SIMD_X86 0
+#endif
+
+namespace stbi_simd {
+
+	static stbi_simd_level_t detectSupportedLevel() {
+#if STBI_SIMD_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) return STBI_SIMD_AVX2;
+		if(__builtin_cpu_supports("sse2")) return STBI_SIMD_SSE2;
+#endif
+		return STBI_SIMD_SCALAR;
+	}
+
+	static const stbi_simd_level_t supportedLevel = detectSupportedLevel();
+	// Relaxed ordering suffices: Worker threads only need to see some valid level, not the exact moment it was changed
+	static std::atomic<stbi_simd_level_t> activeLevel = supportedLevel;
+
+	stbi_simd_level_t getSupportedLevel() {
+		return supportedLevel;
+	}
+
+	stbi_simd_level_t getActiveLevel() {
+		return activeLevel.load(std::memory_order_relaxed);
+	}
+
+	bool setActiveLevel(stbi_simd_level_t level) {
+		if(level < STBI_SIMD_SCALAR || level > supportedLevel) return false;
+
+		activeLevel.store(level, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Pixels are compared as a whole, which is equivalent to comparing all four channels (but branch-free)
+	static void replaceColorScalar(uint8_t* pixels, size_t numPixels, uint32_t sourceColor, uint32_t replacementColor) {
+		for(size_t index = 0; index < numPixels; index++) {
+			uint32_t pixel;
+			memcpy(&pixel, pixels + index * 4, sizeof(pixel));
+			pixel = (pixel == sourceColor) ? replacementColor : pixel;
+			memcpy(pixels + index * 4, &pixel, sizeof(pixel));
+		}
+	}
+
+	static void convertABGRToRGBAScalar(uint8_t* pixels, size_t numPixels) {
+		for(size_t index = 0; index < numPixels; index++) {
+			uint32_t pixel;
+			memcpy(&pixel, pixels + index * 4, sizeof(pixel));
+			pixel = __builtin_bswap32(pixel);
+			memcpy(pixels + index * 4, &pixel, sizeof(pixel));
+		}
+	}
+
+	// Works for any number of channels, but the alpha channel (if any) is always opaque in the diff image
+	static void comparePixelsScalar(const uint8_t* first, const uint8_t* second, size_t numPixels, size_t numChannels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats) {
+		bool hasAlpha = (numChannels == 2 || numChannels == 4);
+		for(size_t index = 0; index < numPixels; index++) {
+			bool isMismatch = false;
+			for(size_t channel = 0; channel < numChannels; channel++) {
+				size_t offset = index * numChannels + channel;
+				uint8_t difference = (first[offset] > second[offset]) ? first[offset] - second[offset] : second[offset] - first[offset];
+
+				stats.sumOfAbsoluteDifferences[channel] += difference;
+				stats.maxAbsoluteDifference[channel] = std::max(stats.maxAbsoluteDifference[channel], difference);
+				stats.sumOfSquaredDifferences += static_cast<uint64_t>(difference) * difference;
+				isMismatch = isMismatch || (difference > tolerance);
+
+				if(diffPixels) diffPixels[offset] = (hasAlpha && channel == numChannels - 1) ? 255 : difference;
+			}
+
+			if(isMismatch) stats.numMismatchedPixels++;
+		}
+	}
+
+	// The squared differences are summed in 32-bit lanes, which would overflow if they weren't flushed periodically
+	constexpr size_t NUM_ITERATIONS_PER_FLUSH = 4096;
+
+	static void mergeMaxDifferences(const uint8_t* maxDifferences, size_t numBytes, PixelDifferenceStats& stats) {
+		for(size_t index = 0; index < numBytes; index++)
+			stats.maxAbsoluteDifference[index % 4] = std::max(stats.maxAbsoluteDifference[index % 4], maxDifferences[index]);
+	}
+
+#if STBI_SIMD_X86
+	__attribute__((target("sse2"))) static void replaceColorSSE2(uint8_t* pixels, size_t numPixels, uint32_t sourceColor, uint32_t replacementColor) {
+		const __m128i source = _mm_set1_epi32(static_cast<int>(sourceColor));
+		const __m128i replacement = _mm_set1_epi32(static_cast<int>(replacementColor));
+
+		size_t index = 0;
+		for(; index + 4 <= numPixels; index += 4) {
+			__m128i* address = reinterpret_cast<__m128i*>(pixels + index * 4);
+			__m128i pixel = _mm_loadu_si128(address);
+			__m128i mask = _mm_cmpeq_epi32(pixel, source);
+			__m128i blended = _mm_or_si128(_mm_and_si128(mask, replacement), _mm_andnot_si128(mask, pixel));
+			_mm_storeu_si128(address, blended);
+		}
+
+		replaceColorScalar(pixels + index * 4, numPixels - index, sourceColor, replacementColor);
+	}
+
+	__attribute__((target("sse2"))) static void convertABGRToRGBASSE2(uint8_t* pixels, size_t numPixels) {
+		size_t index = 0;
+		for(; index + 4 <= numPixels; index += 4) {
+			__m128i* address = reinterpret_cast<__m128i*>(pixels + index * 4);
+			__m128i pixel = _mm_loadu_si128(address);
+			// There's no byte shuffle before SSSE3, so swap the 16-bit halves first and then the bytes within them
+			pixel = _mm_shufflelo_epi16(pixel, _MM_SHUFFLE(2, 3, 0, 1));
+			pixel = _mm_shufflehi_epi16(pixel, _MM_SHUFFLE(2, 3, 0, 1));
+			pixel = _mm_or_si128(_mm_slli_epi16(pixel, 8), _mm_srli_epi16(pixel, 8));
+			_mm_storeu_si128(address, pixel);
+		}
+
+		convertABGRToRGBAScalar(pixels + index * 4, numPixels - index);
+	}
+
+	__attribute__((target("sse2"))) static void compareRGBASSE2(const uint8_t* first, const uint8_t* second, size_t numPixels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i toleranceVector = _mm_set1_epi8(static_cast<char>(tolerance));
+		const __m128i opaqueAlpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		const __m128i channelMasks[4] = {
+			_mm_set1_epi32(0x000000FF),
+			_mm_set1_epi32(0x0000FF00),
+			_mm_set1_epi32(0x00FF0000),
+			_mm_set1_epi32(static_cast<int>(0xFF000000)),
+		};
+
+		__m128i maxDifference = zero;
+		__m128i channelSums[4] = { zero, zero, zero, zero };
+
+		size_t index = 0;
+		while(index + 4 <= numPixels) {
+			__m128i squareSums = zero;
+			size_t flushIndex = std::min(numPixels, index + 4 * NUM_ITERATIONS_PER_FLUSH);
+			for(; index + 4 <= flushIndex; index += 4) {
+				__m128i firstPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + index * 4));
+				__m128i secondPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + index * 4));
+				__m128i difference = _mm_or_si128(_mm_subs_epu8(firstPixels, secondPixels), _mm_subs_epu8(secondPixels, firstPixels));
+
+				maxDifference = _mm_max_epu8(maxDifference, difference);
+				for(size_t channel = 0; channel < 4; channel++)
+					channelSums[channel] = _mm_add_epi64(channelSums[channel], _mm_sad_epu8(_mm_and_si128(difference, channelMasks[channel]), zero));
+
+				__m128i low = _mm_unpacklo_epi8(difference, zero);
+				__m128i high = _mm_unpackhi_epi8(difference, zero);
+				squareSums = _mm_add_epi32(squareSums, _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high)));
+
+				__m128i isWithinTolerance = _mm_cmpeq_epi32(_mm_subs_epu8(difference, toleranceVector), zero);
+				stats.numMismatchedPixels += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(isWithinTolerance)));
+
+				if(diffPixels) _mm_storeu_si128(reinterpret_cast<__m128i*>(diffPixels + index * 4), _mm_or_si128(difference, opaqueAlpha));
+			}
+
+			alignas(16) uint32_t squares[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(squares), squareSums);
+			for(uint32_t square : squares)
+				stats.sumOfSquaredDifferences += square;
+		}
+
+		for(size_t channel = 0; channel < 4; channel++) {
+			alignas(16) uint64_t sums[2];
+			_mm_store_si128(reinterpret_cast<__m128i*>(sums), channelSums[channel]);
+			stats.sumOfAbsoluteDifferences[channel] += sums[0] + sums[1];
+		}
+
+		alignas(16) uint8_t maxDifferences[16];
+		_mm_store_si128(reinterpret_cast<__m128i*>(maxDifferences), maxDifference);
+		mergeMaxDifferences(maxDifferences, sizeof(maxDifferences), stats);
+
+		uint8_t* remainingDiffPixels = diffPixels ? diffPixels + index * 4 : nullptr;
+		comparePixelsScalar(first + index * 4, second + index * 4, numPixels - index, 4, tolerance, remainingDiffPixels, stats);
+	}
+
+	__attribute__((target("avx2"))) static void replaceColorAVX2(uint8_t* pixels, size_t numPixels, uint32_t sourceColor, uint32_t replacementColor) {
+		const __m256i source = _mm256_set1_epi32(static_cast<int>(sourceColor));
+		const __m256i replacement = _mm256_set1_epi32(static_cast<int>(replacementColor));
+
+		size_t index = 0;
+		for(; index + 8 <= numPixels; index += 8) {
+			__m256i* address = reinterpret_cast<__m256i*>(pixels + index * 4);
+			__m256i pixel = _mm256_loadu_si256(address);
+			__m256i mask = _mm256_cmpeq_epi32(pixel, source);
+			_mm256_storeu_si256(address, _mm256_blendv_epi8(pixel, replacement, mask));
+		}
+
+		replaceColorSSE2(pixels + index * 4, numPixels - index, sourceColor, replacementColor);
+	}
+
+	__attribute__((target("avx2"))) static void convertABGRToRGBAAVX2(uint8_t* pixels, size_t numPixels) {
+		const __m256i reverseBytesPerPixel = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+		size_t index = 0;
+		for(; index + 8 <= numPixels; index += 8) {
+			__m256i* address = reinterpret_cast<__m256i*>(pixels + index * 4);
+			__m256i pixel = _mm256_loadu_si256(address);
+			_mm256_storeu_si256(address, _mm256_shuffle_epi8(pixel, reverseBytesPerPixel));
+		}
+
+		convertABGRToRGBASSE2(pixels + index * 4, numPixels - index);
+	}
+
+	__attribute__((target("avx2"))) static void compareRGBAAVX2(const uint8_t* first, const uint8_t* second, size_t numPixels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats) {
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i toleranceVector = _mm256_set1_epi8(static_cast<char>(tolerance));
+		const __m256i opaqueAlpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+		const __m256i channelMasks[4] = {
+			_mm256_set1_epi32(0x000000FF),
+			_mm256_set1_epi32(0x0000FF00),
+			_mm256_set1_epi32(0x00FF0000),
+			_mm256_set1_epi32(static_cast<int>(0xFF000000)),
+		};
+
+		__m256i maxDifference = zero;
+		__m256i channelSums[4] = { zero, zero, zero, zero };
+
+		size_t index = 0;
+		while(index + 8 <= numPixels) {
+			__m256i squareSums = zero;
+			size_t flushIndex = std::min(numPixels, index + 8 * NUM_ITERATIONS_PER_FLUSH);
+			for(; index + 8 <= flushIndex; index += 8) {
+				__m256i firstPixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + index * 4));
+				__m256i secondPixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + index * 4));
+				__m256i difference = _mm256_or_si256(_mm256_subs_epu8(firstPixels, secondPixels), _mm256_subs_epu8(secondPixels, firstPixels));
+
+				maxDifference = _mm256_max_epu8(maxDifference, difference);
+				for(size_t channel = 0; channel < 4; channel++)
+					channelSums[channel] = _mm256_add_epi64(channelSums[channel], _mm256_sad_epu8(_mm256_and_si256(difference, channelMasks[channel]), zero));
+
+				__m256i low = _mm256_unpacklo_epi8(difference, zero);
+				__m256i high = _mm256_unpackhi_epi8(difference, zero);
+				squareSums = _mm256_add_epi32(squareSums, _mm256_add_epi32(_mm256_madd_epi16(low, low), _mm256_madd_epi16(high, high)));
+
+				__m256i isWithinTolerance = _mm256_cmpeq_epi32(_mm256_subs_epu8(difference, toleranceVector), zero);
+				stats.numMismatchedPixels += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(isWithinTolerance)));
+
+				if(diffPixels) _mm256_storeu_si256(reinterpret_cast<__m256i*>(diffPixels + index * 4), _mm256_or_si256(difference, opaqueAlpha));
+			}
+
+			alignas(32) uint32_t squares[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(squares), squareSums);
+			for(uint32_t square : squares)
+				stats.sumOfSquaredDifferences += square;
+		}
+
+		for(size_t channel = 0; channel < 4; channel++) {
+			alignas(32) uint64_t sums[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(sums), channelSums[channel]);
+			stats.sumOfAbsoluteDifferences[channel] += sums[0] + sums[1] + sums[2] + sums[3];
+		}
+
+		alignas(32) uint8_t maxDifferences[32];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(maxDifferences), maxDifference);
+		mergeMaxDifferences(maxDifferences, sizeof(maxDifferences), stats);
+
+		uint8_t* remainingDiffPixels = diffPixels ? diffPixels + index * 4 : nullptr;
+		compareRGBASSE2(first + index * 4, second + index * 4, numPixels - index, tolerance, remainingDiffPixels, stats);
+	}
+#endif
+
+	void replaceColorRGBA(uint8_t* pixels, size_t numPixels, uint32_t sourceColor, uint32_t replacementColor) {
+#if STBI_SIMD_X86
+		const stbi_simd_level_t level = activeLevel.load(std::memory_order_relaxed);
+		if(level == STBI_SIMD_AVX2) return replaceColorAVX2(pixels, numPixels, sourceColor, replacementColor);
+		if(level == STBI_SIMD_SSE2) return replaceColorSSE2(pixels, numPixels, sourceColor, replacementColor);
+#endif
+		replaceColorScalar(pixels, numPixels, sourceColor, replacementColor);
+	}
+
+	void convertABGRToRGBA(uint8_t* pixels, size_t numPixels) {
+#if STBI_SIMD_X86
+		const stbi_simd_level_t level = activeLevel.load(std::memory_order_relaxed);
+		if(level == STBI_SIMD_AVX2) return convertABGRToRGBAAVX2(pixels, numPixels);
+		if(level == STBI_SIMD_SSE2) return convertABGRToRGBASSE2(pixels, numPixels);
+#endif
+		convertABGRToRGBAScalar(pixels, numPixels);
+	}
+
+	void compareRGBA(const uint8_t* first, const uint8_t* second, size_t numPixels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats) {
+#if STBI_SIMD_X86
+		const stbi_simd_level_t level = activeLevel.load(std::memory_order_relaxed);
+		if(level == STBI_SIMD_AVX2) return compareRGBAAVX2(first, second, numPixels, tolerance, diffPixels, stats);
+		if(level == STBI_SIMD_SSE2) return compareRGBASSE2(first, second, numPixels, tolerance, diffPixels, stats);
+#endif
+		comparePixelsScalar(first, second, numPixels, 4, tolerance, diffPixels, stats);
+	}
+
+	void comparePixels(const uint8_t* first, const uint8_t* second, size_t numPixels, size_t numChannels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats) {
+		if(numChannels == 4) return compareRGBA(first, second, numPixels, tolerance, diffPixels, stats);
+		comparePixelsScalar(first, second, numPixels, numChannels, tolerance, diffPixels, stats);
+	}
+
+}
\ No newline at end of file
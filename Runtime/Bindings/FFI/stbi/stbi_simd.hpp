@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "stbi_ffi.hpp" // For the SIMD levels (the exports header lacks include guards)
+
+// Pixel transforms are bandwidth-bound, so they should process as many pixels per instruction as the CPU allows
+// The best available path is detected at runtime (it can be lowered manually, e.g., to compare them in benchmarks)
+namespace stbi_simd {
+	// Sums are accumulated across calls, so that images can be compared in chunks (e.g., by multiple threads)
+	struct PixelDifferenceStats {
+		uint64_t sumOfAbsoluteDifferences[4];
+		uint8_t maxAbsoluteDifference[4];
+		uint64_t sumOfSquaredDifferences;
+		size_t numMismatchedPixels;
+	};
+
+	stbi_simd_level_t getSupportedLevel();
+	stbi_simd_level_t getActiveLevel();
+	bool setActiveLevel(stbi_simd_level_t level);
+
+	void replaceColorRGBA(uint8_t* pixels, size_t numPixels, uint32_t sourceColor, uint32_t replacementColor);
+	void convertABGRToRGBA(uint8_t* pixels, size_t numPixels);
+	// Pixels mismatch if any channel differs by more than the tolerance (the diff image is optional, and always opaque)
+	void compareRGBA(const uint8_t* first, const uint8_t* second, size_t numPixels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats);
+	void comparePixels(const uint8_t* first, const uint8_t* second, size_t numPixels, size_t numChannels, uint8_t tolerance, uint8_t* diffPixels, PixelDifferenceStats& stats);
+}
\ No newline at end of file
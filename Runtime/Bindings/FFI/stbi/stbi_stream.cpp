@@ -0,0 +1,133 @@
+#include "stbi_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "stb_image.h" // Declarations only (the implementation lives in stbi_ffi.cpp)
+
+namespace stbi_stream {
+
+	// Synchronous requests never touch the loop, so there's no need to pass one (these may run on the thread pool)
+	bool openFile(const char* filePath, uv_file& fd) {
+		uv_fs_t request;
+		int result = uv_fs_open(nullptr, &request, filePath, UV_FS_O_RDONLY, 0, nullptr);
+		uv_fs_req_cleanup(&request);
+		if(result < 0) return false;
+
+		fd = static_cast<uv_file>(result);
+		return true;
+	}
+
+	void closeFile(uv_file fd) {
+		uv_fs_t request;
+		uv_fs_close(nullptr, &request, fd, nullptr);
+		uv_fs_req_cleanup(&request);
+	}
+
+	void initializeReader(FileReader& reader, uv_file fd, size_t bufferSize, size_t maxBytesToRead) {
+		reader.fd = fd;
+		reader.fileOffset = 0;
+		reader.buffer.resize(bufferSize);
+		reader.bufferOffset = 0;
+		reader.numBufferedBytes = 0;
+		reader.numBytesRead = 0;
+		reader.maxBytesToRead = maxBytesToRead;
+		reader.hasReachedEnd = false;
+		reader.hasFailed = false;
+	}
+
+	static void refillBuffer(FileReader& reader) {
+		reader.bufferOffset = 0;
+		reader.numBufferedBytes = 0;
+
+		// Hitting the limit looks like the end of the file to stb_image, which then fails gracefully
+		size_t numBytesToRead = std::min(reader.buffer.size(), reader.maxBytesToRead - reader.numBytesRead);
+		if(numBytesToRead == 0) {
+			reader.hasReachedEnd = true;
+			return;
+		}
+
+		uv_buf_t buffer = uv_buf_init(reinterpret_cast<char*>(reader.buffer.data()), static_cast<unsigned int>(numBytesToRead));
+		uv_fs_t request;
+		int result = uv_fs_read(nullptr, &request, reader.fd, &buffer, 1, reader.fileOffset, nullptr);
+		uv_fs_req_cleanup(&request);
+
+		if(result <= 0) {
+			reader.hasReachedEnd = true;
+			reader.hasFailed = (result < 0);
+			return;
+		}
+
+		reader.fileOffset += result;
+		reader.numBufferedBytes = static_cast<size_t>(result);
+		reader.numBytesRead += static_cast<size_t>(result);
+	}
+
+	static int readCallback(void* context, char* data, int size) {
+		FileReader& reader = *static_cast<FileReader*>(context);
+
+		int numBytesCopied = 0;
+		while(numBytesCopied < size) {
+			if(reader.bufferOffset == reader.numBufferedBytes) {
+				if(reader.hasReachedEnd) break;
+				refillBuffer(reader);
+				continue;
+			}
+
+			size_t numAvailableBytes = reader.numBufferedBytes - reader.bufferOffset;
+			size_t numBytesToCopy = std::min(numAvailableBytes, static_cast<size_t>(size - numBytesCopied));
+			memcpy(data + numBytesCopied, reader.buffer.data() + reader.bufferOffset, numBytesToCopy);
+
+			reader.bufferOffset += numBytesToCopy;
+			numBytesCopied += static_cast<int>(numBytesToCopy);
+		}
+
+		return numBytesCopied;
+	}
+
+	// stb_image may also skip backwards (with a negative count), though it's unlikely to ever leave the buffer
+	static void skipCallback(void* context, int numBytes) {
+		FileReader& reader = *static_cast<FileReader*>(context);
+
+		int64_t newBufferOffset = static_cast<int64_t>(reader.bufferOffset) + numBytes;
+		if(newBufferOffset >= 0 && newBufferOffset <= static_cast<int64_t>(reader.numBufferedBytes)) {
+			reader.bufferOffset = static_cast<size_t>(newBufferOffset);
+			return;
+		}
+
+		// The buffered data ends at the current file offset, so that's where the new position is computed from
+		int64_t currentPosition = reader.fileOffset - static_cast<int64_t>(reader.numBufferedBytes - reader.bufferOffset);
+		reader.fileOffset = std::max<int64_t>(currentPosition + numBytes, 0);
+		reader.bufferOffset = 0;
+		reader.numBufferedBytes = 0;
+		reader.hasReachedEnd = false;
+	}
+
+	static int eofCallback(void* context) {
+		FileReader& reader = *static_cast<FileReader*>(context);
+		if(reader.bufferOffset < reader.numBufferedBytes) return 0;
+		if(!reader.hasReachedEnd) refillBuffer(reader);
+
+		return reader.bufferOffset == reader.numBufferedBytes;
+	}
+
+	static const stbi_io_callbacks FILE_READER_CALLBACKS = { readCallback, skipCallback, eofCallback };
+
+	bool loadImage(FileReader& reader, stbi_image_t& image, stbi_color_depth_t colorDepth) {
+		if(colorDepth < NO_CONVERSION || colorDepth > CONVERT_TO_RGB_WITH_ALPHA) return false;
+
+		image.data = stbi_load_from_callbacks(&FILE_READER_CALLBACKS, &reader, &image.width, &image.height, &image.channels, colorDepth);
+		if(image.data && reader.hasFailed) {
+			stbi_image_free(image.data);
+			image.data = nullptr;
+		}
+
+		return image.data != nullptr;
+	}
+
+	bool readImageInfo(FileReader& reader, stbi_image_t& image) {
+		int success = stbi_info_from_callbacks(&FILE_READER_CALLBACKS, &reader, &image.width, &image.height, &image.channels);
+		return success && !reader.hasFailed;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "stbi_ffi.hpp" // For the image types (the exports header lacks include guards)
+
+// Decoding from memory means holding the compressed file and the decoded pixels at the same time (and it's pointless
+// if only the header is needed), so this feeds stb_image via its callback I/O while reading from the file directly
+namespace stbi_stream {
+	// stb_image requests 128 bytes at a time, which would be a syscall each if the reads weren't buffered here
+	constexpr size_t DEFAULT_READ_BUFFER_SIZE = 64 * 1024;
+	constexpr size_t HEADER_READ_BUFFER_SIZE = 4 * 1024;
+	// Enough for most headers (larger metadata segments are skipped without being read, so they don't count)
+	constexpr size_t MAX_HEADER_SIZE = 16 * 1024;
+
+	// Uses positional reads, starting at the beginning of the file (the descriptor's own offset isn't modified)
+	struct FileReader {
+		uv_file fd;
+		int64_t fileOffset;
+		std::vector<uint8_t> buffer;
+		size_t bufferOffset;
+		size_t numBufferedBytes;
+		size_t numBytesRead;
+		size_t maxBytesToRead;
+		bool hasReachedEnd;
+		bool hasFailed;
+	};
+
+	bool openFile(const char* filePath, uv_file& fd);
+	void closeFile(uv_file fd);
+
+	void initializeReader(FileReader& reader, uv_file fd, size_t bufferSize, size_t maxBytesToRead);
+	bool loadImage(FileReader& reader, stbi_image_t& image, stbi_color_depth_t colorDepth);
+	bool readImageInfo(FileReader& reader, stbi_image_t& image);
+}
\ No newline at end of file
@@ -0,0 +1,554 @@
+#include "stbi_transform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <numbers>
+#include <system_error>
+#include <vector>
+
+namespace stbi_transform {
+
+	static thread_local bool isParallelExecutionEnabledForThread = true;
+
+	void setParallelExecutionEnabled(bool isEnabled) {
+		isParallelExecutionEnabledForThread = isEnabled;
+	}
+
+	bool isParallelExecutionEnabled() {
+		return isParallelExecutionEnabledForThread;
+	}
+
+	struct ParallelJob {
+		const std::function<void(size_t)>& runTask;
+		const size_t numTasks;
+		std::atomic<size_t> nextTaskIndex = 0;
+		size_t numActiveWorkers = 0; // Guarded by the pool's mutex
+	};
+
+	static void runRemainingTasks(ParallelJob& job) {
+		for(size_t taskIndex = job.nextTaskIndex++; taskIndex < job.numTasks; taskIndex = job.nextTaskIndex++)
+			job.runTask(taskIndex);
+	}
+
+	class WorkerPool {
+	public:
+		explicit WorkerPool(size_t numWorkers) {
+			m_workers.reserve(numWorkers);
+			for(size_t index = 0; index < numWorkers; index++) {
+				try {
+					m_workers.emplace_back(&WorkerPool::RunWorker, this);
+				} catch(const std::system_error&) {
+					break; // Out of threads? The callers will just have to do more of the work themselves
+				}
+			}
+		}
+
+		~WorkerPool() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_isShuttingDown = true;
+			}
+			m_jobAvailable.notify_all();
+			for(std::thread& worker : m_workers)
+				worker.join();
+		}
+
+		void Run(ParallelJob& job) {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pendingJobs.push_back(&job);
+			}
+			m_jobAvailable.notify_all();
+
+			runRemainingTasks(job);
+
+			// All tasks have been claimed by now, but workers may still be busy with theirs (and they reference the job)
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto queuedJob = std::find(m_pendingJobs.begin(), m_pendingJobs.end(), &job);
+			if(queuedJob != m_pendingJobs.end()) m_pendingJobs.erase(queuedJob);
+			m_jobFinished.wait(lock, [&job] { return job.numActiveWorkers == 0; });
+		}
+
+	private:
+		void RunWorker() {
+			setParallelExecutionEnabled(false); // Nested calls would otherwise wait on the very workers that are running them
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while(true) {
+				m_jobAvailable.wait(lock, [this] { return m_isShuttingDown || !m_pendingJobs.empty(); });
+				if(m_isShuttingDown) return;
+
+				ParallelJob* job = m_pendingJobs.front();
+				if(job->nextTaskIndex >= job->numTasks) {
+					m_pendingJobs.pop_front(); // Nothing left to help with
+					continue;
+				}
+
+				job->numActiveWorkers++;
+				lock.unlock();
+				runRemainingTasks(*job);
+				lock.lock();
+				job->numActiveWorkers--;
+
+				if(job->numActiveWorkers == 0) m_jobFinished.notify_all();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::deque<ParallelJob*> m_pendingJobs;
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_jobFinished;
+		bool m_isShuttingDown = false;
+	};
+
+	void runInParallel(size_t numTasks, const std::function<void(size_t taskIndex)>& runTask) {
+		// The caller is one of the threads doing the work, so one less worker is needed to keep all cores busy
+		static WorkerPool workerPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+		ParallelJob job { runTask, numTasks };
+		workerPool.Run(job);
+	}
+
+	bool isValidImage(const stbi_image_t& image) {
+		if(!image.data) return false;
+		if(image.width <= 0 || image.height <= 0) return false;
+		return image.channels >= 1 && image.channels <= 4;
+	}
+
+	static size_t getImageSize(const stbi_image_t& image) {
+		return static_cast<size_t>(image.width) * static_cast<size_t>(image.height) * static_cast<size_t>(image.channels);
+	}
+
+	static size_t getRowSize(const stbi_image_t& image) {
+		return static_cast<size_t>(image.width) * static_cast<size_t>(image.channels);
+	}
+
+	static uint8_t* getPixel(const stbi_image_t& image, int x, int y) {
+		return image.data + static_cast<size_t>(y) * getRowSize(image) + static_cast<size_t>(x) * image.channels;
+	}
+
+	struct FilterContribution {
+		int firstSourceIndex;
+		int numTaps;
+		size_t firstWeightIndex;
+	};
+
+	struct FilterWeights {
+		std::vector<FilterContribution> contributions;
+		std::vector<float> weights;
+	};
+
+	static float getFilterRadius(stbi_resize_filter_t filter) {
+		switch(filter) {
+		case STBI_FILTER_BOX:
+			return 0.5f;
+		case STBI_FILTER_BILINEAR:
+			return 1.0f;
+		case STBI_FILTER_LANCZOS:
+			return 3.0f;
+		}
+		return 0.0f;
+	}
+
+	static float evaluateFilter(stbi_resize_filter_t filter, float distance) {
+		distance = std::fabs(distance);
+
+		switch(filter) {
+		case STBI_FILTER_BOX:
+			return distance <= 0.5f ? 1.0f : 0.0f;
+		case STBI_FILTER_BILINEAR:
+			return distance < 1.0f ? 1.0f - distance : 0.0f;
+		case STBI_FILTER_LANCZOS: {
+			if(distance < 1e-6f) return 1.0f;
+			if(distance >= 3.0f) return 0.0f;
+			float x = std::numbers::pi_v<float> * distance;
+			return 3.0f * std::sin(x) * std::sin(x / 3.0f) / (x * x);
+		}
+		}
+		return 0.0f;
+	}
+
+	// The weights only depend on the dimensions, so they're computed once per axis and not for every single row
+	static FilterWeights computeFilterWeights(int sourceSize, int destinationSize, stbi_resize_filter_t filter) {
+		FilterWeights result;
+		result.contributions.reserve(destinationSize);
+
+		float scale = static_cast<float>(sourceSize) / static_cast<float>(destinationSize);
+		float filterScale = std::max(scale, 1.0f); // Widening the filter when downscaling avoids aliasing artifacts
+		float support = getFilterRadius(filter) * filterScale;
+
+		for(int destinationIndex = 0; destinationIndex < destinationSize; destinationIndex++) {
+			float center = (static_cast<float>(destinationIndex) + 0.5f) * scale;
+			int first = std::max(0, static_cast<int>(std::floor(center - support)));
+			int last = std::min(sourceSize - 1, static_cast<int>(std::ceil(center + support)));
+
+			FilterContribution contribution = { first, last - first + 1, result.weights.size() };
+			float totalWeight = 0.0f;
+			for(int sourceIndex = first; sourceIndex <= last; sourceIndex++) {
+				float weight = evaluateFilter(filter, (static_cast<float>(sourceIndex) + 0.5f - center) / filterScale);
+				result.weights.push_back(weight);
+				totalWeight += weight;
+			}
+
+			// Taps outside of the image are dropped, so the remaining ones must be renormalized (clamp-to-edge)
+			for(int tap = 0; tap < contribution.numTaps; tap++) {
+				float& weight = result.weights[contribution.firstWeightIndex + tap];
+				weight = (totalWeight != 0.0f) ? weight / totalWeight : (tap == 0 ? 1.0f : 0.0f);
+			}
+
+			result.contributions.push_back(contribution);
+		}
+
+		return result;
+	}
+
+	static uint8_t toPixelValue(float value) {
+		// Lanczos may overshoot, so the result needs to be clamped (rounding also avoids darkening the image)
+		return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+	}
+
+	bool resizeImage(const stbi_image_t& source, stbi_image_t& destination, stbi_resize_filter_t filter) {
+		if(!isValidImage(source) || !isValidImage(destination)) return false;
+		if(source.channels != destination.channels) return false;
+		if(getFilterRadius(filter) == 0.0f) return false;
+
+		const int channels = source.channels;
+		FilterWeights horizontalWeights = computeFilterWeights(source.width, destination.width, filter);
+		FilterWeights verticalWeights = computeFilterWeights(source.height, destination.height, filter);
+
+		// Separable filters can be applied one axis at a time, which is much cheaper than sampling in 2D
+		const size_t intermediateRowSize = static_cast<size_t>(destination.width) * channels;
+		std::vector<float> intermediate(static_cast<size_t>(source.height) * intermediateRowSize);
+
+		forEachRowRange(source.height, destination.width, [&](int firstRow, int lastRow) {
+			for(int y = firstRow; y < lastRow; y++) {
+				const uint8_t* sourceRow = getPixel(source, 0, y);
+				float* intermediateRow = intermediate.data() + static_cast<size_t>(y) * intermediateRowSize;
+
+				for(int x = 0; x < destination.width; x++) {
+					const FilterContribution& contribution = horizontalWeights.contributions[x];
+					const float* weights = horizontalWeights.weights.data() + contribution.firstWeightIndex;
+
+					float accumulator[4] = {};
+					for(int tap = 0; tap < contribution.numTaps; tap++) {
+						const uint8_t* pixel = sourceRow + static_cast<size_t>(contribution.firstSourceIndex + tap) * channels;
+						for(int channel = 0; channel < channels; channel++) {
+							accumulator[channel] += weights[tap] * pixel[channel];
+						}
+					}
+
+					memcpy(intermediateRow + static_cast<size_t>(x) * channels, accumulator, channels * sizeof(float));
+				}
+			}
+		});
+
+		forEachRowRange(destination.height, destination.width, [&](int firstRow, int lastRow) {
+			std::vector<float> accumulator(intermediateRowSize);
+
+			for(int y = firstRow; y < lastRow; y++) {
+				const FilterContribution& contribution = verticalWeights.contributions[y];
+				const float* weights = verticalWeights.weights.data() + contribution.firstWeightIndex;
+
+				std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+				for(int tap = 0; tap < contribution.numTaps; tap++) {
+					const float* intermediateRow = intermediate.data() + static_cast<size_t>(contribution.firstSourceIndex + tap) * intermediateRowSize;
+					for(size_t index = 0; index < intermediateRowSize; index++) {
+						accumulator[index] += weights[tap] * intermediateRow[index];
+					}
+				}
+
+				uint8_t* destinationRow = getPixel(destination, 0, y);
+				for(size_t index = 0; index < intermediateRowSize; index++) {
+					destinationRow[index] = toPixelValue(accumulator[index]);
+				}
+			}
+		});
+
+		return true;
+	}
+
+	bool cropImage(const stbi_image_t& source, stbi_image_t& destination, int offsetX, int offsetY) {
+		if(!isValidImage(source) || !isValidImage(destination)) return false;
+		if(source.channels != destination.channels) return false;
+		if(offsetX < 0 || offsetY < 0) return false;
+		if(offsetX + destination.width > source.width) return false;
+		if(offsetY + destination.height > source.height) return false;
+
+		forEachRowRange(destination.height, destination.width, [&](int firstRow, int lastRow) {
+			for(int y = firstRow; y < lastRow; y++) {
+				memcpy(getPixel(destination, 0, y), getPixel(source, offsetX, offsetY + y), getRowSize(destination));
+			}
+		});
+
+		return true;
+	}
+
+	bool rotateImage(const stbi_image_t& source, stbi_image_t& destination, stbi_rotation_t rotation) {
+		if(!isValidImage(source) || !isValidImage(destination)) return false;
+		if(source.channels != destination.channels) return false;
+
+		bool isQuarterTurn = rotation == STBI_ROTATE_CLOCKWISE_90 || rotation == STBI_ROTATE_CLOCKWISE_270;
+		if(!isQuarterTurn && rotation != STBI_ROTATE_CLOCKWISE_180) return false;
+
+		int expectedWidth = isQuarterTurn ? source.height : source.width;
+		int expectedHeight = isQuarterTurn ? source.width : source.height;
+		if(destination.width != expectedWidth || destination.height != expectedHeight) return false;
+
+		const int channels = source.channels;
+		forEachRowRange(destination.height, destination.width, [&](int firstRow, int lastRow) {
+			for(int y = firstRow; y < lastRow; y++) {
+				uint8_t* destinationPixel = getPixel(destination, 0, y);
+				for(int x = 0; x < destination.width; x++) {
+					int sourceX, sourceY;
+					switch(rotation) {
+					case STBI_ROTATE_CLOCKWISE_90:
+						sourceX = y;
+						sourceY = source.height - 1 - x;
+						break;
+					case STBI_ROTATE_CLOCKWISE_180:
+						sourceX = source.width - 1 - x;
+						sourceY = source.height - 1 - y;
+						break;
+					default:
+						sourceX = source.width - 1 - y;
+						sourceY = x;
+						break;
+					}
+
+					memcpy(destinationPixel, getPixel(source, sourceX, sourceY), channels);
+					destinationPixel += channels;
+				}
+			}
+		});
+
+		return true;
+	}
+
+	bool flipImage(stbi_image_t& image, stbi_flip_axis_t axis) {
+		if(!isValidImage(image)) return false;
+
+		const int channels = image.channels;
+		if(axis == STBI_FLIP_HORIZONTAL) {
+			forEachRowRange(image.height, image.width, [&](int firstRow, int lastRow) {
+				for(int y = firstRow; y < lastRow; y++) {
+					for(int left = 0, right = image.width - 1; left < right; left++, right--) {
+						std::swap_ranges(getPixel(image, left, y), getPixel(image, left, y) + channels, getPixel(image, right, y));
+					}
+				}
+			});
+			return true;
+		}
+
+		if(axis == STBI_FLIP_VERTICAL) {
+			forEachRowRange(image.height / 2, image.width, [&](int firstRow, int lastRow) {
+				for(int y = firstRow; y < lastRow; y++) {
+					uint8_t* topRow = getPixel(image, 0, y);
+					std::swap_ranges(topRow, topRow + getRowSize(image), getPixel(image, 0, image.height - 1 - y));
+				}
+			});
+			return true;
+		}
+
+		return false;
+	}
+
+	bool premultiplyAlpha(stbi_image_t& image) {
+		if(!isValidImage(image)) return false;
+
+		// Images without an alpha channel are already premultiplied, in a manner of speaking
+		bool hasAlphaChannel = image.channels == 2 || image.channels == 4;
+		if(!hasAlphaChannel) return true;
+
+		const int numColorChannels = image.channels - 1;
+		forEachRowRange(image.height, image.width, [&](int firstRow, int lastRow) {
+			for(int y = firstRow; y < lastRow; y++) {
+				uint8_t* pixel = getPixel(image, 0, y);
+				for(int x = 0; x < image.width; x++, pixel += image.channels) {
+					unsigned int alpha = pixel[numColorChannels];
+					for(int channel = 0; channel < numColorChannels; channel++) {
+						pixel[channel] = static_cast<uint8_t>((pixel[channel] * alpha + 127) / 255);
+					}
+				}
+			}
+		});
+
+		return true;
+	}
+
+	// Same weights that stb_image uses when converting to greyscale, so that both conversions yield the same results
+	static uint8_t computeLuminance(uint8_t red, uint8_t green, uint8_t blue) {
+		return static_cast<uint8_t>((red * 77 + green * 150 + blue * 29) >> 8);
+	}
+
+	bool convertColorDepth(const stbi_image_t& source, stbi_image_t& destination) {
+		if(!isValidImage(source) || !isValidImage(destination)) return false;
+		if(source.width != destination.width || source.height != destination.height) return false;
+
+		forEachRowRange(destination.height, destination.width, [&](int firstRow, int lastRow) {
+			for(int y = firstRow; y < lastRow; y++) {
+				const uint8_t* sourcePixel = getPixel(source, 0, y);
+				uint8_t* destinationPixel = getPixel(destination, 0, y);
+
+				for(int x = 0; x < destination.width; x++) {
+					uint8_t rgba[4];
+					bool isGreyscale = source.channels <= 2;
+					rgba[0] = sourcePixel[0];
+					rgba[1] = isGreyscale ? sourcePixel[0] : sourcePixel[1];
+					rgba[2] = isGreyscale ? sourcePixel[0] : sourcePixel[2];
+					bool hasAlphaChannel = source.channels == 2 || source.channels == 4;
+					rgba[3] = hasAlphaChannel ? sourcePixel[source.channels - 1] : 255;
+
+					switch(destination.channels) {
+					case 1:
+						destinationPixel[0] = isGreyscale ? rgba[0] : computeLuminance(rgba[0], rgba[1], rgba[2]);
+						break;
+					case 2:
+						destinationPixel[0] = isGreyscale ? rgba[0] : computeLuminance(rgba[0], rgba[1], rgba[2]);
+						destinationPixel[1] = rgba[3];
+						break;
+					default:
+						memcpy(destinationPixel, rgba, destination.channels);
+						break;
+					}
+
+					sourcePixel += source.channels;
+					destinationPixel += destination.channels;
+				}
+			}
+		});
+
+		return true;
+	}
+
+	static bool getStepResultSize(const stbi_image_t& input, const stbi_transform_t& step, stbi_image_t& output) {
+		output.width = input.width;
+		output.height = input.height;
+		output.channels = input.channels;
+
+		switch(step.type) {
+		case STBI_TRANSFORM_RESIZE:
+			if(step.width <= 0 || step.height <= 0) return false;
+			if(getFilterRadius(step.filter) == 0.0f) return false;
+			output.width = step.width;
+			output.height = step.height;
+			return true;
+		case STBI_TRANSFORM_CROP:
+			if(step.offset_x < 0 || step.offset_y < 0 || step.width <= 0 || step.height <= 0) return false;
+			if(step.offset_x + step.width > input.width || step.offset_y + step.height > input.height) return false;
+			output.width = step.width;
+			output.height = step.height;
+			return true;
+		case STBI_TRANSFORM_ROTATE:
+			if(step.rotation == STBI_ROTATE_CLOCKWISE_180) return true;
+			if(step.rotation != STBI_ROTATE_CLOCKWISE_90 && step.rotation != STBI_ROTATE_CLOCKWISE_270) return false;
+			output.width = input.height;
+			output.height = input.width;
+			return true;
+		case STBI_TRANSFORM_FLIP:
+			return step.axis == STBI_FLIP_HORIZONTAL || step.axis == STBI_FLIP_VERTICAL;
+		case STBI_TRANSFORM_PREMULTIPLY_ALPHA:
+			return true;
+		case STBI_TRANSFORM_CONVERT_COLOR_DEPTH:
+			if(step.channels < 1 || step.channels > 4) return false;
+			output.channels = step.channels;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool getTransformedSize(const stbi_image_t& source, const stbi_transform_t* steps, size_t numSteps, stbi_image_t& result) {
+		if(!isValidImage(source)) return false;
+		if(!steps && numSteps > 0) return false;
+
+		stbi_image_t current = source;
+		for(size_t index = 0; index < numSteps; index++) {
+			if(!getStepResultSize(current, steps[index], result)) return false;
+			current.width = result.width;
+			current.height = result.height;
+			current.channels = result.channels;
+		}
+
+		result.width = current.width;
+		result.height = current.height;
+		result.channels = current.channels;
+		return true;
+	}
+
+	static bool isInPlaceTransform(const stbi_transform_t& step) {
+		return step.type == STBI_TRANSFORM_FLIP || step.type == STBI_TRANSFORM_PREMULTIPLY_ALPHA;
+	}
+
+	static bool isOverlapping(const stbi_image_t& first, const stbi_image_t& second) {
+		const uint8_t* firstStart = first.data;
+		const uint8_t* secondStart = second.data;
+		return firstStart < secondStart + getImageSize(second) && secondStart < firstStart + getImageSize(first);
+	}
+
+	static bool applyTransform(const stbi_image_t& input, const stbi_transform_t& step, stbi_image_t& output) {
+		if(isInPlaceTransform(step) && output.data != input.data) memcpy(output.data, input.data, getImageSize(input));
+
+		switch(step.type) {
+		case STBI_TRANSFORM_RESIZE:
+			return resizeImage(input, output, step.filter);
+		case STBI_TRANSFORM_CROP:
+			return cropImage(input, output, step.offset_x, step.offset_y);
+		case STBI_TRANSFORM_ROTATE:
+			return rotateImage(input, output, step.rotation);
+		case STBI_TRANSFORM_FLIP:
+			return flipImage(output, step.axis);
+		case STBI_TRANSFORM_PREMULTIPLY_ALPHA:
+			return premultiplyAlpha(output);
+		case STBI_TRANSFORM_CONVERT_COLOR_DEPTH:
+			return convertColorDepth(input, output);
+		}
+
+		return false;
+	}
+
+	bool applyTransforms(const stbi_image_t& source, const stbi_transform_t* steps, size_t numSteps, stbi_image_t& destination) {
+		stbi_image_t expectedResult;
+		if(!getTransformedSize(source, steps, numSteps, expectedResult)) return false;
+		if(!destination.data) return false;
+
+		bool hasExpectedSize = destination.width == expectedResult.width && destination.height == expectedResult.height && destination.channels == expectedResult.channels;
+		if(!hasExpectedSize) return false;
+
+		if(numSteps == 0) {
+			if(destination.data != source.data) memmove(destination.data, source.data, getImageSize(source));
+			return true;
+		}
+
+		// Intermediate results alternate between two scratch buffers, but the last step writes to the destination directly
+		std::vector<uint8_t> scratchBuffers[2];
+		stbi_image_t current = source;
+		for(size_t index = 0; index < numSteps; index++) {
+			stbi_image_t next;
+			getStepResultSize(current, steps[index], next);
+
+			// Writing to a buffer that's still being read would corrupt the pixels, unless the step works on them directly anyway
+			bool isLastStep = (index == numSteps - 1);
+			next.data = destination.data;
+			bool canWriteToDestination = !isOverlapping(current, next) || (isInPlaceTransform(steps[index]) && current.data == next.data);
+			if(!isLastStep || !canWriteToDestination) {
+				std::vector<uint8_t>& scratchBuffer = scratchBuffers[index % 2];
+				scratchBuffer.resize(getImageSize(next));
+				next.data = scratchBuffer.data();
+			}
+
+			if(!applyTransform(current, steps[index], next)) return false;
+			current = next;
+		}
+
+		if(current.data != destination.data) memcpy(destination.data, current.data, getImageSize(current));
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+#include "stbi_ffi.hpp" // For the image types (the exports header lacks include guards)
+
+// Generating thumbnails and the like shouldn't require shipping pixels to Lua (or another process) and back
+// All transforms work on 8-bit images with 1-4 channels, and larger images are split across threads row by row
+namespace stbi_transform {
+	// Handing work to other threads isn't free, so small images (i.e., most icons and thumbnails) are processed inline
+	constexpr size_t MIN_PIXELS_PER_THREAD = 64 * 1024;
+
+	// Work that's already running on a thread pool shouldn't spawn even more threads (this only affects the caller's thread)
+	void setParallelExecutionEnabled(bool isEnabled);
+	bool isParallelExecutionEnabled();
+
+	// The workers are started on first use and then kept around, since spawning threads for every image adds up quickly
+	// The calling thread processes tasks as well, and it only returns once all of them are done (in no particular order)
+	void runInParallel(size_t numTasks, const std::function<void(size_t taskIndex)>& runTask);
+
+	// Also used by the encoders, which is why it lives here (rows are always processed in ascending order within a range)
+	template <typename RowRangeFunction>
+	void forEachRowRange(int numRows, size_t numPixelsPerRow, RowRangeFunction processRows) {
+		size_t numPixels = static_cast<size_t>(numRows) * numPixelsPerRow;
+		size_t numAvailableThreads = std::max(1u, std::thread::hardware_concurrency());
+		size_t numThreads = std::min({ numAvailableThreads, numPixels / MIN_PIXELS_PER_THREAD, static_cast<size_t>(numRows) });
+
+		if(numThreads <= 1 || !isParallelExecutionEnabled()) {
+			processRows(0, numRows);
+			return;
+		}
+
+		int numRowsPerThread = static_cast<int>((static_cast<size_t>(numRows) + numThreads - 1) / numThreads);
+		runInParallel(numThreads, [&](size_t rangeIndex) {
+			int firstRow = static_cast<int>(rangeIndex) * numRowsPerThread;
+			if(firstRow < numRows) processRows(firstRow, std::min(firstRow + numRowsPerThread, numRows));
+		});
+	}
+
+	bool isValidImage(const stbi_image_t& image);
+
+	bool resizeImage(const stbi_image_t& source, stbi_image_t& destination, stbi_resize_filter_t filter);
+	bool cropImage(const stbi_image_t& source, stbi_image_t& destination, int offsetX, int offsetY);
+	bool rotateImage(const stbi_image_t& source, stbi_image_t& destination, stbi_rotation_t rotation);
+	bool flipImage(stbi_image_t& image, stbi_flip_axis_t axis);
+	bool premultiplyAlpha(stbi_image_t& image);
+	bool convertColorDepth(const stbi_image_t& source, stbi_image_t& destination);
+
+	// Steps are applied in order, using scratch buffers for the intermediate results (only the last one is exposed)
+	// The destination may share its pixels with the source, in which case the last step goes through a scratch buffer as well
+	bool getTransformedSize(const stbi_image_t& source, const stbi_transform_t* steps, size_t numSteps, stbi_image_t& result);
+	bool applyTransforms(const stbi_image_t& source, const stbi_transform_t* steps, size_t numSteps, stbi_image_t& destination);
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "stduuid_codec.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STDUUID_CODEC_X86 1
+#include <immintrin.h>
+#else
+#define STDUUID_CODEC_X86 0
+#endif
+
+namespace stduuid_codec {
+
+	constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+	// The dashes separate the groups of 8-4-4-4-12 hex digits
+	static constexpr bool isDashOffset(size_t offset) {
+		return offset == 8 || offset == 13 || offset == 18 || offset == 23;
+	}
+
+	constexpr size_t COMPACT_STRING_LENGTH = 2 * UUID_BINARY_SIZE;
+	constexpr size_t BRACED_STRING_LENGTH = UUID_RFC_STRING_LENGTH + 2;
+
+	// Anything that isn't a hex digit maps to a value with the high bits set, so errors can be checked once at the end
+	constexpr uint8_t INVALID_HEX_DIGIT = 0xF0;
+	constexpr std::array<uint8_t, 256> HEX_DIGIT_VALUES = [] {
+		std::array<uint8_t, 256> values {};
+		for(size_t index = 0; index < values.size(); index++) {
+			if(index >= '0' && index <= '9') values[index] = static_cast<uint8_t>(index - '0');
+			else if(index >= 'a' && index <= 'f') values[index] = static_cast<uint8_t>(index - 'a' + 10);
+			else if(index >= 'A' && index <= 'F') values[index] = static_cast<uint8_t>(index - 'A' + 10);
+			else values[index] = INVALID_HEX_DIGIT;
+		}
+		return values;
+	}();
+
+	// Where each hex digit is found in the input, depending on whether there are dashes in between the groups
+	constexpr std::array<uint8_t, COMPACT_STRING_LENGTH> CANONICAL_DIGIT_OFFSETS = [] {
+		std::array<uint8_t, COMPACT_STRING_LENGTH> offsets {};
+		for(size_t offset = 0, index = 0; offset < UUID_RFC_STRING_LENGTH; offset++) {
+			if(!isDashOffset(offset)) offsets[index++] = static_cast<uint8_t>(offset);
+		}
+		return offsets;
+	}();
+	constexpr std::array<uint8_t, COMPACT_STRING_LENGTH> COMPACT_DIGIT_OFFSETS = [] {
+		std::array<uint8_t, COMPACT_STRING_LENGTH> offsets {};
+		for(size_t index = 0; index < offsets.size(); index++)
+			offsets[index] = static_cast<uint8_t>(index);
+		return offsets;
+	}();
+
+	static void formatScalar(const uint8_t* binary, char* output) {
+		for(size_t offset = 0, index = 0; offset < UUID_RFC_STRING_LENGTH; index++) {
+			if(isDashOffset(offset)) output[offset++] = '-';
+			output[offset++] = HEX_DIGITS[binary[index] >> 4];
+			output[offset++] = HEX_DIGITS[binary[index] & 0x0F];
+		}
+	}
+
+#if STDUUID_CODEC_X86
+
+	static bool detectSSSE3() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3");
+	}
+
+	static const bool hasSSSE3 = detectSSSE3();
+
+	// All 32 hex digits are looked up at once, and then moved to their final positions (leaving gaps for the dashes)
+	__attribute__((target("ssse3"))) static void formatSSSE3(const uint8_t* binary, char* output) {
+		const __m128i DIGITS = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+		const __m128i LOW_NIBBLE_MASK = _mm_set1_epi8(0x0F);
+
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(binary));
+		const __m128i highDigits = _mm_shuffle_epi8(DIGITS, _mm_and_si128(_mm_srli_epi16(bytes, 4), LOW_NIBBLE_MASK));
+		const __m128i lowDigits = _mm_shuffle_epi8(DIGITS, _mm_and_si128(bytes, LOW_NIBBLE_MASK));
+		const __m128i firstHalf = _mm_unpacklo_epi8(highDigits, lowDigits); // Digits 0-15
+		const __m128i secondHalf = _mm_unpackhi_epi8(highDigits, lowDigits); // Digits 16-31
+
+		// Indices with the high bit set produce zeroes, which are then replaced with dashes where needed
+		const char Z = static_cast<char>(0x80);
+		const __m128i firstBlock = _mm_or_si128(
+			_mm_shuffle_epi8(firstHalf, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, Z, 8, 9, 10, 11, Z, 12, 13)),
+			_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0));
+		const __m128i secondBlock = _mm_or_si128(
+			_mm_or_si128(
+				_mm_shuffle_epi8(firstHalf, _mm_setr_epi8(14, 15, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z)),
+				_mm_shuffle_epi8(secondHalf, _mm_setr_epi8(Z, Z, Z, 0, 1, 2, 3, Z, 4, 5, 6, 7, 8, 9, 10, 11))),
+			_mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0));
+		const int lastDigits = _mm_cvtsi128_si32(_mm_srli_si128(secondHalf, 12));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), firstBlock);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), secondBlock);
+		memcpy(output + 32, &lastDigits, sizeof(lastDigits));
+	}
+
+#else
+
+	static const bool hasSSSE3 = false;
+
+	static void formatSSSE3(const uint8_t* binary, char* output) {}
+
+#endif
+
+	void formatRFCString(const uint8_t* binary, char* output) {
+		if(hasSSSE3) formatSSSE3(binary, output);
+		else formatScalar(binary, output);
+	}
+
+	void formatRFCStrings(const uint8_t* binary, size_t numUUIDs, char* output) {
+		for(size_t index = 0; index < numUUIDs; index++)
+			formatRFCString(binary + index * UUID_BINARY_SIZE, output + index * UUID_RFC_STRING_LENGTH);
+	}
+
+	static bool decodeHexDigits(const char* input, const std::array<uint8_t, COMPACT_STRING_LENGTH>& digitOffsets, uint8_t* output) {
+		uint8_t errorBits = 0;
+		for(size_t index = 0; index < UUID_BINARY_SIZE; index++) {
+			const uint8_t highNibble = HEX_DIGIT_VALUES[static_cast<uint8_t>(input[digitOffsets[2 * index]])];
+			const uint8_t lowNibble = HEX_DIGIT_VALUES[static_cast<uint8_t>(input[digitOffsets[2 * index + 1]])];
+			errorBits |= highNibble | lowNibble;
+			output[index] = static_cast<uint8_t>((highNibble << 4) | lowNibble);
+		}
+		return (errorBits & INVALID_HEX_DIGIT) == 0;
+	}
+
+	static inline bool hasDashes(const char* input) {
+		return (input[8] == '-') & (input[13] == '-') & (input[18] == '-') & (input[23] == '-');
+	}
+
+	bool parseUUID(const char* input, size_t length, uint8_t* output) {
+		if(input == nullptr) return false;
+
+		// Decoding into a temporary buffer means the output is left untouched if the input turns out to be invalid
+		uint8_t binary[UUID_BINARY_SIZE];
+		bool isValid = false;
+		switch(length) {
+		case UUID_RFC_STRING_LENGTH:
+			isValid = hasDashes(input) & decodeHexDigits(input, CANONICAL_DIGIT_OFFSETS, binary);
+			break;
+		case BRACED_STRING_LENGTH:
+			isValid = (input[0] == '{') & (input[BRACED_STRING_LENGTH - 1] == '}') & hasDashes(input + 1) & decodeHexDigits(input + 1, CANONICAL_DIGIT_OFFSETS, binary);
+			break;
+		case COMPACT_STRING_LENGTH:
+			isValid = decodeHexDigits(input, COMPACT_DIGIT_OFFSETS, binary);
+			break;
+		}
+
+		if(isValid && output) memcpy(output, binary, UUID_BINARY_SIZE);
+		return isValid;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "stduuid_ffi.hpp" // For the UUID types (the exports header lacks include guards)
+
+// Formatting UUIDs by hand avoids the temporary std::string (and the stream machinery) that uuids::to_string uses
+// Invalid input makes the parser return false, whereas uuids::uuid::from_string(...).value() would throw
+namespace stduuid_codec {
+	// Writes exactly UUID_RFC_STRING_LENGTH characters (lowercase hex digits and dashes, without a null terminator)
+	void formatRFCString(const uint8_t* binary, char* output);
+	void formatRFCStrings(const uint8_t* binary, size_t numUUIDs, char* output);
+
+	// Accepts the canonical, braced, and compact (hex digits only) forms, in any case; the output is optional
+	bool parseUUID(const char* input, size_t length, uint8_t* output);
+}
\ No newline at end of file
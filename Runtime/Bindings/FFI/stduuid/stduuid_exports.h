@@ -1,10 +1,39 @@
 // RFC UUIDs are always 36 characters (+ null terminator)
 typedef char uuid_rfc_string_t[37];
 
+enum {
+	UUID_BINARY_SIZE = 16,
+	UUID_RFC_STRING_LENGTH = 36,
+};
+
+typedef enum uuid_version_t {
+	UUID_VERSION_RANDOM = 4,
+	UUID_VERSION_TIME_ORDERED = 7, // Sortable by creation time, which makes them better suited for database keys
+} uuid_version_t;
+
+typedef enum uuid_format_t {
+	UUID_FORMAT_BINARY, // 16 bytes per UUID
+	UUID_FORMAT_RFC_STRING, // 36 characters per UUID (no null terminators)
+} uuid_format_t;
+
+typedef struct uuid_string_ref_t {
+	const char* data;
+	size_t length;
+} uuid_string_ref_t;
+
 struct static_stduuid_exports_table {
 	const char* (*stduuid_version)(void);
 	bool (*uuid_create_v4)(uuid_rfc_string_t* result);
 	bool (*uuid_create_mt19937)(uuid_rfc_string_t* result);
 	bool (*uuid_create_v5)(const char* namespace_uuid_str, const char* name, uuid_rfc_string_t* result);
 	bool (*uuid_create_system)(uuid_rfc_string_t* result);
+	bool (*uuid_create_v7)(uuid_rfc_string_t* result);
+
+	// Bulk API (UUIDs are written back to back, so the buffer must have room for num_uuids times the size of the format)
+	bool (*uuid_create_batch)(uuid_version_t version, uuid_format_t format, size_t num_uuids, char* output);
+	void (*uuid_format_batch)(const uint8_t* uuids, size_t num_uuids, char* output);
+
+	// Validation API (canonical, braced, and compact hex strings are accepted; the outputs are optional)
+	bool (*uuid_parse)(const char* input, size_t length, uint8_t* result);
+	size_t (*uuid_validate_batch)(const uuid_string_ref_t* inputs, size_t num_inputs, bool* results);
 };
\ No newline at end of file
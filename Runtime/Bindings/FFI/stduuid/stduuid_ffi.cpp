@@ -1,12 +1,15 @@
 #include <random>
 #include <array>
+#include <cstring>
 
 // The platform-specific RNG APIs aren't enabled by default since they're non-standard
 #define UUID_SYSTEM_GENERATOR
 #include "uuid.h"
 #undef UUID_SYSTEM_GENERATOR
 
+#include "stduuid_codec.hpp"
 #include "stduuid_ffi.hpp"
+#include "stduuid_generator.hpp"
 
 std::ranlux48_base create_basic_generator() {
 	std::random_device random_number_generator;
@@ -28,18 +31,20 @@ std::mt19937 create_mt19937_generator() {
 	return std::mt19937(random_byte_sequence);
 }
 
-// Static generators are kept around so that they don't need to be seeded for every UUID
-static std::ranlux48_base low_quality_rng = create_basic_generator();
-static std::mt19937 high_quality_rng = create_mt19937_generator();
+// Generators are kept around so that they don't need to be seeded for every UUID (one per thread, since they aren't thread-safe)
+static thread_local std::ranlux48_base low_quality_rng = create_basic_generator();
+static thread_local std::mt19937 high_quality_rng = create_mt19937_generator();
+
+static void format_rfc_string(const uuids::uuid& id, uuid_rfc_string_t* result) {
+	stduuid_codec::formatRFCString(reinterpret_cast<const uint8_t*>(id.as_bytes().data()), *result);
+	(*result)[UUID_RFC_STRING_LENGTH] = '\0';
+}
 
 bool uuid_create_v4(uuid_rfc_string_t* result) {
 	uuids::basic_uuid_random_generator<std::ranlux48_base> gen(&low_quality_rng);
 
 	uuids::uuid const id = gen();
-	std::string str_id = uuids::to_string(id);
-
-	std::memcpy(result, str_id.c_str(), str_id.size());
-	(*result)[str_id.size()] = '\0';
+	format_rfc_string(id, result);
 
 	return true;
 }
@@ -48,37 +53,73 @@ bool uuid_create_mt19937(uuid_rfc_string_t* result) {
 	uuids::basic_uuid_random_generator<std::mt19937> gen(&high_quality_rng);
 
 	uuids::uuid const id = gen();
-	std::string str_id = uuids::to_string(id);
-
-	std::memcpy(result, str_id.c_str(), str_id.size());
-	(*result)[str_id.size()] = '\0';
+	format_rfc_string(id, result);
 
 	return true;
 }
 
 bool uuid_create_v5(const char* namespace_uuid_str, const char* name, uuid_rfc_string_t* result) {
-	uuids::uuid namespace_uuid = uuids::uuid::from_string(namespace_uuid_str).value();
+	if(namespace_uuid_str == nullptr || name == nullptr) return false;
+
+	// Unwrapping the result of uuids::uuid::from_string would throw (and bring down the process) for malformed input
+	uint8_t namespace_bytes[UUID_BINARY_SIZE];
+	if(!stduuid_codec::parseUUID(namespace_uuid_str, strlen(namespace_uuid_str), namespace_bytes)) return false;
+
+	uuids::uuid namespace_uuid(std::begin(namespace_bytes), std::end(namespace_bytes));
 	uuids::uuid_name_generator gen(namespace_uuid);
 	uuids::uuid const id = gen(name);
 
-	std::string str_id = uuids::to_string(id);
-
-	std::memcpy(result, str_id.c_str(), str_id.size());
-	(*result)[str_id.size()] = '\0';
+	format_rfc_string(id, result);
 
 	return true;
 }
 
 bool uuid_create_system(uuid_rfc_string_t* result) {
 	uuids::uuid const id = uuids::uuid_system_generator {}();
-	std::string str_id = uuids::to_string(id);
+	format_rfc_string(id, result);
+
+	return true;
+}
+
+bool uuid_create_v7(uuid_rfc_string_t* result) {
+	uint8_t id[UUID_BINARY_SIZE];
+	stduuid_generator::generateTimeOrderedUUIDs(id, 1);
 
-	std::memcpy(result, str_id.c_str(), str_id.size());
-	(*result)[str_id.size()] = '\0';
+	stduuid_codec::formatRFCString(id, *result);
+	(*result)[UUID_RFC_STRING_LENGTH] = '\0';
 
 	return true;
 }
 
+bool uuid_create_batch(uuid_version_t version, uuid_format_t format, size_t num_uuids, char* output) {
+	if(output == nullptr) return false;
+
+	return stduuid_generator::generateBatch(version, format, num_uuids, output);
+}
+
+void uuid_format_batch(const uint8_t* uuids, size_t num_uuids, char* output) {
+	if(uuids == nullptr || output == nullptr) return;
+
+	stduuid_codec::formatRFCStrings(uuids, num_uuids, output);
+}
+
+bool uuid_parse(const char* input, size_t length, uint8_t* result) {
+	return stduuid_codec::parseUUID(input, length, result);
+}
+
+size_t uuid_validate_batch(const uuid_string_ref_t* inputs, size_t num_inputs, bool* results) {
+	if(inputs == nullptr) return 0;
+
+	size_t num_valid_inputs = 0;
+	for(size_t index = 0; index < num_inputs; index++) {
+		bool is_valid = stduuid_codec::parseUUID(inputs[index].data, inputs[index].length, nullptr);
+		if(results) results[index] = is_valid;
+		num_valid_inputs += is_valid;
+	}
+
+	return num_valid_inputs;
+}
+
 namespace stduuid_ffi {
 
 	const char* stduuid_version() {
@@ -93,6 +134,11 @@ namespace stduuid_ffi {
 			.uuid_create_mt19937 = uuid_create_mt19937,
 			.uuid_create_v5 = uuid_create_v5,
 			.uuid_create_system = uuid_create_system,
+			.uuid_create_v7 = uuid_create_v7,
+			.uuid_create_batch = uuid_create_batch,
+			.uuid_format_batch = uuid_format_batch,
+			.uuid_parse = uuid_parse,
+			.uuid_validate_batch = uuid_validate_batch,
 		};
 
 		return &exports;
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "stduuid_exports.h"
 
 bool uuid_create_v4(uuid_rfc_string_t* result);
 bool uuid_create_mt19937(uuid_rfc_string_t* result);
 bool uuid_create_v5(const char* namespace_uuid_str, const char* name, uuid_rfc_string_t* result);
 bool uuid_create_system(uuid_rfc_string_t* result);
+bool uuid_create_v7(uuid_rfc_string_t* result);
+bool uuid_create_batch(uuid_version_t version, uuid_format_t format, size_t num_uuids, char* output);
+void uuid_format_batch(const uint8_t* uuids, size_t num_uuids, char* output);
+bool uuid_parse(const char* input, size_t length, uint8_t* result);
+size_t uuid_validate_batch(const uuid_string_ref_t* inputs, size_t num_inputs, bool* results);
 
 namespace stduuid_ffi {
 	void* getExportsTable();
@@ -0,0 +1,116 @@
+#include "stduuid_codec.hpp"
+#include "stduuid_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+
+namespace stduuid_generator {
+
+	// String batches are generated in binary form first, which only needs a small buffer on the stack
+	constexpr size_t NUM_UUIDS_PER_CHUNK = 64;
+
+	// The counter spans the 12 bits after the timestamp and the 6 bits after the variant (method 1 in RFC 9562, section 6.2)
+	constexpr uint32_t MAX_COUNTER_VALUE = 0x3FFFF;
+	// Starting at a random offset with the highest bit unset leaves room for at least 2^17 UUIDs per millisecond
+	constexpr uint32_t COUNTER_SEED_MASK = 0x1FFFF;
+	// Reading the clock can cost more than generating the UUID, and a few microseconds don't matter here
+	constexpr size_t NUM_UUIDS_PER_CLOCK_READ = 64;
+
+	static std::mt19937_64 createGenerator() {
+		std::random_device randomDevice;
+		auto seedData = std::array<unsigned int, 8> {};
+
+		std::generate(std::begin(seedData), std::end(seedData), std::ref(randomDevice));
+		std::seed_seq seedSequence(std::begin(seedData), std::end(seedData));
+
+		return std::mt19937_64(seedSequence);
+	}
+
+	static std::mt19937_64& getGenerator() {
+		static thread_local std::mt19937_64 generator = createGenerator();
+		return generator;
+	}
+
+	static inline void setVariant(uint8_t* uuid) {
+		uuid[8] = static_cast<uint8_t>((uuid[8] & 0x3F) | 0x80);
+	}
+
+	void generateRandomUUIDs(uint8_t* output, size_t numUUIDs) {
+		std::mt19937_64& generator = getGenerator();
+
+		for(size_t index = 0; index < numUUIDs; index++) {
+			uint8_t* uuid = output + index * UUID_BINARY_SIZE;
+			const uint64_t randomBits[2] = { generator(), generator() };
+			memcpy(uuid, randomBits, sizeof(randomBits));
+
+			uuid[6] = static_cast<uint8_t>((uuid[6] & 0x0F) | 0x40);
+			setVariant(uuid);
+		}
+	}
+
+	struct TimeOrderedState {
+		uint64_t lastTimestamp = 0;
+		uint32_t counter = 0;
+	};
+
+	static uint64_t getUnixTimeInMilliseconds() {
+		auto timeSinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceEpoch).count());
+	}
+
+	void generateTimeOrderedUUIDs(uint8_t* output, size_t numUUIDs) {
+		static thread_local TimeOrderedState state;
+		std::mt19937_64& generator = getGenerator();
+
+		uint64_t timestamp = 0;
+		for(size_t index = 0; index < numUUIDs; index++) {
+			if(index % NUM_UUIDS_PER_CLOCK_READ == 0) timestamp = getUnixTimeInMilliseconds();
+			if(timestamp > state.lastTimestamp) {
+				state.lastTimestamp = timestamp;
+				state.counter = static_cast<uint32_t>(generator() & COUNTER_SEED_MASK);
+			} else if(state.counter < MAX_COUNTER_VALUE) {
+				state.counter++; // Also keeps the order intact if the system clock was turned back
+			} else {
+				state.lastTimestamp++; // Borrowing from the next millisecond is the only way to stay ordered here
+				state.counter = static_cast<uint32_t>(generator() & COUNTER_SEED_MASK);
+			}
+
+			uint8_t* uuid = output + index * UUID_BINARY_SIZE;
+			for(size_t byteIndex = 0; byteIndex < 6; byteIndex++)
+				uuid[byteIndex] = static_cast<uint8_t>(state.lastTimestamp >> (40 - 8 * byteIndex));
+			uuid[6] = static_cast<uint8_t>(0x70 | (state.counter >> 14));
+			uuid[7] = static_cast<uint8_t>(state.counter >> 6);
+			uuid[8] = static_cast<uint8_t>(0x80 | (state.counter & 0x3F));
+
+			const uint64_t randomBits = generator();
+			memcpy(uuid + 9, &randomBits, UUID_BINARY_SIZE - 9);
+		}
+	}
+
+	bool generateBatch(uuid_version_t version, uuid_format_t format, size_t numUUIDs, char* output) {
+		void (*generate)(uint8_t*, size_t) = nullptr;
+		if(version == UUID_VERSION_RANDOM) generate = &generateRandomUUIDs;
+		if(version == UUID_VERSION_TIME_ORDERED) generate = &generateTimeOrderedUUIDs;
+		if(!generate) return false;
+
+		if(format == UUID_FORMAT_BINARY) {
+			generate(reinterpret_cast<uint8_t*>(output), numUUIDs);
+			return true;
+		}
+		if(format != UUID_FORMAT_RFC_STRING) return false;
+
+		uint8_t chunk[NUM_UUIDS_PER_CHUNK * UUID_BINARY_SIZE];
+		for(size_t offset = 0; offset < numUUIDs; offset += NUM_UUIDS_PER_CHUNK) {
+			size_t numUUIDsInChunk = std::min(NUM_UUIDS_PER_CHUNK, numUUIDs - offset);
+			generate(chunk, numUUIDsInChunk);
+			stduuid_codec::formatRFCStrings(chunk, numUUIDsInChunk, output + offset * UUID_RFC_STRING_LENGTH);
+		}
+
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "stduuid_ffi.hpp" // For the UUID types (the exports header lacks include guards)
+
+// Each thread seeds its own generator on first use, so that no locking is required (and the state isn't shared)
+namespace stduuid_generator {
+	// Writes numUUIDs * UUID_BINARY_SIZE bytes, with the version and variant bits already set
+	void generateRandomUUIDs(uint8_t* output, size_t numUUIDs);
+	// UUIDs generated by the same thread are strictly increasing, even if many are created within the same millisecond
+	void generateTimeOrderedUUIDs(uint8_t* output, size_t numUUIDs);
+
+	bool generateBatch(uuid_version_t version, uuid_format_t format, size_t numUUIDs, char* output);
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "EventLoopMetrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+constexpr uint64_t NANOSECONDS_PER_MILLISECOND = 1000 * 1000;
+
+EventLoopMetrics::EventLoopMetrics(uv_loop_t* loop)
+	: m_loop(loop) {
+	// Without this, libuv doesn't track the time spent in the kernel's event provider (i.e., waiting for I/O)
+	uv_loop_configure(m_loop, UV_METRICS_IDLE_TIME);
+
+	m_startTime = uv_hrtime();
+	m_lastCheckTime = m_startTime;
+
+	uv_prepare_init(m_loop, &m_prepareHandle);
+	m_prepareHandle.data = this;
+	uv_prepare_start(&m_prepareHandle, OnPrepare);
+	uv_unref(reinterpret_cast<uv_handle_t*>(&m_prepareHandle));
+
+	uv_check_init(m_loop, &m_checkHandle);
+	m_checkHandle.data = this;
+	uv_check_start(&m_checkHandle, OnCheck);
+	uv_unref(reinterpret_cast<uv_handle_t*>(&m_checkHandle));
+}
+
+void EventLoopMetrics::InstallCallbackHandler(lua_State* L) {
+	luv_ctx_t* context = luv_context(L);
+	m_originalCallbackHandler = context->cb_pcall;
+	context->extra = this;
+	luv_set_callback(L, OnCallback);
+}
+
+void EventLoopMetrics::OnLoopStarted() {
+	m_lastCheckTime = uv_hrtime();
+}
+
+void EventLoopMetrics::Stop() {
+	uv_prepare_stop(&m_prepareHandle);
+	uv_check_stop(&m_checkHandle);
+}
+
+void EventLoopMetrics::GetMetrics(runtime_event_loop_metrics_t* metrics) const {
+	*metrics = m_metrics;
+	metrics->run_time_in_nanoseconds = uv_hrtime() - m_startTime;
+	metrics->idle_time_in_nanoseconds = uv_metrics_idle_time(m_loop);
+}
+
+void EventLoopMetrics::ResetPeaks() {
+	m_metrics.max_lag_in_nanoseconds = 0;
+	m_metrics.max_callback_time_in_nanoseconds = 0;
+	m_metrics.slowest_callback[0] = '\0';
+}
+
+void EventLoopMetrics::OnPrepare(uv_prepare_t* handle) {
+	EventLoopMetrics* metrics = static_cast<EventLoopMetrics*>(handle->data);
+	metrics->m_pollStartTime = uv_hrtime();
+	metrics->m_idleTimeBeforePoll = uv_metrics_idle_time(metrics->m_loop);
+}
+
+void EventLoopMetrics::OnCheck(uv_check_t* handle) {
+	EventLoopMetrics* metrics = static_cast<EventLoopMetrics*>(handle->data);
+	uint64_t now = uv_hrtime();
+
+	// I/O callbacks run during the poll phase, so only the time spent waiting for events can be subtracted
+	uint64_t busyTimeBeforePoll = metrics->m_pollStartTime - std::min(metrics->m_lastCheckTime, metrics->m_pollStartTime);
+	uint64_t idleTimeDuringPoll = uv_metrics_idle_time(metrics->m_loop) - metrics->m_idleTimeBeforePoll;
+	uint64_t pollTime = now - metrics->m_pollStartTime;
+	uint64_t busyTimeDuringPoll = pollTime - std::min(idleTimeDuringPoll, pollTime);
+
+	metrics->RecordIteration(busyTimeBeforePoll + busyTimeDuringPoll);
+	metrics->m_lastCheckTime = now;
+}
+
+int EventLoopMetrics::OnCallback(lua_State* L, int numArgs, int numResults, int flags) {
+	EventLoopMetrics* metrics = static_cast<EventLoopMetrics*>(luv_context(L)->extra);
+
+	// The function is consumed by the call, but it's needed to find out where the slowest callback was defined
+	lua_pushvalue(L, -(numArgs + 1));
+	lua_insert(L, -(numArgs + 2));
+	int functionIndex = lua_gettop(L) - numArgs - 1;
+
+	uint64_t startTime = uv_hrtime();
+	int status = metrics->m_originalCallbackHandler(L, numArgs, numResults, flags);
+	uint64_t elapsedTime = uv_hrtime() - startTime;
+
+	metrics->RecordCallback(L, functionIndex, elapsedTime);
+	lua_remove(L, functionIndex);
+
+	return status;
+}
+
+void EventLoopMetrics::RecordIteration(uint64_t lag) {
+	m_metrics.num_iterations++;
+	m_metrics.max_lag_in_nanoseconds = std::max(m_metrics.max_lag_in_nanoseconds, lag);
+
+	// Bucket N counts iterations that took less than 2^N milliseconds (so bucket 0 is for anything below 1 ms)
+	uint64_t lagInMilliseconds = lag / NANOSECONDS_PER_MILLISECOND;
+	size_t bucket = std::bit_width(lagInMilliseconds);
+	bucket = std::min(bucket, static_cast<size_t>(EVENT_LOOP_LAG_HISTOGRAM_SIZE - 1));
+	m_metrics.lag_histogram[bucket]++;
+}
+
+void EventLoopMetrics::RecordCallback(lua_State* L, int functionIndex, uint64_t elapsedTime) {
+	m_metrics.num_callbacks++;
+	m_metrics.total_callback_time_in_nanoseconds += elapsedTime;
+	if(elapsedTime <= m_metrics.max_callback_time_in_nanoseconds) return;
+
+	// Looking up the debug info is fairly slow, but new peaks should be rare enough that it doesn't matter
+	m_metrics.max_callback_time_in_nanoseconds = elapsedTime;
+
+	lua_Debug activationRecord;
+	lua_pushvalue(L, functionIndex);
+	lua_getinfo(L, ">S", &activationRecord);
+	snprintf(m_metrics.slowest_callback, EVENT_LOOP_CALLBACK_LOCATION_SIZE, "%s:%d",
+		activationRecord.short_src, activationRecord.linedefined);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "runtime_ffi.hpp"
+
+#include <cstdint>
+
+extern "C" {
+#include "luv.h"
+#include "uv.h"
+}
+
+// Tracks how much time the loop spends running callbacks (as opposed to waiting for I/O), one iteration at a time
+// Iterations are delimited by the check phase, and the prepare phase marks the point where the loop may block
+class EventLoopMetrics {
+public:
+	explicit EventLoopMetrics(uv_loop_t* loop);
+	EventLoopMetrics(const EventLoopMetrics&) = delete;
+	EventLoopMetrics& operator=(const EventLoopMetrics&) = delete;
+
+	// Must be called after luv was loaded (the original handler is wrapped, so that errors are still reported)
+	void InstallCallbackHandler(lua_State* L);
+	// Whatever happened before the loop started (e.g., running the main chunk) shouldn't count as an iteration
+	void OnLoopStarted();
+	void Stop();
+
+	void GetMetrics(runtime_event_loop_metrics_t* metrics) const;
+	void ResetPeaks();
+
+private:
+	static void OnPrepare(uv_prepare_t* handle);
+	static void OnCheck(uv_check_t* handle);
+	static int OnCallback(lua_State* L, int numArgs, int numResults, int flags);
+
+	void RecordIteration(uint64_t lag);
+	void RecordCallback(lua_State* L, int functionIndex, uint64_t elapsedTime);
+
+	uv_loop_t* m_loop;
+	uv_prepare_t m_prepareHandle;
+	uv_check_t m_checkHandle;
+	luv_CFpcall m_originalCallbackHandler = nullptr;
+
+	uint64_t m_startTime = 0;
+	uint64_t m_lastCheckTime = 0;
+	uint64_t m_pollStartTime = 0;
+	uint64_t m_idleTimeBeforePoll = 0;
+
+	runtime_event_loop_metrics_t m_metrics {};
+};
\ No newline at end of file
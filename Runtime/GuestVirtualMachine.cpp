@@ -0,0 +1,261 @@
+#include "GuestVirtualMachine.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
+
+GuestVirtualMachine::GuestVirtualMachine(std::string name, runtime_guest_limits_t limits)
+	: m_name(name), m_limits(limits) {
+	// Memory usage is always tracked, since it's the only way to tell what each guest is costing the host
+	m_allocator = std::make_shared<InstrumentedLuaAllocator>(std::make_shared<SystemLuaAllocator>());
+	m_allocator->SetMemoryLimit(limits.max_memory_in_bytes);
+	m_virtualMachine = std::make_shared<LuaVirtualMachine>(m_allocator);
+
+	// Compiled traces don't call hooks, so the instruction budget could be bypassed by any hot loop if the JIT was on
+	if(limits.max_instructions_per_callback > 0) luaJIT_setmode(m_virtualMachine->GetState(), 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+}
+
+GuestVirtualMachine::~GuestVirtualMachine() {
+	// The registry references are released along with the VM itself, so there's no need to unref them here
+	m_pendingCallbacks.clear();
+}
+
+void GuestVirtualMachine::AssignEventLoop(uv_loop_t* loop, uv_timer_t* accountingTimer) {
+	// Must happen before luv is loaded, or it will create a separate loop that nobody ever runs
+	luv_set_loop(m_virtualMachine->GetState(), loop);
+	m_accountingTimer = accountingTimer;
+}
+
+void GuestVirtualMachine::UnassignEventLoop() {
+	luv_set_loop(m_virtualMachine->GetState(), nullptr);
+	m_accountingTimer = nullptr;
+}
+
+void GuestVirtualMachine::InstallCallbackHandler() {
+	lua_State* L = m_virtualMachine->GetState();
+
+	luv_ctx_t* context = luv_context(L);
+	context->extra = this;
+	luv_set_callback(L, OnCallback);
+}
+
+bool GuestVirtualMachine::RunScript(std::string scriptPath) {
+	// Guests don't process the command line, so the script must be run directly (evo.run would start the host's app)
+	char* argv[] = { nullptr, scriptPath.data() };
+	m_virtualMachine->SetGlobalArgs(1, argv);
+
+	std::string chunk = "return require('guest').run(arg[0])";
+	std::string chunkName = "=(Guest entry point, for " + m_name + ")";
+
+	m_allocator->SetMemoryLimitEnforced(true);
+	bool success = m_virtualMachine->DoString(chunk, chunkName);
+	m_allocator->SetMemoryLimitEnforced(false);
+
+	return success;
+}
+
+void GuestVirtualMachine::Retire() {
+	if(m_isRetired) return;
+
+	lua_State* L = m_virtualMachine->GetState();
+	int stackTop = lua_gettop(L);
+	if(luaL_dostring(L, "require('guest').closeAllHandles()") != LUA_OK) {
+		std::cerr << "Failed to close handles of guest " << m_name << ": " << lua_tostring(L, -1) << std::endl;
+	}
+	lua_settop(L, stackTop);
+	m_isRetired = true;
+
+	for(PendingCallback& callback : m_pendingCallbacks) {
+		luaL_unref(L, LUA_REGISTRYINDEX, callback.registryReference);
+	}
+	m_pendingCallbacks.clear();
+
+	// The VM itself can't be closed yet, but most of the memory used by the script can be freed already
+	lua_gc(L, LUA_GCCOLLECT, 0);
+}
+
+bool GuestVirtualMachine::HasRequestsInFlight() {
+	// Releasing the VM while it's still on the stack would pull the rug out from under luv (and LuaJIT)
+	if(m_callbackDepth > 0) return true;
+
+	lua_State* L = m_virtualMachine->GetState();
+	int stackTop = lua_gettop(L);
+
+	// luv anchors handles in the registry until they're closed, and requests until their callback has run
+	std::unordered_set<const void*> luvMetatables;
+	lua_pushnil(L);
+	while(lua_next(L, LUA_REGISTRYINDEX) != 0) {
+		if(lua_type(L, -2) == LUA_TSTRING && lua_istable(L, -1)) {
+			std::string_view name = lua_tostring(L, -2);
+			if(name.starts_with("uv_") || name.starts_with("luv_")) luvMetatables.insert(lua_topointer(L, -1));
+		}
+		lua_pop(L, 1);
+	}
+
+	bool hasRequestsInFlight = false;
+	lua_pushnil(L);
+	while(!hasRequestsInFlight && lua_next(L, LUA_REGISTRYINDEX) != 0) {
+		if(lua_type(L, -1) == LUA_TUSERDATA && lua_getmetatable(L, -1)) {
+			hasRequestsInFlight = luvMetatables.contains(lua_topointer(L, -1));
+			lua_pop(L, 1);
+		}
+		lua_pop(L, 1);
+	}
+	lua_settop(L, stackTop);
+
+	return hasRequestsInFlight;
+}
+
+void GuestVirtualMachine::StartNextAccountingWindow() {
+	m_stats.window_cpu_time_in_nanoseconds = 0;
+	m_stats.is_throttled = false;
+
+	lua_State* L = m_virtualMachine->GetState();
+
+	// If the guest ends up throttled again while catching up, the rest is deferred (in order) until the next window
+	size_t numPendingCallbacks = m_pendingCallbacks.size();
+	for(size_t index = 0; index < numPendingCallbacks; index++) {
+		PendingCallback callback = m_pendingCallbacks.front();
+		m_pendingCallbacks.pop_front();
+
+		lua_rawgeti(L, LUA_REGISTRYINDEX, callback.registryReference);
+		int tableIndex = lua_gettop(L);
+		for(int valueIndex = 1; valueIndex <= callback.numArgs + 1; valueIndex++) {
+			lua_rawgeti(L, tableIndex, valueIndex);
+		}
+		lua_remove(L, tableIndex);
+		luaL_unref(L, LUA_REGISTRYINDEX, callback.registryReference);
+
+		OnCallback(L, callback.numArgs, 0, 0);
+	}
+}
+
+void GuestVirtualMachine::GetStats(runtime_guest_stats_t* stats) const {
+	*stats = m_stats;
+	stats->num_pending_callbacks = m_pendingCallbacks.size();
+
+	lua_allocator_stats_t allocatorStats;
+	m_allocator->GetStats(&allocatorStats);
+	stats->bytes_in_use = allocatorStats.bytes_in_use;
+	stats->peak_bytes_in_use = allocatorStats.peak_bytes_in_use;
+	stats->num_failed_allocations = allocatorStats.num_failed_allocations;
+}
+
+GuestVirtualMachine* GuestVirtualMachine::FromState(lua_State* L) {
+	return static_cast<GuestVirtualMachine*>(luv_context(L)->extra);
+}
+
+int GuestVirtualMachine::OnCallback(lua_State* L, int numArgs, int numResults, int flags) {
+	GuestVirtualMachine* guest = FromState(L);
+
+	// Close callbacks (and those of requests that were still in flight) might still arrive after the guest was retired
+	if(guest->m_isRetired) {
+		lua_pop(L, numArgs + 1);
+		for(int index = 0; index < numResults; index++) {
+			lua_pushnil(L);
+		}
+		return std::max(numResults, 0);
+	}
+
+	// Results can't be delivered later, but luv doesn't expect any for the vast majority of callbacks anyway
+	if(guest->m_stats.is_throttled && numResults == 0) {
+		guest->DeferCallback(L, numArgs);
+		return 0;
+	}
+
+	// Uncaught errors in one guest shouldn't take down the host and all other guests (so the flags are ignored)
+	return guest->RunCallback(L, numArgs, numResults);
+}
+
+int GuestVirtualMachine::OnCallbackError(lua_State* L) {
+	// Creating the traceback requires memory, and failing to do so would hide the actual error
+	FromState(L)->m_allocator->SetMemoryLimitEnforced(false);
+
+	lua_getglobal(L, "debug");
+	lua_getfield(L, -1, "traceback");
+	lua_pushvalue(L, 1);
+	lua_pushinteger(L, 2);
+	lua_call(L, 2, 1);
+
+	return 1;
+}
+
+void GuestVirtualMachine::OnInstructionBudgetExceeded(lua_State* L, lua_Debug* activationRecord) {
+	GuestVirtualMachine* guest = FromState(L);
+	luaL_error(L, "Guest %s exceeded its budget of %d instructions per callback",
+		guest->m_name.c_str(), guest->m_limits.max_instructions_per_callback);
+}
+
+int GuestVirtualMachine::RunCallback(lua_State* L, int numArgs, int numResults) {
+	int errorHandlerIndex = lua_gettop(L) - numArgs;
+	lua_pushcfunction(L, OnCallbackError);
+	lua_insert(L, errorHandlerIndex);
+
+	// Guests may run the loop themselves, but only the outermost callback should be accounted for
+	bool isOutermostCallback = (m_callbackDepth == 0);
+	m_callbackDepth++;
+	m_stats.num_callbacks++;
+
+	// Count hooks slow down the interpreter, so they're only set if needed (and hooks are per VM, not global)
+	bool hasInstructionBudget = m_limits.max_instructions_per_callback > 0;
+	if(isOutermostCallback && hasInstructionBudget) {
+		lua_sethook(L, OnInstructionBudgetExceeded, LUA_MASKCOUNT, m_limits.max_instructions_per_callback);
+	}
+
+	// Unprotected allocations (e.g., by luv itself) must never fail, so the limit only applies inside of pcall
+	m_allocator->SetMemoryLimitEnforced(true);
+	uint64_t startTime = uv_hrtime();
+	int status = lua_pcall(L, numArgs, numResults, errorHandlerIndex);
+	uint64_t elapsedTime = uv_hrtime() - startTime;
+	m_allocator->SetMemoryLimitEnforced(!isOutermostCallback);
+
+	m_callbackDepth--;
+	if(isOutermostCallback) {
+		if(hasInstructionBudget) lua_sethook(L, nullptr, 0, 0);
+		RecordCallbackTime(elapsedTime);
+	}
+
+	if(status != LUA_OK) {
+		m_stats.num_failed_callbacks++;
+		std::cerr << "Uncaught error in guest " << m_name << ": " << lua_tostring(L, -1) << std::endl;
+		lua_pop(L, 1);
+		lua_remove(L, errorHandlerIndex);
+		return -status;
+	}
+
+	lua_remove(L, errorHandlerIndex);
+	if(numResults == LUA_MULTRET) return lua_gettop(L) - errorHandlerIndex + 1;
+	return numResults;
+}
+
+void GuestVirtualMachine::DeferCallback(lua_State* L, int numArgs) {
+	// The function and its arguments are moved into a table that's anchored in the registry until it can be run
+	int numValues = numArgs + 1;
+	lua_createtable(L, numValues, 0);
+	lua_insert(L, -(numValues + 1));
+	for(int valueIndex = numValues; valueIndex >= 1; valueIndex--) {
+		lua_rawseti(L, -(valueIndex + 1), valueIndex);
+	}
+
+	int registryReference = luaL_ref(L, LUA_REGISTRYINDEX);
+	m_pendingCallbacks.push_back({ registryReference, numArgs });
+	m_stats.num_deferred_callbacks++;
+
+	// Otherwise, the loop might exit before the accounting window ends (if nothing else is keeping it alive)
+	if(m_accountingTimer != nullptr) uv_ref(reinterpret_cast<uv_handle_t*>(m_accountingTimer));
+}
+
+void GuestVirtualMachine::RecordCallbackTime(uint64_t elapsedTime) {
+	m_stats.total_cpu_time_in_nanoseconds += elapsedTime;
+	m_stats.window_cpu_time_in_nanoseconds += elapsedTime;
+	m_stats.max_callback_time_in_nanoseconds = std::max(m_stats.max_callback_time_in_nanoseconds, elapsedTime);
+
+	uint64_t cpuTimeBudget = m_limits.max_cpu_time_per_window_in_nanoseconds;
+	if(cpuTimeBudget == 0 || m_stats.is_throttled) return;
+
+	if(m_stats.window_cpu_time_in_nanoseconds > cpuTimeBudget) {
+		m_stats.is_throttled = true;
+		m_stats.num_times_throttled++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "LuaMemoryAllocator.hpp"
+#include "LuaVirtualMachine.hpp"
+#include "runtime_ffi.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include "luv.h"
+#include "uv.h"
+}
+
+// Guests are isolated Lua states that share the host's event loop, so their callbacks must be kept on a short leash
+// The budgets aren't preemptive: A runaway callback is only stopped by the instruction limit (if one was set)
+class GuestVirtualMachine {
+public:
+	GuestVirtualMachine(std::string name, runtime_guest_limits_t limits);
+	~GuestVirtualMachine();
+	GuestVirtualMachine(const GuestVirtualMachine&) = delete;
+	GuestVirtualMachine& operator=(const GuestVirtualMachine&) = delete;
+
+	// The loop must be assigned before luv is loaded, and the handler installed after (it's stored in luv's context)
+	void AssignEventLoop(uv_loop_t* loop, uv_timer_t* accountingTimer);
+	void UnassignEventLoop();
+	void InstallCallbackHandler();
+	bool RunScript(std::string scriptPath);
+
+	// Closes all handles and discards any callbacks that are still pending, so that the guest never runs again
+	// Requests that are already in flight may still reference the VM, so it can only be released once they're done
+	void Retire();
+	bool HasRequestsInFlight();
+
+	// LuaJIT may refuse custom allocators, but then neither the memory limit nor the memory stats would work
+	bool HasInstrumentedAllocator() { return m_virtualMachine->GetAllocator() == m_allocator; }
+
+	// Once the window is over, throttled guests get to run the callbacks that have piled up in the meantime
+	void StartNextAccountingWindow();
+	bool HasPendingCallbacks() const { return !m_pendingCallbacks.empty(); }
+
+	void GetStats(runtime_guest_stats_t* stats) const;
+	const std::string& GetName() const { return m_name; }
+	std::shared_ptr<LuaVirtualMachine> GetVirtualMachine() { return m_virtualMachine; }
+
+private:
+	struct PendingCallback {
+		int registryReference;
+		int numArgs;
+	};
+
+	static int OnCallback(lua_State* L, int numArgs, int numResults, int flags);
+	static int OnCallbackError(lua_State* L);
+	static void OnInstructionBudgetExceeded(lua_State* L, lua_Debug* activationRecord);
+	static GuestVirtualMachine* FromState(lua_State* L);
+
+	int RunCallback(lua_State* L, int numArgs, int numResults);
+	void DeferCallback(lua_State* L, int numArgs);
+	void RecordCallbackTime(uint64_t elapsedTime);
+
+	std::string m_name;
+	runtime_guest_limits_t m_limits;
+	std::shared_ptr<InstrumentedLuaAllocator> m_allocator;
+	std::shared_ptr<LuaVirtualMachine> m_virtualMachine;
+	std::deque<PendingCallback> m_pendingCallbacks;
+	runtime_guest_stats_t m_stats {};
+	uv_timer_t* m_accountingTimer = nullptr;
+	int m_callbackDepth = 0;
+	bool m_isRetired = false;
+};
\ No newline at end of file
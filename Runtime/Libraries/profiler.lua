@@ -3,15 +3,213 @@ package.loaded["jit.vmdef"] = require("vmdef")
 package.loaded["jit.zone"] = require("zone") -- Optionally required by jit.p
 package.loaded["jit.p"] = require("p") -- Requires jit.vmdef
 
+local jit_profile = require("jit.profile")
+local jit_util = require("jit.util")
 local p = require("jit.p")
+local vmdef = require("jit.vmdef")
 local zone = require("jit.zone")
 
-local profiler = {}
+local format = string.format
+local pairs = pairs
+local profile_dumpstack = jit_profile.dumpstack
+local table_concat = table.concat
+local table_sort = table.sort
+local type = type
+
+local profiler = {
+	DEFAULT_SAMPLING_INTERVAL_IN_MILLISECONDS = 10,
+	DEFAULT_MAX_STACK_DEPTH = 64,
+	-- Appended as the leaf frame, so that time spent outside of the Lua interpreter shows up in the flame graph
+	VM_STATE_FRAMES = {
+		N = "[compiled]",
+		I = "[interpreted]",
+		C = "[C]",
+		G = "[GC]",
+		J = "[JIT compiler]",
+	},
+}
+
+local isSampling = false
+local isJitProfilerRunning = false
+
+-- Both profilers share the same low-level API (which only supports one callback), so only one of them may be running
+local startJitProfiler, stopJitProfiler = p.start, p.stop
+function p.start(...)
+	if isSampling then
+		error("Cannot start jit.p (the sampling profiler is already running)", 0)
+	end
+
+	startJitProfiler(...)
+	isJitProfilerRunning = true
+end
+
+function p.stop(...)
+	stopJitProfiler(...)
+	isJitProfilerRunning = false
+end
 
 profiler.start = p.start
 profiler.stop = p.stop
 profiler.zone = zone
 
+local foldedStackCounts = {}
+local numCollectedSamples = 0
+
+local isTrackingTraces = false
+local traceAborts = {}
+local traceExits = {}
+local traceStartLocations = {}
+
+local function formatFunction(func, pc)
+	local info = jit_util.funcinfo(func, pc)
+	if info.loc then
+		return info.loc
+	elseif info.ffid then
+		return vmdef.ffnames[info.ffid]
+	elseif info.addr then
+		return format("C:%x", info.addr)
+	end
+	return "(?)"
+end
+
+local function formatTraceError(errorCode, errorInfo)
+	-- Same as jit.dump, since the error messages are format strings that may refer to a function
+	if type(errorCode) ~= "number" then
+		return tostring(errorCode)
+	end
+
+	if type(errorInfo) == "function" then
+		errorInfo = formatFunction(errorInfo)
+	end
+	return format(vmdef.traceerr[errorCode], errorInfo)
+end
+
+local function onTraceEvent(what, traceID, func, pc, errorCode, errorInfo)
+	if what == "flush" then
+		-- Trace IDs are reused after flushing, so the old locations would be misleading (and never released)
+		traceStartLocations = {}
+	elseif what == "start" then
+		traceStartLocations[traceID] = formatFunction(func, pc)
+	elseif what == "abort" then
+		local key = formatFunction(func, pc) .. "\0" .. formatTraceError(errorCode, errorInfo)
+		traceAborts[key] = (traceAborts[key] or 0) + 1
+	end
+end
+
+local function onTraceExit(traceID, exitID)
+	local key = traceID .. "\0" .. exitID
+	traceExits[key] = (traceExits[key] or 0) + 1
+end
+
+function profiler.startSampling(options)
+	if isSampling or isJitProfilerRunning then
+		error("Cannot start sampling (the profiler is already running)", 0)
+	end
+
+	options = options or {}
+	local intervalInMilliseconds = options.intervalInMilliseconds or profiler.DEFAULT_SAMPLING_INTERVAL_IN_MILLISECONDS
+	local maxStackDepth = options.maxStackDepth or profiler.DEFAULT_MAX_STACK_DEPTH
+
+	-- Using the low-level API directly avoids the overhead of jit.p's reporting, which isn't needed here
+	-- Negative depths make dumpstack list the outermost frame first, which is the order expected for folded stacks
+	local vmStateFrames = profiler.VM_STATE_FRAMES
+	jit_profile.start("i" .. intervalInMilliseconds, function(thread, numSamples, vmState)
+		local stack = profile_dumpstack(thread, "F;", -maxStackDepth)
+		local foldedStack = stack .. (vmStateFrames[vmState] or vmState)
+		foldedStackCounts[foldedStack] = (foldedStackCounts[foldedStack] or 0) + numSamples
+		numCollectedSamples = numCollectedSamples + numSamples
+	end)
+
+	isSampling = true
+end
+
+function profiler.stopSampling()
+	if not isSampling then
+		return
+	end
+
+	jit_profile.stop()
+	isSampling = false
+end
+
+function profiler.getNumCollectedSamples()
+	return numCollectedSamples
+end
+
+-- Can be pulled periodically (e.g., from a timer) and fed to flamegraph.pl, speedscope, or pprof (via conversion)
+function profiler.getFoldedStacks(shouldReset)
+	local lines = {}
+	for foldedStack, count in pairs(foldedStackCounts) do
+		lines[#lines + 1] = foldedStack .. " " .. count
+	end
+	table_sort(lines)
+
+	if shouldReset then
+		foldedStackCounts = {}
+		numCollectedSamples = 0
+	end
+
+	if #lines == 0 then
+		return ""
+	end
+	return table_concat(lines, "\n") .. "\n"
+end
+
+function profiler.startTraceTracking()
+	if isTrackingTraces then
+		return
+	end
+
+	traceStartLocations = {}
+	jit.attach(onTraceEvent, "trace")
+	jit.attach(onTraceExit, "texit")
+	isTrackingTraces = true
+end
+
+function profiler.stopTraceTracking()
+	if not isTrackingTraces then
+		return
+	end
+
+	jit.attach(onTraceEvent)
+	jit.attach(onTraceExit)
+	isTrackingTraces = false
+end
+
+-- Code that keeps falling out of the JIT shows up here, either as repeated aborts or frequently-taken side exits
+function profiler.getTraceReport(shouldReset)
+	local aborts = {}
+	for key, count in pairs(traceAborts) do
+		local location, reason = key:match("^(.-)%z(.*)$")
+		aborts[#aborts + 1] = { location = location, reason = reason, count = count }
+	end
+
+	local exits = {}
+	for key, count in pairs(traceExits) do
+		local traceID, exitID = key:match("^(%d+)%z(%d+)$")
+		traceID, exitID = tonumber(traceID), tonumber(exitID)
+		exits[#exits + 1] = {
+			traceID = traceID,
+			exitID = exitID,
+			location = traceStartLocations[traceID] or "(?)",
+			count = count,
+		}
+	end
+
+	local function byCountDescending(a, b)
+		return a.count > b.count
+	end
+	table_sort(aborts, byCountDescending)
+	table_sort(exits, byCountDescending)
+
+	if shouldReset then
+		traceAborts = {}
+		traceExits = {}
+	end
+
+	return { aborts = aborts, exits = exits }
+end
+
 assert(profiler.start)
 assert(profiler.stop)
 assert(profiler.zone)
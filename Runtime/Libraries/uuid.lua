@@ -1,5 +1,6 @@
 local ffi = require("ffi")
 local stduuid = require("stduuid")
+local table_new = require("table.new")
 local validation = require("validation")
 
 local type = type
@@ -7,12 +8,34 @@ local ffi_cast = ffi.cast
 local ffi_new = ffi.new
 local ffi_string = ffi.string
 local string_match = string.match
+local validateNumber = validation.validateNumber
 local validateString = validation.validateString
+local validateTable = validation.validateTable
+
+local BINARY_SIZE_IN_BYTES = 16
+local RFC_STRING_LENGTH = 36
 
 local uuid = {
 	RFC_STRING_PATTERN = "^%x%x%x%x%x%x%x%x%-%x%x%x%x%-%x%x%x%x%-%x%x%x%x%-%x%x%x%x%x%x%x%x%x%x%x%x$",
+	VERSION_RANDOM = "random",
+	VERSION_TIME_ORDERED = "time-ordered",
+	FORMAT_BINARY = "binary",
+	FORMAT_RFC_STRING = "rfc-string",
+}
+
+-- The enums can only be looked up once the bindings have been loaded, so this stores their names instead
+local versions = {
+	[uuid.VERSION_RANDOM] = "UUID_VERSION_RANDOM",
+	[uuid.VERSION_TIME_ORDERED] = "UUID_VERSION_TIME_ORDERED",
 }
 
+local formats = {
+	[uuid.FORMAT_BINARY] = { name = "UUID_FORMAT_BINARY", size = BINARY_SIZE_IN_BYTES },
+	[uuid.FORMAT_RFC_STRING] = { name = "UUID_FORMAT_RFC_STRING", size = RFC_STRING_LENGTH },
+}
+
+local preallocatedBatchBuffer
+
 function uuid.createBasicUUID()
 	local guid = ffi_new("uuid_rfc_string_t")
 	local guidPointer = ffi_cast("uuid_rfc_string_t*", guid)
@@ -44,7 +67,9 @@ function uuid.createNameBasedUUID(namespace, name)
 	local guid = ffi_new("uuid_rfc_string_t")
 	local guidPointer = ffi_cast("uuid_rfc_string_t*", guid)
 
-	stduuid.bindings.uuid_create_v5(namespace, name, guidPointer)
+	if not stduuid.bindings.uuid_create_v5(namespace, name, guidPointer) then
+		error("Failed to create name-based UUID", 0)
+	end
 	guid = ffi_string(guid)
 
 	return guid
@@ -60,6 +85,73 @@ function uuid.createSystemUUID()
 	return guid
 end
 
+function uuid.createTimeOrderedUUID()
+	local guid = ffi_new("uuid_rfc_string_t")
+	local guidPointer = ffi_cast("uuid_rfc_string_t*", guid)
+
+	stduuid.bindings.uuid_create_v7(guidPointer)
+	guid = ffi_string(guid)
+
+	return guid
+end
+
+-- Generating many UUIDs at once only needs a single call into C, which is much faster than creating them one by one
+-- If a buffer is passed, the UUIDs are appended to it back to back; otherwise, a table of strings is returned
+function uuid.createBatch(count, version, outputFormat, outputBuffer)
+	validateNumber(count, "count")
+	version = version or uuid.VERSION_RANDOM
+	outputFormat = outputFormat or uuid.FORMAT_RFC_STRING
+
+	local versionName = versions[version]
+	if not versionName then
+		error(format("Unsupported UUID version %s", tostring(version)), 0)
+	end
+
+	local formatInfo = formats[outputFormat]
+	if not formatInfo then
+		error(format("Unsupported UUID format %s", tostring(outputFormat)), 0)
+	end
+
+	if count < 0 or count % 1 ~= 0 then
+		error(format("Invalid UUID count %s (must be a non-negative integer)", tostring(count)), 0)
+	end
+
+	preallocatedBatchBuffer = preallocatedBatchBuffer or buffer.new()
+	local writeBuffer = outputBuffer or preallocatedBatchBuffer:reset()
+	local numBytesRequired = count * formatInfo.size
+	if count > 0 then
+		local writeCursor = writeBuffer:reserve(numBytesRequired)
+		if not stduuid.bindings.uuid_create_batch(ffi.C[versionName], ffi.C[formatInfo.name], count, writeCursor) then
+			error("Failed to generate UUIDs", 0)
+		end
+		writeBuffer:commit(numBytesRequired)
+	end
+
+	if outputBuffer then
+		return outputBuffer
+	end
+
+	local guids = table_new(count, 0)
+	for index = 1, count, 1 do
+		guids[index] = writeBuffer:get(formatInfo.size)
+	end
+
+	return guids
+end
+
+-- Converts the raw 16-byte representation (e.g., from uuid.createBatch) into an RFC UUID string
+function uuid.fromBinary(binaryUUID)
+	validateString(binaryUUID, "binaryUUID")
+	if #binaryUUID ~= BINARY_SIZE_IN_BYTES then
+		error(format("Expected argument binaryUUID to be exactly %d bytes long", BINARY_SIZE_IN_BYTES), 0)
+	end
+
+	local guid = ffi_new("uuid_rfc_string_t")
+	stduuid.bindings.uuid_format_batch(binaryUUID, 1, guid)
+
+	return ffi_string(guid, RFC_STRING_LENGTH)
+end
+
 function uuid.isCanonical(input)
 	if type(input) ~= "string" then
 		return false
@@ -68,6 +160,55 @@ function uuid.isCanonical(input)
 	return string_match(input, uuid.RFC_STRING_PATTERN) ~= nil
 end
 
+-- Unlike isCanonical, this also accepts braced ({...}) and compact (hex digits only) UUID strings
+function uuid.isValid(input)
+	if type(input) ~= "string" then
+		return false
+	end
+
+	return stduuid.bindings.uuid_parse(input, #input, nil)
+end
+
+-- Returns the raw 16-byte representation, or nil if the input isn't a valid UUID string (in any of the supported forms)
+function uuid.parse(input)
+	if type(input) ~= "string" then
+		return nil, format("Cannot parse UUID from a %s value", type(input))
+	end
+
+	local binaryUUID = ffi_new("uint8_t[?]", BINARY_SIZE_IN_BYTES)
+	if not stduuid.bindings.uuid_parse(input, #input, binaryUUID) then
+		return nil, format("Invalid UUID string %s", input)
+	end
+
+	return ffi_string(binaryUUID, BINARY_SIZE_IN_BYTES)
+end
+
+-- Returns a table with the result for each input (in the same order), as well as the number of valid inputs
+function uuid.validateBatch(inputs)
+	validateTable(inputs, "inputs")
+
+	local numInputs = #inputs
+	local stringRefs = ffi_new("uuid_string_ref_t[?]", numInputs)
+	for index = 1, numInputs, 1 do
+		local input = inputs[index]
+		-- Other types can't be valid, and a length of zero ensures that they'll be rejected without being accessed
+		if type(input) == "string" then
+			stringRefs[index - 1].data = input
+			stringRefs[index - 1].length = #input
+		end
+	end
+
+	local results = ffi_new("bool[?]", numInputs)
+	local numValidInputs = stduuid.bindings.uuid_validate_batch(stringRefs, numInputs, results)
+
+	local isValid = table_new(numInputs, 0)
+	for index = 1, numInputs, 1 do
+		isValid[index] = results[index - 1]
+	end
+
+	return isValid, tonumber(numValidInputs)
+end
+
 -- Shorthand (alias) for the most likely default choice
 uuid.create = uuid.createMersenneTwistedUUID
 
@@ -0,0 +1,215 @@
+#include "LuaMemoryAllocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Tuned for LuaJIT's GC64 object layouts: Short strings, tables (64 bytes), closures, upvalues, and small arrays
+constexpr std::array<size_t, LUA_ALLOCATOR_NUM_SIZE_CLASSES - 1> POOLED_SIZE_CLASSES = {
+	16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+
+constexpr size_t LARGE_ALLOCATION_SIZE_CLASS = LUA_ALLOCATOR_NUM_SIZE_CLASSES - 1;
+
+void* LuaMemoryAllocator::Allocate(void* userdata, void* pointer, size_t oldSize, size_t newSize) {
+	LuaMemoryAllocator* allocator = static_cast<LuaMemoryAllocator*>(userdata);
+	// LuaJIT doesn't pass the type of new objects via oldSize (unlike PUC Lua 5.2+), but let's not rely on that
+	if(pointer == nullptr) oldSize = 0;
+	return allocator->Reallocate(pointer, oldSize, newSize);
+}
+
+std::shared_ptr<LuaMemoryAllocator> LuaMemoryAllocator::CreateFromName(const std::string& name) {
+	if(name.empty() || name == "default") return nullptr;
+
+	if(name == "system") return std::make_shared<SystemLuaAllocator>();
+	if(name == "pooled") return std::make_shared<PooledLuaAllocator>();
+	if(name == "instrumented") return std::make_shared<InstrumentedLuaAllocator>(std::make_shared<SystemLuaAllocator>());
+	if(name == "instrumented-pooled") return std::make_shared<InstrumentedLuaAllocator>(std::make_shared<PooledLuaAllocator>());
+
+	std::cerr << "Unknown allocator " << name << " requested (using the default allocator instead)" << std::endl;
+	return nullptr;
+}
+
+size_t LuaMemoryAllocator::GetSizeClass(size_t size) {
+	// A binary search would be overkill for such a small table (and this is quite branch predictor-friendly)
+	for(size_t sizeClass = 0; sizeClass < POOLED_SIZE_CLASSES.size(); sizeClass++) {
+		if(size <= POOLED_SIZE_CLASSES[sizeClass]) return sizeClass;
+	}
+
+	return LARGE_ALLOCATION_SIZE_CLASS;
+}
+
+size_t LuaMemoryAllocator::GetSizeClassLimit(size_t sizeClass) {
+	if(sizeClass >= POOLED_SIZE_CLASSES.size()) return SIZE_MAX;
+	return POOLED_SIZE_CLASSES[sizeClass];
+}
+
+void LuaMemoryAllocator::GetStats(lua_allocator_stats_t* stats) const {
+	// Only the instrumented allocator keeps track of the other fields, since it's not free
+	*stats = {};
+	stats->name = this->GetName();
+	stats->bytes_reserved = this->GetNumReservedBytes();
+
+	for(size_t sizeClass = 0; sizeClass < LUA_ALLOCATOR_NUM_SIZE_CLASSES; sizeClass++) {
+		stats->size_class_limits[sizeClass] = GetSizeClassLimit(sizeClass);
+	}
+}
+
+void* SystemLuaAllocator::Reallocate(void* pointer, size_t oldSize, size_t newSize) {
+	if(newSize == 0) {
+		free(pointer);
+		return nullptr;
+	}
+
+	return realloc(pointer, newSize);
+}
+
+PooledLuaAllocator::~PooledLuaAllocator() {
+	for(void* slab : m_slabs) {
+		free(slab);
+	}
+}
+
+void* PooledLuaAllocator::Reallocate(void* pointer, size_t oldSize, size_t newSize) {
+	size_t oldSizeClass = GetSizeClass(oldSize);
+	size_t newSizeClass = GetSizeClass(newSize);
+
+	if(newSize == 0) {
+		if(pointer == nullptr) return nullptr;
+
+		if(oldSizeClass == LARGE_ALLOCATION_SIZE_CLASS) free(pointer);
+		else ReturnToPool(pointer, oldSizeClass);
+
+		return nullptr;
+	}
+
+	if(pointer == nullptr) {
+		if(newSizeClass == LARGE_ALLOCATION_SIZE_CLASS) return malloc(newSize);
+		return AllocateFromPool(newSizeClass);
+	}
+
+	bool isLargeAllocation = (oldSizeClass == LARGE_ALLOCATION_SIZE_CLASS) && (newSizeClass == LARGE_ALLOCATION_SIZE_CLASS);
+	if(isLargeAllocation) return realloc(pointer, newSize);
+
+	// Growing and shrinking within the same class is free since the block is already large enough
+	if(oldSizeClass == newSizeClass) return pointer;
+
+	void* newPointer = (newSizeClass == LARGE_ALLOCATION_SIZE_CLASS) ? malloc(newSize) : AllocateFromPool(newSizeClass);
+	if(newPointer == nullptr) return nullptr; // The old block must remain valid if reallocation fails
+
+	memcpy(newPointer, pointer, std::min(oldSize, newSize));
+
+	if(oldSizeClass == LARGE_ALLOCATION_SIZE_CLASS) free(pointer);
+	else ReturnToPool(pointer, oldSizeClass);
+
+	return newPointer;
+}
+
+void* PooledLuaAllocator::AllocateFromPool(size_t sizeClass) {
+	if(m_freeLists[sizeClass] == nullptr && !RefillPool(sizeClass)) return nullptr;
+
+	FreeListNode* node = m_freeLists[sizeClass];
+	m_freeLists[sizeClass] = node->next;
+	return node;
+}
+
+void PooledLuaAllocator::ReturnToPool(void* pointer, size_t sizeClass) {
+	FreeListNode* node = static_cast<FreeListNode*>(pointer);
+	node->next = m_freeLists[sizeClass];
+	m_freeLists[sizeClass] = node;
+}
+
+bool PooledLuaAllocator::RefillPool(size_t sizeClass) {
+	// Slabs are never returned to the system (until the VM shuts down), so the working set stays warm
+	uint8_t* slab = static_cast<uint8_t*>(malloc(SLAB_SIZE_IN_BYTES));
+	if(slab == nullptr) return false;
+
+	m_slabs.push_back(slab);
+	m_numReservedBytes += SLAB_SIZE_IN_BYTES;
+
+	size_t blockSize = POOLED_SIZE_CLASSES[sizeClass];
+	size_t numBlocks = SLAB_SIZE_IN_BYTES / blockSize;
+	for(size_t index = numBlocks; index > 0; index--) {
+		ReturnToPool(slab + (index - 1) * blockSize, sizeClass);
+	}
+
+	return true;
+}
+
+InstrumentedLuaAllocator::InstrumentedLuaAllocator(std::shared_ptr<LuaMemoryAllocator> upstream)
+	: m_upstream(upstream) {
+	m_name = std::string("instrumented-") + m_upstream->GetName();
+}
+
+void* InstrumentedLuaAllocator::Reallocate(void* pointer, size_t oldSize, size_t newSize) {
+	if(IsOverMemoryLimit(oldSize, newSize)) {
+		m_stats.num_failed_allocations++;
+		return nullptr;
+	}
+
+	void* newPointer = m_upstream->Reallocate(pointer, oldSize, newSize);
+
+	if(newSize == 0) {
+		if(pointer != nullptr) RecordDeallocation(oldSize);
+		return newPointer;
+	}
+
+	if(newPointer == nullptr) {
+		m_stats.num_failed_allocations++;
+		return nullptr;
+	}
+
+	if(pointer == nullptr) {
+		RecordAllocation(newSize);
+		return newPointer;
+	}
+
+	m_stats.num_reallocations++;
+	m_stats.bytes_in_use -= oldSize;
+	m_stats.bytes_in_use += newSize;
+	m_stats.peak_bytes_in_use = std::max(m_stats.peak_bytes_in_use, m_stats.bytes_in_use);
+
+	return newPointer;
+}
+
+bool InstrumentedLuaAllocator::IsOverMemoryLimit(size_t oldSize, size_t newSize) const {
+	if(!m_isMemoryLimitEnforced || m_memoryLimit == 0) return false;
+
+	// Shrinking must always succeed, or the GC couldn't free up anything once the limit has been reached
+	if(newSize <= oldSize) return false;
+
+	return m_stats.bytes_in_use + (newSize - oldSize) > m_memoryLimit;
+}
+
+void InstrumentedLuaAllocator::RecordAllocation(size_t size) {
+	size_t sizeClass = GetSizeClass(size);
+
+	m_stats.num_allocations++;
+	m_stats.num_allocations_by_size_class[sizeClass]++;
+	m_stats.bytes_allocated_by_size_class[sizeClass] += size;
+	m_stats.bytes_in_use += size;
+	m_stats.peak_bytes_in_use = std::max(m_stats.peak_bytes_in_use, m_stats.bytes_in_use);
+}
+
+void InstrumentedLuaAllocator::RecordDeallocation(size_t size) {
+	m_stats.num_deallocations++;
+	m_stats.bytes_in_use -= size;
+}
+
+void InstrumentedLuaAllocator::GetStats(lua_allocator_stats_t* stats) const {
+	LuaMemoryAllocator::GetStats(stats);
+
+	stats->num_allocations = m_stats.num_allocations;
+	stats->num_reallocations = m_stats.num_reallocations;
+	stats->num_deallocations = m_stats.num_deallocations;
+	stats->num_failed_allocations = m_stats.num_failed_allocations;
+	stats->bytes_in_use = m_stats.bytes_in_use;
+	stats->peak_bytes_in_use = m_stats.peak_bytes_in_use;
+
+	for(size_t sizeClass = 0; sizeClass < LUA_ALLOCATOR_NUM_SIZE_CLASSES; sizeClass++) {
+		stats->num_allocations_by_size_class[sizeClass] = m_stats.num_allocations_by_size_class[sizeClass];
+		stats->bytes_allocated_by_size_class[sizeClass] = m_stats.bytes_allocated_by_size_class[sizeClass];
+	}
+}
\ No newline at end of file
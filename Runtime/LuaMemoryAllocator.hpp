@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lua.hpp>
+
+#include "runtime_ffi.hpp" // For the allocator stats (the exports header lacks include guards)
+
+// Can be passed to lua_newstate so that the VM's heap can be swapped out without touching LuaJIT itself
+class LuaMemoryAllocator {
+public:
+	virtual ~LuaMemoryAllocator() = default;
+
+	// Signature must match lua_Alloc (the userdata is always the allocator instance)
+	static void* Allocate(void* userdata, void* pointer, size_t oldSize, size_t newSize);
+
+	// Returns nullptr if the default allocator (LuaJIT's built-in one) should be used instead
+	static std::shared_ptr<LuaMemoryAllocator> CreateFromName(const std::string& name);
+
+	static size_t GetSizeClass(size_t size);
+	static size_t GetSizeClassLimit(size_t sizeClass);
+
+	virtual void* Reallocate(void* pointer, size_t oldSize, size_t newSize) = 0;
+	virtual void GetStats(lua_allocator_stats_t* stats) const;
+	virtual const char* GetName() const = 0;
+	virtual size_t GetNumReservedBytes() const { return 0; }
+};
+
+class SystemLuaAllocator : public LuaMemoryAllocator {
+public:
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize) override;
+	const char* GetName() const override { return "system"; }
+};
+
+// Most objects created by LuaJIT are tiny strings, tables, closures and upvalues (usually well below 512 bytes)
+// Recycling them via per-class free lists avoids hitting malloc for every short-lived request-scoped object
+class PooledLuaAllocator : public LuaMemoryAllocator {
+public:
+	PooledLuaAllocator() = default;
+	~PooledLuaAllocator() override;
+	PooledLuaAllocator(const PooledLuaAllocator&) = delete;
+	PooledLuaAllocator& operator=(const PooledLuaAllocator&) = delete;
+
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize) override;
+	const char* GetName() const override { return "pooled"; }
+	size_t GetNumReservedBytes() const override { return m_numReservedBytes; }
+
+private:
+	struct FreeListNode {
+		FreeListNode* next;
+	};
+
+	void* AllocateFromPool(size_t sizeClass);
+	void ReturnToPool(void* pointer, size_t sizeClass);
+	bool RefillPool(size_t sizeClass);
+
+	static constexpr size_t SLAB_SIZE_IN_BYTES = 64 * 1024;
+
+	std::array<FreeListNode*, LUA_ALLOCATOR_NUM_SIZE_CLASSES> m_freeLists {};
+	std::vector<void*> m_slabs;
+	size_t m_numReservedBytes = 0;
+};
+
+// Decorates another allocator to record what LuaJIT is asking for (at the cost of some bookkeeping overhead)
+class InstrumentedLuaAllocator : public LuaMemoryAllocator {
+public:
+	explicit InstrumentedLuaAllocator(std::shared_ptr<LuaMemoryAllocator> upstream);
+
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize) override;
+	void GetStats(lua_allocator_stats_t* stats) const override;
+	const char* GetName() const override { return m_name.c_str(); }
+	size_t GetNumReservedBytes() const override { return m_upstream->GetNumReservedBytes(); }
+
+	// Growing the heap past the limit fails, but only while enforced (LuaJIT panics if unprotected allocations fail)
+	void SetMemoryLimit(size_t maxBytesInUse) { m_memoryLimit = maxBytesInUse; }
+	void SetMemoryLimitEnforced(bool isEnforced) { m_isMemoryLimitEnforced = isEnforced; }
+
+private:
+	void RecordAllocation(size_t size);
+	void RecordDeallocation(size_t size);
+	bool IsOverMemoryLimit(size_t oldSize, size_t newSize) const;
+
+	std::shared_ptr<LuaMemoryAllocator> m_upstream;
+	std::string m_name;
+	lua_allocator_stats_t m_stats {};
+	size_t m_memoryLimit = 0;
+	bool m_isMemoryLimitEnforced = false;
+};
\ No newline at end of file
@@ -21,13 +21,36 @@ int onLuaError(lua_State* m_luaState) {
 	return EXIT_FAILURE; // It's an error, after all
 }
 
-LuaVirtualMachine::LuaVirtualMachine() {
+int onLuaPanic(lua_State* m_luaState) {
+	// Same as luaL_newstate, which sets this up automatically (but lua_newstate doesn't)
+	std::cerr << "PANIC: unprotected error in call to Lua API (" << lua_tostring(m_luaState, -1) << ")" << std::endl;
+	return 0;
+}
+
+LuaVirtualMachine::LuaVirtualMachine()
+	: LuaVirtualMachine(nullptr) {
+}
+
+LuaVirtualMachine::LuaVirtualMachine(std::shared_ptr<LuaMemoryAllocator> allocator) {
 	m_relativeStackOffset = 0;
 
 	// Standard Lua module convention: Return a single table with the module's exports
 	m_numExpectedArgsFromLuaMain = 1;
 
-	m_luaState = luaL_newstate();
+	m_luaState = nullptr;
+	if(allocator) {
+		m_luaState = lua_newstate(&LuaMemoryAllocator::Allocate, allocator.get());
+		// LuaJIT refuses custom allocators on 64-bit platforms unless built in GC64 mode
+		if(m_luaState == nullptr) std::cerr << "Failed to create Lua state with allocator " << allocator->GetName() << " (using the default allocator instead)" << std::endl;
+		else lua_atpanic(m_luaState, onLuaPanic);
+	}
+
+	if(m_luaState == nullptr) {
+		m_luaState = luaL_newstate();
+		allocator = nullptr;
+	}
+	m_allocator = allocator;
+
 	luaL_openlibs(m_luaState);
 
 	// No need to modify the stack offset since this will never be popped
@@ -152,4 +175,8 @@ bool LuaVirtualMachine::CheckStack() {
 
 lua_State* LuaVirtualMachine::GetState() {
 	return m_luaState;
+}
+
+std::shared_ptr<LuaMemoryAllocator> LuaVirtualMachine::GetAllocator() {
+	return m_allocator;
 }
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <lua.hpp>
 
+#include "LuaMemoryAllocator.hpp"
+
 class LuaVirtualMachine {
 public:
 	LuaVirtualMachine();
+	explicit LuaVirtualMachine(std::shared_ptr<LuaMemoryAllocator> allocator);
 	~LuaVirtualMachine();
 
 	bool LoadPackage(std::string packageName);
@@ -20,9 +24,11 @@ public:
 	void CreateGlobalNamespace(std::string name);
 	bool CheckStack();
 	lua_State* GetState();
+	std::shared_ptr<LuaMemoryAllocator> GetAllocator();
 
 private:
 	lua_State* m_luaState;
+	std::shared_ptr<LuaMemoryAllocator> m_allocator;
 	int m_onLuaErrorIndex;
 	// Getting these offsets wrong will cause segfaults, so let's just track them and get it over with...
 	int m_numExpectedArgsFromLuaMain;
@@ -1,13 +1,19 @@
 #pragma once
 
+#include "EventLoopMetrics.hpp"
+#include "GuestVirtualMachine.hpp"
 #include "LuaVirtualMachine.hpp"
 #include "curl_ffi.hpp"
 #include "uws_ffi.hpp"
 
 #include <cassert>
 #include <format>
+#include <functional>
+#include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace std;
 using uws_loop_t = uWS::Loop*;
@@ -17,12 +23,51 @@ extern "C" {
 #include "uv.h"
 }
 
+using guest_initializer_t = function<void(shared_ptr<LuaVirtualMachine>)>;
+
+// Short enough that throttled guests don't appear to hang, but long enough to keep the accounting overhead low
+constexpr uint64_t GUEST_ACCOUNTING_WINDOW_IN_MILLISECONDS = 100;
+
 class SharedEventLoop {
 private:
 	shared_ptr<LuaVirtualMachine> m_mainThreadVM;
+	vector<shared_ptr<GuestVirtualMachine>> m_guestVMs;
+	vector<shared_ptr<GuestVirtualMachine>> m_retiredGuestVMs;
+	guest_initializer_t m_guestInitializer;
 
 	uv_loop_t m_uvMainLoop;
 	uws_loop_t m_uwsMainLoop;
+	uv_timer_t m_guestAccountingTimer;
+	unique_ptr<EventLoopMetrics> m_metrics;
+
+	static void OnGuestAccountingWindowEnded(uv_timer_t* handle) {
+		SharedEventLoop* eventLoop = static_cast<SharedEventLoop*>(handle->data);
+		eventLoop->ReleaseRetiredGuests();
+
+		bool hasPendingCallbacks = false;
+		for(auto& guest : eventLoop->m_guestVMs) {
+			guest->StartNextAccountingWindow();
+			hasPendingCallbacks = hasPendingCallbacks || guest->HasPendingCallbacks();
+		}
+
+		// Accounting alone shouldn't keep the loop alive, but deferred callbacks still need to run eventually
+		if(hasPendingCallbacks) uv_ref(reinterpret_cast<uv_handle_t*>(handle));
+		else uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+	}
+
+	// Timers never run inside of guest callbacks (unless a guest runs the loop itself), so it's safe to close the VMs here
+	void ReleaseRetiredGuests() {
+		for(auto iterator = m_retiredGuestVMs.begin(); iterator != m_retiredGuestVMs.end();) {
+			shared_ptr<GuestVirtualMachine> guest = *iterator;
+			if(guest->HasRequestsInFlight()) {
+				iterator++;
+				continue;
+			}
+
+			guest->UnassignEventLoop();
+			iterator = m_retiredGuestVMs.erase(iterator);
+		}
+	}
 
 public:
 	explicit SharedEventLoop(auto L) {
@@ -37,6 +82,11 @@ public:
 		}
 
 		luv_set_loop(m_mainThreadVM->GetState(), &m_uvMainLoop);
+		m_metrics = make_unique<EventLoopMetrics>(&m_uvMainLoop);
+
+		uv_timer_init(&m_uvMainLoop, &m_guestAccountingTimer);
+		m_guestAccountingTimer.data = this;
+		uv_unref(reinterpret_cast<uv_handle_t*>(&m_guestAccountingTimer));
 
 		auto uwsEventLoop = uws_ffi::assignEventLoop(&m_uvMainLoop);
 		assert(uwsEventLoop != nullptr);
@@ -50,13 +100,86 @@ public:
 	}
 
 	~SharedEventLoop() {
+		m_metrics->Stop();
+		uv_timer_stop(&m_guestAccountingTimer);
+		// Stopped handles are still part of the loop (and active ones would keep it alive), so they must always be closed
+		uv_close(reinterpret_cast<uv_handle_t*>(&m_guestAccountingTimer), nullptr);
+		for(auto& guest : m_guestVMs) {
+			guest->UnassignEventLoop();
+		}
+		m_guestVMs.clear();
+		for(auto& guest : m_retiredGuestVMs) {
+			guest->UnassignEventLoop();
+		}
+		m_retiredGuestVMs.clear();
+
 		luv_set_loop(m_mainThreadVM->GetState(), nullptr);
 		uws_ffi::unassignEventLoop(m_uwsMainLoop);
 		curl_global_cleanup();
 	}
 
+	void InstallCallbackHandler() {
+		m_metrics->InstallCallbackHandler(m_mainThreadVM->GetState());
+	}
+
+	uv_loop_t* GetLoop() {
+		return &m_uvMainLoop;
+	}
+
+	EventLoopMetrics& GetMetrics() {
+		return *m_metrics;
+	}
+
+	void SetGuestInitializer(guest_initializer_t initializer) {
+		m_guestInitializer = initializer;
+	}
+
+	shared_ptr<GuestVirtualMachine> CreateGuest(const string& name, runtime_guest_limits_t limits) {
+		// Guests are looked up by name, so reusing one would make the older guest inaccessible
+		if(!m_guestInitializer || FindGuest(name) != nullptr) return nullptr;
+
+		auto guest = make_shared<GuestVirtualMachine>(name, limits);
+		if(!guest->HasInstrumentedAllocator()) {
+			cerr << "Failed to create guest " << name << " (the custom allocator was rejected by LuaJIT)" << endl;
+			return nullptr;
+		}
+
+		guest->AssignEventLoop(&m_uvMainLoop, &m_guestAccountingTimer);
+		m_guestInitializer(guest->GetVirtualMachine());
+		guest->InstallCallbackHandler();
+		m_guestVMs.push_back(guest);
+
+		if(!uv_is_active(reinterpret_cast<uv_handle_t*>(&m_guestAccountingTimer))) {
+			uv_timer_start(&m_guestAccountingTimer, OnGuestAccountingWindowEnded,
+				GUEST_ACCOUNTING_WINDOW_IN_MILLISECONDS, GUEST_ACCOUNTING_WINDOW_IN_MILLISECONDS);
+		}
+
+		return guest;
+	}
+
+	void RemoveGuest(const string& name) {
+		for(auto iterator = m_guestVMs.begin(); iterator != m_guestVMs.end(); iterator++) {
+			shared_ptr<GuestVirtualMachine> guest = *iterator;
+			if(guest->GetName() != name) continue;
+
+			guest->Retire();
+			m_guestVMs.erase(iterator);
+			m_retiredGuestVMs.push_back(guest);
+			return;
+		}
+	}
+
+	shared_ptr<GuestVirtualMachine> FindGuest(const string& name) {
+		for(auto& guest : m_guestVMs) {
+			if(guest->GetName() == name) return guest;
+		}
+
+		return nullptr;
+	}
+
 	void RunMainLoopUntilDone() {
-		// There's just a single main loop right now, but that'll probably need to change
+		// Guests don't get their own loops (yet?), so this also runs all of their callbacks
+		m_metrics->OnLoopStarted();
 		int refCount = uv_run(&m_uvMainLoop, UV_RUN_DEFAULT);
 		if(refCount != 0) {
 			auto message = format("Main loop finished running, but there's {} active references", refCount);
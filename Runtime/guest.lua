@@ -0,0 +1,58 @@
+local bindings = require("bindings")
+local ffi = require("ffi")
+local uv = require("uv")
+local validation = require("validation")
+
+local format = string.format
+
+-- Entry point for guest VMs, which only get the bindings that are safe to use without a host (see main.cpp)
+local guest = {
+	openHandles = setmetatable({}, { __mode = "k" }),
+}
+
+local function trackHandle(handle, ...)
+	-- Some constructors (like new_work) create objects that aren't handles and can't be closed
+	if type(handle) == "userdata" and handle.is_closing then
+		guest.openHandles[handle] = true
+	end
+	return handle, ...
+end
+
+function guest.initialize()
+	for libraryName, staticExportsTable in pairs(bindings) do
+		local ffiBindings = require(libraryName)
+		ffiBindings.initialize()
+		local expectedStructName = "struct static_" .. libraryName .. "_exports_table"
+		local ffiExportsTable = ffi.cast(expectedStructName .. "*", staticExportsTable)
+		local success, lastIndex = validation.validateExportsTable(ffiExportsTable, expectedStructName)
+		assert(success, format("Invalid exports table for library %s (entry %d is NULL)", libraryName, lastIndex))
+		ffiBindings.bindings = ffiExportsTable
+	end
+
+	-- Handles are registered on the host's loop, so they must be closed before a failed guest can be unregistered
+	for name, createHandle in pairs(uv) do
+		local isHandleConstructor = (name:match("^new_") or name == "spawn") and type(createHandle) == "function"
+		if isHandleConstructor then
+			uv[name] = function(...)
+				return trackHandle(createHandle(...))
+			end
+		end
+	end
+end
+
+function guest.run(scriptPath)
+	validation.validateString(scriptPath, "scriptPath")
+
+	guest.initialize()
+	return dofile(scriptPath)
+end
+
+function guest.closeAllHandles()
+	for handle in pairs(guest.openHandles) do
+		if not handle:is_closing() then
+			handle:close()
+		end
+	end
+end
+
+return guest
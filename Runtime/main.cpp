@@ -19,6 +19,7 @@ extern "C" {
 #include "labsound_ffi.hpp"
 #include "rapidjson.hpp"
 #include "runtime_ffi.hpp"
+#include "runtime_threadpool.hpp"
 #include "rml_ffi.hpp"
 #include "stbi_ffi.hpp"
 #include "stduuid_ffi.hpp"
@@ -26,19 +27,14 @@ extern "C" {
 #include "wgpu_ffi.hpp"
 #include "webview_ffi.hpp"
 
+#include "LuaMemoryAllocator.hpp"
 #include "LuaVirtualMachine.hpp"
 #include "SharedEventLoop.hpp"
 
-int main(int argc, char* argv[]) {
-	std::shared_ptr<LuaVirtualMachine> luaVM = std::make_shared<LuaVirtualMachine>();
-
-	argv = uv_setup_args(argc, argv); // Required on Linux (see https://github.com/libuv/libuv/issues/2845)
-	auto L = luaVM->GetState();
-	luaVM->SetGlobalArgs(argc, argv);
-
-	// In order to support multiple guests on the event loop, the runtime itself must own it
-	std::unique_ptr<SharedEventLoop> sharedEventLoop = std::make_unique<SharedEventLoop>(luaVM);
+#include <cstdlib>
 
+// Guests only get what's safe to use without a host, i.e., nothing that accesses the main VM or its event loop directly
+static void LoadSandboxedLibraries(std::shared_ptr<LuaVirtualMachine> luaVM) {
 	luaVM->LoadPackage("uv", luaopen_luv);
 	luaVM->LoadPackage("lpeg", luaopen_lpeg);
 	luaVM->LoadPackage("miniz", luaopen_miniz);
@@ -52,10 +48,17 @@ int main(int argc, char* argv[]) {
 	// Some glue code is needed to access them via FFI, but calls have lower overhead and they're easier to extend
 	luaVM->LoadPackage("bindings");
 	luaVM->BindStaticLibraryExports("cpp", cpp_ffi::getExportsTable());
+	luaVM->BindStaticLibraryExports("iconv", iconv_ffi::getExportsTable());
+	luaVM->BindStaticLibraryExports("stduuid", stduuid_ffi::getExportsTable());
+}
+
+static void LoadBuiltinLibraries(std::shared_ptr<LuaVirtualMachine> luaVM) {
+	LoadSandboxedLibraries(luaVM);
+
+	// These rely on global state owned by the host (like the assigned Lua state or its windows), or on its event loop
 	luaVM->BindStaticLibraryExports("crypto", crypto_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("curl", curl_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("glfw", glfw_ffi::getExportsTable());
-	luaVM->BindStaticLibraryExports("iconv", iconv_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("interop", interop_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("labsound", labsound_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("webview", webview_ffi::getExportsTable());
@@ -63,11 +66,34 @@ int main(int argc, char* argv[]) {
 	luaVM->BindStaticLibraryExports("rml", rml_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("runtime", runtime_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("stbi", stbi_ffi::getExportsTable());
-	luaVM->BindStaticLibraryExports("stduuid", stduuid_ffi::getExportsTable());
 	luaVM->BindStaticLibraryExports("wgpu", wgpu_ffi::getExportsTable());
 
 	// Some namespaces cannot be created from Lua because they store info only available in C++ land (like #defines)
 	luaVM->CreateGlobalNamespace("C_Runtime");
+}
+
+int main(int argc, char* argv[]) {
+	// LuaJIT's built-in allocator is used unless another one was explicitly requested (mostly useful for benchmarking)
+	const char* allocatorName = std::getenv("EVO_LUA_ALLOCATOR");
+	auto allocator = LuaMemoryAllocator::CreateFromName(allocatorName ? allocatorName : "");
+	std::shared_ptr<LuaVirtualMachine> luaVM = std::make_shared<LuaVirtualMachine>(allocator);
+
+	argv = uv_setup_args(argc, argv); // Required on Linux (see https://github.com/libuv/libuv/issues/2845)
+	runtime_threadpool::configureThreadPoolSize(); // Must happen before any work is queued (by luv or the runtime)
+	auto L = luaVM->GetState();
+	luaVM->SetGlobalArgs(argc, argv);
+
+	// In order to support multiple guests on the event loop, the runtime itself must own it
+	std::unique_ptr<SharedEventLoop> sharedEventLoop = std::make_unique<SharedEventLoop>(luaVM);
+
+	LoadBuiltinLibraries(luaVM);
+	sharedEventLoop->InstallCallbackHandler(); // Needed to find out which callbacks are blocking the loop
+
+	// Guests share the same event loop, but they can't access the host (or create guests of their own)
+	sharedEventLoop->SetGuestInitializer(LoadSandboxedLibraries);
+	runtime_ffi::assignEventLoop(sharedEventLoop.get());
+	stbi_ffi::assignEventLoop(sharedEventLoop->GetLoop());
+	crypto_ffi::assignEventLoop(sharedEventLoop->GetLoop());
 
 	runtime_ffi::assignLuaState(L);
 	rml_ffi::assignLuaState(L);
@@ -79,10 +105,14 @@ int main(int argc, char* argv[]) {
 	if(!success) {
 		std::cerr << "\t" << FROM_HERE << ": in function 'main'" << std::endl;
 
+		crypto_ffi::unassignEventLoop();
 		return EXIT_FAILURE;
 	}
 
 	sharedEventLoop->RunMainLoopUntilDone();
 
+	// The KDF workers signal the event loop when they finish, so they must be stopped while it (and the Lua state) still exists
+	crypto_ffi::unassignEventLoop();
+
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
+local bit = require("bit")
 local crypto = require("crypto")
+local ffi = require("ffi")
 local openssl = require("openssl")
+local uv = require("uv")
 
 local tinsert = table.insert
 
@@ -8,6 +11,8 @@ describe("crypto", function()
 		assertEquals(crypto.KDF_ARGON2D, "ARGON2D")
 		assertEquals(crypto.KDF_ARGON2I, "ARGON2I")
 		assertEquals(crypto.KDF_ARGON2ID, "ARGON2ID")
+		assertEquals(crypto.KDF_PBKDF2, "PBKDF2")
+		assertEquals(crypto.KDF_SCRYPT, "SCRYPT")
 
 		-- Based on https://cheatsheetseries.owasp.org/cheatsheets/Password_Storage_Cheat_Sheet.html#argon2id
 		assertEquals(crypto.DEFAULT_KDF_PARAMETERS.kdf, crypto.KDF_ARGON2ID)
@@ -184,6 +189,425 @@ describe("crypto", function()
 		end)
 	end)
 
+	describe("encodeBase64", function()
+		it("should return the Base64 encoded input string for each of the RFC 4648 test vectors", function()
+			assertEquals(crypto.encodeBase64(""), "")
+			assertEquals(crypto.encodeBase64("f"), "Zg==")
+			assertEquals(crypto.encodeBase64("fo"), "Zm8=")
+			assertEquals(crypto.encodeBase64("foo"), "Zm9v")
+			assertEquals(crypto.encodeBase64("foob"), "Zm9vYg==")
+			assertEquals(crypto.encodeBase64("fooba"), "Zm9vYmE=")
+			assertEquals(crypto.encodeBase64("foobar"), "Zm9vYmFy")
+		end)
+
+		it("should omit the padding characters if padding is disabled", function()
+			assertEquals(crypto.encodeBase64("f", { padding = false }), "Zg")
+			assertEquals(crypto.encodeBase64("fo", { padding = false }), "Zm8")
+			assertEquals(crypto.encodeBase64("foo", { padding = false }), "Zm9v")
+		end)
+
+		it("should use the URL-safe alphabet if requested", function()
+			local input = "\251\255\191"
+			assertEquals(crypto.encodeBase64(input), "+/+/")
+			assertEquals(crypto.encodeBase64(input, { alphabet = crypto.BASE64_ALPHABET_URL_SAFE }), "-_-_")
+		end)
+
+		it("should not insert line breaks if the input is long", function()
+			local input = string.rep("\0", 1000)
+			assertEquals(crypto.encodeBase64(input), string.rep("AAAA", 333) .. "AA==")
+		end)
+
+		it("should produce the same output regardless of the SIMD level used", function()
+			local input = openssl.random(1000)
+			local options = { alphabet = crypto.BASE64_ALPHABET_URL_SAFE, padding = false }
+			local initialLevel = tonumber(crypto.bindings.base64_get_simd_level()) -- Enums are returned as cdata
+
+			assertTrue(crypto.bindings.base64_set_simd_level(ffi.C.BASE64_SIMD_SCALAR))
+			local expectedOutputs = {}
+			for length = 0, #input, 1 do
+				expectedOutputs[length] = crypto.encodeBase64(input:sub(1, length), options)
+			end
+
+			for level = ffi.C.BASE64_SIMD_SCALAR, initialLevel, 1 do
+				assertTrue(crypto.bindings.base64_set_simd_level(level))
+				for length = 0, #input, 1 do
+					assertEquals(crypto.encodeBase64(input:sub(1, length), options), expectedOutputs[length])
+				end
+			end
+			crypto.bindings.base64_set_simd_level(initialLevel)
+		end)
+
+		it("should throw if an invalid alphabet was passed", function()
+			assertThrows(function()
+				crypto.encodeBase64("foo", { alphabet = "base32" })
+			end, "Invalid Base64 alphabet base32 (must be standard or url)")
+		end)
+
+		it("should throw if an invalid padding option was passed", function()
+			assertThrows(function()
+				crypto.encodeBase64("foo", { padding = 42 })
+			end, "Invalid Base64 padding 42 (must be a boolean value)")
+		end)
+	end)
+
+	describe("decodeBase64", function()
+		it("should return the original input for each of the RFC 4648 test vectors", function()
+			assertEquals(crypto.decodeBase64(""), "")
+			assertEquals(crypto.decodeBase64("Zg=="), "f")
+			assertEquals(crypto.decodeBase64("Zm8="), "fo")
+			assertEquals(crypto.decodeBase64("Zm9v"), "foo")
+			assertEquals(crypto.decodeBase64("Zm9vYg=="), "foob")
+			assertEquals(crypto.decodeBase64("Zm9vYmE="), "fooba")
+			assertEquals(crypto.decodeBase64("Zm9vYmFy"), "foobar")
+		end)
+
+		it("should return the original input if unpadded URL-safe Base64 was passed", function()
+			local options = { alphabet = crypto.BASE64_ALPHABET_URL_SAFE, padding = false }
+			assertEquals(crypto.decodeBase64("-_-_", options), "\251\255\191")
+			assertEquals(crypto.decodeBase64("Zm8", options), "fo")
+		end)
+
+		it("should return the original input regardless of the SIMD level used", function()
+			local input = openssl.random(1000)
+			local initialLevel = tonumber(crypto.bindings.base64_get_simd_level()) -- Enums are returned as cdata
+			for level = ffi.C.BASE64_SIMD_SCALAR, initialLevel, 1 do
+				assertTrue(crypto.bindings.base64_set_simd_level(level))
+				for length = 0, #input, 1 do
+					local expectedOutput = input:sub(1, length)
+					assertEquals(crypto.decodeBase64(crypto.encodeBase64(expectedOutput)), expectedOutput)
+				end
+			end
+			crypto.bindings.base64_set_simd_level(initialLevel)
+		end)
+
+		it("should return nil and an error message if the input contains characters outside of the alphabet", function()
+			local expectedErrorMessage = "Invalid Base64 input (the string contains unexpected characters or padding)"
+			local invalidInputs = {
+				"Zm9v\n",
+				"Zm9v YmFy",
+				"-_-_",
+				string.rep("A", 100) .. "*" .. string.rep("A", 99),
+			}
+			for _, invalidInput in ipairs(invalidInputs) do
+				local result, errorMessage = crypto.decodeBase64(invalidInput)
+				assertEquals(result, nil)
+				assertEquals(errorMessage, expectedErrorMessage)
+			end
+
+			local result, errorMessage = crypto.decodeBase64("+/+/", { alphabet = crypto.BASE64_ALPHABET_URL_SAFE })
+			assertEquals(result, nil)
+			assertEquals(errorMessage, expectedErrorMessage)
+		end)
+
+		it("should return nil and an error message if the padding is missing, misplaced, or unexpected", function()
+			local expectedErrorMessage = "Invalid Base64 input (the string contains unexpected characters or padding)"
+			local invalidInputs = {
+				{ "Zg", true },
+				{ "Zm8", true },
+				{ "Zg=", true },
+				{ "Z===", true },
+				{ "====", true },
+				{ "Zg==Zg==", true },
+				{ "Zg=a", true },
+				{ "Zg==", false },
+				{ "Z", false },
+			}
+			for _, testCase in ipairs(invalidInputs) do
+				local result, errorMessage = crypto.decodeBase64(testCase[1], { padding = testCase[2] })
+				assertEquals(result, nil)
+				assertEquals(errorMessage, expectedErrorMessage)
+			end
+		end)
+
+		it("should return nil and an error message if the unused bits in the last group aren't zero", function()
+			local expectedErrorMessage = "Invalid Base64 input (the string contains unexpected characters or padding)"
+			local result, errorMessage = crypto.decodeBase64("Zh==")
+			assertEquals(result, nil)
+			assertEquals(errorMessage, expectedErrorMessage)
+
+			result, errorMessage = crypto.decodeBase64("Zm9=")
+			assertEquals(result, nil)
+			assertEquals(errorMessage, expectedErrorMessage)
+		end)
+	end)
+
+	describe("digest", function()
+		it("should return the raw digest of the input for each of the supported algorithms", function()
+			local testCases = {
+				[crypto.DIGEST_SHA1] = "a9993e364706816aba3e25717850c26c9cd0d89d",
+				[crypto.DIGEST_SHA256] = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+				[crypto.DIGEST_SHA512] = "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+					.. "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+				[crypto.DIGEST_BLAKE2S256] = "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982",
+				[crypto.DIGEST_BLAKE2B512] = "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+					.. "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923",
+			}
+			for algorithm, expectedDigest in pairs(testCases) do
+				assertEquals(openssl.hex(crypto.digest(algorithm, "abc")), expectedDigest)
+				-- The cached context must have been reset
+				assertEquals(openssl.hex(crypto.digest(algorithm, "abc")), expectedDigest)
+			end
+		end)
+
+		it("should throw if an unsupported algorithm was passed", function()
+			assertThrows(function()
+				crypto.digest("md5", "abc")
+			end, "Unsupported digest algorithm md5")
+		end)
+	end)
+
+	describe("createHash", function()
+		it("should return the same digest regardless of how the input was split up", function()
+			local input = string.rep("The quick brown fox jumps over the lazy dog", 100)
+			local context = crypto.createHash(crypto.DIGEST_SHA256)
+			for offset = 1, #input, 37 do
+				context:update(input:sub(offset, offset + 36))
+			end
+			assertEquals(context:final(), crypto.digest(crypto.DIGEST_SHA256, input))
+		end)
+
+		it("should be reusable after the digest has been finalized", function()
+			local context = crypto.createHash(crypto.DIGEST_SHA1)
+			context:update("hello")
+			local firstDigest = context:final()
+			context:update("hello")
+			assertEquals(context:final(), firstDigest)
+		end)
+
+		it("should discard the input that was passed before resetting", function()
+			local context = crypto.createHash(crypto.DIGEST_SHA512)
+			context:update("garbage")
+			context:reset()
+			context:update("abc")
+			assertEquals(context:final(), crypto.digest(crypto.DIGEST_SHA512, "abc"))
+		end)
+
+		it("should throw if an unsupported algorithm was passed", function()
+			assertThrows(function()
+				crypto.createHash("md4")
+			end, "Unsupported digest algorithm md4")
+		end)
+	end)
+
+	describe("createHMAC", function()
+		it("should return the HMAC of the input for the given key", function()
+			-- Test case 2 from RFC 4231 (and RFC 2202 for SHA-1)
+			local context = crypto.createHMAC(crypto.DIGEST_SHA256, "Jefe")
+			context:update("what do ya want ")
+			context:update("for nothing?")
+			local expectedDigest = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"
+			assertEquals(openssl.hex(context:final()), expectedDigest)
+
+			context = crypto.createHMAC(crypto.DIGEST_SHA1, "Jefe")
+			context:update("what do ya want for nothing?")
+			assertEquals(openssl.hex(context:final()), "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79")
+		end)
+
+		it("should keep using the same key after the digest has been finalized", function()
+			local context = crypto.createHMAC(crypto.DIGEST_SHA256, "Jefe")
+			context:update("what do ya want for nothing?")
+			local firstDigest = context:final()
+			context:update("what do ya want for nothing?")
+			assertEquals(context:final(), firstDigest)
+		end)
+
+		it("should support empty keys", function()
+			local context = crypto.createHMAC(crypto.DIGEST_SHA256, "")
+			local expectedDigest = "b613679a0814d9ec772f95d778c35fc5ff1697c493715653c6c712144292c5ad"
+			assertEquals(openssl.hex(context:final()), expectedDigest)
+		end)
+	end)
+
+	describe("hashBuffers", function()
+		it("should return the digests of all inputs back to back and in the same order", function()
+			local inputs = { "abc", "", string.rep("x", 1000), "abc" }
+			local digests, digestSize = crypto.hashBuffers(crypto.DIGEST_BLAKE2B512, inputs)
+			assertEquals(digestSize, 64)
+			assertEquals(#digests, #inputs * digestSize)
+			for index, input in ipairs(inputs) do
+				local digest = digests:sub((index - 1) * digestSize + 1, index * digestSize)
+				assertEquals(digest, crypto.digest(crypto.DIGEST_BLAKE2B512, input))
+			end
+		end)
+
+		it("should return the correct digests if the number of inputs grows between calls", function()
+			local inputs = { "abc" }
+			crypto.hashBuffers(crypto.DIGEST_SHA256, inputs)
+			for index = 2, 100, 1 do
+				inputs[index] = tostring(index)
+			end
+
+			local digests, digestSize = crypto.hashBuffers(crypto.DIGEST_SHA256, inputs)
+			assertEquals(#digests, #inputs * digestSize)
+			assertEquals(digests:sub(-digestSize), crypto.digest(crypto.DIGEST_SHA256, "100"))
+		end)
+
+		it("should return an empty string if no inputs were passed", function()
+			local digests, digestSize = crypto.hashBuffers(crypto.DIGEST_SHA256, {})
+			assertEquals(digests, "")
+			assertEquals(digestSize, 32)
+		end)
+	end)
+
+	describe("createAEADKey", function()
+		local key = string.rep("k", 32)
+
+		it("should throw if an unsupported algorithm was passed", function()
+			assertThrows(function()
+				crypto.createAEADKey("aes-128-cbc", key)
+			end, "Unsupported AEAD algorithm aes-128-cbc")
+		end)
+
+		it("should throw if the key isn't exactly 32 bytes long", function()
+			assertThrows(function()
+				crypto.createAEADKey(crypto.AEAD_AES_256_GCM, string.rep("k", 16))
+			end, "Invalid AEAD key (expected 32 bytes, got 16)")
+		end)
+
+		it("should throw if the key isn't a string", function()
+			assertThrows(function()
+				crypto.createAEADKey(crypto.AEAD_AES_256_GCM, 42)
+			end, "Invalid AEAD key (expected a string, got number)")
+		end)
+
+		it("should be able to open messages that were sealed with the same key for all supported algorithms", function()
+			for _, algorithm in ipairs({ crypto.AEAD_AES_256_GCM, crypto.AEAD_CHACHA20_POLY1305 }) do
+				local aeadKey = crypto.createAEADKey(algorithm, key)
+				for _, plaintext in ipairs({ "", "Hello world", string.rep("x", 100000) }) do
+					local sealedMessage = aeadKey:seal(plaintext, "header")
+					assertEquals(#sealedMessage, #plaintext + 12 + 16)
+					assertEquals(aeadKey:open(sealedMessage, "header"), plaintext)
+				end
+			end
+		end)
+
+		it("should use a different nonce every time a message is sealed", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_CHACHA20_POLY1305, key)
+			local firstMessage = aeadKey:seal("Hello world")
+			local secondMessage = aeadKey:seal("Hello world")
+			assertFalse(firstMessage == secondMessage)
+			assertEquals(aeadKey:open(firstMessage), "Hello world")
+			assertEquals(aeadKey:open(secondMessage), "Hello world")
+		end)
+
+		it("should return nil and an error message if the sealed message was tampered with", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, key)
+			local sealedMessage = aeadKey:seal("Hello world")
+			-- Flipping a bit guarantees the message is changed (replacing a byte wouldn't if it happened to have the same value)
+			local flippedByte = string.char(bit.bxor(sealedMessage:byte(13), 1))
+			local tamperedMessage = sealedMessage:sub(1, 12) .. flippedByte .. sealedMessage:sub(14)
+
+			local plaintext, errorMessage = aeadKey:open(tamperedMessage)
+			assertEquals(plaintext, nil)
+			assertEquals(
+				errorMessage,
+				"Failed to authenticate sealed message (wrong key, associated data, or corrupted ciphertext)"
+			)
+		end)
+
+		it("should return nil and an error message if the associated data doesn't match", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_CHACHA20_POLY1305, key)
+			local sealedMessage = aeadKey:seal("Hello world", "header")
+
+			local plaintext, errorMessage = aeadKey:open(sealedMessage, "footer")
+			assertEquals(plaintext, nil)
+			assertEquals(
+				errorMessage,
+				"Failed to authenticate sealed message (wrong key, associated data, or corrupted ciphertext)"
+			)
+		end)
+
+		it("should return nil and an error message if the message was sealed with a different key", function()
+			local sealingKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, key)
+			local openingKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, string.rep("K", 32))
+
+			local plaintext, errorMessage = openingKey:open(sealingKey:seal("Hello world"))
+			assertEquals(plaintext, nil)
+			assertEquals(
+				errorMessage,
+				"Failed to authenticate sealed message (wrong key, associated data, or corrupted ciphertext)"
+			)
+		end)
+
+		it("should return nil and an error message if the sealed message is too short", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, key)
+			local plaintext, errorMessage = aeadKey:open(string.rep("x", 27))
+			assertEquals(plaintext, nil)
+			assertEquals(errorMessage, "Invalid sealed message (too short to contain the nonce and tag)")
+		end)
+
+		it("should seal all messages in a batch so that they can be opened individually", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_CHACHA20_POLY1305, key)
+			local plaintexts = { "abc", "", string.rep("x", 1000), "abc" }
+			local sealedMessages = aeadKey:sealBatch(plaintexts, "header")
+
+			assertEquals(#sealedMessages, #plaintexts)
+			assertFalse(sealedMessages[1] == sealedMessages[4])
+			for index, plaintext in ipairs(plaintexts) do
+				assertEquals(aeadKey:open(sealedMessages[index], "header"), plaintext)
+			end
+		end)
+
+		it("should return an empty table if an empty batch was passed", function()
+			local aeadKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, key)
+			assertEquals(aeadKey:sealBatch({}), {})
+		end)
+	end)
+
+	describe("bindings", function()
+		describe("aead_seal", function()
+			-- See https://datatracker.ietf.org/doc/html/rfc8439#section-2.8.2
+			it("should produce the ChaCha20-Poly1305 ciphertext and tag given in RFC 8439", function()
+				local keyBytes = openssl.hex("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f", false)
+				local nonce = openssl.hex("070000004041424344454647", false)
+				local aad = openssl.hex("50515253c0c1c2c3c4c5c6c7", false)
+				local plaintext = "Ladies and Gentlemen of the class of '99: "
+					.. "If I could offer you only one tip for the future, sunscreen would be it."
+				local expectedCiphertext = "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+					.. "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+					.. "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+					.. "3ff4def08e4b7a9de576d26586cec64b6116"
+
+				local aeadKey = crypto.createAEADKey(crypto.AEAD_CHACHA20_POLY1305, keyBytes)
+				local ciphertext = ffi.new("unsigned char[?]", #plaintext)
+				local tag = ffi.new("unsigned char[16]")
+				assertTrue(crypto.bindings.aead_seal(aeadKey, nonce, aad, #aad, plaintext, #plaintext, ciphertext, tag))
+				assertEquals(openssl.hex(ffi.string(ciphertext, #plaintext)), expectedCiphertext)
+				assertEquals(openssl.hex(ffi.string(tag, 16)), "1ae10b594f09e26a7e902ecbd0600691")
+			end)
+
+			-- See NIST's GCM specification (test cases 13 and 14)
+			it("should produce the AES-256-GCM ciphertext and tag given in the GCM test vectors", function()
+				local aeadKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, string.rep("\0", 32))
+				local nonce = string.rep("\0", 12)
+				local ciphertext = ffi.new("unsigned char[16]")
+				local tag = ffi.new("unsigned char[16]")
+
+				assertTrue(crypto.bindings.aead_seal(aeadKey, nonce, nil, 0, nil, 0, ciphertext, tag))
+				assertEquals(openssl.hex(ffi.string(tag, 16)), "530f8afbc74536b9a963b4f1c4cb738b")
+
+				assertTrue(crypto.bindings.aead_seal(aeadKey, nonce, nil, 0, string.rep("\0", 16), 16, ciphertext, tag))
+				assertEquals(openssl.hex(ffi.string(ciphertext, 16)), "cea7403d4d606b6e074ec5d3baf39d18")
+				assertEquals(openssl.hex(ffi.string(tag, 16)), "d0d1c8a799996bf0265b98b5d48ab919")
+			end)
+		end)
+
+		describe("aead_open", function()
+			it("should wipe the output buffer if the tag doesn't match", function()
+				local aeadKey = crypto.createAEADKey(crypto.AEAD_AES_256_GCM, string.rep("k", 32))
+				local nonce = string.rep("n", 12)
+				local ciphertext = ffi.new("unsigned char[5]")
+				local tag = ffi.new("unsigned char[16]")
+				assertTrue(crypto.bindings.aead_seal(aeadKey, nonce, nil, 0, "Hello", 5, ciphertext, tag))
+
+				tag[0] = tag[0] + 1
+				local output = ffi.new("unsigned char[5]")
+				assertFalse(crypto.bindings.aead_open(aeadKey, nonce, nil, 0, ciphertext, 5, tag, output))
+				assertEquals(ffi.string(output, 5), string.rep("\0", 5))
+			end)
+		end)
+	end)
+
 	describe("mcf", function()
 		it(
 			"should return the modular crypt formatted representation of the hash for a given set of Argon2 parameters",
@@ -263,6 +687,48 @@ describe("crypto", function()
 			assertEquals(openssl.hex(crypto.hash("password", "saltsalt", parameters)), expectedResult)
 		end)
 
+		it("should return the derived key if valid PBKDF2 parameters were passed", function()
+			-- PBKDF2-HMAC-SHA256 test vector from RFC 7914 (section 11)
+			local parameters = { kdf = crypto.KDF_PBKDF2, iterations = 1, size = 64 }
+			local expectedHash = "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+				.. "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783"
+			assertEquals(openssl.hex(crypto.hash("passwd", "salt", parameters)), expectedHash)
+		end)
+
+		it("should return the derived key if valid scrypt parameters were passed", function()
+			-- Test vector from RFC 7914 (section 12)
+			local parameters = { kdf = crypto.KDF_SCRYPT, kilobytes = 1024, lanes = 16, size = 64 }
+			local expectedHash = "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+				.. "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640"
+			assertEquals(openssl.hex(crypto.hash("password", "NaCl", parameters)), expectedHash)
+		end)
+
+		it("should be able to derive keys with different algorithms in any order", function()
+			local pbkdf2Parameters = { kdf = crypto.KDF_PBKDF2, iterations = 1, size = 32 }
+			local scryptParameters = { kdf = crypto.KDF_SCRYPT, kilobytes = 16, lanes = 1, size = 32 }
+			local argon2Parameters = { kdf = crypto.KDF_ARGON2ID, kilobytes = 1024, iterations = 1, size = 32 }
+
+			local pbkdf2Hash = crypto.hash("password", "saltsalt", pbkdf2Parameters)
+			local scryptHash = crypto.hash("password", "saltsalt", scryptParameters)
+			local argon2Hash = crypto.hash("password", "saltsalt", argon2Parameters)
+			for _ = 1, 3, 1 do
+				assertEquals(crypto.hash("password", "saltsalt", argon2Parameters), argon2Hash)
+				assertEquals(crypto.hash("password", "saltsalt", scryptParameters), scryptHash)
+				assertEquals(crypto.hash("password", "saltsalt", pbkdf2Parameters), pbkdf2Hash)
+			end
+		end)
+
+		it("should still be able to derive keys after a derivation has failed", function()
+			local parameters = { kdf = crypto.KDF_SCRYPT, kilobytes = 1000, lanes = 1, size = 32 }
+			local result = crypto.hash("password", "saltsalt", parameters) -- N must be a power of two
+			assertEquals(result, nil)
+
+			parameters.kilobytes = 1024
+			local hash = crypto.hash("password", "saltsalt", parameters)
+			assertEquals(type(hash), "string")
+			assertEquals(#hash, 32)
+		end)
+
 		it("should use the default KDF parameters if none were passed", function()
 			local parameters = crypto.DEFAULT_KDF_PARAMETERS
 			local actual = openssl.hex(crypto.hash("password", "saltsalt"))
@@ -271,6 +737,99 @@ describe("crypto", function()
 		end)
 	end)
 
+	describe("hashAsync", function()
+		local FAST_KDF_PARAMETERS = {
+			kdf = crypto.KDF_ARGON2ID,
+			version = 0x13,
+			kilobytes = 1024,
+			threads = 1,
+			lanes = 1,
+			size = 32,
+			iterations = 1,
+		}
+
+		it("should throw if no completion handler was passed on the main thread", function()
+			local function hashWithoutHandler()
+				crypto.hashAsync("password", "saltsalt", FAST_KDF_PARAMETERS)
+			end
+			local expectedErrorMessage =
+				"Cannot yield from the main thread (pass a completion handler or wrap async task in a coroutine)"
+			assertThrows(hashWithoutHandler, expectedErrorMessage)
+		end)
+
+		it("should pass the same key that crypto.hash derives to the completion handler", function()
+			local hash, errorMessage
+			crypto.hashAsync("password", "saltsalt", FAST_KDF_PARAMETERS, function(...)
+				hash, errorMessage = ...
+			end)
+
+			repeat
+				uv.run("once")
+			until hash ~= nil or errorMessage ~= nil
+
+			assertEquals(errorMessage, nil)
+			assertEquals(hash, crypto.hash("password", "saltsalt", FAST_KDF_PARAMETERS))
+			assertEquals(tonumber(crypto.bindings.kdf_pending_requests()), 0)
+		end)
+
+		it("should resume the calling coroutine if no completion handler was passed", function()
+			local isDone = false
+			coroutine.wrap(function()
+				local hash, errorMessage = crypto.hashAsync("password", "saltsalt", FAST_KDF_PARAMETERS)
+				assertEquals(errorMessage, nil)
+				assertEquals(hash, crypto.hash("password", "saltsalt", FAST_KDF_PARAMETERS))
+				isDone = true
+			end)()
+
+			repeat
+				uv.run("once")
+			until isDone
+		end)
+
+		it("should derive all keys correctly if multiple requests are pending at the same time", function()
+			local passwords = { "first", "second", "third", "fourth", "fifth", "sixth", "seventh", "eighth" }
+			local parameters = {
+				kdf = crypto.KDF_ARGON2ID,
+				version = 0x13,
+				kilobytes = 1024,
+				threads = 2,
+				lanes = 2,
+				size = 32,
+				iterations = 1,
+			}
+			local hashes = {}
+			local numCompletedRequests = 0
+			for index, password in ipairs(passwords) do
+				crypto.hashAsync(password, "saltsalt", parameters, function(hash)
+					hashes[index] = hash
+					numCompletedRequests = numCompletedRequests + 1
+				end)
+			end
+
+			repeat
+				uv.run("once")
+			until numCompletedRequests == #passwords
+
+			for index, password in ipairs(passwords) do
+				assertEquals(hashes[index], crypto.hash(password, "saltsalt", parameters))
+			end
+		end)
+
+		it("should pass the OpenSSL error message to the completion handler if the key couldn't be derived", function()
+			local hash, errorMessage
+			crypto.hashAsync("password", "salt", FAST_KDF_PARAMETERS, function(...)
+				hash, errorMessage = ...
+			end)
+
+			repeat
+				uv.run("once")
+			until hash ~= nil or errorMessage ~= nil
+
+			assertEquals(hash, nil)
+			assertEquals(errorMessage, "OpenSSL error:1C800070:Provider routines::invalid salt length")
+		end)
+	end)
+
 	describe("verify", function()
 		it(
 			"should return false if the given hash cannot be derived from the plaintext password, salt, and kdf parameters",
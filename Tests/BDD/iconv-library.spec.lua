@@ -76,6 +76,110 @@ describe("iconv", function()
 					},
 				})
 			end)
+
+			it("should reuse the same descriptor for repeated conversions between the same charsets", function()
+				assertConversionResult({
+					input = "Hello",
+					from = "ASCII",
+					to = "UTF-16LE",
+					expected = {
+						result = ffi.C.ICONV_RESULT_OK,
+						output = "H\0e\0l\0l\0o\0",
+					},
+				})
+				local numCachedDescriptors = tonumber(iconv.bindings.iconv_cached_descriptors())
+
+				assertConversionResult({
+					input = "World",
+					from = "ASCII",
+					to = "UTF-16LE",
+					expected = {
+						result = ffi.C.ICONV_RESULT_OK,
+						output = "W\0o\0r\0l\0d\0",
+					},
+				})
+				assertEquals(tonumber(iconv.bindings.iconv_cached_descriptors()), numCachedDescriptors)
+			end)
+
+			it("should not cache more descriptors than the configured limit", function()
+				local charsets = { "UTF-16LE", "UTF-16BE", "UTF-32LE", "UTF-32BE", "LATIN1", "CP1252", "KOI8-R" }
+				for _, charset in ipairs(charsets) do
+					iconv.convert("abc", "UTF-8", charset)
+					iconv.convert("abc", charset, "UTF-8")
+				end
+
+				local maxCachedDescriptors = tonumber(ffi.C.ICONV_MAX_CACHED_DESCRIPTORS)
+				assertEquals(tonumber(iconv.bindings.iconv_cached_descriptors()), maxCachedDescriptors)
+			end)
+
+			it("should reset cached descriptors after a conversion has failed", function()
+				local input = "\192\175\192\250\192\206\197\205\198\228\192\204\189" -- Note: Final byte missing
+				local output, message = iconv.convert(input, "CP949", "UTF-8")
+				assertEquals(output, nil)
+				assertEquals(message, iconv.strerror(ffi.C.ICONV_INCOMPLETE_INPUT))
+
+				assertConversionResult({
+					input = "\192\175\192\250\192\206\197\205\198\228\192\204\189\186",
+					from = "CP949",
+					to = "UTF-8",
+					expected = {
+						result = ffi.C.ICONV_RESULT_OK,
+						output = "유저인터페이스",
+					},
+				})
+			end)
+		end)
+
+		describe("iconv_set_fast_paths", function()
+			after(function()
+				iconv.bindings.iconv_set_fast_paths(true)
+			end)
+
+			local function convertWithAndWithoutFastPaths(input, inputEncoding, outputEncoding)
+				iconv.bindings.iconv_set_fast_paths(true)
+				local output, message = iconv.convert(input, inputEncoding, outputEncoding)
+				iconv.bindings.iconv_set_fast_paths(false)
+				local expectedOutput, expectedMessage = iconv.convert(input, inputEncoding, outputEncoding)
+				assertEquals(output, expectedOutput)
+				assertEquals(message, expectedMessage)
+			end
+
+			local inputs = {
+				"",
+				"Hello world",
+				string.rep("Hello world! ", 10),
+				string.rep("Ça va très bien, merci. ", 10),
+				string.rep("Добрый день! ", 10),
+				string.rep("유저인터페이스 ", 10),
+				string.rep("Emoji: 😀🚀 ", 10),
+				string.rep("x", 40) .. "\237\160\128" .. string.rep("y", 40), -- Surrogate
+				string.rep("x", 40) .. "\192\175" .. string.rep("y", 40), -- Overlong encoding
+				string.rep("x", 40) .. "\255" .. string.rep("y", 40),
+				string.rep("x", 40) .. "\226\130", -- Truncated
+				string.rep("ÿ", 30) .. "\195",
+			}
+
+			it("should produce the same results as iconv when converting from or to UTF-8", function()
+				for _, input in ipairs(inputs) do
+					convertWithAndWithoutFastPaths(input, "UTF-8", "UTF-8")
+					convertWithAndWithoutFastPaths(input, "UTF-8", "ISO-8859-1")
+					convertWithAndWithoutFastPaths(input, "UTF-8", "UTF-16LE")
+				end
+			end)
+
+			it("should produce the same results as iconv when converting from Latin-1 or UTF-16LE", function()
+				for _, input in ipairs(inputs) do
+					convertWithAndWithoutFastPaths(input, "LATIN1", "UTF-8")
+					convertWithAndWithoutFastPaths(input, "UTF-16LE", "UTF-8")
+				end
+			end)
+
+			it("should recognize charset names regardless of their capitalization", function()
+				local input = string.rep("Ça va très bien, merci. ", 10)
+				local latin1, message = iconv.convert(input, "utf8", "latin1")
+				assertEquals(message, iconv.strerror(ffi.C.ICONV_RESULT_OK))
+				assertEquals(iconv.convert(latin1, "Iso-8859-1", "Utf-8"), input)
+			end)
 		end)
 
 		describe("iconv_open", function()
@@ -216,6 +320,141 @@ describe("iconv", function()
 		end)
 	end)
 
+	describe("createStreamingConverter", function()
+		it("should throw if the conversion isn't supported", function()
+			local function createWithInvalidEncoding()
+				iconv.createStreamingConverter("INVALID_ENCODING", "UTF-8")
+			end
+			assertThrows(createWithInvalidEncoding, "Unsupported conversion from INVALID_ENCODING to UTF-8")
+		end)
+
+		it("should carry incomplete multibyte sequences over to the next chunk", function()
+			local converter = iconv.createStreamingConverter("CP949", "UTF-8")
+			local input = "\192\175\192\250\192\206\197\205\198\228\192\204\189\186"
+			local outputs = {}
+			for index = 1, #input, 3 do
+				local output, message = converter:write(input:sub(index, index + 2))
+				assertEquals(message, iconv.strerror(ffi.C.ICONV_RESULT_OK))
+				table.insert(outputs, output)
+			end
+			assertEquals(converter:getNumPendingBytes(), 0)
+			assertEquals(converter:finish(), "")
+			assertEquals(table.concat(outputs), "유저인터페이스")
+		end)
+
+		it("should use the same results as iconv.convert when chunks are split at every possible offset", function()
+			local inputs = {
+				["UTF-16LE"] = "Ça va? 유저인터페이스 😀🚀",
+				["UTF-32"] = "Ça va? 유저인터페이스 😀🚀",
+				["ISO-2022-KR"] = "Hi 유저인터페이스 ok", -- Stateful encoding (with escape sequences)
+			}
+			for outputEncoding, input in pairs(inputs) do
+				local expectedOutput = iconv.convert(input, "UTF-8", outputEncoding)
+				assertEquals(type(expectedOutput), "string")
+				local converter = iconv.createStreamingConverter("UTF-8", outputEncoding)
+				for offset = 1, #input, 1 do
+					local outputBuffer = buffer.new()
+					converter:write(input:sub(1, offset), outputBuffer)
+					converter:write(input:sub(offset + 1), outputBuffer)
+					converter:finish(outputBuffer)
+					assertEquals(tostring(outputBuffer), expectedOutput)
+				end
+			end
+		end)
+
+		it("should fail if the input ended with an incomplete multibyte sequence", function()
+			local converter = iconv.createStreamingConverter("UTF-8", "UTF-16LE")
+			assertEquals(converter:write("Hi\240\159"), "H\0i\0")
+			assertEquals(converter:getNumPendingBytes(), 2)
+			assertFailure(function()
+				return converter:finish()
+			end, iconv.strerror(ffi.C.ICONV_INCOMPLETE_INPUT))
+
+			-- Finishing resets the converter, so the truncated sequence doesn't affect the next input
+			assertEquals(converter:getNumPendingBytes(), 0)
+			assertEquals(converter:write("Hi"), "H\0i\0")
+		end)
+
+		it("should fail if a chunk contains an invalid multibyte sequence", function()
+			local converter = iconv.createStreamingConverter("UTF-8", "ISO-8859-1")
+			assertEquals(converter:write("Hi \195"), "Hi ")
+			assertFailure(function()
+				return converter:write("\255")
+			end, iconv.strerror(ffi.C.ICONV_CONVERSION_FAILED))
+		end)
+
+		it("should append to the given buffer if one was passed", function()
+			local converter = iconv.createStreamingConverter("ISO-8859-1", "UTF-8")
+			local outputBuffer = buffer.new()
+			outputBuffer:put("Output: ")
+			assertEquals(converter:write("\231a va", outputBuffer), outputBuffer)
+			assertEquals(converter:finish(outputBuffer), outputBuffer)
+			assertEquals(tostring(outputBuffer), "Output: ça va")
+		end)
+
+		it("should grow the output buffer if the converted chunk doesn't fit", function()
+			local converter = iconv.createStreamingConverter("ASCII", "UTF-32")
+			local input = string.rep("A", 1000)
+			local output = converter:write(input)
+			assertEquals(output, iconv.convert(input, "ASCII", "UTF-32"))
+		end)
+	end)
+
+	describe("createFileChunkListener", function()
+		local AsyncFileReader = require("AsyncFileReader")
+		local etrace = require("etrace")
+		local uv = require("uv")
+
+		local TEST_FILE = "temp-iconv-chunks.txt"
+		local FILE_CONTENTS = "\192\175\192\250\192\206\197\205\198\228\192\204\189\186"
+		local oldChunkSize = AsyncFileReader.CHUNK_SIZE_IN_BYTES
+
+		before(function()
+			C_FileSystem.WriteFile(TEST_FILE, FILE_CONTENTS)
+			AsyncFileReader.CHUNK_SIZE_IN_BYTES = 3 -- Splits most of the two-byte sequences
+		end)
+
+		after(function()
+			AsyncFileReader.CHUNK_SIZE_IN_BYTES = oldChunkSize
+			C_FileSystem.Delete(TEST_FILE)
+		end)
+
+		it("should convert the chunks of the given file as they become available", function()
+			local outputs = {}
+			local converter = iconv.createStreamingConverter("CP949", "UTF-8")
+			local listener = iconv.createFileChunkListener(TEST_FILE, converter, function(output, message, payload)
+				assertEquals(message, iconv.strerror(ffi.C.ICONV_RESULT_OK))
+				assertEquals(payload.fileSystemPath, TEST_FILE)
+				table.insert(outputs, output)
+			end)
+
+			etrace.subscribe("FILE_CHUNK_AVAILABLE", listener)
+			AsyncFileReader:LoadFileContents(TEST_FILE)
+			uv.run()
+			etrace.unsubscribe("FILE_CHUNK_AVAILABLE", listener)
+
+			assertEquals(#outputs, math.ceil(#FILE_CONTENTS / 3))
+			assertEquals(table.concat(outputs), "유저인터페이스")
+		end)
+
+		it("should report an error if the file ends with an incomplete multibyte sequence", function()
+			C_FileSystem.WriteFile(TEST_FILE, FILE_CONTENTS:sub(1, -2))
+
+			local messages = {}
+			local converter = iconv.createStreamingConverter("CP949", "UTF-8")
+			local listener = iconv.createFileChunkListener(TEST_FILE, converter, function(output, message, payload)
+				table.insert(messages, message)
+			end)
+
+			etrace.subscribe("FILE_CHUNK_AVAILABLE", listener)
+			AsyncFileReader:LoadFileContents(TEST_FILE)
+			uv.run()
+			etrace.unsubscribe("FILE_CHUNK_AVAILABLE", listener)
+
+			assertEquals(messages[#messages], iconv.strerror(ffi.C.ICONV_INCOMPLETE_INPUT))
+		end)
+	end)
+
 	describe("strerror", function()
 		it("should return human-readable error strings for all known result types", function()
 			local firstValidOffset = tonumber(ffi.C.ICONV_RESULT_OK)
@@ -1,3 +1,7 @@
+local ffi = require("ffi")
+local stbi = require("stbi")
+local uv = require("uv")
+
 local EXAMPLE_IMAGE_DATA = "\255\0\0\0\0\255\0\0\0\0\255\0\0\0\0\255"
 local EXAMPLE_IMAGE_BUFFER = buffer.new():put(EXAMPLE_IMAGE_DATA)
 local EXAMPLE_BMP_BYTES = C_FileSystem.ReadFile(path.join("Tests", "Fixtures", "rgba-pixels.bmp"))
@@ -199,6 +203,382 @@ describe("C_ImageProcessing", function()
 		end)
 	end)
 
+	describe("DecodePooledImage", function()
+		it("should be able to decode file contents given as a string", function()
+			local pooledImage, imageWidthInPixels, imageHeightInPixels =
+				C_ImageProcessing.DecodePooledImage(EXAMPLE_PNG_BYTES)
+			assertEquals(ffi.string(pooledImage.data, 16), EXAMPLE_IMAGE_DATA)
+			assertEquals(imageWidthInPixels, 2)
+			assertEquals(imageHeightInPixels, 2)
+			assertEquals(pooledImage.channels, 4)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+		end)
+
+		it("should be able to decode file contents given as a string buffer", function()
+			local pooledImage = C_ImageProcessing.DecodePooledImage(EXAMPLE_TGA_BUFFER)
+			assertEquals(ffi.string(pooledImage.data, 16), EXAMPLE_IMAGE_DATA)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+		end)
+
+		it("should reuse pixel buffers that have been released", function()
+			local fileContents = C_FileSystem.ReadFile(path.join("Tests", "Fixtures", "test-icon.png"))
+			C_ImageProcessing.ReleasePooledImage(C_ImageProcessing.DecodePooledImage(fileContents))
+
+			local statsBefore = ffi.new("stbi_pool_stats_t")
+			stbi.bindings.stbi_get_pool_stats(statsBefore)
+			local pooledImage = C_ImageProcessing.DecodePooledImage(fileContents)
+			local statsAfter = ffi.new("stbi_pool_stats_t")
+			stbi.bindings.stbi_get_pool_stats(statsAfter)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+
+			assertTrue(statsAfter.num_reused_allocations > statsBefore.num_reused_allocations)
+		end)
+
+		it("should be usable as the input for the encoders", function()
+			local pooledImage, width, height = C_ImageProcessing.DecodePooledImage(EXAMPLE_PNG_BYTES)
+			local bmpFileContents = C_ImageProcessing.EncodeBMP(pooledImage, width, height)
+			assertEquals(bmpFileContents, EXAMPLE_BMP_BYTES)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+		end)
+
+		it("should throw if the file contents couldn't be decoded", function()
+			local function attemptToDecodeInvalidFile()
+				C_ImageProcessing.DecodePooledImage("not an image")
+			end
+			assertThrows(attemptToDecodeInvalidFile, "Failed to decode image data (stbi_load_rgba returned NULL)")
+		end)
+	end)
+
+	describe("ReleasePooledImage", function()
+		it("should do nothing if the image has already been released", function()
+			local pooledImage = C_ImageProcessing.DecodePooledImage(EXAMPLE_PNG_BYTES)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+			C_ImageProcessing.ReleasePooledImage(pooledImage)
+			assertTrue(pooledImage.data == nil)
+		end)
+
+		it("should throw if a non-cdata value was passed", function()
+			local function attemptToReleaseInvalidImage()
+				C_ImageProcessing.ReleasePooledImage("not an image")
+			end
+			local expectedErrorMessage =
+				"Expected argument pooledImage to be a cdata value, but received a string value instead"
+			assertThrows(attemptToReleaseInvalidImage, expectedErrorMessage)
+		end)
+	end)
+
+	describe("DecodeFile", function()
+		it("should be able to decode image files without loading them into memory first", function()
+			for _, extension in ipairs({ "bmp", "png", "tga" }) do
+				local filePath = path.join("Tests", "Fixtures", "rgba-pixels." .. extension)
+				local rgbaPixelArray, imageWidthInPixels, imageHeightInPixels = C_ImageProcessing.DecodeFile(filePath)
+				assertEquals(rgbaPixelArray, EXAMPLE_IMAGE_DATA)
+				assertEquals(imageWidthInPixels, 2)
+				assertEquals(imageHeightInPixels, 2)
+			end
+		end)
+
+		it("should produce the same pixels as decoding the file contents", function()
+			local filePath = path.join("Tests", "Fixtures", "test-icon.png")
+			local rgbaPixelArray, imageWidthInPixels, imageHeightInPixels = C_ImageProcessing.DecodeFile(filePath)
+			local expectedPixelArray = C_ImageProcessing.DecodeFileContents(C_FileSystem.ReadFile(filePath))
+			assertEquals(rgbaPixelArray, expectedPixelArray)
+			assertEquals(imageWidthInPixels, 256)
+			assertEquals(imageHeightInPixels, 256)
+		end)
+
+		it("should throw if the file doesn't exist", function()
+			local function attemptToDecodeMissingFile()
+				C_ImageProcessing.DecodeFile("does-not-exist.png")
+			end
+			local expectedErrorMessage =
+				"Failed to decode image file does-not-exist.png (stbi_load_from_path returned NULL)"
+			assertThrows(attemptToDecodeMissingFile, expectedErrorMessage)
+		end)
+
+		it("should throw if the file isn't a supported image format", function()
+			local filePath = path.join("Tests", "Fixtures", "miniz-poem.txt")
+			local function attemptToDecodeInvalidFile()
+				C_ImageProcessing.DecodeFile(filePath)
+			end
+			local expectedErrorMessage = "Failed to decode image file "
+				.. filePath
+				.. " (stbi_load_from_path returned NULL)"
+			assertThrows(attemptToDecodeInvalidFile, expectedErrorMessage)
+		end)
+	end)
+
+	describe("GetImageInfo", function()
+		it("should return the dimensions and number of channels stored in the image header", function()
+			local filePath = path.join("Tests", "Fixtures", "test-icon.png")
+			local width, height, channels = C_ImageProcessing.GetImageInfo(filePath)
+			assertEquals(width, 256)
+			assertEquals(height, 256)
+			assertEquals(channels, 3)
+		end)
+
+		it("should throw if the file isn't a supported image format", function()
+			local filePath = path.join("Tests", "Fixtures", "miniz-poem.txt")
+			local function attemptToReadInvalidFile()
+				C_ImageProcessing.GetImageInfo(filePath)
+			end
+			local expectedErrorMessage = "Failed to read image header from "
+				.. filePath
+				.. " (stbi_info_from_path returned false)"
+			assertThrows(attemptToReadInvalidFile, expectedErrorMessage)
+		end)
+	end)
+
+	describe("TransformImage", function()
+		local RED, GREEN, BLUE, BLACK = "\255\0\0\0", "\0\255\0\0", "\0\0\255\0", "\0\0\0\255"
+
+		it("should return the unmodified pixel data if no transformation steps were given", function()
+			local rgbaPixelArray, width, height, channels =
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, {})
+			assertEquals(rgbaPixelArray, EXAMPLE_IMAGE_DATA)
+			assertEquals(width, 2)
+			assertEquals(height, 2)
+			assertEquals(channels, 4)
+		end)
+
+		it("should be able to transform pixel data given as a string buffer", function()
+			local steps = { { type = "flip", axis = "horizontal" } }
+			local rgbaPixelArray = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_BUFFER, 2, 2, steps)
+			assertEquals(rgbaPixelArray, GREEN .. RED .. BLACK .. BLUE)
+		end)
+
+		it("should be able to flip the image vertically", function()
+			local steps = { { type = "flip", axis = "vertical" } }
+			local rgbaPixelArray = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(rgbaPixelArray, BLUE .. BLACK .. RED .. GREEN)
+		end)
+
+		it("should be able to rotate the image clockwise", function()
+			local steps = { { type = "rotate", degrees = 90 } }
+			local rgbaPixelArray = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(rgbaPixelArray, BLUE .. RED .. BLACK .. GREEN)
+		end)
+
+		it("should be able to crop the image", function()
+			local steps = { { type = "crop", x = 1, y = 1, width = 1, height = 1 } }
+			local rgbaPixelArray, width, height = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(rgbaPixelArray, BLACK)
+			assertEquals(width, 1)
+			assertEquals(height, 1)
+		end)
+
+		it("should be able to resize the image using a box filter", function()
+			local steps = { { type = "resize", width = 1, height = 1, filter = "box" } }
+			local rgbaPixelArray, width, height = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(rgbaPixelArray, "\64\64\64\64")
+			assertEquals(width, 1)
+			assertEquals(height, 1)
+		end)
+
+		it("should preserve solid colors when resizing the image with any of the supported filters", function()
+			local solidColorImage = string.rep("\12\34\56\78", 16 * 16)
+			for filter in pairs(C_ImageProcessing.RESIZE_FILTERS) do
+				local steps = { { type = "resize", width = 5, height = 40, filter = filter } }
+				local rgbaPixelArray = C_ImageProcessing.TransformImage(solidColorImage, 16, 16, steps)
+				assertEquals(rgbaPixelArray, string.rep("\12\34\56\78", 5 * 40))
+			end
+		end)
+
+		it("should be able to premultiply the alpha channel", function()
+			local steps = { { type = "premultiply" } }
+			local rgbaPixelArray = C_ImageProcessing.TransformImage("\200\100\50\128", 1, 1, steps)
+			assertEquals(rgbaPixelArray, "\100\50\25\128")
+		end)
+
+		it("should be able to convert the image to greyscale", function()
+			local steps = { { type = "convert", channels = 1 } }
+			local pixelArray, width, height, channels =
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(pixelArray, "\76\149\28\0")
+			assertEquals(width, 2)
+			assertEquals(height, 2)
+			assertEquals(channels, 1)
+		end)
+
+		it("should apply multiple transformation steps in order", function()
+			local steps = {
+				{ type = "rotate", degrees = 180 },
+				{ type = "crop", x = 0, y = 0, width = 2, height = 1 },
+				{ type = "convert", channels = 3 },
+			}
+			local pixelArray, width, height, channels =
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(pixelArray, "\0\0\0" .. "\0\0\255")
+			assertEquals(width, 2)
+			assertEquals(height, 1)
+			assertEquals(channels, 3)
+		end)
+
+		it("should throw if an unknown transformation step was given", function()
+			local function attemptToTransformImage()
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, { { type = "sharpen" } })
+			end
+			assertThrows(attemptToTransformImage, "Invalid transformation step 1 (unknown type: sharpen)")
+		end)
+
+		it("should throw if the transformation steps can't be applied to an image of the given size", function()
+			local function attemptToTransformImage()
+				local steps = { { type = "crop", x = 1, y = 1, width = 2, height = 2 } }
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			end
+			assertThrows(attemptToTransformImage, "Failed to transform image (invalid transformation steps?)")
+		end)
+
+		it("should throw if the pixel array doesn't match the given image dimensions", function()
+			local function attemptToTransformImage()
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 3, 2, {})
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to contain 24 bytes (3x2 RGBA pixels), but got 16"
+			assertThrows(attemptToTransformImage, expectedErrorMessage)
+		end)
+
+		it("should throw if a non-table type was passed as the transformation steps", function()
+			local function attemptToTransformImage()
+				C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, "resize")
+			end
+			local expectedErrorMessage =
+				"Expected argument transformationSteps to be a table value, but received a string value instead"
+			assertThrows(attemptToTransformImage, expectedErrorMessage)
+		end)
+	end)
+
+	describe("CompareImages", function()
+		it("should report no differences if the images are identical", function()
+			local comparison = C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, EXAMPLE_IMAGE_BUFFER, 2, 2)
+			assertEquals(comparison.numMismatchedPixels, 0)
+			assertEquals(comparison.meanAbsoluteDifference, { 0, 0, 0, 0 })
+			assertEquals(comparison.maxAbsoluteDifference, { 0, 0, 0, 0 })
+			assertEquals(comparison.meanSquaredError, 0)
+			assertEquals(comparison.peakSignalToNoiseRatio, math.huge)
+			assertEquals(comparison.structuralSimilarity, 1)
+		end)
+
+		it("should compute the per-channel differences and error metrics", function()
+			local blackPixels = string.rep("\0", 16)
+			local comparison = C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, blackPixels, 2, 2)
+			assertEquals(comparison.numMismatchedPixels, 4)
+			assertEquals(comparison.meanAbsoluteDifference, { 63.75, 63.75, 63.75, 63.75 })
+			assertEquals(comparison.maxAbsoluteDifference, { 255, 255, 255, 255 })
+			assertEquals(comparison.meanSquaredError, 16256.25)
+			assertEquals(string.format("%.4f", comparison.peakSignalToNoiseRatio), "6.0206")
+			assertTrue(comparison.structuralSimilarity < 1)
+		end)
+
+		it("should ignore differences that don't exceed the tolerance", function()
+			local slightlyDifferentPixels = "\252" .. EXAMPLE_IMAGE_DATA:sub(2)
+			local comparison = C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, slightlyDifferentPixels, 2, 2)
+			assertEquals(comparison.numMismatchedPixels, 1)
+			assertEquals(comparison.maxAbsoluteDifference, { 3, 0, 0, 0 })
+
+			comparison = C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, slightlyDifferentPixels, 2, 2, {
+				tolerance = 3,
+			})
+			assertEquals(comparison.numMismatchedPixels, 0)
+		end)
+
+		it("should be able to create an opaque image of the absolute differences", function()
+			local blackPixels = string.rep("\0", 16)
+			local options = { createDiffImage = true }
+			local _, diffImage = C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, blackPixels, 2, 2, options)
+			assertEquals(diffImage, "\255\0\0\255\0\255\0\255\0\0\255\255\0\0\0\255")
+		end)
+
+		it("should tolerate the compression artifacts of lossy formats if the tolerance is high enough", function()
+			local pngPixels = C_ImageProcessing.DecodeFileContents(EXAMPLE_PNG_BYTES)
+			local jpgPixels = C_ImageProcessing.DecodeFileContents(EXAMPLE_JPG_BYTES)
+			local comparison = C_ImageProcessing.CompareImages(pngPixels, jpgPixels, 2, 2, { tolerance = 255 })
+			assertEquals(comparison.numMismatchedPixels, 0)
+		end)
+
+		it("should throw if the tolerance is out of range", function()
+			local function attemptToCompareImages()
+				C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, EXAMPLE_IMAGE_DATA, 2, 2, { tolerance = 256 })
+			end
+			assertThrows(attemptToCompareImages, "Invalid tolerance 256 (must be between 0 and 255)")
+		end)
+
+		it("should throw if the pixel arrays don't match the given image dimensions", function()
+			local function attemptToCompareImages()
+				C_ImageProcessing.CompareImages(EXAMPLE_IMAGE_DATA, EXAMPLE_IMAGE_DATA .. "\0\0\0\0", 2, 2)
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to contain 16 bytes (2x2 RGBA pixels), but got 20"
+			assertThrows(attemptToCompareImages, expectedErrorMessage)
+		end)
+	end)
+
+	describe("CreateTextureAtlas", function()
+		it("should pack all images into a single atlas and return their regions", function()
+			local opaqueWhitePixels = string.rep("\255", 4 * 4 * 4)
+			local images = {
+				{ pixels = EXAMPLE_IMAGE_DATA, width = 2, height = 2 },
+				{ pixels = opaqueWhitePixels, width = 4, height = 4 },
+			}
+			local atlasPixels, atlasWidth, atlasHeight, regions =
+				C_ImageProcessing.CreateTextureAtlas(images, { padding = 0 })
+
+			assertEquals(atlasWidth, 4)
+			assertEquals(atlasHeight, 6)
+			local expectedAtlasPixels = opaqueWhitePixels
+				.. EXAMPLE_IMAGE_DATA:sub(1, 8)
+				.. string.rep("\0", 8)
+				.. EXAMPLE_IMAGE_DATA:sub(9, 16)
+				.. string.rep("\0", 8)
+			assertEquals(atlasPixels, expectedAtlasPixels)
+
+			assertEquals(#regions, 2)
+			assertEquals(regions[1].x, 0)
+			assertEquals(regions[1].y, 4)
+			assertEquals(regions[1].width, 2)
+			assertEquals(regions[1].height, 2)
+			assertEquals(regions[1].maxU, 0.5)
+			assertEquals(regions[1].maxV, 1)
+			assertEquals(regions[2], {
+				x = 0,
+				y = 0,
+				width = 4,
+				height = 4,
+				minU = 0,
+				minV = 0,
+				maxU = 1,
+				maxV = regions[2].maxV,
+			})
+		end)
+
+		it("should accept string buffers as pixel arrays", function()
+			local images = { { pixels = EXAMPLE_IMAGE_BUFFER, width = 2, height = 2 } }
+			local atlasPixels, atlasWidth, atlasHeight = C_ImageProcessing.CreateTextureAtlas(images)
+			assertEquals(atlasWidth, 2)
+			assertEquals(atlasHeight, 2)
+			assertEquals(atlasPixels, EXAMPLE_IMAGE_DATA)
+		end)
+
+		it("should throw if the list of images is empty", function()
+			local function attemptToCreateTextureAtlas()
+				C_ImageProcessing.CreateTextureAtlas({})
+			end
+			assertThrows(attemptToCreateTextureAtlas, "Cannot create texture atlas (the list of images is empty)")
+		end)
+
+		it("should throw if the images don't fit into an atlas of the maximum size", function()
+			local images = {
+				{ pixels = EXAMPLE_IMAGE_DATA, width = 2, height = 2 },
+				{ pixels = EXAMPLE_IMAGE_DATA, width = 2, height = 2 },
+			}
+			local function attemptToCreateTextureAtlas()
+				C_ImageProcessing.CreateTextureAtlas(images, { maxWidth = 2, maxHeight = 2 })
+			end
+			local expectedErrorMessage = "Failed to pack 2 images into a texture atlas of up to 2x2 pixels"
+			assertThrows(attemptToCreateTextureAtlas, expectedErrorMessage)
+		end)
+	end)
+
 	describe("EncodeBMP", function()
 		it("should be able to encode pixel data given as a string", function()
 			local bmpFileContents = C_ImageProcessing.EncodeBMP(EXAMPLE_IMAGE_DATA, 2, 2)
@@ -244,11 +624,111 @@ describe("C_ImageProcessing", function()
 			assertEquals(pngFileContents, EXAMPLE_PNG_BYTES)
 		end)
 
+		it("should be able to encode pixel data given as a native array", function()
+			local rgbaPixels = ffi.new("uint8_t[?]", #EXAMPLE_IMAGE_DATA)
+			ffi.copy(rgbaPixels, EXAMPLE_IMAGE_DATA, #EXAMPLE_IMAGE_DATA)
+			local pngFileContents = C_ImageProcessing.EncodePNG(rgbaPixels, 2, 2)
+			assertEquals(pngFileContents, EXAMPLE_PNG_BYTES)
+		end)
+
+		it("should throw if the native array is too small for the given image dimensions", function()
+			local rgbaPixels = ffi.new("uint8_t[?]", #EXAMPLE_IMAGE_DATA)
+			local function attemptToEncodeInvalidFile()
+				C_ImageProcessing.EncodePNG(rgbaPixels, 2, 3)
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to contain at least 24 bytes (2x3 RGBA pixels), but got 16"
+			assertThrows(attemptToEncodeInvalidFile, expectedErrorMessage)
+		end)
+
+		it("should be able to encode pixel data given as a fixed-size native array", function()
+			local rgbaPixels = ffi.new("uint8_t[16]")
+			ffi.copy(rgbaPixels, EXAMPLE_IMAGE_DATA, #EXAMPLE_IMAGE_DATA)
+			local pngFileContents = C_ImageProcessing.EncodePNG(rgbaPixels, 2, 2)
+			assertEquals(pngFileContents, EXAMPLE_PNG_BYTES)
+		end)
+
+		it("should throw if the pixel data is given as a raw pointer", function()
+			local rgbaPixels = ffi.new("uint8_t[?]", #EXAMPLE_IMAGE_DATA)
+			local function attemptToEncodeInvalidFile()
+				C_ImageProcessing.EncodePNG(ffi.cast("uint8_t*", rgbaPixels), 2, 2)
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to be a byte array or pooled image (other cdata has no known size)"
+			assertThrows(attemptToEncodeInvalidFile, expectedErrorMessage)
+		end)
+
+		it("should throw if the pixel data is given as an array of anything other than bytes", function()
+			local rgbaPixels = ffi.new("uint32_t[?]", #EXAMPLE_IMAGE_DATA / 4)
+			local function attemptToEncodeInvalidFile()
+				C_ImageProcessing.EncodePNG(rgbaPixels, 2, 2)
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to be a byte array or pooled image (other cdata has no known size)"
+			assertThrows(attemptToEncodeInvalidFile, expectedErrorMessage)
+		end)
+
+		it("should be able to encode images that exceed the initial buffer size estimate", function()
+			-- Random noise doesn't compress well, so the encoded size will be much larger than the estimate
+			local numPixels = 64 * 64
+			local randomPixels = buffer.new(numPixels * 4)
+			for index = 1, numPixels * 4 do
+				randomPixels:put(string.char(math.random(0, 255)))
+			end
+
+			local pngFileContents = C_ImageProcessing.EncodePNG(randomPixels, 64, 64)
+			local decodedPixels, width, height = C_ImageProcessing.DecodeFileContents(pngFileContents)
+			assertEquals(decodedPixels, randomPixels:tostring())
+			assertEquals(width, 64)
+			assertEquals(height, 64)
+		end)
+
+		it("should throw if the pixel array doesn't match the given image dimensions", function()
+			local function attemptToEncodeInvalidFile()
+				C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_DATA, 2, 3)
+			end
+			local expectedErrorMessage =
+				"Expected argument rgbaPixelArray to contain 24 bytes (2x3 RGBA pixels), but got 16"
+			assertThrows(attemptToEncodeInvalidFile, expectedErrorMessage)
+		end)
+
 		it("should be able to encode pixel data given as a string buffer", function()
 			local pngFileContents = C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_BUFFER, 2, 2)
 			assertEquals(pngFileContents, EXAMPLE_PNG_BYTES)
 		end)
 
+		it("should be able to encode pixel data using one of the compression presets", function()
+			for presetName in pairs(C_ImageProcessing.PNG_COMPRESSION_PRESETS) do
+				local pngFileContents = C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_DATA, 2, 2, presetName)
+				local decodedPixels, width, height = C_ImageProcessing.DecodeFileContents(pngFileContents)
+				assertEquals(decodedPixels, EXAMPLE_IMAGE_DATA)
+				assertEquals(width, 2)
+				assertEquals(height, 2)
+			end
+		end)
+
+		it("should be able to encode pixel data using custom compression options", function()
+			for filter in pairs(C_ImageProcessing.PNG_FILTERS) do
+				local options = { compressionLevel = 3, filter = filter }
+				local pngFileContents = C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_DATA, 2, 2, options)
+				assertEquals(C_ImageProcessing.DecodeFileContents(pngFileContents), EXAMPLE_IMAGE_DATA)
+			end
+		end)
+
+		it("should throw if an unknown compression preset was passed", function()
+			local function attemptToEncodeWithInvalidPreset()
+				C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_DATA, 2, 2, "tiny")
+			end
+			assertThrows(attemptToEncodeWithInvalidPreset, "Invalid PNG compression options (unknown preset: tiny)")
+		end)
+
+		it("should throw if the compression level is out of range", function()
+			local function attemptToEncodeWithInvalidLevel()
+				C_ImageProcessing.EncodePNG(EXAMPLE_IMAGE_DATA, 2, 2, { compressionLevel = 10 })
+			end
+			assertThrows(attemptToEncodeWithInvalidLevel, "Invalid PNG compression options (level 10 is out of range)")
+		end)
+
 		it("should throw if a non-string type was passed as the pixel buffer", function()
 			local function attemptToEncodeInvalidFile()
 				C_ImageProcessing.EncodePNG(123, 2, 2)
@@ -354,4 +834,78 @@ describe("C_ImageProcessing", function()
 			assertThrows(attemptToEncodeInvalidFile, expectedErrorMessage)
 		end)
 	end)
+
+	describe("TranscodeImages", function()
+		local function transcodeAndWait(imageFileContentsList, options)
+			local results = {}
+			local isBatchCompleted = false
+			local function onImageTranscoded(index, fileContents, width, height)
+				results[index] = { fileContents = fileContents or false, width = width, height = height }
+			end
+			local function onBatchCompleted()
+				isBatchCompleted = true
+			end
+			C_ImageProcessing.TranscodeImages(imageFileContentsList, options, onImageTranscoded, onBatchCompleted)
+
+			repeat
+				uv.run("once")
+			until isBatchCompleted
+
+			return results
+		end
+
+		it("should be able to transcode all images in the batch", function()
+			local inputs = { EXAMPLE_PNG_BYTES, EXAMPLE_TGA_BUFFER, EXAMPLE_BMP_BYTES }
+			local results = transcodeAndWait(inputs, { format = "bmp" })
+
+			assertEquals(#results, 3)
+			for index = 1, #results do
+				assertEquals(results[index].fileContents, EXAMPLE_BMP_BYTES)
+				assertEquals(results[index].width, 2)
+				assertEquals(results[index].height, 2)
+			end
+			assertEquals(tonumber(stbi.bindings.stbi_get_transcoding_memory_usage()), 0)
+		end)
+
+		it("should apply the transformation steps before encoding the images", function()
+			local steps = { { type = "flip", axis = "vertical" }, { type = "rotate", degrees = 90 } }
+			local results = transcodeAndWait({ EXAMPLE_PNG_BYTES }, { format = "png", steps = steps })
+
+			local expectedPixels = C_ImageProcessing.TransformImage(EXAMPLE_IMAGE_DATA, 2, 2, steps)
+			assertEquals(results[1].fileContents, C_ImageProcessing.EncodePNG(expectedPixels, 2, 2))
+		end)
+
+		it("should process images one at a time if they exceed the memory budget", function()
+			local inputs = { EXAMPLE_PNG_BYTES, EXAMPLE_PNG_BYTES, EXAMPLE_PNG_BYTES, EXAMPLE_PNG_BYTES }
+			local results = transcodeAndWait(inputs, { format = "tga", maxBytesInFlight = 1 })
+
+			assertEquals(#results, 4)
+			for index = 1, #results do
+				assertEquals(results[index].fileContents, EXAMPLE_TGA_BYTES)
+			end
+			assertEquals(tonumber(stbi.bindings.stbi_get_transcoding_memory_usage()), 0)
+		end)
+
+		it("should report images that couldn't be decoded without failing the entire batch", function()
+			local results = transcodeAndWait({ "not an image", EXAMPLE_PNG_BYTES }, { format = "bmp" })
+
+			assertEquals(results[1].fileContents, false)
+			assertEquals(results[1].width, nil)
+			assertEquals(results[2].fileContents, EXAMPLE_BMP_BYTES)
+		end)
+
+		it("should throw if an unknown output format was passed", function()
+			local function attemptToTranscodeImages()
+				C_ImageProcessing.TranscodeImages({ EXAMPLE_PNG_BYTES }, { format = "webp" }, function() end)
+			end
+			assertThrows(attemptToTranscodeImages, "Cannot transcode images (unknown output format: webp)")
+		end)
+
+		it("should throw if the list of file contents is empty", function()
+			local function attemptToTranscodeImages()
+				C_ImageProcessing.TranscodeImages({}, nil, function() end)
+			end
+			assertThrows(attemptToTranscodeImages, "Cannot transcode images (the list of file contents is empty)")
+		end)
+	end)
 end)
@@ -18,4 +18,115 @@ describe("profiler", function()
 		profiler.zone("BYE")
 		assertEquals(profiler.zone(), "BYE")
 	end)
+
+	describe("startSampling", function()
+		after(function()
+			profiler.stopSampling()
+			profiler.getFoldedStacks(true)
+		end)
+
+		it("should throw if the profiler is already running", function()
+			profiler.startSampling()
+			assertThrows(profiler.startSampling, "Cannot start sampling (the profiler is already running)")
+		end)
+
+		it("should throw if LuaJIT's high-level profiler is already running", function()
+			local outputFilePath = os.tmpname()
+			profiler.start("f", outputFilePath)
+			local success, errorMessage = pcall(profiler.startSampling)
+			profiler.stop()
+			os.remove(outputFilePath)
+
+			assertFalse(success)
+			assertEquals(errorMessage, "Cannot start sampling (the profiler is already running)")
+		end)
+
+		it("should prevent LuaJIT's high-level profiler from starting while sampling", function()
+			local outputFilePath = os.tmpname()
+			profiler.startSampling()
+			assertThrows(function()
+				profiler.start("f", outputFilePath)
+			end, "Cannot start jit.p (the sampling profiler is already running)")
+			os.remove(outputFilePath)
+		end)
+
+		it("should aggregate the sampled stacks in the folded stack format", function()
+			profiler.startSampling({ intervalInMilliseconds = 1 })
+			local startTime = os.clock()
+			local sum = 0
+			while os.clock() - startTime < 0.1 do
+				sum = sum + math.sqrt(startTime)
+			end
+			profiler.stopSampling()
+
+			assertTrue(sum > 0)
+			assertTrue(profiler.getNumCollectedSamples() > 0)
+			local foldedStacks = profiler.getFoldedStacks()
+			for line in foldedStacks:gmatch("[^\n]+") do
+				local stack, count = line:match("^(.+) (%d+)$")
+				assertEquals(type(stack), "string")
+				assertTrue(tonumber(count) > 0)
+			end
+		end)
+
+		it("should reset the collected samples if requested", function()
+			profiler.startSampling({ intervalInMilliseconds = 1 })
+			local startTime = os.clock()
+			repeat
+			until os.clock() - startTime > 0.01
+			profiler.stopSampling()
+
+			profiler.getFoldedStacks(true)
+			assertEquals(profiler.getFoldedStacks(), "")
+			assertEquals(profiler.getNumCollectedSamples(), 0)
+		end)
+	end)
+
+	describe("getTraceReport", function()
+		it("should return the aggregated trace aborts and side exits", function()
+			profiler.getTraceReport(true)
+			profiler.startTraceTracking()
+			for _ = 1, 1000 do
+				string.dump(function() end) -- Not compiled (NYI), so this should abort any traces that include it
+			end
+			-- The branch that isn't taken while recording becomes a side exit (until it's hot enough for a side trace)
+			local sum = 0
+			for index = 1, 1000 do
+				if index % 4 == 0 then
+					sum = sum + 1
+				end
+			end
+			profiler.stopTraceTracking()
+
+			local report = profiler.getTraceReport(true)
+			assertEquals(sum, 250)
+
+			-- Anything else that happens to run in between might also show up, but the loops above should always be listed
+			local function isInSpecFile(entry)
+				return entry.location:match("profiler%-library%.spec%.lua:%d+$") ~= nil
+			end
+			local numAbortsInSpecFile, numExitsInSpecFile = 0, 0
+			for _, abort in ipairs(report.aborts) do
+				assertTrue(#abort.reason > 0)
+				assertTrue(abort.count > 0)
+				if isInSpecFile(abort) then
+					numAbortsInSpecFile = numAbortsInSpecFile + 1
+				end
+			end
+			for _, exit in ipairs(report.exits) do
+				assertEquals(type(exit.traceID), "number")
+				assertEquals(type(exit.exitID), "number")
+				assertTrue(exit.count > 0)
+				if isInSpecFile(exit) then
+					numExitsInSpecFile = numExitsInSpecFile + 1
+				end
+			end
+			assertTrue(numAbortsInSpecFile > 0)
+			assertTrue(numExitsInSpecFile > 0)
+
+			local emptyReport = profiler.getTraceReport()
+			assertEquals(#emptyReport.aborts, 0)
+			assertEquals(#emptyReport.exits, 0)
+		end)
+	end)
 end)
@@ -1,6 +1,12 @@
+local crypto = require("crypto")
+local ffi = require("ffi")
+local json = require("json")
 local runtime = require("runtime")
+local stbi = require("stbi")
 local uv = require("uv")
 
+local EXAMPLE_PNG_BYTES = C_FileSystem.ReadFile(path.join("Tests", "Fixtures", "rgba-pixels.png"))
+
 describe("runtime", function()
 	describe("version", function()
 		it("should export the EVO_VERSION define from the native entry point", function()
@@ -34,6 +40,244 @@ describe("runtime", function()
 		end)
 	end)
 
+	describe("getAllocatorStats", function()
+		local ALLOCATOR_STATS_SCRIPT = path.join("Tests", "Fixtures", "allocator-stats.lua")
+
+		-- Allocators can't be swapped once the VM exists, so each one needs a fresh runtime process
+		local function getAllocatorStatsWith(allocatorName)
+			local environment = {}
+			for key, value in pairs(uv.os_environ()) do
+				if key ~= "EVO_LUA_ALLOCATOR" then
+					table.insert(environment, key .. "=" .. value)
+				end
+			end
+			table.insert(environment, "EVO_LUA_ALLOCATOR=" .. allocatorName)
+
+			local stdoutPipe = uv.new_pipe()
+			local chunks = {}
+			local exitCode
+			local process = uv.spawn(uv.exepath(), {
+				args = { ALLOCATOR_STATS_SCRIPT },
+				env = environment,
+				stdio = { 0, stdoutPipe, 2 },
+			}, function(code)
+				exitCode = code
+			end)
+			assert(process, "Failed to spawn " .. uv.exepath())
+
+			stdoutPipe:read_start(function(readError, chunk)
+				assert(not readError, readError)
+				if chunk then
+					table.insert(chunks, chunk)
+				else
+					stdoutPipe:close()
+				end
+			end)
+
+			repeat
+				uv.run("once")
+			until exitCode ~= nil and stdoutPipe:is_closing()
+			process:close()
+
+			assertEquals(exitCode, 0)
+			return json.parse(table.concat(chunks))
+		end
+
+		local function assertStatsLayout(stats, expectedName)
+			assertEquals(stats.name, expectedName)
+			assertEquals(type(stats.numAllocations), "number")
+			assertEquals(type(stats.numReallocations), "number")
+			assertEquals(type(stats.numDeallocations), "number")
+			assertEquals(type(stats.numFailedAllocations), "number")
+			assertEquals(type(stats.bytesInUse), "number")
+			assertEquals(type(stats.peakBytesInUse), "number")
+			assertEquals(type(stats.bytesReserved), "number")
+			assertEquals(stats.numSizeClasses, 17)
+			assertEquals(stats.smallestSizeClassLimit, 16)
+			assertEquals(stats.hasUnboundedSizeClass, true)
+		end
+
+		it("should return nil if the default allocator is in use", function()
+			local result = getAllocatorStatsWith("default")
+			assertEquals(result.numObjects, 50000)
+			assertEquals(result.before, nil)
+			assertEquals(result.after, nil)
+		end)
+
+		it("should report the number of reserved bytes if the pooled allocator is in use", function()
+			local result = getAllocatorStatsWith("pooled")
+			assertStatsLayout(result.before, "pooled")
+			assertStatsLayout(result.after, "pooled")
+
+			-- Only the instrumented allocator keeps track of individual allocations
+			assertTrue(result.before.bytesReserved > 0)
+			assertTrue(result.after.bytesReserved > result.before.bytesReserved)
+			assertEquals(result.after.numAllocations, 0)
+		end)
+
+		it("should count allocations if the instrumented allocator is in use", function()
+			local result = getAllocatorStatsWith("instrumented")
+			assertStatsLayout(result.before, "instrumented-system")
+			assertStatsLayout(result.after, "instrumented-system")
+
+			local before, after = result.before, result.after
+			assertTrue(after.numAllocations >= before.numAllocations + 50000)
+			assertTrue(after.numSmallAllocations >= before.numSmallAllocations + 50000)
+			assertTrue(after.bytesInUse > before.bytesInUse)
+			assertTrue(after.peakBytesInUse >= after.bytesInUse)
+			assertEquals(after.numFailedAllocations, 0)
+			assertEquals(after.bytesReserved, 0)
+		end)
+
+		it("should count allocations and reserved bytes if the instrumented pooled allocator is in use", function()
+			local result = getAllocatorStatsWith("instrumented-pooled")
+			assertStatsLayout(result.before, "instrumented-pooled")
+			assertStatsLayout(result.after, "instrumented-pooled")
+
+			local before, after = result.before, result.after
+			assertTrue(after.numAllocations >= before.numAllocations + 50000)
+			assertTrue(after.numSmallAllocations >= before.numSmallAllocations + 50000)
+			assertTrue(after.bytesInUse > before.bytesInUse)
+			assertTrue(after.bytesReserved > before.bytesReserved)
+			assertEquals(after.numFailedAllocations, 0)
+		end)
+	end)
+
+	describe("offload", function()
+		it("should throw if the given export isn't whitelisted", function()
+			local function offloadUnsafeExport()
+				runtime.offload("stbi_flip_vertically_on_write", print, 1)
+			end
+			local expectedErrorMessage =
+				"Cannot offload stbi_flip_vertically_on_write (only whitelisted exports can be run in the thread pool)"
+			assertThrows(offloadUnsafeExport, expectedErrorMessage)
+		end)
+
+		it("should be able to encode PNG images in the thread pool", function()
+			local image = ffi.new("stbi_image_t")
+			assertTrue(stbi.bindings.stbi_load_rgba(EXAMPLE_PNG_BYTES, #EXAMPLE_PNG_BYTES, image))
+			local decodedPixels = ffi.string(image.data, image.width * image.height * image.channels)
+
+			local maxFileSize = tonumber(stbi.bindings.stbi_get_required_png_size(image, 0))
+			local result = buffer.new()
+			local startPointer, length = result:reserve(maxFileSize)
+			local numBytesWritten
+			runtime.offload("stbi_encode_png", function(...)
+				numBytesWritten = ...
+			end, image, startPointer, length, 0)
+
+			repeat
+				uv.run("once")
+			until numBytesWritten ~= nil
+			stbi.bindings.stbi_image_free(image)
+
+			assertTrue(numBytesWritten > 0)
+			result:commit(numBytesWritten)
+			local encodedFileContents = tostring(result)
+			assertTrue(stbi.bindings.stbi_load_rgba(encodedFileContents, #encodedFileContents, image))
+			assertEquals(ffi.string(image.data, image.width * image.height * image.channels), decodedPixels)
+			stbi.bindings.stbi_image_free(image)
+		end)
+
+		it("should be able to derive keys in the thread pool", function()
+			local password, salt = "password", "saltsalt"
+			local inputs = ffi.new("kdf_input_t", { password, #password, salt, #salt })
+			local scryptParameters = {
+				kdf = crypto.KDF_SCRYPT,
+				version = 0,
+				kilobytes = 16,
+				threads = 1,
+				lanes = 1,
+				size = 32,
+				iterations = 0,
+			}
+			local parameters = ffi.new("kdf_parameters_t", scryptParameters)
+
+			local hash = buffer.new()
+			local message = buffer.new()
+			local result = ffi.new("kdf_result_t")
+			result.hash = hash:reserve(parameters.size)
+			result.message = message:reserve(256)
+			local success
+			runtime.offload("openssl_kdf_derive", function(...)
+				success = ...
+			end, inputs, parameters, result)
+
+			repeat
+				uv.run("once")
+			until success ~= nil
+
+			assertTrue(success)
+			hash:commit(parameters.size)
+			assertEquals(tostring(hash), crypto.hash(password, salt, scryptParameters))
+		end)
+
+		it("should throw if no completion handler was passed on the main thread", function()
+			local function offloadWithoutHandler()
+				runtime.offload("stbi_load_rgba", nil, EXAMPLE_PNG_BYTES, ffi.new("stbi_image_t"))
+			end
+			local expectedErrorMessage =
+				"Cannot yield from the main thread (pass a completion handler or wrap async task in a coroutine)"
+			assertThrows(offloadWithoutHandler, expectedErrorMessage)
+		end)
+
+		it("should pass the result to the completion handler once the work is done", function()
+			local image = ffi.new("stbi_image_t")
+			local result, errorMessage
+			runtime.offload("stbi_load_rgba", function(...)
+				result, errorMessage = ...
+			end, EXAMPLE_PNG_BYTES, image)
+
+			repeat
+				uv.run("once")
+			until result ~= nil or errorMessage ~= nil
+
+			assertEquals(result, true)
+			assertEquals(errorMessage, nil)
+			assertEquals(image.width, 2)
+			assertEquals(image.height, 2)
+			stbi.bindings.stbi_image_free(image)
+		end)
+
+		it("should resume the calling coroutine if no completion handler was passed", function()
+			local image = ffi.new("stbi_image_t")
+			local isDone = false
+			coroutine.wrap(function()
+				local result = runtime.offload("stbi_load_rgba", nil, EXAMPLE_PNG_BYTES, image)
+				assertEquals(result, true)
+				isDone = true
+			end)()
+
+			repeat
+				uv.run("once")
+			until isDone
+
+			assertEquals(image.width, 2)
+			assertEquals(image.height, 2)
+			stbi.bindings.stbi_image_free(image)
+		end)
+	end)
+
+	describe("getThreadPoolSize", function()
+		it("should return the number of threads that libuv will use for offloaded work", function()
+			-- The runtime picks a default if none was set, so the variable should always exist at this point
+			local numThreads = tonumber(uv.os_getenv("UV_THREADPOOL_SIZE"))
+			local expectedSize = math.min(math.max(numThreads, 1), 1024)
+			assertEquals(runtime.getThreadPoolSize(), expectedSize)
+		end)
+
+		it("should not be affected by changes to the environment after startup", function()
+			local sizeBefore = runtime.getThreadPoolSize()
+			local previousValue = uv.os_getenv("UV_THREADPOOL_SIZE")
+
+			uv.os_setenv("UV_THREADPOOL_SIZE", tostring(sizeBefore + 1))
+			local sizeAfter = runtime.getThreadPoolSize()
+			uv.os_setenv("UV_THREADPOOL_SIZE", previousValue)
+
+			assertEquals(sizeAfter, sizeBefore)
+		end)
+	end)
+
 	describe("embeddedLibraryVersions", function()
 		it("should export the auto-generated versioning information for all embedded submodules", function()
 			local FULL_GIT_COMMIT_HASH_LENGTH = 40
@@ -1,15 +1,21 @@
 local console = require("console")
 local runtime = require("runtime")
+local uv = require("uv")
 
 describe("C_Runtime", function()
 	-- Ideally there should be some high-level snapshot tests, but more plumbing is needed
 	-- Not great, but for the time being this will have to do - will revisit later, when it makes sense
 	local commandLineAPI = {
+		"CreateGuest",
 		"EvaluateString",
+		"GetEventLoopMetrics",
+		"GetGuestStats",
 		"PrintVersionString",
 		"RunBasicTests",
 		"RunDetailedTests",
 		"RunMinimalTests",
+		"StartEventLoopSampling",
+		"StopEventLoopSampling",
 	}
 	for _, exportedFunctionName in ipairs(commandLineAPI) do
 		it("should export " .. exportedFunctionName, function()
@@ -135,4 +141,216 @@ describe("C_Runtime", function()
 			assertTrue(hasExecutedHelloWorldTest)
 		end)
 	end)
+
+	describe("CreateGuest", function()
+		it("should throw if a non-string name was passed", function()
+			local function createWithoutName()
+				C_Runtime.CreateGuest(nil, "guest-script.lua")
+			end
+			assertThrows(
+				createWithoutName,
+				"Expected argument name to be a string value, but received a nil value instead"
+			)
+		end)
+
+		it("should throw if a non-string script path was passed", function()
+			local function createWithoutScript()
+				C_Runtime.CreateGuest("guest", nil)
+			end
+			assertThrows(
+				createWithoutScript,
+				"Expected argument scriptPath to be a string value, but received a nil value instead"
+			)
+		end)
+
+		it("should run the script in an isolated VM that shares the event loop", function()
+			local scriptPath = path.join("Tests", "Fixtures", "guest-script.lua")
+			local limits = { maxMemoryInBytes = 64 * 1024 * 1024, maxCpuTimePerWindowInMilliseconds = 50 }
+
+			assertTrue(C_Runtime.CreateGuest("isolated-guest", scriptPath, limits))
+			assertEquals(_G.GUEST_SCRIPT_GLOBAL, nil)
+
+			local stats = C_Runtime.GetGuestStats("isolated-guest")
+			assertEquals(type(stats), "table")
+			assertEquals(stats.numFailedCallbacks, 0)
+			assertTrue(stats.bytesInUse > 0)
+			assertTrue(stats.peakBytesInUse >= stats.bytesInUse)
+			assertEquals(stats.isThrottled, false)
+		end)
+
+		it("should fail if a guest with the same name already exists", function()
+			local scriptPath = path.join("Tests", "Fixtures", "guest-script.lua")
+			C_Runtime.CreateGuest("duplicate-guest", scriptPath)
+			assertFalse(C_Runtime.CreateGuest("duplicate-guest", scriptPath))
+		end)
+
+		it("should remove the guest if its script fails to run", function()
+			local failingScriptPath = path.join("Tests", "Fixtures", "guest-failing-script.lua")
+			assertFalse(C_Runtime.CreateGuest("failing-guest", failingScriptPath))
+			assertEquals(C_Runtime.GetGuestStats("failing-guest"), nil)
+
+			-- The timer created by the failed script would have fired a few times by now, had it not been closed
+			local hasTimerFired = false
+			local timer = uv.new_timer()
+			timer:start(50, 0, function()
+				timer:close()
+				hasTimerFired = true
+			end)
+			repeat
+				uv.run("once")
+			until hasTimerFired
+
+			local scriptPath = path.join("Tests", "Fixtures", "guest-script.lua")
+			assertTrue(C_Runtime.CreateGuest("failing-guest", scriptPath))
+			assertEquals(C_Runtime.GetGuestStats("failing-guest").numFailedCallbacks, 0)
+		end)
+
+		-- Guest callbacks only run on the host's event loop, so it must be kept running until the guest is done
+		local function runUntilGuestIsDone(name, isDone)
+			local stats = C_Runtime.GetGuestStats(name)
+			while not isDone(stats) do
+				local isLoopAlive = uv.run("once")
+				stats = C_Runtime.GetGuestStats(name)
+				if not isLoopAlive then
+					break
+				end
+			end
+			return stats
+		end
+
+		it("should abort callbacks that exceed the instruction budget", function()
+			local scriptPath = path.join("Tests", "Fixtures", "guest-infinite-loop.lua")
+			assertTrue(C_Runtime.CreateGuest("runaway-guest", scriptPath, { maxInstructionsPerCallback = 1E6 }))
+
+			local stats = runUntilGuestIsDone("runaway-guest", function(currentStats)
+				return currentStats.numCallbacks > 0
+			end)
+			assertEquals(stats.numCallbacks, 1)
+			assertEquals(stats.numFailedCallbacks, 1)
+		end)
+
+		it("should fail allocations that would exceed the memory limit", function()
+			local scriptPath = path.join("Tests", "Fixtures", "guest-memory-hog.lua")
+			local memoryLimit = 32 * 1024 * 1024
+			assertTrue(C_Runtime.CreateGuest("memory-hog-guest", scriptPath, { maxMemoryInBytes = memoryLimit }))
+
+			local stats = runUntilGuestIsDone("memory-hog-guest", function(currentStats)
+				return currentStats.numCallbacks > 0
+			end)
+			assertEquals(stats.numFailedCallbacks, 1)
+			assertTrue(stats.numFailedAllocations > 0)
+			assertTrue(stats.peakBytesInUse <= memoryLimit)
+		end)
+
+		it("should defer callbacks while the guest is over its CPU time budget", function()
+			local scriptPath = path.join("Tests", "Fixtures", "guest-busy-timer.lua")
+			assertTrue(C_Runtime.CreateGuest("throttled-guest", scriptPath, { maxCpuTimePerWindowInMilliseconds = 1 }))
+
+			local stats = runUntilGuestIsDone("throttled-guest", function(currentStats)
+				local hasCaughtUp = currentStats.numPendingCallbacks == 0 and not currentStats.isThrottled
+				return currentStats.numTimesThrottled > 0 and hasCaughtUp
+			end)
+			assertTrue(stats.numTimesThrottled > 0)
+			assertTrue(stats.numDeferredCallbacks > 0)
+			assertEquals(stats.numPendingCallbacks, 0)
+			assertEquals(stats.numFailedCallbacks, 0)
+			-- Deferred callbacks run once the next accounting window has started, so none of them should be lost
+			assertTrue(stats.numCallbacks > 2)
+		end)
+	end)
+
+	describe("GetGuestStats", function()
+		it("should return nil if no guest with the given name exists", function()
+			assertEquals(C_Runtime.GetGuestStats("this-guest-does-not-exist"), nil)
+		end)
+	end)
+
+	describe("GetEventLoopMetrics", function()
+		it("should return the instrumentation data collected for the shared event loop", function()
+			local metrics = C_Runtime.GetEventLoopMetrics()
+			assertEquals(type(metrics.numIterations), "number")
+			assertEquals(type(metrics.numCallbacks), "number")
+			assertEquals(type(metrics.slowestCallback), "string")
+			assertTrue(metrics.runTimeInMilliseconds >= metrics.idleTimeInMilliseconds)
+			assertTrue(metrics.utilization >= 0 and metrics.utilization <= 1)
+			assertTrue(metrics.maxCallbackTimeInMilliseconds <= metrics.callbackTimeInMilliseconds)
+		end)
+
+		it("should use exponentially-sized buckets for the lag histogram", function()
+			local metrics = C_Runtime.GetEventLoopMetrics()
+			assertEquals(#metrics.lagHistogram, 12)
+			assertEquals(metrics.lagHistogram[1].maxLagInMilliseconds, 1)
+			assertEquals(metrics.lagHistogram[2].maxLagInMilliseconds, 2)
+			assertEquals(metrics.lagHistogram[11].maxLagInMilliseconds, 1024)
+			assertEquals(metrics.lagHistogram[12].maxLagInMilliseconds, math.huge)
+		end)
+	end)
+
+	describe("StartEventLoopSampling", function()
+		it("should throw if a non-number interval was passed", function()
+			local function startWithoutInterval()
+				C_Runtime.StartEventLoopSampling(nil, print)
+			end
+			assertThrows(
+				startWithoutInterval,
+				"Expected argument intervalInMilliseconds to be a number value, but received a nil value instead"
+			)
+		end)
+
+		it("should throw if a non-function callback was passed", function()
+			local function startWithoutCallback()
+				C_Runtime.StartEventLoopSampling(100, nil)
+			end
+			assertThrows(
+				startWithoutCallback,
+				"Expected argument onSampleCollected to be a function value, but received a nil value instead"
+			)
+		end)
+
+		it("should pass the metrics collected during each interval to the callback", function()
+			local BUSY_TIME_IN_MILLISECONDS = 10
+
+			-- Blocking the loop for a while should show up in the sample (as lag, and as the slowest callback)
+			local busyTimer = uv.new_timer()
+			busyTimer:start(0, 0, function()
+				local startTime = uv.hrtime()
+				repeat
+				until uv.hrtime() - startTime > BUSY_TIME_IN_MILLISECONDS * 1E6
+			end)
+
+			local sample
+			C_Runtime.StartEventLoopSampling(25, function(collectedSample)
+				sample = sample or collectedSample
+			end)
+
+			-- The sampling timer itself doesn't keep the loop alive
+			local keepAliveTimer = uv.new_timer()
+			keepAliveTimer:start(5, 5, function() end)
+			repeat
+				uv.run("once")
+			until sample ~= nil
+
+			C_Runtime.StopEventLoopSampling()
+			keepAliveTimer:close()
+			busyTimer:close()
+
+			assertTrue(sample.numIterations >= 1)
+			assertTrue(sample.numCallbacks >= 1)
+			assertTrue(sample.runTimeInMilliseconds >= BUSY_TIME_IN_MILLISECONDS)
+			assertTrue(sample.idleTimeInMilliseconds >= 0)
+			assertTrue(sample.idleTimeInMilliseconds <= sample.runTimeInMilliseconds)
+			assertTrue(sample.utilization > 0 and sample.utilization <= 1)
+			assertTrue(sample.callbackTimeInMilliseconds >= BUSY_TIME_IN_MILLISECONDS)
+			assertTrue(sample.maxCallbackTimeInMilliseconds >= BUSY_TIME_IN_MILLISECONDS)
+			assertTrue(sample.maxCallbackTimeInMilliseconds <= sample.callbackTimeInMilliseconds)
+			assertTrue(sample.maxLagInMilliseconds >= BUSY_TIME_IN_MILLISECONDS)
+			assertTrue(sample.slowestCallback:match("runtime%-namespace%.spec%.lua:%d+$") ~= nil)
+
+			local numIterationsInHistogram = 0
+			for _, bucket in ipairs(sample.lagHistogram) do
+				numIterationsInHistogram = numIterationsInHistogram + bucket.numIterations
+			end
+			assertEquals(numIterationsInHistogram, sample.numIterations)
+		end)
+	end)
 end)
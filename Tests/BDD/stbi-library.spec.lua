@@ -1,5 +1,6 @@
 local ffi = require("ffi")
 local stbi = require("stbi")
+local uv = require("uv")
 
 local FIXTURES_DIR = path.join("Tests", "Fixtures")
 
@@ -32,6 +33,35 @@ describe("stbi", function()
 				"stbi_get_required_png_size",
 				"stbi_get_required_jpg_size",
 				"stbi_get_required_tga_size",
+				"stbi_get_simd_level",
+				"stbi_set_simd_level",
+				"stbi_resize_image",
+				"stbi_crop_image",
+				"stbi_rotate_image",
+				"stbi_flip_image",
+				"stbi_premultiply_alpha",
+				"stbi_convert_color_depth",
+				"stbi_get_transformed_size",
+				"stbi_transform_image",
+				"stbi_encode_bmp_growable",
+				"stbi_encode_png_growable",
+				"stbi_encode_jpg_growable",
+				"stbi_encode_tga_growable",
+				"stbi_growable_buffer_free",
+				"stbi_transcode_batch",
+				"stbi_release_transcoded_image",
+				"stbi_get_transcoding_memory_usage",
+				"stbi_encode_png_with_options",
+				"stbi_load_from_path",
+				"stbi_load_from_fd",
+				"stbi_info_from_path",
+				"stbi_info_from_fd",
+				"stbi_get_pool_stats",
+				"stbi_set_pool_limit",
+				"stbi_trim_pool",
+				"stbi_compare_images",
+				"stbi_pack_atlas",
+				"stbi_render_atlas",
 			}
 
 			for _, functionName in ipairs(exportedApiSurface) do
@@ -72,6 +102,124 @@ describe("stbi", function()
 			end)
 		end)
 
+		describe("stbi_load_from_path", function()
+			it("should decode the image without requiring the file contents to be loaded first", function()
+				local image = ffi.new("stbi_image_t")
+				local filePath = path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp")
+				assertTrue(stbi.bindings.stbi_load_from_path(filePath, image, ffi.C.NO_CONVERSION))
+
+				local expectedImage = ffi.new("stbi_image_t")
+				stbi.bindings.stbi_load_image(EXAMPLE_FILE_CONTENTS, #EXAMPLE_FILE_CONTENTS, expectedImage)
+				assertEquals(image.width, expectedImage.width)
+				assertEquals(image.height, expectedImage.height)
+				assertEquals(image.channels, expectedImage.channels)
+				local numBytes = image.width * image.height * image.channels
+				assertEquals(ffi.string(image.data, numBytes), ffi.string(expectedImage.data, numBytes))
+
+				stbi.bindings.stbi_image_free(expectedImage)
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should return false if the file doesn't exist", function()
+				local image = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_load_from_path("does-not-exist.bmp", image, ffi.C.NO_CONVERSION))
+			end)
+
+			it("should return false if an invalid color depth was passed", function()
+				local image = ffi.new("stbi_image_t")
+				local filePath = path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp")
+				assertFalse(stbi.bindings.stbi_load_from_path(filePath, image, 42))
+			end)
+		end)
+
+		describe("stbi_load_from_fd", function()
+			it("should decode the image from the start of the file", function()
+				local fd = uv.fs_open(path.join(FIXTURES_DIR, "rgba-pixels.png"), "r", 0)
+				local image = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_load_from_fd(fd, image, ffi.C.CONVERT_TO_RGB_WITH_ALPHA))
+				uv.fs_close(fd)
+
+				assertEquals(image.width, 2)
+				assertEquals(image.height, 2)
+				assertEquals(ffi.string(image.data, 16), "\255\0\0\0\0\255\0\0\0\0\255\0\0\0\0\255")
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should return false if the file descriptor is invalid", function()
+				local image = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_load_from_fd(-1, image, ffi.C.NO_CONVERSION))
+			end)
+		end)
+
+		describe("stbi_info_from_path", function()
+			it("should return the metadata stored in the image header", function()
+				local image = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_info_from_path(path.join(FIXTURES_DIR, "test-icon.png"), image))
+				assertEquals(image.width, 256)
+				assertEquals(image.height, 256)
+				assertEquals(image.channels, 3)
+				assertTrue(image.data == nil)
+			end)
+
+			it("should return false if the file isn't a supported image format", function()
+				local image = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_info_from_path(path.join(FIXTURES_DIR, "miniz-poem.txt"), image))
+			end)
+		end)
+
+		describe("stbi_info_from_fd", function()
+			it("should return the metadata stored in the image header", function()
+				local fd = uv.fs_open(path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp"), "r", 0)
+				local image = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_info_from_fd(fd, image))
+				uv.fs_close(fd)
+
+				assertEquals(image.width, 2)
+				assertEquals(image.height, 3)
+				assertEquals(image.channels, 3)
+			end)
+		end)
+
+		describe("stbi_trim_pool", function()
+			it("should free all pixel buffers retained by the pool", function()
+				local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "test-icon.png"))
+				local image = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_load_rgba(fileContents, #fileContents, image))
+				stbi.bindings.stbi_image_free(image)
+
+				local stats = ffi.new("stbi_pool_stats_t")
+				stbi.bindings.stbi_get_pool_stats(stats)
+				assertTrue(stats.bytes_retained > 0)
+
+				stbi.bindings.stbi_trim_pool()
+				stbi.bindings.stbi_get_pool_stats(stats)
+				assertEquals(tonumber(stats.bytes_retained), 0)
+				for sizeClass = 0, ffi.C.STBI_POOL_NUM_SIZE_CLASSES - 1 do
+					assertEquals(tonumber(stats.num_retained_by_size_class[sizeClass]), 0)
+				end
+			end)
+		end)
+
+		describe("stbi_set_pool_limit", function()
+			it("should prevent the pool from retaining more than the given number of bytes", function()
+				local stats = ffi.new("stbi_pool_stats_t")
+				stbi.bindings.stbi_get_pool_stats(stats)
+				local defaultLimit = stats.max_bytes_retained
+
+				stbi.bindings.stbi_set_pool_limit(0)
+				local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "test-icon.png"))
+				local image = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_load_rgba(fileContents, #fileContents, image))
+				stbi.bindings.stbi_image_free(image)
+
+				stbi.bindings.stbi_get_pool_stats(stats)
+				assertEquals(tonumber(stats.bytes_retained), 0)
+				assertEquals(tonumber(stats.max_bytes_retained), 0)
+
+				stbi.bindings.stbi_set_pool_limit(defaultLimit)
+			end)
+		end)
+
 		describe("stbi_load_image", function()
 			local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp"))
 			it("should return the decoded image data if the buffer contains a supported image format", function()
@@ -362,6 +510,107 @@ describe("stbi", function()
 			end)
 		end)
 
+		describe("stbi_encode_png_growable", function()
+			local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp"))
+
+			it("should produce the same output as the preallocating encoder", function()
+				local image = ffi.new("stbi_image_t")
+				stbi.bindings.stbi_load_image(fileContents, #fileContents, image)
+
+				local maxFileSize = tonumber(stbi.bindings.stbi_get_required_png_size(image, 0))
+				local preallocatedBuffer = buffer.new()
+				local startPointer, length = preallocatedBuffer:reserve(maxFileSize)
+				local numBytesWritten = stbi.bindings.stbi_encode_png(image, startPointer, length, 0)
+				preallocatedBuffer:commit(numBytesWritten)
+
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				assertTrue(stbi.bindings.stbi_encode_png_growable(image, growableBuffer, 0))
+				assertEquals(ffi.string(growableBuffer.data, growableBuffer.size), tostring(preallocatedBuffer))
+
+				stbi.bindings.stbi_growable_buffer_free(growableBuffer)
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should discard the previous contents if the buffer is reused", function()
+				local image = ffi.new("stbi_image_t")
+				stbi.bindings.stbi_load_image(fileContents, #fileContents, image)
+
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				assertTrue(stbi.bindings.stbi_encode_png_growable(image, growableBuffer, 0))
+				local firstResult = ffi.string(growableBuffer.data, growableBuffer.size)
+				assertTrue(stbi.bindings.stbi_encode_png_growable(image, growableBuffer, 0))
+				local secondResult = ffi.string(growableBuffer.data, growableBuffer.size)
+				assertEquals(secondResult, firstResult)
+
+				stbi.bindings.stbi_growable_buffer_free(growableBuffer)
+				assertTrue(growableBuffer.data == nil)
+				assertEquals(tonumber(growableBuffer.capacity), 0)
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should return false if no image was passed", function()
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				assertFalse(stbi.bindings.stbi_encode_png_growable(nil, growableBuffer, 0))
+			end)
+		end)
+
+		describe("stbi_encode_png_with_options", function()
+			local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp"))
+
+			it("should produce images that decode to the original pixels with every filter", function()
+				local image = ffi.new("stbi_image_t")
+				stbi.bindings.stbi_load_image(fileContents, #fileContents, image)
+				local originalPixels = ffi.string(image.data, image.width * image.height * image.channels)
+
+				local filters = {
+					ffi.C.STBI_PNG_FILTER_NONE,
+					ffi.C.STBI_PNG_FILTER_SUB,
+					ffi.C.STBI_PNG_FILTER_UP,
+					ffi.C.STBI_PNG_FILTER_AVERAGE,
+					ffi.C.STBI_PNG_FILTER_PAETH,
+					ffi.C.STBI_PNG_FILTER_ADAPTIVE,
+				}
+
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				for _, filter in ipairs(filters) do
+					for compressionLevel = 0, 9 do
+						local options = ffi.new("stbi_png_options_t", { compressionLevel, filter })
+						assertTrue(stbi.bindings.stbi_encode_png_with_options(image, growableBuffer, options))
+
+						local decodedImage = ffi.new("stbi_image_t")
+						local encodedSize = growableBuffer.size
+						assertTrue(stbi.bindings.stbi_load_image(growableBuffer.data, encodedSize, decodedImage))
+						assertEquals(decodedImage.width, image.width)
+						assertEquals(decodedImage.height, image.height)
+						assertEquals(decodedImage.channels, image.channels)
+						local decodedPixels = ffi.string(decodedImage.data, image.width * image.height * image.channels)
+						assertEquals(decodedPixels, originalPixels)
+						stbi.bindings.stbi_image_free(decodedImage)
+					end
+				end
+
+				stbi.bindings.stbi_growable_buffer_free(growableBuffer)
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should return false if the compression level is out of range", function()
+				local image = ffi.new("stbi_image_t")
+				stbi.bindings.stbi_load_image(fileContents, #fileContents, image)
+
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				local options = ffi.new("stbi_png_options_t", { 10, ffi.C.STBI_PNG_FILTER_NONE })
+				assertFalse(stbi.bindings.stbi_encode_png_with_options(image, growableBuffer, options))
+
+				stbi.bindings.stbi_growable_buffer_free(growableBuffer)
+				stbi.bindings.stbi_image_free(image)
+			end)
+
+			it("should return false if no options were passed", function()
+				local growableBuffer = ffi.new("stbi_growable_buffer_t")
+				assertFalse(stbi.bindings.stbi_encode_png_with_options(nil, growableBuffer, nil))
+			end)
+		end)
+
 		describe("stbi_encode_jpg", function()
 			local fileContents = C_FileSystem.ReadFile(path.join(FIXTURES_DIR, "8bpp-image-without-alpha.bmp"))
 			local image = ffi.new("stbi_image_t")
@@ -422,6 +671,40 @@ describe("stbi", function()
 				stbi.bindings.stbi_image_free(image)
 			end)
 
+			it("should split very large images into restart intervals to encode them in parallel", function()
+				local WIDTH, HEIGHT = 2048, 1024 -- Just large enough to not be handed off to stb_image_write
+				local largeImage = ffi.new("stbi_image_t")
+				largeImage.width = WIDTH
+				largeImage.height = HEIGHT
+				largeImage.channels = 4
+				local pixels = ffi.new("uint8_t[?]", WIDTH * HEIGHT * 4)
+				for index = 0, WIDTH * HEIGHT * 4 - 1 do
+					local x = math.floor(index / 4) % WIDTH
+					pixels[index] = (index % 4 == 3) and 255 or math.floor(x / 8)
+				end
+				largeImage.data = pixels
+
+				local requiredSize = tonumber(stbi.bindings.stbi_get_required_jpg_size(largeImage, 90))
+				local encodedBuffer = buffer.new()
+				local startPointer, length = encodedBuffer:reserve(requiredSize)
+				local numBytesWritten = tonumber(stbi.bindings.stbi_encode_jpg(largeImage, startPointer, length, 90))
+				assertEquals(numBytesWritten, requiredSize)
+				encodedBuffer:commit(numBytesWritten)
+				local encodedFileContents = tostring(encodedBuffer)
+
+				-- DRI marker, followed by the restart interval (one row of 16x16 MCUs)
+				assertTrue(encodedFileContents:find("\255\221\0\4\0\128", 1, true) ~= nil)
+
+				local decodedImage = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_load_rgba(encodedFileContents, #encodedFileContents, decodedImage))
+				decodedImage.channels = 4 -- stb_image reports the number of channels in the file
+				local comparison = ffi.new("stbi_comparison_result_t")
+				assertTrue(stbi.bindings.stbi_compare_images(largeImage, decodedImage, 4, comparison, nil))
+				assertEquals(tonumber(comparison.num_mismatched_pixels), 0)
+
+				stbi.bindings.stbi_image_free(decodedImage)
+			end)
+
 			it("should return zero if a null pointer was passed as the result", function()
 				local numBytesWritten = stbi.bindings.stbi_encode_jpg(image, nil, 0, 100)
 				assertEquals(tonumber(numBytesWritten), 0)
@@ -909,6 +1192,342 @@ describe("stbi", function()
 				end
 			end)
 		end)
+
+		describe("stbi_compare_images", function()
+			local pixelBuffers = {} -- The images don't keep their pixels alive
+			local function createTestImage(numPixels, getPixelValue)
+				local image = ffi.new("stbi_image_t")
+				image.width = numPixels
+				image.height = 1
+				image.channels = 4
+				local pixels = ffi.new("uint8_t[?]", numPixels * 4)
+				for index = 0, numPixels * 4 - 1 do
+					pixels[index] = getPixelValue(index)
+				end
+				image.data = pixels
+				table.insert(pixelBuffers, pixels)
+				return image
+			end
+
+			it("should return false if any of the required arguments is missing", function()
+				local image = createTestImage(4, function(index)
+					return index
+				end)
+				local result = ffi.new("stbi_comparison_result_t")
+				assertFalse(stbi.bindings.stbi_compare_images(nil, image, 0, result, nil))
+				assertFalse(stbi.bindings.stbi_compare_images(image, nil, 0, result, nil))
+				assertFalse(stbi.bindings.stbi_compare_images(image, image, 0, nil, nil))
+			end)
+
+			it("should return false if the image dimensions don't match", function()
+				local getPixelValue = function()
+					return 0
+				end
+				local first = createTestImage(4, getPixelValue)
+				local second = createTestImage(5, getPixelValue)
+				local result = ffi.new("stbi_comparison_result_t")
+				assertFalse(stbi.bindings.stbi_compare_images(first, second, 0, result, nil))
+			end)
+
+			it("should report a perfect match if the images are identical", function()
+				local image = createTestImage(16, function(index)
+					return index % 256
+				end)
+				local result = ffi.new("stbi_comparison_result_t")
+				assertTrue(stbi.bindings.stbi_compare_images(image, image, 0, result, nil))
+				assertEquals(tonumber(result.num_mismatched_pixels), 0)
+				assertEquals(result.mean_squared_error, 0)
+				assertEquals(result.peak_signal_to_noise_ratio, math.huge)
+				assertEquals(result.structural_similarity, 1)
+			end)
+
+			it("should write the absolute differences to the diff image if one was provided", function()
+				local first = createTestImage(2, function(index)
+					return 100
+				end)
+				local second = createTestImage(2, function(index)
+					return index * 10
+				end)
+				local diffImage = ffi.new("stbi_image_t")
+				local diffPixels = ffi.new("uint8_t[?]", 2 * 4)
+				diffImage.data = diffPixels
+
+				local result = ffi.new("stbi_comparison_result_t")
+				assertTrue(stbi.bindings.stbi_compare_images(first, second, 0, result, diffImage))
+				assertEquals(diffImage.width, 2)
+				assertEquals(diffImage.height, 1)
+				assertEquals(diffImage.channels, 4)
+
+				-- The alpha channel is forced to be opaque, or the diff image would be invisible in most viewers
+				local expectedPixels = { 100, 90, 80, 255, 60, 50, 40, 255 }
+				for index = 0, 7 do
+					assertEquals(diffPixels[index], expectedPixels[index + 1])
+				end
+				assertEquals(tonumber(result.num_mismatched_pixels), 2)
+				assertEquals(result.max_absolute_difference[0], 100)
+				assertEquals(result.max_absolute_difference[3], 70)
+			end)
+
+			it("should produce the same results regardless of which SIMD level is used", function()
+				-- Odd pixel counts ensure the leftover pixels that don't fill an entire vector are also processed
+				local NUM_PIXELS = 1027
+				local first = createTestImage(NUM_PIXELS, function(index)
+					return (index * 7) % 256
+				end)
+				local second = createTestImage(NUM_PIXELS, function(index)
+					return (index * 13) % 256
+				end)
+
+				local supportedLevel = tonumber(stbi.bindings.stbi_get_simd_level()) -- Enums are returned as cdata
+				local function compareImages(level)
+					assertTrue(stbi.bindings.stbi_set_simd_level(level))
+					local result = ffi.new("stbi_comparison_result_t")
+					local diffImage = ffi.new("stbi_image_t")
+					local diffPixels = ffi.new("uint8_t[?]", NUM_PIXELS * 4)
+					diffImage.data = diffPixels
+					assertTrue(stbi.bindings.stbi_compare_images(first, second, 16, result, diffImage))
+					return result, ffi.string(diffPixels, NUM_PIXELS * 4)
+				end
+
+				local expectedResult, expectedDiffPixels = compareImages(ffi.C.STBI_SIMD_SCALAR)
+				for level = ffi.C.STBI_SIMD_SCALAR, supportedLevel do
+					local result, diffPixels = compareImages(level)
+					assertEquals(diffPixels, expectedDiffPixels)
+					assertEquals(tonumber(result.num_mismatched_pixels), tonumber(expectedResult.num_mismatched_pixels))
+					assertEquals(result.mean_squared_error, expectedResult.mean_squared_error)
+					for channel = 0, 3 do
+						local meanAbsoluteDifference = result.mean_absolute_difference[channel]
+						local maxAbsoluteDifference = result.max_absolute_difference[channel]
+						assertEquals(meanAbsoluteDifference, expectedResult.mean_absolute_difference[channel])
+						assertEquals(maxAbsoluteDifference, expectedResult.max_absolute_difference[channel])
+					end
+				end
+				stbi.bindings.stbi_set_simd_level(supportedLevel)
+			end)
+		end)
+
+		describe("stbi_pack_atlas", function()
+			local function createImages(dimensions)
+				local images = ffi.new("stbi_image_t[?]", #dimensions)
+				for index, size in ipairs(dimensions) do
+					images[index - 1].width = size[1]
+					images[index - 1].height = size[2]
+					images[index - 1].channels = 4
+				end
+				return images
+			end
+
+			it("should compute the layout without requiring any pixel data", function()
+				local images = createImages({ { 2, 2 }, { 4, 4 }, { 1, 1 } })
+				local options = ffi.new("stbi_atlas_options_t", { max_width = 64, max_height = 64, padding = 0 })
+				local regions = ffi.new("stbi_atlas_region_t[?]", 3)
+				local atlas = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_pack_atlas(images, 3, options, regions, atlas))
+
+				assertEquals(atlas.width, 4)
+				assertEquals(atlas.height, 6)
+				assertEquals(atlas.channels, 4)
+
+				-- Tallest images are placed first, and the others fill the gaps as low as possible
+				assertEquals({ regions[0].x, regions[0].y, regions[0].width, regions[0].height }, { 0, 4, 2, 2 })
+				assertEquals({ regions[1].x, regions[1].y, regions[1].width, regions[1].height }, { 0, 0, 4, 4 })
+				assertEquals({ regions[2].x, regions[2].y, regions[2].width, regions[2].height }, { 2, 4, 1, 1 })
+				assertEquals({ regions[1].min_u, regions[1].min_v, regions[1].max_u }, { 0, 0, 1 })
+				assertEquals({ regions[2].min_u, regions[2].max_u }, { 0.5, 0.75 })
+			end)
+
+			it("should leave room for the padding between images", function()
+				local images = createImages({ { 2, 2 }, { 2, 2 } })
+				local options = ffi.new("stbi_atlas_options_t", { max_width = 64, max_height = 64, padding = 1 })
+				local regions = ffi.new("stbi_atlas_region_t[?]", 2)
+				local atlas = ffi.new("stbi_image_t")
+				assertTrue(stbi.bindings.stbi_pack_atlas(images, 2, options, regions, atlas))
+
+				assertEquals({ regions[0].x, regions[0].y }, { 0, 0 })
+				assertEquals({ regions[1].x, regions[1].y }, { 0, 3 })
+				assertEquals(atlas.width, 2)
+				assertEquals(atlas.height, 5)
+			end)
+
+			it("should return false if the images don't fit into an atlas of the maximum size", function()
+				local images = createImages({ { 64, 64 }, { 64, 64 } })
+				local options = ffi.new("stbi_atlas_options_t", { max_width = 64, max_height = 64, padding = 0 })
+				local regions = ffi.new("stbi_atlas_region_t[?]", 2)
+				local atlas = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 2, options, regions, atlas))
+				assertTrue(stbi.bindings.stbi_pack_atlas(images, 1, options, regions, atlas))
+			end)
+
+			it("should return false if the options are invalid", function()
+				local images = createImages({ { 2, 2 } })
+				local options = ffi.new("stbi_atlas_options_t", { max_width = 64, max_height = 64, padding = -1 })
+				local regions = ffi.new("stbi_atlas_region_t[?]", 1)
+				local atlas = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 1, options, regions, atlas))
+			end)
+
+			it("should return false if any of the required arguments is missing", function()
+				local images = createImages({ { 2, 2 } })
+				local options = ffi.new("stbi_atlas_options_t", { max_width = 64, max_height = 64, padding = 0 })
+				local regions = ffi.new("stbi_atlas_region_t[?]", 1)
+				local atlas = ffi.new("stbi_image_t")
+				assertFalse(stbi.bindings.stbi_pack_atlas(nil, 1, options, regions, atlas))
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 1, nil, regions, atlas))
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 1, options, nil, atlas))
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 1, options, regions, nil))
+				assertFalse(stbi.bindings.stbi_pack_atlas(images, 0, options, regions, atlas))
+			end)
+		end)
+
+		describe("stbi_render_atlas", function()
+			it("should copy the images into their regions and leave the rest of the atlas transparent", function()
+				local images = ffi.new("stbi_image_t[?]", 2)
+				local rgbaPixels = ffi.new("uint8_t[?]", 4, { 1, 2, 3, 4 })
+				local greyscalePixels = ffi.new("uint8_t[?]", 2, { 42, 43 })
+				images[0] = { data = rgbaPixels, width = 1, height = 1, channels = 4 }
+				images[1] = { data = greyscalePixels, width = 2, height = 1, channels = 1 }
+
+				local regions = ffi.new("stbi_atlas_region_t[?]", 2)
+				regions[0] = { x = 0, y = 0, width = 1, height = 1 }
+				regions[1] = { x = 1, y = 1, width = 2, height = 1 }
+
+				local atlasPixels = ffi.new("uint8_t[?]", 3 * 2 * 4)
+				ffi.fill(atlasPixels, 3 * 2 * 4, 0xFF)
+				local atlas = ffi.new("stbi_image_t", { data = atlasPixels, width = 3, height = 2, channels = 4 })
+				assertTrue(stbi.bindings.stbi_render_atlas(images, 2, regions, atlas))
+
+				-- Greyscale is replicated across the color channels, and the alpha channel is opaque
+				local expectedPixels = {
+					{ 1, 2, 3, 4 },
+					{ 0, 0, 0, 0 },
+					{ 0, 0, 0, 0 },
+					{ 0, 0, 0, 0 },
+					{ 42, 42, 42, 255 },
+					{ 43, 43, 43, 255 },
+				}
+				for pixelIndex, expectedPixel in ipairs(expectedPixels) do
+					for channel = 1, 4 do
+						assertEquals(atlasPixels[(pixelIndex - 1) * 4 + channel - 1], expectedPixel[channel])
+					end
+				end
+			end)
+
+			it("should return false if any of the regions exceeds the atlas bounds", function()
+				local pixels = ffi.new("uint8_t[?]", 4)
+				local images = ffi.new("stbi_image_t[?]", 1)
+				images[0] = { data = pixels, width = 1, height = 1, channels = 4 }
+				local regions = ffi.new("stbi_atlas_region_t[?]", 1)
+				regions[0] = { x = 1, y = 0, width = 1, height = 1 }
+
+				local atlasPixels = ffi.new("uint8_t[?]", 4)
+				local atlas = ffi.new("stbi_image_t", { data = atlasPixels, width = 1, height = 1, channels = 4 })
+				assertFalse(stbi.bindings.stbi_render_atlas(images, 1, regions, atlas))
+			end)
+
+			it("should return false if the atlas has no pixel buffer", function()
+				local pixels = ffi.new("uint8_t[?]", 4)
+				local images = ffi.new("stbi_image_t[?]", 1)
+				images[0] = { data = pixels, width = 1, height = 1, channels = 4 }
+				local regions = ffi.new("stbi_atlas_region_t[?]", 1)
+				regions[0] = { x = 0, y = 0, width = 1, height = 1 }
+
+				local atlas = ffi.new("stbi_image_t", { width = 1, height = 1, channels = 4 })
+				assertFalse(stbi.bindings.stbi_render_atlas(images, 1, regions, atlas))
+			end)
+		end)
+
+		describe("stbi_transform_image", function()
+			local RED, GREEN, BLUE, BLACK = "\255\0\0\0", "\0\255\0\0", "\0\0\255\0", "\0\0\0\255"
+
+			local function transformInPlace(step)
+				local pixels = ffi.new("uint8_t[?]", 16)
+				ffi.copy(pixels, RED .. GREEN .. BLUE .. BLACK, 16)
+				local source = ffi.new("stbi_image_t", { data = pixels, width = 2, height = 2, channels = 4 })
+				local steps = ffi.new("stbi_transform_t[1]")
+				steps[0] = step
+
+				local destination = ffi.new("stbi_image_t", { data = pixels, channels = 4 })
+				assertTrue(stbi.bindings.stbi_get_transformed_size(source, steps, 1, destination))
+				assertTrue(stbi.bindings.stbi_transform_image(source, steps, 1, destination))
+
+				return ffi.string(pixels, destination.width * destination.height * destination.channels)
+			end
+
+			it("should be able to rotate the image in place", function()
+				local step = { type = ffi.C.STBI_TRANSFORM_ROTATE, rotation = ffi.C.STBI_ROTATE_CLOCKWISE_90 }
+				assertEquals(transformInPlace(step), BLUE .. RED .. BLACK .. GREEN)
+			end)
+
+			it("should be able to resize the image in place", function()
+				local step = { type = ffi.C.STBI_TRANSFORM_RESIZE, width = 1, height = 1, filter = ffi.C.STBI_FILTER_BOX }
+				assertEquals(transformInPlace(step), "\64\64\64\64")
+			end)
+
+			it("should be able to flip the image in place", function()
+				local step = { type = ffi.C.STBI_TRANSFORM_FLIP, axis = ffi.C.STBI_FLIP_VERTICAL }
+				assertEquals(transformInPlace(step), BLUE .. BLACK .. RED .. GREEN)
+			end)
+		end)
+
+		describe("stbi_set_simd_level", function()
+			local supportedLevel
+			before(function()
+				supportedLevel = tonumber(stbi.bindings.stbi_get_simd_level()) -- Enums are returned as cdata
+			end)
+
+			after(function()
+				stbi.bindings.stbi_set_simd_level(supportedLevel)
+			end)
+
+			it("should default to the best level that is supported by the CPU", function()
+				assertTrue(supportedLevel >= ffi.C.STBI_SIMD_SCALAR)
+				assertTrue(supportedLevel <= ffi.C.STBI_SIMD_AVX2)
+			end)
+
+			it("should return false if the given level isn't supported by the CPU", function()
+				assertFalse(stbi.bindings.stbi_set_simd_level(supportedLevel + 1))
+				assertEquals(tonumber(stbi.bindings.stbi_get_simd_level()), supportedLevel)
+			end)
+
+			it("should always allow falling back to the scalar implementation", function()
+				assertTrue(stbi.bindings.stbi_set_simd_level(ffi.C.STBI_SIMD_SCALAR))
+				assertEquals(tonumber(stbi.bindings.stbi_get_simd_level()), ffi.C.STBI_SIMD_SCALAR)
+			end)
+
+			it("should produce the same results regardless of which level is used", function()
+				-- Odd pixel counts ensure the leftover pixels that don't fill an entire vector are also processed
+				local NUM_PIXELS = 1027
+				local function createTestImage()
+					local image = ffi.new("stbi_image_t")
+					image.width = NUM_PIXELS
+					image.height = 1
+					image.channels = 4
+					local pixels = ffi.new("uint8_t[?]", NUM_PIXELS * 4)
+					for index = 0, NUM_PIXELS * 4 - 1 do
+						pixels[index] = index % 3 == 0 and 255 or 0
+					end
+					image.data = pixels
+					return image, pixels -- The image doesn't keep the pixels alive
+				end
+
+				local sourceColor = ffi.new("stbi_color_t", { 255, 0, 0, 255 })
+				local replacementColor = ffi.new("stbi_color_t", { 1, 2, 3, 4 })
+
+				stbi.bindings.stbi_set_simd_level(ffi.C.STBI_SIMD_SCALAR)
+				local expectedImage, expectedImagePixels = createTestImage()
+				stbi.bindings.stbi_replace_pixel_color_rgba(expectedImage, sourceColor, replacementColor)
+				stbi.bindings.stbi_abgr_to_rgba(expectedImage)
+				local expectedPixels = ffi.string(expectedImagePixels, NUM_PIXELS * 4)
+
+				for level = ffi.C.STBI_SIMD_SCALAR, supportedLevel do
+					assertTrue(stbi.bindings.stbi_set_simd_level(level))
+					local image, pixels = createTestImage()
+					stbi.bindings.stbi_replace_pixel_color_rgba(image, sourceColor, replacementColor)
+					stbi.bindings.stbi_abgr_to_rgba(image)
+					assertEquals(ffi.string(pixels, NUM_PIXELS * 4), expectedPixels)
+				end
+			end)
+		end)
 	end)
 
 	describe("version", function()
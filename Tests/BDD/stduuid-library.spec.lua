@@ -11,6 +11,11 @@ describe("stduuid", function()
 				"uuid_create_mt19937",
 				"uuid_create_v5",
 				"uuid_create_system",
+				"uuid_create_v7",
+				"uuid_create_batch",
+				"uuid_format_batch",
+				"uuid_parse",
+				"uuid_validate_batch",
 			}
 
 			for _, functionName in ipairs(exportedApiSurface) do
@@ -60,6 +65,27 @@ describe("stduuid", function()
 				assertTrue(isValidUUID)
 				assertEquals(guid, expectedGUID)
 			end)
+
+			it("should fail instead of throwing if the namespace is malformed", function()
+				local guid = ffi.new("uuid_rfc_string_t")
+				local guidPointer = ffi.cast("char (*)[37]", guid)
+
+				assertFalse(stduuid.bindings.uuid_create_v5("not-a-uuid", "john", guidPointer))
+				assertFalse(stduuid.bindings.uuid_create_v5(nil, "john", guidPointer))
+			end)
+
+			it("should accept namespaces in the braced and compact forms", function()
+				local guid = ffi.new("uuid_rfc_string_t")
+				local guidPointer = ffi.cast("char (*)[37]", guid)
+
+				local bracedNamespace = "{47183823-2574-4bfd-b411-99ed177d3e43}"
+				assertTrue(stduuid.bindings.uuid_create_v5(bracedNamespace, "john", guidPointer))
+				assertEquals(ffi.string(guid), "0dbbd6be-b274-536b-b356-c22d8ea30a0e")
+
+				local compactNamespace = "4718382325744bfdb41199ed177d3e43"
+				assertTrue(stduuid.bindings.uuid_create_v5(compactNamespace, "john", guidPointer))
+				assertEquals(ffi.string(guid), "0dbbd6be-b274-536b-b356-c22d8ea30a0e")
+			end)
 		end)
 
 		describe("uuid_create_system", function()
@@ -74,6 +100,110 @@ describe("stduuid", function()
 				assertTrue(isValidUUID)
 			end)
 		end)
+
+		describe("uuid_create_v7", function()
+			it("should generate a UUID string in the expected format", function()
+				local guid = ffi.new("uuid_rfc_string_t")
+				local guidPointer = ffi.cast("char (*)[37]", guid)
+
+				stduuid.bindings.uuid_create_v7(guidPointer)
+				guid = ffi.string(guid)
+
+				local isValidUUID = string.match(guid, UUID_PATTERN) ~= nil
+				assertTrue(isValidUUID)
+				assertEquals(guid:sub(15, 15), "7")
+			end)
+		end)
+
+		describe("uuid_create_batch", function()
+			it("should write the requested number of UUIDs back to back", function()
+				local numUUIDs = 100
+				local output = ffi.new("char[?]", numUUIDs * ffi.C.UUID_RFC_STRING_LENGTH)
+				local success = stduuid.bindings.uuid_create_batch(
+					ffi.C.UUID_VERSION_RANDOM,
+					ffi.C.UUID_FORMAT_RFC_STRING,
+					numUUIDs,
+					output
+				)
+				assertTrue(success)
+
+				local guids = ffi.string(output, numUUIDs * ffi.C.UUID_RFC_STRING_LENGTH)
+				for index = 1, numUUIDs, 1 do
+					local offset = (index - 1) * ffi.C.UUID_RFC_STRING_LENGTH
+					local guid = guids:sub(offset + 1, offset + ffi.C.UUID_RFC_STRING_LENGTH)
+					assertTrue(string.match(guid, UUID_PATTERN) ~= nil)
+					assertEquals(guid:sub(15, 15), "4")
+				end
+			end)
+
+			it("should set the version and variant bits in binary mode", function()
+				local numUUIDs = 100
+				local output = ffi.new("uint8_t[?]", numUUIDs * ffi.C.UUID_BINARY_SIZE)
+				local success = stduuid.bindings.uuid_create_batch(
+					ffi.C.UUID_VERSION_TIME_ORDERED,
+					ffi.C.UUID_FORMAT_BINARY,
+					numUUIDs,
+					ffi.cast("char*", output)
+				)
+				assertTrue(success)
+
+				for index = 0, numUUIDs - 1, 1 do
+					local offset = index * ffi.C.UUID_BINARY_SIZE
+					assertEquals(bit.rshift(output[offset + 6], 4), 7)
+					assertEquals(bit.rshift(output[offset + 8], 6), 2)
+				end
+			end)
+
+			it("should fail if an unsupported version is requested", function()
+				local output = ffi.new("char[?]", ffi.C.UUID_BINARY_SIZE)
+				assertFalse(stduuid.bindings.uuid_create_batch(5, ffi.C.UUID_FORMAT_BINARY, 1, output))
+			end)
+		end)
+
+		describe("uuid_format_batch", function()
+			it("should format binary UUIDs as lowercase RFC strings", function()
+				local binaryUUID = "\71\24\56\35\37\116\75\253\180\17\153\237\23\125\62\67"
+				local output = ffi.new("char[?]", ffi.C.UUID_RFC_STRING_LENGTH)
+				stduuid.bindings.uuid_format_batch(binaryUUID, 1, output)
+				assertEquals(ffi.string(output, ffi.C.UUID_RFC_STRING_LENGTH), "47183823-2574-4bfd-b411-99ed177d3e43")
+			end)
+		end)
+
+		describe("uuid_parse", function()
+			it("should write the binary representation if the input is valid", function()
+				local input = "47183823-2574-4bfd-b411-99ed177d3e43"
+				local result = ffi.new("uint8_t[?]", ffi.C.UUID_BINARY_SIZE)
+				assertTrue(stduuid.bindings.uuid_parse(input, #input, result))
+				assertEquals(result[0], 0x47)
+				assertEquals(result[15], 0x43)
+			end)
+
+			it("should leave the output untouched if the input is invalid", function()
+				local input = "47183823-2574-4bfd-b411-99ed177d3e4x"
+				local result = ffi.new("uint8_t[?]", ffi.C.UUID_BINARY_SIZE)
+				assertFalse(stduuid.bindings.uuid_parse(input, #input, result))
+				assertEquals(result[0], 0)
+			end)
+
+			it("should fail if no input was passed", function()
+				assertFalse(stduuid.bindings.uuid_parse(nil, 36, nil))
+			end)
+		end)
+
+		describe("uuid_validate_batch", function()
+			it("should return the number of valid inputs", function()
+				local inputs = ffi.new("uuid_string_ref_t[2]")
+				inputs[0].data = "47183823-2574-4bfd-b411-99ed177d3e43"
+				inputs[0].length = 36
+				inputs[1].data = "47183823-2574-4bfd-b411-99ed177d3e43"
+				inputs[1].length = 35
+
+				local results = ffi.new("bool[2]")
+				assertEquals(tonumber(stduuid.bindings.uuid_validate_batch(inputs, 2, results)), 1)
+				assertTrue(results[0])
+				assertFalse(results[1])
+			end)
+		end)
 	end)
 
 	describe("version", function()
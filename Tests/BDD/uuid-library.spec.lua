@@ -66,6 +66,94 @@ describe("uuid", function()
 		end)
 	end)
 
+	describe("createTimeOrderedUUID", function()
+		it("should generate a UUID string in the expected format", function()
+			local guid = uuid.createTimeOrderedUUID()
+
+			local isValidUUID = string.match(guid, UUID_PATTERN) ~= nil
+			assertTrue(isValidUUID)
+			assertEquals(guid:sub(15, 15), "7")
+		end)
+
+		it("should generate UUIDs that are ordered by creation time", function()
+			local previousGUID = uuid.createTimeOrderedUUID()
+			for i = 1, 1000, 1 do
+				local guid = uuid.createTimeOrderedUUID()
+				assertTrue(guid > previousGUID)
+				previousGUID = guid
+			end
+		end)
+	end)
+
+	describe("createBatch", function()
+		it("should return a table of UUID strings if no buffer was passed", function()
+			local guids = uuid.createBatch(100)
+			assertEquals(#guids, 100)
+			for _, guid in ipairs(guids) do
+				assertTrue(string.match(guid, UUID_PATTERN) ~= nil)
+				assertEquals(guid:sub(15, 15), "4")
+			end
+		end)
+
+		it("should generate time-ordered UUIDs in ascending order", function()
+			local guids = uuid.createBatch(1000, uuid.VERSION_TIME_ORDERED)
+			for index = 2, #guids, 1 do
+				assertTrue(guids[index] > guids[index - 1])
+			end
+		end)
+
+		it("should append the UUIDs to the given buffer if one was passed", function()
+			local outputBuffer = buffer.new()
+			outputBuffer:put("UUIDs: ")
+
+			local returnValue = uuid.createBatch(10, uuid.VERSION_RANDOM, uuid.FORMAT_BINARY, outputBuffer)
+			assertEquals(returnValue, outputBuffer)
+			assertEquals(#outputBuffer, #"UUIDs: " + 10 * 16)
+		end)
+
+		it("should return an empty table if no UUIDs were requested", function()
+			assertEquals(#uuid.createBatch(0), 0)
+		end)
+
+		it("should throw if an invalid count was passed", function()
+			assertThrows(function()
+				uuid.createBatch(-1)
+			end, "Invalid UUID count -1 (must be a non-negative integer)")
+		end)
+
+		it("should throw if an unsupported version was passed", function()
+			assertThrows(function()
+				uuid.createBatch(1, "v5")
+			end, "Unsupported UUID version v5")
+		end)
+
+		it("should throw if an unsupported format was passed", function()
+			assertThrows(function()
+				uuid.createBatch(1, uuid.VERSION_RANDOM, "hex")
+			end, "Unsupported UUID format hex")
+		end)
+	end)
+
+	describe("fromBinary", function()
+		it("should convert binary UUIDs to RFC UUID strings", function()
+			local binaryUUID = "\71\24\56\35\37\116\75\253\180\17\153\237\23\125\62\67"
+			assertEquals(uuid.fromBinary(binaryUUID), "47183823-2574-4bfd-b411-99ed177d3e43")
+		end)
+
+		it("should be able to convert binary UUIDs created in batches", function()
+			local binaryUUIDs = uuid.createBatch(10, uuid.VERSION_TIME_ORDERED, uuid.FORMAT_BINARY)
+			for _, binaryUUID in ipairs(binaryUUIDs) do
+				assertTrue(string.match(uuid.fromBinary(binaryUUID), UUID_PATTERN) ~= nil)
+			end
+		end)
+
+		it("should throw if the input isn't exactly 16 bytes long", function()
+			assertThrows(function()
+				uuid.fromBinary("47183823-2574-4bfd-b411-99ed177d3e43")
+			end, "Expected argument binaryUUID to be exactly 16 bytes long")
+		end)
+	end)
+
 	describe("isCanonical", function()
 		it("should return false if an invalid type is passed", function()
 			local isValidUUID = uuid.isCanonical(42)
@@ -82,6 +170,79 @@ describe("uuid", function()
 		end)
 	end)
 
+	describe("isValid", function()
+		it("should return false if an invalid type is passed", function()
+			assertFalse(uuid.isValid(42))
+			assertFalse(uuid.isValid(nil))
+		end)
+
+		it("should return true if the value passed is a UUID string in any of the supported forms", function()
+			assertTrue(uuid.isValid("47183823-2574-4bfd-b411-99ed177d3e43"))
+			assertTrue(uuid.isValid("{47183823-2574-4BFD-B411-99ED177D3E43}"))
+			assertTrue(uuid.isValid("4718382325744bfdb41199ed177d3e43"))
+		end)
+
+		it("should return false if the value passed is not a valid UUID string", function()
+			assertFalse(uuid.isValid(""))
+			assertFalse(uuid.isValid("47183823-2574-4bfd-b411-99ed177d3e43xxx"))
+			assertFalse(uuid.isValid("47183823-2574-4bfd-b411-99ed177d3e4g"))
+			assertFalse(uuid.isValid("47183823+2574-4bfd-b411-99ed177d3e43"))
+			assertFalse(uuid.isValid("{47183823-2574-4bfd-b411-99ed177d3e43"))
+			assertFalse(uuid.isValid("4718382325744bfdb41199ed177d3e4"))
+		end)
+	end)
+
+	describe("parse", function()
+		it("should return the binary representation of the given UUID string", function()
+			local expectedBinaryUUID = "\71\24\56\35\37\116\75\253\180\17\153\237\23\125\62\67"
+			assertEquals(uuid.parse("47183823-2574-4bfd-b411-99ed177d3e43"), expectedBinaryUUID)
+			assertEquals(uuid.parse("{47183823-2574-4bfd-b411-99ed177d3e43}"), expectedBinaryUUID)
+			assertEquals(uuid.parse("4718382325744BFDB41199ED177D3E43"), expectedBinaryUUID)
+		end)
+
+		it("should be the inverse of fromBinary", function()
+			local guid = uuid.createTimeOrderedUUID()
+			assertEquals(uuid.fromBinary(uuid.parse(guid)), guid)
+		end)
+
+		it("should fail if the input isn't a valid UUID string", function()
+			assertFailure(function()
+				return uuid.parse("47183823-2574-4bfd-b411-99ed177d3e43xxx")
+			end, "Invalid UUID string 47183823-2574-4bfd-b411-99ed177d3e43xxx")
+			assertFailure(function()
+				return uuid.parse(42)
+			end, "Cannot parse UUID from a number value")
+		end)
+	end)
+
+	describe("validateBatch", function()
+		it("should return the validation result for each input, in the same order", function()
+			local inputs = {
+				"47183823-2574-4bfd-b411-99ed177d3e43",
+				"not-a-uuid",
+				"{47183823-2574-4bfd-b411-99ed177d3e43}",
+				42,
+				"4718382325744bfdb41199ed177d3e43",
+			}
+
+			local results, numValidInputs = uuid.validateBatch(inputs)
+			assertEquals(results, { true, false, true, false, true })
+			assertEquals(numValidInputs, 3)
+		end)
+
+		it("should return an empty table if no inputs were passed", function()
+			local results, numValidInputs = uuid.validateBatch({})
+			assertEquals(results, {})
+			assertEquals(numValidInputs, 0)
+		end)
+
+		it("should throw if a non-table value was passed", function()
+			assertThrows(function()
+				uuid.validateBatch("47183823-2574-4bfd-b411-99ed177d3e43")
+			end, "Expected argument inputs to be a table value, but received a string value instead")
+		end)
+	end)
+
 	describe("create", function()
 		it("should generate a UUID string in the expected format", function()
 			assertEquals(uuid.create, uuid.createMersenneTwistedUUID)
@@ -0,0 +1,39 @@
+local json = require("json")
+local runtime = require("runtime")
+
+-- The allocator can only be selected at startup, so the runtime library spec runs this with EVO_LUA_ALLOCATOR set
+local function getAllocatorStats()
+	local stats = runtime.getAllocatorStats()
+	if not stats then
+		return nil
+	end
+
+	-- The last size class has no upper limit, which can't be represented in JSON
+	local sizeClasses = stats.sizeClasses
+	stats.numSizeClasses = #sizeClasses
+	stats.smallestSizeClassLimit = sizeClasses[1].maxSizeInBytes
+	stats.hasUnboundedSizeClass = (sizeClasses[#sizeClasses].maxSizeInBytes == math.huge)
+	stats.numSmallAllocations = 0
+	for index = 1, #stats.sizeClasses - 1, 1 do
+		stats.numSmallAllocations = stats.numSmallAllocations + stats.sizeClasses[index].numAllocations
+	end
+	stats.sizeClasses = nil
+
+	return stats
+end
+
+local statsBefore = getAllocatorStats()
+
+-- Enough small objects to require a few fresh slabs, even if the pools had some blocks to spare
+local objects = {}
+for index = 1, 50000, 1 do
+	objects[index] = { id = "object-" .. index }
+end
+
+local statsAfter = getAllocatorStats()
+
+print(json.stringify({
+	before = statsBefore,
+	after = statsAfter,
+	numObjects = #objects,
+}))
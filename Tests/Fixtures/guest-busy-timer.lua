@@ -0,0 +1,22 @@
+local uv = require("uv")
+
+local NUM_BUSY_CALLBACKS = 2
+local BUSY_TIME_IN_NANOSECONDS = 3E6
+
+-- The timer keeps firing while the guest is throttled, so these callbacks should be deferred (and run later)
+local numCallbacks = 0
+local timer = uv.new_timer()
+timer:start(0, 1, function()
+	numCallbacks = numCallbacks + 1
+	if numCallbacks > NUM_BUSY_CALLBACKS then
+		if not timer:is_closing() then
+			timer:close()
+		end
+		return
+	end
+
+	-- Busy waiting should exceed any small CPU time budget
+	local startTime = uv.hrtime()
+	repeat
+	until uv.hrtime() - startTime > BUSY_TIME_IN_NANOSECONDS
+end)
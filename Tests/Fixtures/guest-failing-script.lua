@@ -0,0 +1,9 @@
+local uv = require("uv")
+
+-- The timer must be closed when the guest is removed, or its callback would still be run by the host's event loop
+local timer = uv.new_timer()
+timer:start(10, 10, function()
+	error("This callback should never run")
+end)
+
+error("This guest failed to initialize")
@@ -0,0 +1,10 @@
+local uv = require("uv")
+
+local timer = uv.new_timer()
+timer:start(0, 0, function()
+	timer:close()
+
+	-- Without an instruction budget, this would block the host's event loop forever
+	while true do
+	end
+end)
@@ -0,0 +1,10 @@
+local uv = require("uv")
+
+local timer = uv.new_timer()
+timer:start(0, 0, function()
+	timer:close()
+
+	-- Much larger than the memory limit used in the tests (so the allocation is guaranteed to fail)
+	local hugeString = string.rep("x", 256 * 1024 * 1024)
+	GUEST_HUGE_STRING = hugeString
+end)
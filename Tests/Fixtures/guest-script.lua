@@ -0,0 +1,16 @@
+local bindings = require("bindings")
+local uv = require("uv")
+
+-- Guests must not be able to see (or modify) the host's globals
+GUEST_SCRIPT_GLOBAL = "Hello from the guest VM"
+
+-- Nor should they be able to access bindings that operate on the host's VM (or create guests of their own)
+assert(bindings.runtime == nil, "Guests should not have access to the runtime bindings")
+assert(bindings.rml == nil, "Guests should not have access to the RML bindings")
+assert(bindings.uws == nil, "Guests should not have access to the uws bindings")
+assert(bindings.iconv ~= nil, "Guests should have access to the iconv bindings")
+
+local timer = uv.new_timer()
+timer:start(0, 0, function()
+	timer:close()
+end)